@@ -0,0 +1,5 @@
+#include "../CSC8503/AssetToolStart.cpp"
+
+int main(int argc, char** argv) {
+	return RunAssetTool(argc, argv);
+}
@@ -0,0 +1,123 @@
+################################################################################
+# Adds one of the headless builds' executables: the dedicated server or a tool
+# built around the game's libraries, without a window, renderer or audio.
+#
+# Input:
+#     NAME       - Executable target
+#     START_FILE - Source with its main, relative to the calling directory
+################################################################################
+function(add_headless_tool NAME START_FILE)
+    message("${NAME} PC")
+
+    set(Source_Files
+        "${START_FILE}"
+    )
+
+    source_group("Source Files" FILES ${Source_Files})
+
+    add_executable(${NAME} ${Source_Files})
+
+    set_target_properties(${NAME} PROPERTIES
+        VS_GLOBAL_KEYWORD "Win32Proj"
+    )
+    set_target_properties(${NAME} PROPERTIES
+        INTERPROCEDURAL_OPTIMIZATION_RELEASE "TRUE"
+    )
+
+    ################################################################################
+    # Compile definitions
+    ################################################################################
+    if(MSVC)
+        target_compile_definitions(${NAME} PRIVATE
+            "UNICODE;"
+            "_UNICODE"
+            "WIN32_LEAN_AND_MEAN"
+            "_WINSOCKAPI_"
+            "_WINSOCK2API_"
+            "_WINSOCK_DEPRECATED_NO_WARNINGS"
+        )
+    endif()
+
+    target_precompile_headers(${NAME} PRIVATE
+        <vector>
+        <map>
+        <stack>
+        <list>
+        <set>
+        <string>
+        <thread>
+        <atomic>
+        <functional>
+        <iostream>
+        <chrono>
+        <sstream>
+
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Vector2i.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Vector3i.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Vector4i.h"
+
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Vector2.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Vector3.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Vector4.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Quaternion.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Plane.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Matrix2.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Matrix3.h"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/Matrix4.h"
+
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/GameTimer.h"
+    )
+
+    ################################################################################
+    # Compile and link options
+    ################################################################################
+    if(MSVC)
+        target_compile_options(${NAME} PRIVATE
+            $<$<CONFIG:Release>:
+                /Oi;
+                /Gy
+            >
+            /permissive-;
+            /std:c++latest;
+            /sdl;
+            /W3;
+            ${DEFAULT_CXX_DEBUG_INFORMATION_FORMAT};
+            ${DEFAULT_CXX_EXCEPTION_HANDLING};
+            /Y-
+        )
+        target_link_options(${NAME} PRIVATE
+            $<$<CONFIG:Release>:
+                /OPT:REF;
+                /OPT:ICF
+            >
+        )
+    endif()
+
+    ################################################################################
+    # Dependencies
+    ################################################################################
+    if(MSVC)
+        target_link_libraries(${NAME} LINK_PUBLIC "Winmm.lib")
+    endif()
+
+    target_include_directories(${NAME} PRIVATE
+        "${CMAKE_SOURCE_DIR}/CSC8503"
+        "${CMAKE_SOURCE_DIR}/OpenGLRendering/"
+        "${CMAKE_SOURCE_DIR}/NCLCoreClasses/"
+        "${CMAKE_SOURCE_DIR}/CSC8503CoreClasses/"
+        "${CMAKE_SOURCE_DIR}/Recast"
+        "${CMAKE_SOURCE_DIR}/Detour"
+        "${CMAKE_SOURCE_DIR}/DebugUtils"
+        "${CMAKE_SOURCE_DIR}/DetourTileCache"
+        "${CMAKE_SOURCE_DIR}/FMODCoreAPI/includes"
+    )
+
+    target_link_libraries(${NAME} LINK_PUBLIC CSC8503)
+    target_link_libraries(${NAME} LINK_PUBLIC NCLCoreClasses)
+    target_link_libraries(${NAME} LINK_PUBLIC CSC8503CoreClasses)
+    target_link_libraries(${NAME} LINK_PUBLIC OpenGLRendering)
+    target_link_libraries(${NAME} LINK_PUBLIC Recast)
+    target_link_libraries(${NAME} LINK_PUBLIC Detour)
+    target_link_libraries(${NAME} LINK_PUBLIC DebugUtils)
+    target_link_libraries(${NAME} LINK_PUBLIC DetourTileCache)
+endfunction()
@@ -0,0 +1,340 @@
+#include "AssetCache.h"
+#include "Assets.h"
+#include "CookedAnimation.h"
+#include "CookedLevel.h"
+#include "CookedMaterial.h"
+#include "CookedMesh.h"
+#include "CookedTexture.h"
+#include "LevelReader.h"
+#include "MeshAnimation.h"
+#include "MeshMaterial.h"
+#include "MshLoader.h"
+#include "NullRenderer.h"
+#include "TextureLoader.h"
+
+using namespace NCL;
+using namespace CSC8503;
+using namespace Rendering;
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+enum AssetKind {
+    MeshAsset,
+    ClipAsset,
+    MaterialAsset,
+    TextureAsset,
+    LevelAsset,
+    RoomAsset,
+    ASSET_KIND_COUNT
+};
+
+namespace {
+    constexpr const char* ASSET_KIND_NAMES[ASSET_KIND_COUNT] = { "mesh", "clip", "material", "texture", "level", "room" };
+}
+
+struct UsedAsset {
+    AssetKind kind;
+    //as its loader takes it, a full path for levels and rooms
+    std::string file;
+};
+
+//Every texture a material's layers name, which the renderer loads alongside the ones UsedAssets.csv lists.
+void AddMaterialTextures(const std::string& file, std::vector<UsedAsset>& assets) {
+    //read as text so finding the assets doesn't cache anything
+    MeshMaterial material;
+    material.LoadTextMaterial(file);
+    for (int i = 0; material.GetMaterialForLayer(i); i++) {
+        for (const char* channel : { "Diffuse", "Normal" }) {
+            const std::string* texture = nullptr;
+            const bool isNew = material.GetMaterialForLayer(i)->GetEntry(channel, &texture) &&
+                std::none_of(assets.begin(), assets.end(), [texture](const UsedAsset& asset) { return asset.kind == TextureAsset && asset.file == *texture; });
+            if (isNew) {
+                assets.push_back({ TextureAsset, *texture });
+            }
+        }
+    }
+}
+
+//What LevelManager loads at start up: UsedAssets.csv, the textures its materials name, and every level and room.
+//Shaders are left out, they are compiled by the driver and there is nothing of them to cook.
+std::vector<UsedAsset> FindUsedAssets() {
+    std::vector<UsedAsset> assets;
+    std::ifstream assetsFile(Assets::ASSETROOT + "UsedAssets.csv");
+    std::string line;
+    std::vector<std::string> materials;
+    while (getline(assetsFile, line)) {
+        //type,name,file,extra
+        const size_t typeEnd = line.find(',');
+        const size_t nameEnd = typeEnd == std::string::npos ? typeEnd : line.find(',', typeEnd + 1);
+        if (nameEnd == std::string::npos) {
+            continue;
+        }
+        const size_t fileEnd = line.find(',', nameEnd + 1);
+        const std::string type = line.substr(0, typeEnd);
+        const std::string file = line.substr(nameEnd + 1, fileEnd == std::string::npos ? fileEnd : fileEnd - nameEnd - 1);
+        if (type == "msh") {
+            assets.push_back({ MeshAsset, file });
+        }
+        else if (type == "anim") {
+            assets.push_back({ ClipAsset, file });
+        }
+        else if (type == "mat") {
+            assets.push_back({ MaterialAsset, file });
+            materials.push_back(file);
+        }
+        else if (type == "tex") {
+            assets.push_back({ TextureAsset, file });
+        }
+    }
+    for (const std::string& material : materials) {
+        AddMaterialTextures(material, assets);
+    }
+    for (const char* folder : { "Levels", "Rooms" }) {
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(Assets::LEVELDIR + folder)) {
+            if (entry.path().extension() == ".json") {
+                assets.push_back({ strcmp(folder, "Rooms") == 0 ? RoomAsset : LevelAsset, entry.path().string() });
+            }
+        }
+    }
+    return assets;
+}
+
+std::string GetCookedPath(const UsedAsset& asset) {
+    switch (asset.kind) {
+    case MeshAsset:
+        return CookedMesh::GetCookedPath(asset.file);
+    case ClipAsset:
+        return CookedAnimation::GetCookedPath(asset.file);
+    case MaterialAsset:
+        return CookedMaterial::GetCookedPath(asset.file);
+    case TextureAsset:
+        return CookedTexture::GetCookedPath(TextureLoader::GetImagePath(asset.file));
+    default:
+        return CookedLevel::GetCookedPath(asset.file);
+    }
+}
+
+bool IsCached(const UsedAsset& asset) {
+    const std::string cookedPath = GetCookedPath(asset);
+    return !cookedPath.empty() && std::filesystem::exists(cookedPath);
+}
+
+//Loads the asset as the game does, so through the cache, and cooked into it if it isn't there yet, when the cache is enabled.
+bool LoadAsset(const UsedAsset& asset) {
+    switch (asset.kind) {
+    case MeshAsset: {
+        NullMesh mesh;
+        return MshLoader::LoadMesh(asset.file, mesh);
+    }
+    case ClipAsset: {
+        MeshAnimation anim(asset.file);
+        return anim.GetFrameCount() > 0;
+    }
+    case MaterialAsset: {
+        MeshMaterial material(asset.file);
+        return material.GetMaterialForLayer(0) != nullptr;
+    }
+    case TextureAsset: {
+        char* data = nullptr;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        int flags = 0;
+        const bool isLoaded = TextureLoader::LoadTexture(asset.file, data, width, height, channels, flags);
+        free(data);
+        return isLoaded;
+    }
+    case LevelAsset: {
+        Level level(asset.file);
+        return true;
+    }
+    default: {
+        Room room(asset.file);
+        return true;
+    }
+    }
+}
+
+//Whether the cached copy loads the same as importing the source again, without cooking anything.
+bool IsCachedMatch(const UsedAsset& asset) {
+    switch (asset.kind) {
+    case MeshAsset: {
+        NullMesh expected;
+        NullMesh actual;
+        return CookedMesh::Load(asset.file, actual) && MshLoader::LoadTextMesh(asset.file, expected) && CookedMesh::IsSameMesh(expected, actual);
+    }
+    case ClipAsset: {
+        MeshAnimation expected;
+        MeshAnimation actual;
+        return CookedAnimation::Load(asset.file, actual) && expected.LoadTextAnimation(asset.file) &&
+            CookedAnimation::GetMaxError(expected, actual) <= CookedAnimation::MAX_ERROR;
+    }
+    case MaterialAsset: {
+        MeshMaterial expected;
+        MeshMaterial actual;
+        return CookedMaterial::Load(asset.file, actual) && expected.LoadTextMaterial(asset.file) && CookedMaterial::IsSameMaterial(expected, actual);
+    }
+    case TextureAsset: {
+        char* cooked = nullptr;
+        int width = 0;
+        int height = 0;
+        if (!CookedTexture::Load(TextureLoader::GetImagePath(asset.file), cooked, width, height)) {
+            return false;
+        }
+        char* decoded = nullptr;
+        int decodedWidth = 0;
+        int decodedHeight = 0;
+        int channels = 0;
+        int flags = 0;
+        //disabled, so the image is decoded and not cooked again
+        AssetCache::SetEnabled(false);
+        const bool isDecoded = TextureLoader::LoadTexture(asset.file, decoded, decodedWidth, decodedHeight, channels, flags);
+        AssetCache::SetEnabled(true);
+        const bool isMatch = isDecoded && decodedWidth == width && decodedHeight == height &&
+            memcmp(cooked, decoded, (size_t)width * height * 4) == 0;
+        free(cooked);
+        free(decoded);
+        return isMatch;
+    }
+    case LevelAsset: {
+        Level expected;
+        Level actual;
+        LevelReader reader;
+        return CookedLevel::Load(asset.file, &actual, nullptr) && reader.ReadFile(asset.file, &expected, nullptr) && CookedLevel::IsSameLevel(expected, actual);
+    }
+    default: {
+        Room expected;
+        Room actual;
+        LevelReader reader;
+        return CookedLevel::Load(asset.file, nullptr, &actual) && reader.ReadFile(asset.file, nullptr, &expected) && CookedLevel::IsSameRoom(expected, actual);
+    }
+    }
+}
+
+size_t GetCacheBytes() {
+    size_t bytes = 0;
+    std::error_code error;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(AssetCache::GetCacheDir(), error)) {
+        if (entry.is_regular_file()) {
+            bytes += (size_t)entry.file_size();
+        }
+    }
+    return bytes;
+}
+
+//Milliseconds to load every asset once, as a start up would, split by kind.
+double TimeStartup(const std::vector<UsedAsset>& assets, double (&kindMs)[ASSET_KIND_COUNT]) {
+    std::fill(std::begin(kindMs), std::end(kindMs), 0.0);
+    for (const UsedAsset& asset : assets) {
+        const auto start = std::chrono::steady_clock::now();
+        LoadAsset(asset);
+        const auto end = std::chrono::steady_clock::now();
+        kindMs[asset.kind] += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    double total = 0.0;
+    for (double ms : kindMs) {
+        total += ms;
+    }
+    return total;
+}
+
+//Loads every asset, cooking what isn't in the cache yet.
+int RunPrewarm(const std::vector<UsedAsset>& assets) {
+    int cachedCounts[ASSET_KIND_COUNT] = {};
+    int cookedCounts[ASSET_KIND_COUNT] = {};
+    int failedCount = 0;
+    for (const UsedAsset& asset : assets) {
+        const bool wasCached = IsCached(asset);
+        if (!LoadAsset(asset) || !IsCached(asset)) {
+            std::cout << asset.file << " not cached\n";
+            failedCount++;
+        }
+        else if (wasCached) {
+            cachedCounts[asset.kind]++;
+        }
+        else {
+            cookedCounts[asset.kind]++;
+        }
+    }
+    for (int kind = 0; kind < ASSET_KIND_COUNT; kind++) {
+        std::cout << ASSET_KIND_NAMES[kind] << " cached " << cachedCounts[kind] << " cooked " << cookedCounts[kind] << "\n";
+    }
+    std::cout << "cache_bytes " << GetCacheBytes() << "\n";
+    std::cout << "failures " << failedCount << "\n";
+    return failedCount > 0 ? 1 : 0;
+}
+
+//Every asset has to be in the cache as its source is now, and load from it the same as from its source.
+int RunVerify(const std::vector<UsedAsset>& assets) {
+    int failedCount = 0;
+    for (const UsedAsset& asset : assets) {
+        if (!IsCached(asset)) {
+            std::cout << asset.file << " missing\n";
+            failedCount++;
+        }
+        else if (!IsCachedMatch(asset)) {
+            std::cout << asset.file << " mismatch\n";
+            failedCount++;
+        }
+    }
+    std::cout << "assets " << assets.size() << "\n";
+    std::cout << "failures " << failedCount << "\n";
+    return failedCount > 0 ? 1 : 0;
+}
+
+//Loads everything three times: from the sources alone, into an emptied cache, then from the cache.
+int RunStartup(const std::vector<UsedAsset>& assets) {
+    double sourceMs[ASSET_KIND_COUNT];
+    double coldMs[ASSET_KIND_COUNT];
+    double warmMs[ASSET_KIND_COUNT];
+    AssetCache::SetEnabled(false);
+    const double sourceTotal = TimeStartup(assets, sourceMs);
+    AssetCache::SetEnabled(true);
+    AssetCache::Clear();
+    const double coldTotal = TimeStartup(assets, coldMs);
+    const double warmTotal = TimeStartup(assets, warmMs);
+
+    int counts[ASSET_KIND_COUNT] = {};
+    for (const UsedAsset& asset : assets) {
+        counts[asset.kind]++;
+    }
+    for (int kind = 0; kind < ASSET_KIND_COUNT; kind++) {
+        std::cout << ASSET_KIND_NAMES[kind] << " files " << counts[kind] << " source_ms " << sourceMs[kind] << " cold_ms " << coldMs[kind]
+            << " warm_ms " << warmMs[kind] << " speedup " << sourceMs[kind] / std::max(warmMs[kind], 1e-9) << "\n";
+    }
+    std::cout << "source_ms " << sourceTotal << "\n";
+    std::cout << "cold_ms " << coldTotal << "\n";
+    std::cout << "warm_ms " << warmTotal << "\n";
+    std::cout << "speedup " << sourceTotal / std::max(warmTotal, 1e-9) << "\n";
+    std::cout << "cache_bytes " << GetCacheBytes() << "\n";
+    return 0;
+}
+
+int RunAssetTool(int argc, char** argv) {
+    if (argc < 2 || (strcmp(argv[1], "prewarm") != 0 && strcmp(argv[1], "verify") != 0 && strcmp(argv[1], "startup") != 0)) {
+        std::cout << "Usage: prewarm\n";
+        std::cout << "       verify\n";
+        std::cout << "       startup (empties the cache, then fills it again)\n";
+        return 1;
+    }
+    const std::vector<UsedAsset> assets = FindUsedAssets();
+    if (assets.empty()) {
+        std::cout << "No assets in " << Assets::ASSETROOT << "UsedAssets.csv\n";
+        return 1;
+    }
+    if (strcmp(argv[1], "prewarm") == 0) {
+        return RunPrewarm(assets);
+    }
+    if (strcmp(argv[1], "verify") == 0) {
+        return RunVerify(assets);
+    }
+    return RunStartup(assets);
+}
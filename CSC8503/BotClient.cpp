@@ -0,0 +1,293 @@
+#ifdef USEGL
+#include "BotClient.h"
+
+#include "GameClient.h"
+#include "NetworkObject.h"
+#include "Matrix4.h"
+
+#include <fstream>
+#include <sstream>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	constexpr int MOVE_FORWARD_INDEX = 0;
+	constexpr int MOVE_LEFT_INDEX = 1;
+	constexpr int MOVE_BACKWARDS_INDEX = 2;
+	constexpr int MOVE_RIGHT_INDEX = 3;
+
+	constexpr float MIN_HOLD_TIME = 0.5f;
+	constexpr float MAX_HOLD_TIME = 3.0f;
+	constexpr float MAX_YAW_STEP = 10.0f;
+	constexpr float RTT_SAMPLE_INTERVAL = 1.0f;
+	//Gain RFC 3550 uses so one late packet barely moves the estimate.
+	constexpr float JITTER_GAIN = 1.0f / 16.0f;
+
+	Vector3 GetYawAxis(float yaw, const Vector3& axis) {
+		return Matrix4::Rotation(yaw, Vector3(0, 1, 0)) * axis;
+	}
+}
+
+bool BotScript::LoadFromFile(const std::string& path, BotScript& script) {
+	std::ifstream file(path);
+	if (!file) {
+		std::cout << "Bot script " << path << " could not be opened\n";
+		return false;
+	}
+
+	script.steps.clear();
+	script.length = 0.0f;
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		std::istringstream lineStream(line);
+		BotScriptStep step;
+		std::string keys;
+		if (!(lineStream >> step.duration >> keys >> step.cameraYaw) || step.duration <= 0.0f) {
+			std::cout << "Bot script " << path << ":" << lineNumber << " is not \"<seconds> <WASD or -> <yaw>\", skipped\n";
+			continue;
+		}
+		for (char key : keys) {
+			switch (toupper(key)) {
+			case 'W': step.movementButtons[MOVE_FORWARD_INDEX] = true; break;
+			case 'A': step.movementButtons[MOVE_LEFT_INDEX] = true; break;
+			case 'S': step.movementButtons[MOVE_BACKWARDS_INDEX] = true; break;
+			case 'D': step.movementButtons[MOVE_RIGHT_INDEX] = true; break;
+			default: break;
+			}
+		}
+		std::string flag;
+		while (lineStream >> flag) {
+			if (flag == "sprint") {
+				step.isSprinting = true;
+			}
+			else if (flag == "crouch") {
+				step.isCrouching = true;
+			}
+			else if (flag == "interact") {
+				step.isInteractButtonPressed = true;
+			}
+		}
+		script.steps.push_back(step);
+		script.length += step.duration;
+	}
+	return !script.steps.empty();
+}
+
+const BotScriptStep& BotScript::GetStepAt(float time) const {
+	float stepTime = std::fmod(time, length);
+	for (const BotScriptStep& step : steps) {
+		if (stepTime < step.duration) {
+			return step;
+		}
+		stepTime -= step.duration;
+	}
+	return steps.back();
+}
+
+BotClient::BotClient(int botId, unsigned int seed, const BotScript* script) : mRandom(seed) {
+	mBotId = botId;
+	mClient = nullptr;
+	mScript = script;
+
+	mTime = 0.0f;
+	mConnectTime = 0.0f;
+	mNextInputTime = 0.0f;
+	mNextRttSampleTime = 0.0f;
+	mNextInputId = 0;
+	mIsGameFinished = false;
+
+	for (bool& button : mHeldButtons) {
+		button = false;
+	}
+	mHeldUntil = 0.0f;
+	mYaw = std::uniform_real_distribution<float>(0.0f, 360.0f)(mRandom);
+	mIsScriptCrouched = false;
+
+	mLastFullID = -1;
+	mIsJoinStateAckDue = false;
+	mLastTransit = 0.0f;
+}
+
+BotClient::~BotClient() {
+	Disconnect();
+	delete mClient;
+}
+
+bool BotClient::Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int port, uint32_t sessionId) {
+	mClient = new GameClient();
+	if (!mClient->Connect(a, b, c, d, port, "Bot" + std::to_string(mBotId), sessionId)) {
+		return false;
+	}
+	//Every message is counted towards bandwidth, even the ones a bot has no use for.
+	for (int type = BasicNetworkMessages::None; type < BasicNetworkMessages::MessageTypeCount; type++) {
+		mClient->RegisterPacketHandler(type, this);
+	}
+	return true;
+}
+
+void BotClient::Disconnect() {
+	if (mClient != nullptr && mClient->GetIsConnected()) {
+		mClient->Disconnect();
+	}
+	mStats.isConnected = false;
+}
+
+void BotClient::Update(float time, float inputRate) {
+	mTime = time;
+	if (mClient == nullptr) {
+		return;
+	}
+	mClient->UpdateClient();
+
+	if (!mStats.isConnected && mClient->GetIsConnected()) {
+		mStats.isConnected = true;
+		mConnectTime = time;
+	}
+	if (!mStats.isConnected) {
+		return;
+	}
+	mStats.connectedTime = time - mConnectTime;
+
+	if (time >= mNextRttSampleTime) {
+		mStats.rttSamplesMs.push_back(mClient->GetRoundTripTime());
+		mNextRttSampleTime = time + RTT_SAMPLE_INTERVAL;
+	}
+
+	if (mIsJoinStateAckDue) {
+		JoinStateAckPacket ack;
+		mJoinStateReceiver.FillAck(ack);
+		mClient->SendPacket(ack);
+		mIsJoinStateAckDue = false;
+	}
+
+	//the server has no player to apply inputs to until the match starts
+	if (!mStats.isGameStarted || mIsGameFinished) {
+		return;
+	}
+	const float inputInterval = 1.0f / inputRate;
+	if (time >= mNextInputTime) {
+		SendInput();
+		mNextInputTime = std::max(mNextInputTime + inputInterval, time);
+	}
+}
+
+void BotClient::SendInput() {
+	PlayerInputs inputs;
+	if (mScript != nullptr) {
+		MakeScriptedInput(inputs);
+	}
+	else {
+		MakeRandomInput(inputs);
+	}
+	inputs.fwdAxis = GetYawAxis(inputs.cameraYaw, Vector3(0, 0, -1));
+	inputs.rightAxis = GetYawAxis(inputs.cameraYaw, Vector3(1, 0, 0));
+
+	const int inputId = mNextInputId++;
+	mRecentInputs[inputId % MAX_INPUTS_PER_PACKET] = inputs;
+	const int firstInputId = std::max(0, inputId - MAX_INPUTS_PER_PACKET + 1);
+	PlayerInputs sentInputs[MAX_INPUTS_PER_PACKET];
+	int inputCount = 0;
+	for (int id = firstInputId; id <= inputId; id++) {
+		sentInputs[inputCount++] = mRecentInputs[id % MAX_INPUTS_PER_PACKET];
+	}
+
+	mClient->WriteAndSendClientInputPacket(mLastFullID, firstInputId,
+		mReplicatedProperties.GetReceivedSequence(), (int)mReplicatedProperties.GetReceivedAckBits(), sentInputs, inputCount);
+	mStats.inputsSent++;
+}
+
+void BotClient::MakeRandomInput(PlayerInputs& inputs) {
+	if (mTime >= mHeldUntil) {
+		for (bool& button : mHeldButtons) {
+			button = std::bernoulli_distribution(0.3)(mRandom);
+		}
+		mHeldUntil = mTime + std::uniform_real_distribution<float>(MIN_HOLD_TIME, MAX_HOLD_TIME)(mRandom);
+	}
+	mYaw += std::uniform_real_distribution<float>(-MAX_YAW_STEP, MAX_YAW_STEP)(mRandom);
+
+	for (int i = 0; i < 4; i++) {
+		inputs.movementButtons[i] = mHeldButtons[i];
+	}
+	inputs.cameraYaw = mYaw;
+	inputs.isSprinting = std::bernoulli_distribution(0.1)(mRandom);
+}
+
+void BotClient::MakeScriptedInput(PlayerInputs& inputs) {
+	const BotScriptStep& step = mScript->GetStepAt(mTime - mConnectTime);
+	for (int i = 0; i < 4; i++) {
+		inputs.movementButtons[i] = step.movementButtons[i];
+	}
+	inputs.cameraYaw = step.cameraYaw;
+	inputs.isSprinting = step.isSprinting;
+	inputs.isCrouching = step.isCrouching != mIsScriptCrouched;
+	mIsScriptCrouched = step.isCrouching;
+	inputs.isInteractButtonPressed = step.isInteractButtonPressed;
+}
+
+void BotClient::ReceivePacket(int type, GamePacket* payload, int source) {
+	mStats.bytesReceived += payload->GetTotalSize();
+	mStats.packetsReceived++;
+
+	switch (type) {
+	case BasicNetworkMessages::GameStartState: {
+		GameStartStatePacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			mStats.isGameStarted = packet.isGameStarted;
+		}
+		break;
+	}
+	case BasicNetworkMessages::GameEndState: {
+		GameEndStatePacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			mIsGameFinished = packet.isGameEnded;
+		}
+		break;
+	}
+	case BasicNetworkMessages::JoinState_Chunk: {
+		if (mJoinStateReceiver.ReceiveChunk(*(JoinStateChunkPacket*)payload)) {
+			mIsJoinStateAckDue = true;
+			mStats.joinBytesReceived += payload->GetTotalSize();
+			//a bot never builds the world, so having all of it is as far as joining goes
+			if (!mStats.isGameStarted && mJoinStateReceiver.IsComplete()) {
+				mStats.isGameStarted = true;
+				mStats.joinTimeMs = (mTime - mConnectTime) * 1000.0f;
+			}
+		}
+		break;
+	}
+	case BasicNetworkMessages::Snapshot_State: {
+		SnapshotPacket* snapshotPacket = (SnapshotPacket*)payload;
+		OnSnapshotReceived(snapshotPacket->stateID, snapshotPacket->serverTime, snapshotPacket->isDeltaFrame,
+			snapshotPacket->propertySequence, snapshotPacket->propertyCount);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+void BotClient::OnSnapshotReceived(int stateID, float serverTime, bool isDeltaFrame, int propertySequence, int propertyCount) {
+	mStats.snapshotsReceived++;
+
+	//transit time includes the offset between the two clocks, but that cancels out of the difference
+	const float transit = mTime - serverTime;
+	if (mStats.snapshotsReceived > 1) {
+		const float difference = std::abs(transit - mLastTransit) * 1000.0f;
+		mStats.jitterMs += (difference - mStats.jitterMs) * JITTER_GAIN;
+	}
+	mLastTransit = transit;
+
+	if (propertyCount > 0) {
+		mReplicatedProperties.MarkReceived(propertySequence);
+	}
+	if (!isDeltaFrame) {
+		mLastFullID = std::max(mLastFullID, stateID);
+	}
+}
+#endif
@@ -0,0 +1,110 @@
+#ifdef USEGL
+#pragma once
+#include <random>
+#include <string>
+#include <vector>
+
+#include "JoinState.h"
+#include "NetworkBase.h"
+#include "NetworkObject.h"
+#include "NetworkPlayer.h"
+#include "ReplicatedProperties.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		class GameClient;
+
+		//One line of a bot script: hold these inputs for duration seconds.
+		struct BotScriptStep {
+			float duration = 1.0f;
+			bool movementButtons[4] = {false};
+			float cameraYaw = 0.0f;
+			bool isSprinting = false;
+			bool isCrouching = false;
+			bool isInteractButtonPressed = false;
+		};
+
+		//Inputs a bot plays back on a loop. Each line is "<seconds> <WASD or -> <yaw> [sprint] [crouch] [interact]",
+		//blank lines and lines starting with # are skipped.
+		struct BotScript {
+			std::vector<BotScriptStep> steps;
+			float length = 0.0f;
+
+			static bool LoadFromFile(const std::string& path, BotScript& script);
+			const BotScriptStep& GetStepAt(float time) const;
+		};
+
+		//What a bot measured over its connection.
+		struct BotStats {
+			bool isConnected = false;
+			bool isGameStarted = false;
+			float connectedTime = 0.0f;
+			int bytesReceived = 0;
+			int packetsReceived = 0;
+			int snapshotsReceived = 0;
+			int inputsSent = 0;
+			float jitterMs = 0.0f;	//RFC 3550 interarrival jitter of the snapshots
+			float joinTimeMs = -1.0f;	//Connected until a match in progress had streamed its world, -1 for a bot there from the start
+			int joinBytesReceived = 0;
+			std::vector<int> rttSamplesMs;
+		};
+
+		//A headless client that plays the game with made up inputs. It never builds a world, it only takes part
+		//in the protocol: sends an input stream at a fixed rate and acknowledges the snapshots it gets back.
+		class BotClient : public PacketReceiver {
+		public:
+			//Without a script the bot wanders, holding random movement keys and turning a little each input.
+			BotClient(int botId, unsigned int seed, const BotScript* script = nullptr);
+			~BotClient();
+
+			bool Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int port, uint32_t sessionId = 0);
+			void Disconnect();
+
+			//time is seconds on the driver's clock, shared by every bot so their stats line up.
+			void Update(float time, float inputRate);
+
+			void ReceivePacket(int type, GamePacket* payload, int source) override;
+
+			const BotStats& GetStats() const { return mStats; }
+			bool GetIsGameFinished() const { return mIsGameFinished; }
+
+		protected:
+			void SendInput();
+			void MakeRandomInput(PlayerInputs& inputs);
+			void MakeScriptedInput(PlayerInputs& inputs);
+			void OnSnapshotReceived(int stateID, float serverTime, bool isDeltaFrame, int propertySequence, int propertyCount);
+
+			int mBotId;
+			GameClient* mClient;
+			const BotScript* mScript;
+			std::mt19937 mRandom;
+
+			float mTime;
+			float mConnectTime;
+			float mNextInputTime;
+			float mNextRttSampleTime;
+			int mNextInputId;
+			bool mIsGameFinished;
+			//Bots never read input acks, so every packet carries the last few inputs like a client's worst case.
+			PlayerInputs mRecentInputs[MAX_INPUTS_PER_PACKET];
+
+			//Random walk state, held for a while so the bot actually goes somewhere.
+			bool mHeldButtons[4];
+			float mHeldUntil;
+			float mYaw;
+			//Crouch is a toggle, so a scripted bot presses it entering and leaving a crouched step.
+			bool mIsScriptCrouched;
+
+			int mLastFullID;
+			//Only used to acknowledge property blocks, the values are never read.
+			ReplicatedProperties mReplicatedProperties;
+			//Assembled and acknowledged like a client's, but the image is never applied.
+			JoinStateReceiver mJoinStateReceiver;
+			bool mIsJoinStateAckDue;
+
+			float mLastTransit;
+			BotStats mStats;
+		};
+	}
+}
+#endif
@@ -24,6 +24,10 @@ function(Create_PC_CSC8503_Files)
         "WindowsUI.h"
         "ControllerInterface.h"
         "MiniMap.h"
+        "NullRenderer.h"
+        "NullSoundManager.h"
+        "MatchHost.h"
+        "BotClient.h"
     )
     source_group("Header Files" FILES ${Header_Files})
 
@@ -76,8 +80,21 @@ function(Create_PC_CSC8503_Files)
         "WindowsUI.cpp"
         "ControllerInterface.cpp"
         "MiniMap.cpp"
+        "NullRenderer.cpp"
+        "MatchHost.cpp"
+        "BotClient.cpp"
     )
 
+    # The dedicated server never draws or plays audio, so it does not build against GL or FMOD
+    if(BUILD_HEADLESS_SERVER)
+        list(REMOVE_ITEM Source_Files
+            "GameTechRenderer.cpp"
+            "SoundManager.cpp"
+            "WindowsUI.cpp"
+            "MiniMap.cpp"
+        )
+    endif()
+
 
     file(GLOB SHADER_FILES ${ASSET_ROOT}/Shaders/VK/*.*)
 
@@ -240,12 +257,14 @@ function(Create_PC_CSC8503_Files)
     target_link_libraries(${PROJECT_NAME} LINK_PUBLIC Detour)
     target_link_libraries(${PROJECT_NAME} LINK_PUBLIC DebugUtils)
     target_link_libraries(${PROJECT_NAME} LINK_PUBLIC DetourTileCache)
-    target_link_libraries(${PROJECT_NAME} LINK_PUBLIC "../FMODCoreAPI/libs/fmod_vc")
-    target_link_libraries(${PROJECT_NAME} LINK_PUBLIC "../FMODCoreAPI/libs/fmodL_vc")
+    if(NOT BUILD_HEADLESS_SERVER)
+        target_link_libraries(${PROJECT_NAME} LINK_PUBLIC "../FMODCoreAPI/libs/fmod_vc")
+        target_link_libraries(${PROJECT_NAME} LINK_PUBLIC "../FMODCoreAPI/libs/fmodL_vc")
 
-    file(GLOB DLLS "../FMODCoreAPI/dlls/*.dll")
+        file(GLOB DLLS "../FMODCoreAPI/dlls/*.dll")
 
-    foreach(DLL ${DLLS})
-          add_custom_command(TARGET ${PROJECT_NAME} PRE_BUILD COMMAND ${CMAKE_COMMAND} -E copy ${DLL} $<TARGET_FILE_DIR:${PROJECT_NAME}>)
-    endforeach(DLL)
+        foreach(DLL ${DLLS})
+              add_custom_command(TARGET ${PROJECT_NAME} PRE_BUILD COMMAND ${CMAKE_COMMAND} -E copy ${DLL} $<TARGET_FILE_DIR:${PROJECT_NAME}>)
+        endforeach(DLL)
+    endif()
 endfunction()
\ No newline at end of file
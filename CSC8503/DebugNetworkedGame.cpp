@@ -1,17 +1,26 @@
 ﻿#ifdef USEGL
 #include "DebugNetworkedGame.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <string>
 
+#include "Assets.h"
 #include "GameServer.h"
 #include "GameClient.h"
 #include "Helipad.h"
 #include "Interactable.h"
 #include "InteractableDoor.h"
+#include "JoinState.h"
 #include "MultiplayerStates.h"
 #include "NetworkObject.h"
 #include "NetworkPlayer.h"
+#include "NetworkReceiver.h"
+#include "PacketSender.h"
+#include "ReplayPlayer.h"
+#include "SnapshotCompression.h"
+#include "SnapshotWriter.h"
 #include "PushdownMachine.h"
 #include "RenderObject.h"
 #include "LevelManager.h"
@@ -22,12 +31,68 @@
 #include "Debug.h"
 
 namespace {
-	constexpr int MAX_PLAYER = 4;
+	constexpr int DEFAULT_MAX_PLAYERS = 4;
 	constexpr int DEMO_LEVEL_NUM = 0;
 	constexpr int LEVEL_NUM = 1;
 	constexpr int SERVER_PLAYER_PEER = 0;
+	//State 0 is what every client starts with, so the first real full state is 1.
+	constexpr int FIRST_FULL_STATE_ID = 1;
+
+	//Share of each client's snapshot budget replicated properties may use before objects.
+	constexpr float PROPERTY_BUDGET_SHARE = 0.25f;
+	//Suspicion is synced as whole numbers, 7 bits covers 0-127 exactly.
+	constexpr ReplicatedPropertyDesc SUSPICION_PROPERTY{ 0.0f, 127.0f, 7, 0.05f };
+	//Peer IDs from -1, 8 bits covers -1-254 exactly.
+	constexpr ReplicatedPropertyDesc PLAYER_LIST_PROPERTY{ -1.0f, 254.0f, 8, 0.1f };
 
 	constexpr const char* PLAYER_PREFIX = "Player";
+	//Trained by the snapshot tool, snapshots go uncompressed without it.
+	constexpr const char* SNAPSHOT_DICTIONARY_FILE = "snapshot.dict";
+
+	//Shared by every join stream in a tick, the rest of the connection is left to the players already in the match.
+	constexpr int JOIN_STATE_BYTES_PER_TICK = 4096;
+	//A few round trips, so a chunk that is only slow doesn't go twice.
+	constexpr float JOIN_STATE_RESEND_DELAY = 0.25f;
+
+	//Start of a join image. The player list, property block, object block and catch-up packets follow in that order.
+	struct JoinStateImageHeader {
+		uint32_t levelSeed = 0;
+		float serverTime = 0.0f;
+		int stateID = -1;
+		int propertySequence = -1;
+		int propertyBytes = 0;
+		int objectBytes = 0;
+		short playerCount = 0;
+		short propertyCount = 0;
+		short objectCount = 0;
+		short packetCount = 0;
+	};
+
+	//Gameplay events a join image already accounts for.
+	bool IsWorldEventPacket(int type) {
+		switch (type) {
+		case BasicNetworkMessages::ClientSyncItemSlotUsage:
+		case BasicNetworkMessages::ClientSyncItemSlot:
+		case BasicNetworkMessages::ClientSyncBuffs:
+		case BasicNetworkMessages::ClientSyncLocalActiveCause:
+		case BasicNetworkMessages::ClientSyncLocalSusChange:
+		case BasicNetworkMessages::ClientSyncLocationActiveCause:
+		case BasicNetworkMessages::ClientSyncLocationSusChange:
+		case BasicNetworkMessages::SyncInteractable:
+		case BasicNetworkMessages::ClientSyncGlobalSusChange:
+		case BasicNetworkMessages::SyncObjectState:
+		case BasicNetworkMessages::SyncAnnouncements:
+		case BasicNetworkMessages::GuardSpotSound:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	void AppendBytes(std::vector<char>& image, const void* data, int size) {
+		const char* bytes = static_cast<const char*>(data);
+		image.insert(image.end(), bytes, bytes + size);
+	}
 
 	//PLAYER MENU
 	constexpr Vector4 LOCAL_PLAYER_COLOUR(0, 0, 1, 1);
@@ -40,28 +105,42 @@ namespace {
 DebugNetworkedGame::DebugNetworkedGame() {
 	mThisServer = nullptr;
 	mThisClient = nullptr;
+	mPacketSender = nullptr;
+	mReplayPlayer = nullptr;
+
+	if (mSnapshotDictionary.LoadFromFile(Assets::DATADIR + SNAPSHOT_DICTIONARY_FILE)) {
+		mSnapshotCodec.SetDictionary(&mSnapshotDictionary);
+		mJoinStateReceiver.SetDictionary(&mSnapshotDictionary);
+	}
 
 	mClientSideLastFullID = 0;
 	mServerSideLastFullID = 0;
+	mServerSideNextFullID = FIRST_FULL_STATE_ID;
 	mGameState = GameSceneState::MainMenuState;
 
 	NetworkBase::Initialise();
 	mTimeToNextPacket = 0.0f;
 	mPacketsToSnapshot = 0;
+	mNetworkTime = 0.0f;
 	mWinningPlayerId = -1;
 	mLocalPlayerId = -1;
 
-	bool isEmpty = mPacketToSendQueue.empty();
 	mTimeToNextPacket = 0.0f;
 	mPacketsToSnapshot = -1;
 	InitInGameMenuManager();
 
-	for (int i = 0; i < MAX_PLAYER; i++) {
-		mPlayerList.push_back(-1);
-	}
+	SetMaxPlayers(DEFAULT_MAX_PLAYERS);
+	InitReplicatedProperties();
 }
 
 DebugNetworkedGame::~DebugNetworkedGame() {
+	for (const auto& [peerNumber, joinStream] : mJoinStreams) {
+		delete joinStream;
+	}
+	//the sender thread still uses the server until it is stopped
+	delete mPacketSender;
+	delete mThisServer;
+	delete mReplayPlayer;
 }
 
 bool DebugNetworkedGame::GetIsServer() const {
@@ -101,8 +180,60 @@ const bool DebugNetworkedGame::GetIsGameStarted() const {
 	return mIsGameStarted;
 }
 
+bool DebugNetworkedGame::GetIsDedicatedServer() const {
+	return mIsDedicatedServer;
+}
+
+int DebugNetworkedGame::GetPlayersToStart() const {
+	return mPlayersToStart;
+}
+
+bool DebugNetworkedGame::GetIsMatchOver() const {
+	return mIsMatchOver;
+}
+
+void DebugNetworkedGame::SetIsMatchOver(bool isMatchOver) {
+	mIsMatchOver = isMatchOver;
+}
+
+int DebugNetworkedGame::GetConnectedPlayerCount() const {
+	return (int)mPlayerIndices.size();
+}
+
+void DebugNetworkedGame::SetMaxPlayers(int maxPlayers) {
+	mMaxPlayers = std::clamp(maxPlayers, 1, MAX_PLAYER_SLOTS);
+	mPlayerList.assign(mMaxPlayers, -1);
+	mPlayerIndices.clear();
+}
+
+int DebugNetworkedGame::GetMaxDedicatedPlayers() {
+	return MAX_PLAYER_SLOTS - 1;
+}
+
 bool DebugNetworkedGame::StartAsServer(const std::string& playerName) {
-	mThisServer = new GameServer(NetworkBase::GetDefaultPort(), MAX_PLAYER);
+	if (!StartServer()) {
+		return false;
+	}
+	AddToPlayerPeerNameMap(SERVER_PLAYER_PEER, playerName);
+	return true;
+}
+
+bool DebugNetworkedGame::StartAsDedicatedServer(int playersToStart, int maxPlayers, SessionHost& sessionHost) {
+	mIsDedicatedServer = true;
+	mPlayersToStart = playersToStart;
+	//slot 0 stays empty without a host player
+	SetMaxPlayers(maxPlayers + 1);
+	return StartServer(&sessionHost);
+}
+
+bool DebugNetworkedGame::StartServer(SessionHost* sessionHost, ReplayPlayer* replay) {
+	//slot 0 is the host's, so a session on a shared host only has room for the rest
+	if (replay) {
+		mThisServer = new GameServer(*replay, mMaxPlayers - 1);
+	}
+	else {
+		mThisServer = sessionHost ? new GameServer(*sessionHost, mMaxPlayers - 1) : new GameServer(NetworkBase::GetDefaultPort(), mMaxPlayers);
+	}
 	if (mThisServer) {
 
 		mIsServer = true;
@@ -116,50 +247,118 @@ bool DebugNetworkedGame::StartAsServer(const std::string& playerName) {
 		mThisServer->RegisterPacketHandler(BasicNetworkMessages::ClientSyncItemSlot, this);
 		mThisServer->RegisterPacketHandler(BasicNetworkMessages::ClientSyncLocationSusChange, this);
 		mThisServer->RegisterPacketHandler(BasicNetworkMessages::GuardSpotSound, this);
-
-		AddToPlayerPeerNameMap(SERVER_PLAYER_PEER, playerName);
-
-		std::thread senderThread(&DebugNetworkedGame::SendPacketsThread, this);
-		senderThread.detach();
+		mThisServer->RegisterPacketHandler(BasicNetworkMessages::JoinState_Ack, this);
+		mThisServer->RegisterPacketHandler(BasicNetworkMessages::Player_Disconnected, this);
+
+		mPacketSender = new PacketSender(*mThisServer);
+		mPacketSender->SetDictionary(&mSnapshotDictionary);
+		//nothing is sent in a replay, so sending on this thread costs nothing
+		if (!replay && NetworkBase::GetTransport().GetAllowsNetworkThreads()) {
+			mPacketSender->Start();
+			//a shared host is serviced by whoever owns it
+			if (!sessionHost) {
+				mThisServer->StartReceiveThread();
+			}
+		}
 	}
 	return mThisServer;
 }
 
-bool DebugNetworkedGame::StartAsClient(char a, char b, char c, char d, const std::string& playerName) {
+bool DebugNetworkedGame::StartAsClient(char a, char b, char c, char d, const std::string& playerName, uint32_t sessionId) {
 	mThisClient = new GameClient();
-	const bool isConnected = mThisClient->Connect(a, b, c, d, NetworkBase::GetDefaultPort(), playerName);
+	mThisClient->SetSnapshotDictionaryId(mSnapshotDictionary.GetId());
+	const bool isConnected = mThisClient->Connect(a, b, c, d, NetworkBase::GetDefaultPort(), playerName, sessionId);
 
 	if (isConnected) {
 		mIsServer = false;
-		mThisClient->RegisterPacketHandler(Delta_State, this);
-		mThisClient->RegisterPacketHandler(Full_State, this);
-		mThisClient->RegisterPacketHandler(Player_Connected, this);
-		mThisClient->RegisterPacketHandler(Player_Disconnected, this);
-		mThisClient->RegisterPacketHandler(String_Message, this);
-		mThisClient->RegisterPacketHandler(GameStartState, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::SyncPlayers, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::GameEndState, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncItemSlotUsage, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncItemSlot, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncBuffs, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncLocalActiveCause, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncLocalSusChange, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncGlobalSusChange, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncLocationActiveCause, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncLocationSusChange, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::SyncInteractable, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncBuffs, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::SyncObjectState, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::SyncPlayerIdNameMap, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::SyncAnnouncements, this);
-		mThisClient->RegisterPacketHandler(BasicNetworkMessages::GuardSpotSound, this);
+		RegisterClientPacketHandlers();
+		if (NetworkBase::GetTransport().GetAllowsNetworkThreads()) {
+			mThisClient->StartReceiveThread();
+		}
 	}
 
 	return isConnected;
 
 }
 
+bool DebugNetworkedGame::StartAsReplay(const std::string& filepath, int peerNumber) {
+	mReplayPlayer = new ReplayPlayer();
+	if (!mReplayPlayer->Open(filepath)) {
+		delete mReplayPlayer;
+		mReplayPlayer = nullptr;
+		return false;
+	}
+	if (peerNumber == 0) {
+		peerNumber = mReplayPlayer->GetFirstPeerNumber();
+	}
+	mThisClient = new GameClient();
+	mThisClient->StartReplay(*mReplayPlayer, peerNumber);
+	mIsServer = false;
+	RegisterClientPacketHandlers();
+	return true;
+}
+
+bool DebugNetworkedGame::StartAsServerReplay(const std::string& filepath, int playersToStart, int maxPlayers) {
+	mReplayPlayer = new ReplayPlayer();
+	if (!mReplayPlayer->Open(filepath)) {
+		delete mReplayPlayer;
+		mReplayPlayer = nullptr;
+		return false;
+	}
+	const GamePacket* startState = mReplayPlayer->FindPacket(ReplayDirection::ServerToClient, [](const GamePacket& packet) {
+		GameStartStatePacket state;
+		return packet.type == BasicNetworkMessages::GameStartState && PacketSerializer::Read(packet, state) && state.isGameStarted;
+	});
+	if (startState) {
+		GameStartStatePacket state;
+		PacketSerializer::Read(*startState, state);
+		SetServerLevelSeed((unsigned int)std::stoul(state.levelSeed));
+	}
+
+	mIsDedicatedServer = true;
+	mPlayersToStart = playersToStart;
+	SetMaxPlayers(maxPlayers + 1);
+	return StartServer(nullptr, mReplayPlayer);
+}
+
+void DebugNetworkedGame::RegisterClientPacketHandlers() {
+	mThisClient->RegisterPacketHandler(Snapshot_State, this);
+	mThisClient->RegisterPacketHandler(Player_Connected, this);
+	mThisClient->RegisterPacketHandler(Player_Disconnected, this);
+	mThisClient->RegisterPacketHandler(String_Message, this);
+	mThisClient->RegisterPacketHandler(GameStartState, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::SyncPlayers, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::GameEndState, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncItemSlotUsage, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncItemSlot, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncBuffs, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncLocalActiveCause, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncLocalSusChange, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncGlobalSusChange, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncLocationActiveCause, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncLocationSusChange, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::SyncInteractable, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::ClientSyncBuffs, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::SyncObjectState, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::SyncPlayerIdNameMap, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::SyncAnnouncements, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::GuardSpotSound, this);
+	mThisClient->RegisterPacketHandler(BasicNetworkMessages::JoinState_Chunk, this);
+}
+
 void DebugNetworkedGame::UpdateGame(float dt) {
+	mNetworkTime += dt;
+
+	//everything received since last frame is handled here and only here
+	if (mReplayPlayer) {
+		mReplayPlayer->AdvanceTime(dt);
+	}
+	if (mThisServer) {
+		mThisServer->UpdateServer();
+	}
+	if (mThisClient) {
+		mThisClient->UpdateClient();
+	}
 
 	mTimeToNextPacket -= dt;
 	if (mTimeToNextPacket < 0) {
@@ -169,13 +368,17 @@ void DebugNetworkedGame::UpdateGame(float dt) {
 		else if (mThisClient) {
 			UpdateAsClient(dt);
 		}
-		mTimeToNextPacket += 1.0f / 60.0f; //20hz server/client update
+		mTimeToNextPacket += 1.0f / NETWORK_TICK_RATE;
 
 		if (mThisServer && !mIsGameFinished) {
 			SyncPlayerList();
 		}
 	}
 
+	if (mThisClient && mIsGameStarted) {
+		UpdateInterpolation(dt);
+	}
+
 	if (mPushdownMachine != nullptr) {
 		mPushdownMachine->Update(dt);
 	}
@@ -190,6 +393,14 @@ void DebugNetworkedGame::UpdateGame(float dt) {
 
 		if (mThisServer) {
 			Debug::Print("SERVER", Vector2(5, 10), Debug::MAGENTA);
+			Debug::Print("Send queue: " + std::to_string(mPacketSender->GetQueueDepth()) + " (peak " + std::to_string(mPacketSender->GetPeakQueueDepth()) + ")", Vector2(5, 13), Debug::MAGENTA);
+			Debug::Print("Send latency ms: " + std::to_string(mPacketSender->GetAverageSendLatencyMs()), Vector2(5, 16), Debug::MAGENTA);
+			if (const NetworkReceiver* receiver = mThisServer->GetReceiver()) {
+				Debug::Print("Receive queue ms: " + std::to_string(receiver->GetAverageQueueTimeMs()), Vector2(5, 19), Debug::MAGENTA);
+			}
+			if (!mCompressedPeers.empty()) {
+				Debug::Print("Snapshot ratio: " + std::to_string(mPacketSender->GetCompressionRatio()), Vector2(5, 22), Debug::MAGENTA);
+			}
 		}
 		else {
 			Debug::Print("CLIENT", Vector2(5, 10), Debug::MAGENTA);
@@ -200,13 +411,6 @@ void DebugNetworkedGame::UpdateGame(float dt) {
 	else {
 		mLevelManager->GetRenderer()->Render();
 	}
-
-	if (mThisServer) {
-		mThisServer->UpdateServer();
-	}
-	if (mThisClient) {
-		mThisClient->UpdateClient();
-	}
 }
 
 void DebugNetworkedGame::SetIsGameStarted(bool isGameStarted, unsigned int seed) {
@@ -220,13 +424,14 @@ void DebugNetworkedGame::SetIsGameStarted(bool isGameStarted, unsigned int seed)
 		mGameState = GameSceneState::InitialisingLevelState;
 		if (mThisServer) {
 			std::random_device rd;
-			const unsigned int serverCreatedSeed = rd();
+			const unsigned int serverCreatedSeed = mHasServerLevelSeed ? mServerLevelSeed : rd();
 
 			const std::string seedString = std::to_string(serverCreatedSeed);
 
 			SendStartGameStatusPacket(seedString);
 			seedToUse = serverCreatedSeed;
 		}
+		mLevelSeed = (unsigned int)seedToUse;
 
 		std::mt19937 g(seedToUse);
 		StartLevel(g);
@@ -260,95 +465,146 @@ void DebugNetworkedGame::AddEventOnGameStarts(std::function<void()> event) {
 }
 
 void DebugNetworkedGame::ReceivePacket(int type, GamePacket* payload, int source) {
-	
+	//a client joining a match in progress has no world for these yet, and its join image will cover them
+	if (mThisClient && !mIsGameStarted && IsWorldEventPacket(type)) {
+		return;
+	}
+
 	switch (type) {
 	case BasicNetworkMessages::GameStartState: {
-		GameStartStatePacket* packet = (GameStartStatePacket*)payload;
+		GameStartStatePacket packet;
+		if (!PacketSerializer::Read(*payload, packet)) {
+			break;
+		}
 		unsigned int seed = 0;
 
-		seed = std::stoul(packet->levelSeed);
-		SetIsGameStarted(packet->isGameStarted, seed);
-		break;
-	}
-	case BasicNetworkMessages::Full_State: {
-		FullPacket* packet = (FullPacket*)payload;
-		HandleFullPacket(packet);
+		seed = std::stoul(packet.levelSeed);
+		SetIsGameStarted(packet.isGameStarted, seed);
 		break;
 	}
-	case BasicNetworkMessages::Delta_State: {
-		DeltaPacket* deltaPacket = (DeltaPacket*)payload;
-		HandleDeltaPacket(deltaPacket);
+	case BasicNetworkMessages::Snapshot_State: {
+		SnapshotPacket* snapshotPacket = (SnapshotPacket*)payload;
+		HandleSnapshotPacket(snapshotPacket);
 		break;
 	}
 	case BasicNetworkMessages::GameEndState: {
-		GameEndStatePacket* packet = (GameEndStatePacket*)payload;
-		SetIsGameFinished(packet->isGameEnded, packet->winningPlayerId);
+		GameEndStatePacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			SetIsGameFinished(packet.isGameEnded, packet.winningPlayerId);
+		}
 		break;
 	}
 	case BasicNetworkMessages::SyncPlayers: {
-		SyncPlayerListPacket* packet = (SyncPlayerListPacket*)payload;
-		packet->SyncPlayerList(mPlayerList);
+		SyncPlayerListPacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			for (int i = 0; i < (int)packet.playerList.size(); i++) {
+				SetPlayerSlot(i, packet.playerList[i]);
+			}
+		}
 		break;
 	}
 	case  BasicNetworkMessages::ClientPlayerInputState: {
-		ClientPlayerInputPacket* packet = (ClientPlayerInputPacket*)payload;
-		HandleClientPlayerInputPacket(packet, source + 1);
+		ClientPlayerInputPacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			HandleClientPlayerInputPacket(&packet, source + 1);
+		}
 		break;
 	}
 	case BasicNetworkMessages::ClientSyncItemSlot: {
-		ClientSyncItemSlotPacket* packet = (ClientSyncItemSlotPacket*)(payload);
-		HandlePlayerEquippedItemChange(packet);
+		ClientSyncItemSlotPacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			HandlePlayerEquippedItemChange(&packet);
+		}
 		break;
 	}
 	case BasicNetworkMessages::SyncInteractable: {
-		SyncInteractablePacket* packet = (SyncInteractablePacket*)(payload);
-		HandleInteractablePacket(packet);
+		SyncInteractablePacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			HandleInteractablePacket(&packet);
+		}
 		break;
 	}
 	case BasicNetworkMessages::ClientSyncBuffs: {
-		ClientSyncBuffPacket* packet = (ClientSyncBuffPacket*)(payload);
-		HandlePlayerBuffChange(packet);
+		ClientSyncBuffPacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			HandlePlayerBuffChange(&packet);
+		}
 		break;
 	}
 	case BasicNetworkMessages::ClientSyncLocalActiveCause: {
-		ClientSyncLocalActiveSusCausePacket* packet = (ClientSyncLocalActiveSusCausePacket*)(payload);
-		HandleLocalActiveSusCauseChange(packet);
+		ClientSyncLocalActiveSusCausePacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			HandleLocalActiveSusCauseChange(&packet);
+		}
 		break;
 	}
 	case BasicNetworkMessages::ClientSyncLocalSusChange: {
-		ClientSyncLocalSusChangePacket* packet = (ClientSyncLocalSusChangePacket*)(payload);
-		HandleLocalSusChange(packet);
+		ClientSyncLocalSusChangePacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			HandleLocalSusChange(&packet);
+		}
 		break;
 	}
 	case BasicNetworkMessages::ClientSyncGlobalSusChange: {
-		ClientSyncGlobalSusChangePacket* packet = (ClientSyncGlobalSusChangePacket*)(payload);
-		HandleGlobalSusChange(packet);
+		ClientSyncGlobalSusChangePacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			HandleGlobalSusChange(&packet);
+		}
 		break;
 	}
 	case BasicNetworkMessages::SyncObjectState: {
-		SyncObjectStatePacket* packet = (SyncObjectStatePacket*)(payload);
-		HandleObjectStatePacket(packet);
+		SyncObjectStatePacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			HandleObjectStatePacket(&packet);
+		}
 		break;
 	}
 	case BasicNetworkMessages::ClientInit: {
-		ClientInitPacket* packet = (ClientInitPacket*)(payload);
-		const int playerPeer = source + 1;
-		HandleClientInitPacket(packet, playerPeer);
+		ClientInitPacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			const int playerPeer = source + 1;
+			HandleClientInitPacket(&packet, playerPeer);
+		}
 		break;
 	}
 	case BasicNetworkMessages::SyncPlayerIdNameMap: {
-		const SyncPlayerIdNameMapPacket* packet = (SyncPlayerIdNameMapPacket*)(payload);
-		HandleSyncPlayerIdNameMapPacket(packet);
+		SyncPlayerIdNameMapPacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			HandleSyncPlayerIdNameMapPacket(&packet);
+		}
 		break;
 	}
 	case BasicNetworkMessages::SyncAnnouncements: {
-		const AnnouncementSyncPacket* packet = (AnnouncementSyncPacket*)(payload);
-		HandleAnnouncementSync(packet);
+		AnnouncementSyncPacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			HandleAnnouncementSync(&packet);
+		}
 		break;
 	}
 	case BasicNetworkMessages::GuardSpotSound: {
-		GuardSpotSoundPacket* packet = (GuardSpotSoundPacket*)(payload);
-		HandleGuardSpotSound(packet);
+		GuardSpotSoundPacket packet;
+		if (PacketSerializer::Read(*payload, packet)) {
+			HandleGuardSpotSound(&packet);
+		}
+		break;
+	}
+	case BasicNetworkMessages::JoinState_Chunk: {
+		HandleJoinStateChunk((JoinStateChunkPacket*)payload);
+		break;
+	}
+	case BasicNetworkMessages::JoinState_Ack: {
+		JoinStateAckPacket packet;
+		const auto joinStream = mJoinStreams.find(source + 1);
+		if (joinStream != mJoinStreams.end() && PacketSerializer::Read(*payload, packet)) {
+			joinStream->second->Acknowledge(packet);
+		}
+		break;
+	}
+	case BasicNetworkMessages::Player_Disconnected: {
+		//raised by the server itself, clients are told through the player list
+		if (mThisServer) {
+			HandlePlayerDisconnected(source + 1);
+		}
 		break;
 	}
 	default:
@@ -385,14 +641,12 @@ void DebugNetworkedGame::SendClientSyncLocalActiveSusCausePacket(int playerNo, i
 	mThisServer->SendGlobalPacket(packet);
 }
 
-void DebugNetworkedGame::SendClientSyncLocalSusChangePacket(int playerNo, int changedValue) const {
-	NCL::CSC8503::ClientSyncLocalSusChangePacket packet(playerNo, changedValue);
-	mThisServer->SendGlobalPacket(packet);
+void DebugNetworkedGame::ReplicateLocalSusChange(int playerNo, int changedValue) {
+	mReplicatedProperties.Set(mLocalSusProperty, playerNo, (float)changedValue);
 }
 
-void DebugNetworkedGame::SendClientSyncGlobalSusChangePacket(int changedValue) const {
-	NCL::CSC8503::ClientSyncGlobalSusChangePacket packet(changedValue);
-	mThisServer->SendGlobalPacket(packet);
+void DebugNetworkedGame::ReplicateGlobalSusChange(int changedValue) {
+	mReplicatedProperties.Set(mGlobalSusProperty, 0, (float)changedValue);
 }
 
 void DebugNetworkedGame::SendClientSyncLocationActiveSusCausePacket(int cantorPairedLocation, int activeSusCause, bool toApply) const {
@@ -401,9 +655,8 @@ void DebugNetworkedGame::SendClientSyncLocationActiveSusCausePacket(int cantorPa
 	mThisServer->SendGlobalPacket(packet);
 }
 
-void DebugNetworkedGame::SendClientSyncLocationSusChangePacket(int cantorPairedLocation, int changedValue) const {
-	NCL::CSC8503::ClientSyncLocationSusChangePacket packet(cantorPairedLocation, changedValue);
-	mThisServer->SendGlobalPacket(packet);
+void DebugNetworkedGame::ReplicateLocationSusChange(int cantorPairedLocation, int changedValue) {
+	mReplicatedProperties.Set(mLocationSusProperty, cantorPairedLocation, (float)changedValue);
 }
 
 void NCL::CSC8503::DebugNetworkedGame::SendAnnouncementSyncPacket(int annType, float time, int playerNo){
@@ -416,20 +669,6 @@ void DebugNetworkedGame::SendGuardSpotSoundPacket(int playerId) const {
 	mThisServer->SendGlobalPacket(packet);
 }
 
-void DebugNetworkedGame::SendPacketsThread() {
-	while (mThisServer) {
-		std::lock_guard<std::mutex> lock(mPacketToSendQueueMutex);
-		if (mPacketToSendQueue.size() > 1 && !mPacketToSendQueue.empty()) {
-			
-			GamePacket* packet = mPacketToSendQueue.front();
-			if (packet) {
-				mThisServer->SendGlobalPacket(*packet);
-				mPacketToSendQueue.pop();
-			}
-		}
-	}
-}
-
 GameClient* DebugNetworkedGame::GetClient() const {
 	return mThisClient;
 }
@@ -448,11 +687,24 @@ void DebugNetworkedGame::ClearNetworkGame() {
 	}
 
 	mServerPlayers.clear();
+	mStateIDs.clear();
+	ClearNetworkObjects();
+	mPlayoutClock.Reset();
+	mInterestManager.Clear();
+	mReplicatedProperties.Clear();
+	for (const auto& [peerNumber, joinStream] : mJoinStreams) {
+		mThisServer->ReleasePeer(peerNumber);
+		delete joinStream;
+	}
+	mJoinStreams.clear();
+	mJoinStateReceiver.Reset();
+	mIsJoinStateAckDue = false;
 
 	mLevelManager->ClearLevel();
 
 	mClientSideLastFullID = -1;
 	mClientSideLastFullID = -1;
+	mServerSideNextFullID = FIRST_FULL_STATE_ID;
 	mWinningPlayerId = -1;
 	mNetworkObjectCache = 10;
 }
@@ -465,7 +717,19 @@ NetworkPlayer* DebugNetworkedGame::GetLocalPlayer() const {
 	return static_cast<NetworkPlayer*>(mLocalPlayer);
 }
 
+int DebugNetworkedGame::GetLocalPlayerID() const {
+	return mLocalPlayerId;
+}
+
 void DebugNetworkedGame::UpdateAsServer(float dt) {
+	//before the snapshot, so it carries the inputs' acks
+	for (const auto& [slot, player] : mServerPlayers) {
+		if (player != nullptr && !player->GetIsLocalPlayer()) {
+			player->ApplyQueuedInput(1.0f / NETWORK_TICK_RATE);
+		}
+	}
+	UpdateJoinStreams();
+
 	mPacketsToSnapshot--;
 	if (mPacketsToSnapshot < 0) {
 		BroadcastSnapshot(false);
@@ -477,38 +741,73 @@ void DebugNetworkedGame::UpdateAsServer(float dt) {
 }
 
 void DebugNetworkedGame::UpdateAsClient(float dt) {
-	mThisClient->UpdateClient();
+	//packets were already dispatched at the start of UpdateGame
+	if (mIsJoinStateAckDue) {
+		JoinStateAckPacket ack;
+		mJoinStateReceiver.FillAck(ack);
+		mThisClient->SendPacket(ack);
+		mIsJoinStateAckDue = false;
+	}
 }
 
-void DebugNetworkedGame::BroadcastSnapshot(bool deltaFrame) {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-
-	mLevelManager->GetGameWorld()->GetObjectIterators(first, last);
+void DebugNetworkedGame::UpdateInterpolation(float dt) {
+	const float renderTime = mPlayoutClock.GetRenderTime(mNetworkTime, dt);
+	for (NetworkObject* networkObject : mNetworkObjects) {
+		if (networkObject) {
+			networkObject->UpdateInterpolation(renderTime);
+		}
+	}
+}
 
-	for (auto i = first; i != last; ++i) {
-		NetworkObject* o = (*i)->GetNetworkObject();
-		if (!o) {
+void DebugNetworkedGame::BroadcastSnapshot(bool deltaFrame) {
+	//Full frames create a new state for clients to acknowledge, deltas in between are relative
+	//to whichever full state each client last acknowledged for each object.
+	const int stateID = deltaFrame ? mServerSideNextFullID - 1 : mServerSideNextFullID++;
+
+	SnapshotWriter snapshotWriter(mNetworkQuantizer, mPacketSender->GetSnapshotPool());
+	std::vector<NetworkObject*> prioritisedObjects;
+	for (int peerNumber : mPlayerList) {
+		//a client still on its join stream has nothing to apply deltas to yet
+		if (peerNumber == -1 || peerNumber == SERVER_PLAYER_PEER || mJoinStreams.contains(peerNumber)) {
 			continue;
 		}
-		//TODO - you'll need some way of determining
-		//when a player has sent the server an acknowledgement
-		//and store the lastID somewhere. A map between player
-		//and an int could work, or it could be part of a 
-		//NetworkPlayer struct. 
-		int playerState = o->GetLatestNetworkState().stateID;
-		GamePacket* newPacket = nullptr;
-		if (o->WritePacket(&newPacket, deltaFrame, mServerSideLastFullID)) {
-			if (newPacket != nullptr) {
-				std::lock_guard<std::mutex> lock(mPacketToSendQueueMutex);
-				mPacketToSendQueue.push(newPacket);
+
+		Vector3 viewerPosition;
+		const auto viewer = mServerPlayers.find(GetPlayerPeerID(peerNumber));
+		if (viewer != mServerPlayers.end() && viewer->second != nullptr) {
+			viewerPosition = viewer->second->GetTransform().GetPosition();
+		}
+		const auto ackedState = mStateIDs.find(peerNumber);
+		const int ackedStateID = ackedState != mStateIDs.end() ? ackedState->second : -1;
+
+		mInterestManager.GetPrioritisedObjects(peerNumber, viewerPosition, mNetworkObjects, prioritisedObjects);
+
+		snapshotWriter.Begin(deltaFrame, stateID, mNetworkTime, ackedStateID);
+		snapshotWriter.AddProperties(mReplicatedProperties, peerNumber, mNetworkTime,
+			(int)(mInterestManager.GetBudgetBitsPerTick() * PROPERTY_BUDGET_SHARE));
+		for (NetworkObject* networkObject : prioritisedObjects) {
+			// whatever doesn't fit keeps its priority and moves up the list next tick
+			if (snapshotWriter.GetBitsWritten() + snapshotWriter.GetMaxObjectBits() > mInterestManager.GetBudgetBitsPerTick()) {
+				break;
 			}
+			const int networkID = networkObject->GetnetworkID();
+			snapshotWriter.AddObject(*networkObject, mInterestManager.GetSendState(peerNumber, networkID));
+			mInterestManager.MarkSent(peerNumber, networkID);
+		}
+
+		for (SnapshotPacket* snapshotPacket : snapshotWriter.End()) {
+			mPacketSender->Enqueue(snapshotPacket, peerNumber, mCompressedPeers.contains(peerNumber));
 		}
 	}
+	//one wake per tick, the sender drains the whole batch before flushing
+	mPacketSender->Wake();
 }
 
 void DebugNetworkedGame::UpdateMinimumState() {
 	//Periodically remove old data from the server
+	if (mStateIDs.empty()) {
+		return;
+	}
 	int minID = INT_MAX;
 	int maxID = 0; //we could use this to see if a player is lagging behind?
 
@@ -535,12 +834,34 @@ int DebugNetworkedGame::GetPlayerPeerID(int peerId) {
 	if (peerId == -2) {
 		peerId = mThisClient->GetPeerID();
 	}
-	for (int i = 0; i < 4; ++i) {
-		if (mPlayerList[i] == peerId) {
-			return i;
+	const auto playerIndex = mPlayerIndices.find(peerId);
+	return playerIndex != mPlayerIndices.end() ? playerIndex->second : -1;
+}
+
+bool DebugNetworkedGame::SetPlayerSlot(int slot, int peerNumber) {
+	if (slot < 0 || slot >= MAX_PLAYER_SLOTS) {
+		return false;
+	}
+	if (slot >= (int)mPlayerList.size()) {
+		mPlayerList.resize(slot + 1, -1);
+		//clients learn the server's slot count as slots arrive, possibly mid match
+		if (mLevelManager != nullptr && (int)mPlayerList.size() > mMaxPlayers) {
+			mLevelManager->SetPlayerSlotCount((int)mPlayerList.size());
 		}
 	}
-	return -1;
+	const int previousPeer = mPlayerList[slot];
+	if (previousPeer == peerNumber) {
+		return false;
+	}
+	const auto previousIndex = mPlayerIndices.find(previousPeer);
+	if (previousIndex != mPlayerIndices.end() && previousIndex->second == slot) {
+		mPlayerIndices.erase(previousIndex);
+	}
+	mPlayerList[slot] = peerNumber;
+	if (peerNumber != -1) {
+		mPlayerIndices[peerNumber] = slot;
+	}
+	return true;
 }
 
 const int DebugNetworkedGame::GetClientLastFullID() const {
@@ -560,9 +881,24 @@ void DebugNetworkedGame::SendFinishGameStatusPacket() {
 void DebugNetworkedGame::InitWorld(const std::mt19937& levelSeed) {
 	mLevelManager->GetGameWorld()->ClearAndErase();
 	mLevelManager->GetPhysics()->Clear();
+	//the old level's objects are gone, and the level hands out IDs from the start again
+	ClearNetworkObjects();
 
+	mLevelManager->SetPlayerSlotCount(std::max(mMaxPlayers, (int)mPlayerList.size()));
 	mLevelManager->LoadLevel(LEVEL_NUM, levelSeed, 0, true);
 
+	//Both ends load the same level, so they agree on the bounds positions are quantised against.
+	Vector3 levelBoundsMin;
+	Vector3 levelBoundsMax;
+	mLevelManager->GetLevelBounds(levelBoundsMin, levelBoundsMax);
+	mNetworkQuantizer.SetBounds(levelBoundsMin, levelBoundsMax);
+
+	std::vector<Vector3> roomPositions;
+	for (const auto& [roomPosition, room] : mLevelManager->GetActiveLevel()->GetRooms()) {
+		roomPositions.push_back(roomPosition);
+	}
+	mInterestManager.SetRooms(roomPositions);
+
 	SpawnPlayers();
 
 	mLevelManager->SetPlayersForGuards();
@@ -576,14 +912,9 @@ void DebugNetworkedGame::HandleClientPlayerInput(ClientPlayerInputPacket* player
 
 void DebugNetworkedGame::SpawnPlayers() {
 
-	for (int i = 0; i < 4; i++) {
+	for (int i = 0; i < (int)mPlayerList.size(); i++) {
 		if (mPlayerList[i] != -1) {
-
-			const Vector3& pos = mLevelManager->GetPlayerStartPosition(i);
-			auto* netPlayer = AddPlayerObject(pos, i);
-			mServerPlayers.emplace(i, netPlayer);
-			mLevelManager->GetInventoryBuffSystem()->GetPlayerInventoryPtr()->Attach(netPlayer);
-			mLevelManager->GetInventoryBuffSystem()->GetPlayerBuffsPtr()->Attach(netPlayer);
+			SpawnPlayer(i);
 		}
 		else
 		{
@@ -591,6 +922,13 @@ void DebugNetworkedGame::SpawnPlayers() {
 		}
 	}
 
+	//Nobody plays on a dedicated server, every player object is driven by a client.
+	if (mIsDedicatedServer) {
+		mLocalPlayer = nullptr;
+		mLevelManager->SetTempPlayer(nullptr);
+		return;
+	}
+
 	int playerPeerId = 0;
 
 	if (!mThisServer) {
@@ -602,10 +940,33 @@ void DebugNetworkedGame::SpawnPlayers() {
 
 	mLocalPlayerId = mServerPlayers[playerPeerId]->GetPlayerID();
 	localPlayer->SetIsLocalPlayer(true);
+	//the local player is driven by this client, not played back from snapshots
+	localPlayer->GetNetworkObject()->SetIsInterpolated(false);
+	localPlayer->GetNetworkObject()->SetIsPredicted(mThisServer == nullptr);
 	mLevelManager->SetTempPlayer((PlayerObject*)mLocalPlayer);
 	mLocalPlayer->ToggleIsRendered();
 }
 
+NetworkPlayer* DebugNetworkedGame::SpawnPlayer(int slot) {
+	const Vector3& pos = mLevelManager->GetPlayerStartPosition(slot);
+	auto* netPlayer = AddPlayerObject(pos, slot);
+	mServerPlayers[slot] = netPlayer;
+	mLevelManager->GetInventoryBuffSystem()->GetPlayerInventoryPtr()->Attach(netPlayer);
+	mLevelManager->GetInventoryBuffSystem()->GetPlayerBuffsPtr()->Attach(netPlayer);
+	return netPlayer;
+}
+
+void DebugNetworkedGame::SpawnLatePlayer(int slot) {
+	const auto player = mServerPlayers.find(slot);
+	if (player != mServerPlayers.end() && player->second != nullptr) {
+		//the newcomer takes over the player, but numbers its inputs from 0 like any new client
+		player->second->ResetInputState();
+		return;
+	}
+	NetworkPlayer* netPlayer = SpawnPlayer(slot);
+	mLevelManager->AddPlayerMidMatch(*netPlayer);
+}
+
 NetworkPlayer* DebugNetworkedGame::AddPlayerObject(const Vector3& position, int playerNum) {
 
 	//Set Player Obj Name
@@ -618,7 +979,7 @@ NetworkPlayer* DebugNetworkedGame::AddPlayerObject(const Vector3& position, int
 
 	auto* networkComponet = new NetworkObject(*netPlayer, playerNum);
 	netPlayer->SetNetworkObject(networkComponet);
-	mNetworkObjects.push_back(netPlayer->GetNetworkObject());
+	AddNetworkObjectToNetworkObjects(netPlayer->GetNetworkObject());
 	mLevelManager->GetGameWorld()->AddGameObject(netPlayer);
 	mLevelManager->AddUpdateableGameObject(*netPlayer);
 	Vector4 colour;
@@ -643,29 +1004,64 @@ NetworkPlayer* DebugNetworkedGame::AddPlayerObject(const Vector3& position, int
 	return netPlayer;
 }
 
-void DebugNetworkedGame::HandleFullPacket(FullPacket* fullPacket) {
-	for (int i = 0; i < mNetworkObjects.size(); i++) {
-		if (mNetworkObjects[i]->GetnetworkID() == fullPacket->objectID) {
-			mNetworkObjects[i]->ReadPacket(*fullPacket);
+void DebugNetworkedGame::HandleSnapshotPacket(SnapshotPacket* snapshotPacket) {
+	SnapshotPacket decompressedPacket;
+	if (snapshotPacket->isCompressed) {
+		if (!mSnapshotCodec.DecompressPacket(*snapshotPacket, decompressedPacket)) {
+			std::cout << "Dropped a snapshot that did not decompress" << std::endl;
+			return;
 		}
+		snapshotPacket = &decompressedPacket;
 	}
-	mClientSideLastFullID = fullPacket->fullState.stateID;
-}
 
-void DebugNetworkedGame::HandleDeltaPacket(DeltaPacket* deltaPacket) {
-	for (int i = 0; i < mNetworkObjects.size(); i++) {
-		if (mNetworkObjects[i]->GetnetworkID() == deltaPacket->objectID) {
-			mNetworkObjects[i]->ReadPacket(*deltaPacket);
+	BitStream stream = BitStream::ForReading(snapshotPacket->data, snapshotPacket->GetPayloadSize());
+	//when it arrived, not when this frame got round to it
+	mPlayoutClock.OnSnapshotReceived(snapshotPacket->serverTime, mNetworkTime - mThisClient->GetCurrentPacketAge());
+
+	if (snapshotPacket->propertyCount > 0) {
+		mReplicatedProperties.ReadChanges(stream, snapshotPacket->propertySequence, snapshotPacket->propertyCount);
+		if (stream.HasOverflowed()) {
+			std::cout << "Snapshot properties are truncated, dropping the packet." << std::endl;
+			return;
+		}
+	}
+
+	for (int objectIndex = 0; objectIndex < snapshotPacket->objectCount; objectIndex++) {
+		const int objectID = NetworkObject::ReadSnapshotObjectID(stream);
+
+		NetworkObject* networkObject = GetNetworkObjectByID(objectID);
+		if (networkObject) {
+			networkObject->ReadSnapshot(stream, snapshotPacket->isDeltaFrame, snapshotPacket->stateID, snapshotPacket->serverTime, mNetworkQuantizer);
+		}
+		else {
+			NetworkObject::SkipSnapshot(stream, mNetworkQuantizer);
+		}
+
+		if (stream.HasOverflowed()) {
+			std::cout << "Snapshot packet is truncated, dropping the rest of it." << std::endl;
+			break;
 		}
 	}
+
+	if (!snapshotPacket->isDeltaFrame) {
+		mClientSideLastFullID = std::max(mClientSideLastFullID, snapshotPacket->stateID);
+	}
 }
 
 void DebugNetworkedGame::HandleClientPlayerInputPacket(ClientPlayerInputPacket* clientPlayerInputPacket, int playerPeerId) {
 	int playerIndex = GetPlayerPeerID(playerPeerId);
-	auto* playerToHandle = mServerPlayers[playerIndex];
+	//inputs can arrive before the match has spawned the player they are for
+	const auto player = mServerPlayers.find(playerIndex);
+	if (player == mServerPlayers.end() || player->second == nullptr) {
+		return;
+	}
+	auto* playerToHandle = player->second;
 
-	playerToHandle->SetPlayerInput(clientPlayerInputPacket->playerInputs);
+	//applied one per tick by the player, so a burst of packets doesn't speed it up
+	playerToHandle->QueueInputs(clientPlayerInputPacket->firstInputId, clientPlayerInputPacket->inputs, clientPlayerInputPacket->inputCount);
 	mServerSideLastFullID = clientPlayerInputPacket->lastId;
+	mStateIDs[playerPeerId] = clientPlayerInputPacket->lastId;
+	mReplicatedProperties.Acknowledge(playerPeerId, clientPlayerInputPacket->propertyAck, (uint32_t)clientPlayerInputPacket->propertyAckBits);
 	UpdateMinimumState();
 }
 
@@ -674,18 +1070,48 @@ void DebugNetworkedGame::HandleAddPlayerScorePacket(AddPlayerScorePacket* packet
 
 void DebugNetworkedGame::SyncPlayerList() {
 	int peerId;
-	mPlayerList[0] = 0;
-	for (int i = 0; i < 3; ++i) {
-		if (mThisServer->GetPeer(i, peerId)) {
-			mPlayerList[i + 1] = peerId;
-		}
-		else {
-			mPlayerList[i + 1] = -1;
+	SetPlayerSlot(0, mIsDedicatedServer ? -1 : SERVER_PLAYER_PEER);
+	for (int i = 1; i < mMaxPlayers; ++i) {
+		const int peerNumber = mThisServer->GetPeer(i - 1, peerId) ? peerId : -1;
+		//everyone in the lobby spawned with the level, anyone since has joined a match in progress
+		if (SetPlayerSlot(i, peerNumber) && mIsGameStarted && peerNumber != -1) {
+			SpawnLatePlayer(i);
 		}
 	}
 
-	SyncPlayerListPacket packet(mPlayerList);
-	mThisServer->SendGlobalPacket(packet);
+	for (int i = 0; i < mPlayerList.size(); i++) {
+		mReplicatedProperties.Set(mPlayerListProperty, i, (float)mPlayerList[i]);
+	}
+}
+
+void DebugNetworkedGame::InitReplicatedProperties() {
+	//Declared in the same order on server and clients, the callbacks only ever run on clients.
+	mPlayerListProperty = mReplicatedProperties.DeclareGroup(PLAYER_LIST_PROPERTY, [this](int slot, float peerID) {
+		//clients take the server's slot count from the slots it sends
+		const int peerNumber = (int)std::lround(peerID);
+		if (SetPlayerSlot(slot, peerNumber) && mIsGameStarted && peerNumber != -1) {
+			SpawnLatePlayer(slot);
+		}
+	});
+	mLocalSusProperty = mReplicatedProperties.DeclareGroup(SUSPICION_PROPERTY, [this](int playerNo, float value) {
+		if (mLevelManager == nullptr || mLocalPlayer == nullptr) {
+			return;
+		}
+		const int localPlayerID = static_cast<NetworkPlayer*>(mLocalPlayer)->GetPlayerID();
+		mLevelManager->GetSuspicionSystem()->GetLocalSuspicionMetre()->SyncSusChange(playerNo, localPlayerID, (int)std::lround(value));
+	});
+	mGlobalSusProperty = mReplicatedProperties.DeclareGroup(SUSPICION_PROPERTY, [this](int key, float value) {
+		if (mLevelManager == nullptr) {
+			return;
+		}
+		mLevelManager->GetSuspicionSystem()->GetGlobalSuspicionMetre()->SyncSusChange((int)std::lround(value));
+	});
+	mLocationSusProperty = mReplicatedProperties.DeclareGroup(SUSPICION_PROPERTY, [this](int cantorPairedLocation, float value) {
+		if (mLevelManager == nullptr) {
+			return;
+		}
+		mLevelManager->GetSuspicionSystem()->GetLocationBasedSuspicion()->SyncSusChange(cantorPairedLocation, (int)std::lround(value));
+	});
 }
 
 void DebugNetworkedGame::SetItemsLeftToZero() {
@@ -701,23 +1127,21 @@ void DebugNetworkedGame::HandlePlayerEquippedItemChange(ClientSyncItemSlotPacket
 void DebugNetworkedGame::HandleInteractablePacket(SyncInteractablePacket* packet) const {
 	InteractableItems interactableItemType = static_cast<InteractableItems>(packet->interactableItemType);
 
-	NetworkObject* interactedObj = nullptr;
-	for (auto* networkObject : mNetworkObjects) {
-		if (networkObject->GetnetworkID() == packet->networkObjId) {
-			interactedObj = networkObject;
-			break;
-		}
-	}
+	NetworkObject* interactedObj = GetNetworkObjectByID(packet->networkObjId);
+	GameObject* interactedGameObj = interactedObj != nullptr ? &interactedObj->GetGameObject() : nullptr;
 
 	switch (interactableItemType) {
 	case InteractableItems::InteractableDoors: {
-		InteractableDoor* doorObj = reinterpret_cast<InteractableDoor*>(interactedObj);
-		doorObj->SyncDoor(packet->isOpen);
+		//the table holds the network component, the door is the game object that owns it
+		if (InteractableDoor* doorObj = dynamic_cast<InteractableDoor*>(interactedGameObj)) {
+			doorObj->SyncDoor(packet->isOpen);
+		}
 		break;
 	}
 	case InteractableItems::InteractableVents:{
-		Vent* ventObj = reinterpret_cast<Vent*>(interactedObj);
-		ventObj->SetIsOpen(packet->isOpen, false);
+		if (Vent* ventObj = dynamic_cast<Vent*>(interactedGameObj)) {
+			ventObj->SetIsOpen(packet->isOpen, false);
+		}
 		break;
 	}
 	case InteractableItems::HeistItem:{
@@ -785,6 +1209,272 @@ void DebugNetworkedGame::AddToPlayerPeerNameMap(int playerId, const std::string&
 
 void DebugNetworkedGame::HandleClientInitPacket(const ClientInitPacket* packet, int playerID) {
 	AddToPlayerPeerNameMap(playerID, packet->playerName);
+
+	//peer numbers get reused, so a client without the dictionary clears the last one's
+	if (packet->snapshotDictionaryId != 0 && packet->snapshotDictionaryId == mSnapshotDictionary.GetId()) {
+		mCompressedPeers.insert(playerID);
+	}
+	else {
+		mCompressedPeers.erase(playerID);
+	}
+
+	if (mIsGameStarted && !mIsGameFinished) {
+		StartJoinStream(playerID);
+	}
+}
+
+void DebugNetworkedGame::HandlePlayerDisconnected(int peerNumber) {
+	//the slot still maps to the peer until the next player list sync
+	const auto player = mServerPlayers.find(GetPlayerPeerID(peerNumber));
+	if (player != mServerPlayers.end() && player->second != nullptr) {
+		player->second->ResetInputState();
+	}
+	mReplicatedProperties.RemoveClient(peerNumber);
+	mInterestManager.RemoveClient(peerNumber);
+	mStateIDs.erase(peerNumber);
+	UpdateMinimumState();
+}
+
+void DebugNetworkedGame::StartJoinStream(int peerNumber) {
+	//the newcomer needs its slot and player object before the world is written down
+	SyncPlayerList();
+	if (GetPlayerPeerID(peerNumber) < 0) {
+		return;
+	}
+
+	const int stateID = mServerSideNextFullID++;
+	std::vector<char> image;
+	if (!WriteJoinStateImage(peerNumber, stateID, image)) {
+		std::cout << "Join state for peer " << peerNumber << " does not fit in an image" << std::endl;
+		return;
+	}
+
+	const auto previousStream = mJoinStreams.find(peerNumber);
+	if (previousStream != mJoinStreams.end()) {
+		delete previousStream->second;
+	}
+	const SnapshotDictionary* dictionary = mCompressedPeers.contains(peerNumber) ? &mSnapshotDictionary : nullptr;
+	mJoinStreams[peerNumber] = new JoinStateSender(mNextJoinStreamID++, image.data(), (int)image.size(), dictionary, mNetworkTime);
+	//keeps the image's full state in the object histories until the client has moved past it
+	mStateIDs[peerNumber] = stateID;
+	//anything broadcast from here on happened after the image was taken
+	mThisServer->HoldPeer(peerNumber);
+	UpdateJoinStreams();
+}
+
+void DebugNetworkedGame::UpdateJoinStreams() {
+	if (mJoinStreams.empty()) {
+		return;
+	}
+	const int byteBudget = JOIN_STATE_BYTES_PER_TICK / (int)mJoinStreams.size();
+	for (auto it = mJoinStreams.begin(); it != mJoinStreams.end();) {
+		const int peerNumber = it->first;
+		JoinStateSender* joinStream = it->second;
+		//a client that left takes its stream with it
+		if (joinStream->IsComplete() || GetPlayerPeerID(peerNumber) < 0) {
+			if (joinStream->IsComplete()) {
+				std::cout << "Peer " << peerNumber << " caught up in " << (mNetworkTime - joinStream->GetStartTime()) * 1000.0f << "ms, "
+					<< joinStream->GetStreamSize() << " bytes sent for a " << joinStream->GetImageSize() << " byte image" << std::endl;
+			}
+			//from here on it gets the snapshots and broadcasts like everyone else
+			mThisServer->ReleasePeer(peerNumber);
+			delete joinStream;
+			it = mJoinStreams.erase(it);
+			continue;
+		}
+		joinStream->Update(mNetworkTime, byteBudget, JOIN_STATE_RESEND_DELAY, [&](JoinStateChunkPacket& chunk) {
+			mThisServer->SendPacketToPeer(chunk, peerNumber);
+		});
+		++it;
+	}
+}
+
+bool DebugNetworkedGame::WriteJoinStateImage(int peerNumber, int stateID, std::vector<char>& image) {
+	JoinStateImageHeader header;
+	header.levelSeed = mLevelSeed;
+	header.serverTime = mNetworkTime;
+	header.stateID = stateID;
+	header.playerCount = (short)mPlayerList.size();
+
+	image.assign(sizeof(header), 0);
+	AppendBytes(image, mPlayerList.data(), (int)(mPlayerList.size() * sizeof(int)));
+
+	std::vector<char> sectionBuffer(JOIN_STATE_MAX_IMAGE_SIZE);
+	BitStream propertyStream = BitStream::ForWriting(sectionBuffer.data(), (int)sectionBuffer.size());
+	header.propertyCount = (short)mReplicatedProperties.WriteChanges(propertyStream, peerNumber, mNetworkTime,
+		propertyStream.GetBitsRemaining(), header.propertySequence);
+	header.propertyBytes = propertyStream.Flush();
+	AppendBytes(image, sectionBuffer.data(), header.propertyBytes);
+
+	//a full frame of everything, whatever the client's interest in it
+	BitStream objectStream = BitStream::ForWriting(sectionBuffer.data(), (int)sectionBuffer.size());
+	for (NetworkObject* networkObject : mNetworkObjects) {
+		if (!networkObject) {
+			continue;
+		}
+		const int networkID = networkObject->GetnetworkID();
+		if (networkObject->WriteSnapshot(objectStream, false, stateID, -1, mNetworkQuantizer, mInterestManager.GetSendState(peerNumber, networkID))) {
+			mInterestManager.MarkSent(peerNumber, networkID);
+			header.objectCount++;
+		}
+	}
+	if (objectStream.HasOverflowed()) {
+		return false;
+	}
+	header.objectBytes = objectStream.Flush();
+	AppendBytes(image, sectionBuffer.data(), header.objectBytes);
+
+	header.packetCount = (short)WriteJoinStatePackets(image);
+	memcpy(image.data(), &header, sizeof(header));
+	return (int)image.size() <= JOIN_STATE_MAX_IMAGE_SIZE;
+}
+
+int DebugNetworkedGame::WriteJoinStatePackets(std::vector<char>& image) const {
+	PacketSerializer packetSerializer;
+	int packetCount = 0;
+	auto appendPacket = [&](SerializablePacket& packet) {
+		if (SerializedPacket* serialized = packetSerializer.Write(packet)) {
+			AppendBytes(image, serialized, serialized->GetTotalSize());
+			packetSerializer.Release(serialized);
+			packetCount++;
+		}
+	};
+
+	PlayerInventory* inventory = mLevelManager->GetInventoryBuffSystem()->GetPlayerInventoryPtr();
+	PlayerBuffs* buffs = mLevelManager->GetInventoryBuffSystem()->GetPlayerBuffsPtr();
+	LocalSuspicionMetre* localSusMetre = mLevelManager->GetSuspicionSystem()->GetLocalSuspicionMetre();
+	for (int playerNo = 0; playerNo < (int)mPlayerList.size(); playerNo++) {
+		if (mPlayerList[playerNo] == -1) {
+			continue;
+		}
+		for (int invSlot = 0; invSlot < MAX_INVENTORY_SLOTS; invSlot++) {
+			const PlayerInventory::item item = inventory->GetItemInInventorySlot(playerNo, invSlot);
+			if (item != PlayerInventory::none) {
+				ClientSyncItemSlotPacket packet(playerNo, invSlot, item, inventory->GetItemUsageCount(playerNo, invSlot));
+				appendPacket(packet);
+			}
+		}
+		//applied afresh, so a buff runs its full duration again on the new client
+		for (const auto& [buff, duration] : buffs->GetActiveBuffs(playerNo)) {
+			ClientSyncBuffPacket packet(playerNo, buff, true);
+			appendPacket(packet);
+		}
+		for (LocalSuspicionMetre::activeLocalSusCause activeCause : localSusMetre->GetActiveSusCauses(playerNo)) {
+			ClientSyncLocalActiveSusCausePacket packet(playerNo, activeCause, true);
+			appendPacket(packet);
+		}
+	}
+
+	LocationBasedSuspicion* locationSusMetre = mLevelManager->GetSuspicionSystem()->GetLocationBasedSuspicion();
+	for (const auto& [location, activeCauses] : locationSusMetre->GetActiveSusCauses()) {
+		for (LocationBasedSuspicion::activeLocationSusCause activeCause : activeCauses) {
+			ClientSyncLocationActiveSusCausePacket packet(*location, activeCause, true);
+			appendPacket(packet);
+		}
+	}
+
+	//levels load with every door and vent shut and every object idle
+	for (NetworkObject* networkObject : mNetworkObjects) {
+		if (!networkObject) {
+			continue;
+		}
+		const int networkID = networkObject->GetnetworkID();
+		GameObject* gameObject = &networkObject->GetGameObject();
+		if (InteractableDoor* door = dynamic_cast<InteractableDoor*>(gameObject)) {
+			if (door->GetIsOpen()) {
+				SyncInteractablePacket packet(networkID, true, InteractableItems::InteractableDoors);
+				appendPacket(packet);
+			}
+		}
+		else if (Vent* vent = dynamic_cast<Vent*>(gameObject)) {
+			if (vent->IsOpen()) {
+				SyncInteractablePacket packet(networkID, true, InteractableItems::InteractableVents);
+				appendPacket(packet);
+			}
+		}
+		if (gameObject->GetGameOjbectState() != GameObject::GameObjectState::Idle) {
+			SyncObjectStatePacket packet(networkID, gameObject->GetGameOjbectState());
+			appendPacket(packet);
+		}
+	}
+	return packetCount;
+}
+
+void DebugNetworkedGame::HandleJoinStateChunk(const JoinStateChunkPacket* packet) {
+	if (!mJoinStateReceiver.ReceiveChunk(*packet)) {
+		std::cout << "Dropped a join state chunk that did not unpack" << std::endl;
+		return;
+	}
+	//chunks resent after the image was applied still need acknowledging, or the server keeps sending them
+	mIsJoinStateAckDue = true;
+	if (mIsGameStarted || !mJoinStateReceiver.IsComplete()) {
+		return;
+	}
+	if (!ApplyJoinStateImage(mJoinStateReceiver.GetImage())) {
+		std::cout << "Join state image is malformed, the match in progress could not be joined" << std::endl;
+	}
+}
+
+bool DebugNetworkedGame::ApplyJoinStateImage(const std::vector<char>& image) {
+	JoinStateImageHeader header;
+	if (image.size() < sizeof(header)) {
+		return false;
+	}
+	memcpy(&header, image.data(), sizeof(header));
+	const int playersOffset = (int)sizeof(header);
+	const int propertiesOffset = playersOffset + header.playerCount * (int)sizeof(int);
+	const int objectsOffset = propertiesOffset + header.propertyBytes;
+	const int packetsOffset = objectsOffset + header.objectBytes;
+	if (header.playerCount < 0 || header.playerCount > MAX_PLAYER_SLOTS || header.propertyBytes < 0 || header.objectBytes < 0 ||
+		packetsOffset > (int)image.size()) {
+		return false;
+	}
+
+	for (int slot = 0; slot < header.playerCount; slot++) {
+		int peerNumber;
+		memcpy(&peerNumber, image.data() + playersOffset + slot * sizeof(int), sizeof(int));
+		SetPlayerSlot(slot, peerNumber);
+	}
+	if (GetPlayerPeerID() < 0) {
+		return false;
+	}
+	//the same level, with every player in it, that everyone else started on
+	SetIsGameStarted(true, header.levelSeed);
+
+	if (header.propertyCount > 0) {
+		BitStream propertyStream = BitStream::ForReading(image.data() + propertiesOffset, header.propertyBytes);
+		mReplicatedProperties.ReadChanges(propertyStream, header.propertySequence, header.propertyCount);
+	}
+
+	BitStream objectStream = BitStream::ForReading(image.data() + objectsOffset, header.objectBytes);
+	for (int objectIndex = 0; objectIndex < header.objectCount && !objectStream.HasOverflowed(); objectIndex++) {
+		const int objectID = NetworkObject::ReadSnapshotObjectID(objectStream);
+		if (NetworkObject* networkObject = GetNetworkObjectByID(objectID)) {
+			networkObject->ReadSnapshot(objectStream, false, header.stateID, header.serverTime, mNetworkQuantizer);
+		}
+		else {
+			NetworkObject::SkipSnapshot(objectStream, mNetworkQuantizer);
+		}
+	}
+	mClientSideLastFullID = header.stateID;
+
+	SerializedPacket packet;
+	int offset = packetsOffset;
+	for (int packetIndex = 0; packetIndex < header.packetCount; packetIndex++) {
+		if (offset + (int)sizeof(GamePacket) > (int)image.size()) {
+			return false;
+		}
+		memcpy(&packet, image.data() + offset, sizeof(GamePacket));
+		const int packetSize = packet.GetTotalSize();
+		if (packet.size < 0 || packetSize > (int)sizeof(SerializedPacket) || offset + packetSize > (int)image.size() ||
+			!IsWorldEventPacket(packet.type)) {
+			return false;
+		}
+		memcpy(&packet, image.data() + offset, packetSize);
+		ReceivePacket(packet.type, &packet, -1);
+		offset += packetSize;
+	}
+	return true;
 }
 
 void DebugNetworkedGame::WriteAndSendSyncPlayerIdNameMapPacket() const {
@@ -794,7 +1484,7 @@ void DebugNetworkedGame::WriteAndSendSyncPlayerIdNameMapPacket() const {
 
 void DebugNetworkedGame::HandleSyncPlayerIdNameMapPacket(const SyncPlayerIdNameMapPacket* packet) {
 	mPlayerPeerNameMap.clear();
-	for (int i = 0; i < 4; i++) {
+	for (int i = 0; i < (int)packet->playerIds.size(); i++) {
 		if (packet->playerIds[i] != -1) {
 			std::pair<int, std::string> playerIdNamePair(packet->playerIds[i], packet->playerNames[i]);
 			mPlayerPeerNameMap.insert(playerIdNamePair);
@@ -818,13 +1508,7 @@ void DebugNetworkedGame::ShowPlayerList() const {
 }
 
 void DebugNetworkedGame::HandleObjectStatePacket(SyncObjectStatePacket* packet) const {
-	NetworkObject* objectToChangeState = nullptr;
-	for (NetworkObject* networkObject : mNetworkObjects) {
-		if (networkObject->GetnetworkID() == packet->networkObjId) {
-			objectToChangeState = networkObject;
-			break;
-		}
-	}
+	NetworkObject* objectToChangeState = GetNetworkObjectByID(packet->networkObjId);
 
 	GameObject::GameObjectState state = static_cast<GameObject::GameObjectState>(packet->objectState);
 	if (objectToChangeState != nullptr) {
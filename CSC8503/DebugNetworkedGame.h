@@ -5,7 +5,14 @@
 #include <mutex>
 #include <functional>
 #include <random>
+#include <set>
 #include "NetworkedGame.h"
+#include "NetworkQuantizer.h"
+#include "SnapshotInterpolation.h"
+#include "InterestManager.h"
+#include "JoinState.h"
+#include "ReplicatedProperties.h"
+#include "SnapshotCompression.h"
 
 
 namespace NCL::CSC8503
@@ -30,12 +37,14 @@ namespace NCL::CSC8503 {
 
 namespace NCL{
     namespace CSC8503{
-        struct DeltaPacket;
         class GameServer;
         class GameClient;
+        class SessionHost;
         class NetworkPlayer;
+        class PacketSender;
+        class ReplayPlayer;
 
-        struct FullPacket;
+        struct SnapshotPacket;
         struct ClientPlayerInputPacket;
         struct ClientSyncBuffPacket;
         struct AddPlayerScorePacket;
@@ -56,15 +65,38 @@ namespace NCL{
             bool PlayerWonGame() override;
             bool PlayerLostGame() override;
             const bool GetIsGameStarted() const;
+            bool GetIsDedicatedServer() const;
+            //Players currently in the lobby or match, the host counts unless the server is dedicated.
+            int GetConnectedPlayerCount() const;
+            int GetPlayersToStart() const;
+            //Player slots in a match, the host's included. Set before starting a server, clients follow the server's.
+            void SetMaxPlayers(int maxPlayers);
+            int GetMaxPlayers() const { return mMaxPlayers; }
+            //Clients a dedicated server can take, slot 0 is kept empty for the host it doesn't have.
+            static int GetMaxDedicatedPlayers();
+            //Set once a dedicated server's match has ended and it can be torn down.
+            bool GetIsMatchOver() const;
+            void SetIsMatchOver(bool isMatchOver);
 
             const int GetClientLastFullID() const;
 
             bool StartAsServer(const std::string& playerName);
-            bool StartAsClient(char a, char b, char c, char d, const std::string& playerName);
+            //Hosts without a player of its own on a session of the shared host, the match starts once playersToStart clients have joined.
+            bool StartAsDedicatedServer(int playersToStart, int maxPlayers, SessionHost& sessionHost);
+            //A session ID of 0 lets a dedicated server pick the match.
+            bool StartAsClient(char a, char b, char c, char d, const std::string& playerName, uint32_t sessionId = 0);
+            //Plays a recording from GameServer::StartRecording as the client with that peer number, 0 for the first one.
+            bool StartAsReplay(const std::string& filepath, int peerNumber);
+            //Plays a recording back as the dedicated server that made it, on the level it played. playersToStart
+            //and maxPlayers have to be what that server was started with.
+            bool StartAsServerReplay(const std::string& filepath, int playersToStart, int maxPlayers);
+            const ReplayPlayer* GetReplay() const { return mReplayPlayer; }
 
             void UpdateGame(float dt) override;
 
             void SetIsGameStarted(bool isGameStarted, unsigned int seed = -1);
+            //A server starts its level from this rather than a random seed, so a match can be played again.
+            void SetServerLevelSeed(unsigned int seed) { mServerLevelSeed = seed; mHasServerLevelSeed = true; }
             void SetIsGameFinished(bool isGameFinished, int winningPlayerId);
             void StartLevel(const std::mt19937& levelSeed);
 
@@ -80,35 +112,46 @@ namespace NCL{
             void ClearNetworkGame();
 
             void SendClientSyncLocalActiveSusCausePacket(int playerNo, int activeSusCause, bool toApply) const;
-            void SendClientSyncLocalSusChangePacket(int playerNo, int changedValue) const;
-            void SendClientSyncGlobalSusChangePacket(int changedValue) const;
+            //Replicated through the snapshots, so calling these every frame only costs bandwidth when the value moves.
+            void ReplicateLocalSusChange(int playerNo, int changedValue);
+            void ReplicateGlobalSusChange(int changedValue);
             void SendClientSyncLocationActiveSusCausePacket(int cantorPairedLocation, int activeSusCause, bool toApply) const;
-            void SendClientSyncLocationSusChangePacket(int cantorPairedLocation, int changedValue) const;
+            void ReplicateLocationSusChange(int cantorPairedLocation, int changedValue);
 
             void SendAnnouncementSyncPacket(int annType, float time,int playerNo);
 
             void SendGuardSpotSoundPacket(int playerId) const;
 
-            void SendPacketsThread();
+            const ReplicatedProperties& GetReplicatedProperties() const { return mReplicatedProperties; }
 
             GameClient* GetClient() const;
             GameServer* GetServer() const;
             NetworkPlayer* GetLocalPlayer() const;
+            //-1 until players spawn, and always on a dedicated server.
+            int GetLocalPlayerID() const;
 
         protected:
             bool mIsGameStarted = false;
             bool mIsGameFinished = false;
             bool mIsServer = false;
+            bool mIsDedicatedServer = false;
+            bool mIsMatchOver = false;
+            int mPlayersToStart = 1;
 
             int mWinningPlayerId;
             int mLocalPlayerId;
 
+            bool StartServer(SessionHost* sessionHost = nullptr, ReplayPlayer* replay = nullptr);
+            void RegisterClientPacketHandlers();
             void UpdateAsServer(float dt);
             void UpdateAsClient(float dt);
+            void UpdateInterpolation(float dt);
 
             void BroadcastSnapshot(bool deltaFrame);
             void UpdateMinimumState();
             int GetPlayerPeerID(int peerId = -2);
+            //Returns whether the slot changed, slots past the end are added.
+            bool SetPlayerSlot(int slot, int peerNumber);
 
             void SendStartGameStatusPacket(const std::string& seed = "") const;
             void SendFinishGameStatusPacket();
@@ -118,12 +161,14 @@ namespace NCL{
             void HandleClientPlayerInput(ClientPlayerInputPacket* playerMovementPacket, int playerPeerID);
 
             void SpawnPlayers();
+            NetworkPlayer* SpawnPlayer(int slot);
+            //For a slot filled once the match is under way. A peer reusing a slot takes over the player already in it,
+            //with the previous client's inputs forgotten.
+            void SpawnLatePlayer(int slot);
 
         	NetworkPlayer* AddPlayerObject(const Maths::Vector3& position, int playerNum);
 
-            void HandleFullPacket(FullPacket* fullPacket);
-
-            void HandleDeltaPacket(DeltaPacket* deltaPacket);
+            void HandleSnapshotPacket(SnapshotPacket* snapshotPacket);
 
             void HandleClientPlayerInputPacket(ClientPlayerInputPacket* clientPlayerInputPacket, int playerPeerId);
 
@@ -131,6 +176,8 @@ namespace NCL{
 
             void SyncPlayerList();
 
+            void InitReplicatedProperties();
+
         	void SetItemsLeftToZero() override;
 
             void HandlePlayerEquippedItemChange(ClientSyncItemSlotPacket* packet) const;
@@ -153,6 +200,18 @@ namespace NCL{
 
             void AddToPlayerPeerNameMap(int playerId, const std::string& playerName);
             void HandleClientInitPacket(const ClientInitPacket* packet, int playerID);
+            //Forgets the acks and interest kept for the peer, whoever connects next can be given its number.
+            void HandlePlayerDisconnected(int peerNumber);
+
+            //A client joining a match in progress is streamed the world as it is now, and gets nothing else
+            //until it has all of it.
+            void StartJoinStream(int peerNumber);
+            void UpdateJoinStreams();
+            bool WriteJoinStateImage(int peerNumber, int stateID, std::vector<char>& image);
+            //Events that already happened, as the packets that would have told the client about them.
+            int WriteJoinStatePackets(std::vector<char>& image) const;
+            void HandleJoinStateChunk(const JoinStateChunkPacket* packet);
+            bool ApplyJoinStateImage(const std::vector<char>& image);
 
             void WriteAndSendSyncPlayerIdNameMapPacket() const;
             void HandleSyncPlayerIdNameMapPacket(const SyncPlayerIdNameMapPacket* packet);
@@ -165,11 +224,43 @@ namespace NCL{
 
             int mClientSideLastFullID;
             int mServerSideLastFullID;
+            int mServerSideNextFullID;
+
+            NetworkQuantizer mNetworkQuantizer;
+            InterestManager mInterestManager;
+
+            ReplicatedProperties mReplicatedProperties;
+            int mPlayerListProperty;
+            int mLocalSusProperty;
+            int mGlobalSusProperty;
+            int mLocationSusProperty;
 
-            std::queue<GamePacket*> mPacketToSendQueue;
-            std::mutex mPacketToSendQueueMutex;
+            //Seconds since the network game started, snapshots are stamped with the server's.
+            float mNetworkTime;
+            PlayoutClock mPlayoutClock;
+
+            PacketSender* mPacketSender;
+            ReplayPlayer* mReplayPlayer;
+
+            SnapshotDictionary mSnapshotDictionary;
+            //Client side, the server's packet sender compresses on its own thread.
+            SnapshotCodec mSnapshotCodec;
+            std::set<int> mCompressedPeers;
 
             std::map<int, std::string> mPlayerPeerNameMap;
+
+            int mMaxPlayers;
+            //Slot in mPlayerList for each peer in it, so finding a player doesn't scan the list.
+            std::map<int, int> mPlayerIndices;
+
+            //Kept for the level a late joiner has to load.
+            unsigned int mLevelSeed = 0;
+            unsigned int mServerLevelSeed = 0;
+            bool mHasServerLevelSeed = false;
+            std::map<int, JoinStateSender*> mJoinStreams;
+            int mNextJoinStreamID = 0;
+            JoinStateReceiver mJoinStateReceiver;
+            bool mIsJoinStateAckDue = false;
         private:
         };
     }
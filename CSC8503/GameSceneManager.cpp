@@ -76,6 +76,7 @@ void GameSceneManager::InitCamera() {
 void GameSceneManager::CreateLevel() {
 	std::random_device rd;
 	std::mt19937 g(rd());
+	mLevelManager->SetPlayerSlotCount(1);
 #ifdef USEGL
 	mLevelManager->LoadLevel(1, g, 0);
 #endif
@@ -1047,7 +1047,7 @@ void GameTechRenderer::LoadTextures(std::unordered_map<std::string, Texture*>& t
 		fileLoadThreads[i].join();
 	}
 	for (int i = 0; i < details.size() / 3; i++) {
-		OGLTexture* tex = OGLTexture::TextureFromData(texData[i], widths[i], heights[i], channels[i]).release();
+		OGLTexture* tex = OGLTexture::TextureFromData(texData[i], widths[i], heights[i], channels[i], flags[i]).release();
 		if (FindTexHandleIndex(tex->GetObjectID()) == -1) {
 			const GLuint64 handle = glGetTextureHandleARB(tex->GetObjectID());
 			glMakeTextureHandleResidentARB(handle);
@@ -1239,7 +1239,7 @@ void GameTechRenderer::LoadMeshMaterials(std::unordered_map<std::string, Mesh*>&
 	}
 	std::vector<GLuint> textures;
 	for (int i = 0; i < texData.size(); i++) {
-		OGLTexture* tex = OGLTexture::TextureFromData(texData[i], widths[i], heights[i], channels[i]).release();
+		OGLTexture* tex = OGLTexture::TextureFromData(texData[i], widths[i], heights[i], channels[i], flags[i]).release();
 		if (FindTexHandleIndex(tex->GetObjectID()) == -1) {
 			const GLuint64 handle = glGetTextureHandleARB(tex->GetObjectID());
 			glMakeTextureHandleResidentARB(handle);
@@ -28,6 +28,12 @@ namespace InventoryBuffSystem
             mPlayerBuffsPtr->Update(dt);
         };
 
+        void SetPlayerCount(int playerCount)
+        {
+            mPlayerBuffsPtr->SetPlayerCount(playerCount);
+            mPlayerInventoryPtr->SetPlayerCount(playerCount);
+        };
+
         ~InventoryBuffSystemClass() {
             mPlayerInventoryPtr->Detach(mPlayerBuffsPtr);
             delete mPlayerBuffsPtr;
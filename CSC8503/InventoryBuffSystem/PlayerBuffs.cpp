@@ -8,14 +8,24 @@ using namespace InventoryBuffSystem;
 using namespace NCL::CSC8503;
 
 void PlayerBuffs::Init(){
-	for (int playerNo = 0; playerNo < NCL::CSC8503::MAX_PLAYERS; playerNo++){
-		mActiveBuffDurationMap[playerNo].clear();
-		mBuffsToRemove[playerNo].clear();
+	for (int playerNo = 0; playerNo < mPlayerCount; playerNo++){
+		ClearPlayer(playerNo);
 	}
 
 	mBuffsObserverList.clear();
-	mActiveBuffDurationMap->clear();
-	mBuffsToRemove->clear();
+}
+
+void PlayerBuffs::SetPlayerCount(int playerCount){
+	playerCount = std::clamp(playerCount, 1, NCL::CSC8503::MAX_PLAYER_SLOTS);
+	for (int playerNo = mPlayerCount; playerNo < playerCount; playerNo++){
+		ClearPlayer(playerNo);
+	}
+	mPlayerCount = playerCount;
+}
+
+void PlayerBuffs::ClearPlayer(int playerNo){
+	mActiveBuffDurationMap[playerNo].clear();
+	mBuffsToRemove[playerNo].clear();
 }
 
 void PlayerBuffs::ApplyBuffToPlayer(const buff& inBuff, const int& playerNo){
@@ -50,8 +60,7 @@ void PlayerBuffs::HandleBuffNetworking(const buff& inBuff, const int& playerNo,
 	int localPlayerId = 0;
 	DebugNetworkedGame* game = reinterpret_cast<DebugNetworkedGame*>(SceneManager::GetSceneManager()->GetCurrentScene());
 	if (!SceneManager::GetSceneManager()->IsInSingleplayer()) {
-		auto* localPlayer = game->GetLocalPlayer();
-		localPlayerId = localPlayer->GetPlayerID();
+		localPlayerId = game->GetLocalPlayerID();
 		const bool isServer = game->GetIsServer();
 		if (isServer) {
 			game->SendClientSyncBuffPacket(playerNo, inBuff, toApply);
@@ -75,7 +84,7 @@ PlayerBuffs::buff PlayerBuffs::GetRandomBuffFromPool(unsigned int seed, std::vec
 }
 
 void PlayerBuffs::Update(float dt){
-	for (int playerNo = 0; playerNo < NCL::CSC8503::MAX_PLAYERS; playerNo++)
+	for (int playerNo = 0; playerNo < mPlayerCount; playerNo++)
 	{
 		for (auto entry = mActiveBuffDurationMap[playerNo].begin();
 			entry != mActiveBuffDurationMap[playerNo].end(); ++entry)
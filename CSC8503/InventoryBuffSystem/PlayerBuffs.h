@@ -36,6 +36,8 @@ namespace InventoryBuffSystem {
 
 		};
 		void Init();
+		//Slots the match numbers its players by, nothing past them is updated. Slots coming into use start clear.
+		void SetPlayerCount(int playerCount);
 		void ApplyBuffToPlayer(const buff& inBuff, const int& playerNo);
 		void RemoveBuffFromPlayer(const buff& inBuff, const int& playerNo);
 		void HandleBuffNetworking(const buff& inBuff, const int& playerNo, const bool& toApply);
@@ -59,6 +61,7 @@ namespace InventoryBuffSystem {
 		float GetBuffDuration(PlayerBuffs::buff inBuff);
 
 		void SyncPlayerBuffs(int playerID, int localPlayerID, buff buffToSync, bool toApply);
+		const std::map<buff, float>& GetActiveBuffs(const int playerNo) const { return mActiveBuffDurationMap[playerNo]; }
 	private:
 		std::vector< buff> mBuffsInSinglePlayerRandomPool =
 		{
@@ -98,7 +101,7 @@ namespace InventoryBuffSystem {
 		{
 			{slowEveryoneElse,[this](int playerNo)
 				{
-					for (int i = 0; i < NCL::CSC8503::MAX_PLAYERS; i++){
+					for (int i = 0; i < mPlayerCount; i++){
 						if(i!=playerNo){
 							ApplyBuffToPlayer(slow,i);
 						}
@@ -107,7 +110,7 @@ namespace InventoryBuffSystem {
 			},
 			{everyoneElseMakesSound,[this](int playerNo)
 				{
-					for (int i = 0; i < NCL::CSC8503::MAX_PLAYERS; i++) {
+					for (int i = 0; i < mPlayerCount; i++) {
 						if (i != playerNo) {
 							ApplyBuffToPlayer(makeSound,i);
 						}
@@ -116,8 +119,11 @@ namespace InventoryBuffSystem {
 			}
 		};
 
-		std::map<buff, float> mActiveBuffDurationMap[NCL::CSC8503::MAX_PLAYERS];
+		std::map<buff, float> mActiveBuffDurationMap[NCL::CSC8503::MAX_PLAYER_SLOTS];
 		std::list<PlayerBuffsObserver*> mBuffsObserverList;
-		std::vector<buff> mBuffsToRemove[NCL::CSC8503::MAX_PLAYERS];
+		std::vector<buff> mBuffsToRemove[NCL::CSC8503::MAX_PLAYER_SLOTS];
+		int mPlayerCount = NCL::CSC8503::MAX_PLAYER_SLOTS;
+
+		void ClearPlayer(int playerNo);
 	};
 }
@@ -21,7 +21,7 @@ using namespace InventoryBuffSystem;
 using namespace NCL::CSC8503;
 
 void PlayerInventory::Init() {
-	for (int playerNo = 0; playerNo < NCL::CSC8503::MAX_PLAYERS; playerNo++)
+	for (int playerNo = 0; playerNo < mPlayerCount; playerNo++)
 	{
 		for (int invSlot = 0; invSlot < MAX_INVENTORY_SLOTS; invSlot++)
 		{
@@ -45,6 +45,18 @@ void PlayerInventory::Init() {
 	mInventoryObserverList.clear();
 }
 
+void PlayerInventory::SetPlayerCount(int playerCount) {
+	playerCount = std::clamp(playerCount, 1, NCL::CSC8503::MAX_PLAYER_SLOTS);
+	for (int playerNo = mPlayerCount; playerNo < playerCount; playerNo++)
+	{
+		for (int invSlot = 0; invSlot < MAX_INVENTORY_SLOTS; invSlot++)
+		{
+			mPlayerInventory[playerNo][invSlot] = none;
+		}
+	}
+	mPlayerCount = playerCount;
+}
+
 //Returns the inventory slot the item is in or -1 if inventory is full
 int PlayerInventory::AddItemToPlayer(const item& inItem, const int& playerNo) {
 	if (IsInventoryFull(playerNo))
@@ -61,8 +73,7 @@ int PlayerInventory::AddItemToPlayer(const item& inItem, const int& playerNo) {
 #ifdef USEGL
 			if (!SceneManager::GetSceneManager()->IsInSingleplayer()) {
 				DebugNetworkedGame* game = reinterpret_cast<DebugNetworkedGame*>(SceneManager::GetSceneManager()->GetCurrentScene());
-				auto* localPlayer = game->GetLocalPlayer();
-				localPlayerId = localPlayer->GetPlayerID();
+				localPlayerId = game->GetLocalPlayerID();
 
 				//if it's server, inform clients
 				if (game->GetIsServer()) {
@@ -110,8 +121,7 @@ void PlayerInventory::RemoveItemFromPlayer(const int& playerNo, const int& invSl
 #ifdef USEGL
 	DebugNetworkedGame* game = reinterpret_cast<DebugNetworkedGame*>(SceneManager::GetSceneManager()->GetCurrentScene());
 	if (!SceneManager::GetSceneManager()->IsInSingleplayer()) {
-		const auto* localPlayer = game->GetLocalPlayer();
-		localPlayerId = localPlayer->GetPlayerID();
+		localPlayerId = game->GetLocalPlayerID();
 
 		const bool isServer = game->GetIsServer();
 		if (isServer) {
@@ -167,8 +177,7 @@ void PlayerInventory::UseItemInPlayerSlot(const int& playerNo, const int& invSlo
 #ifdef USEGL
 		if (!SceneManager::GetSceneManager()->IsInSingleplayer()) {
 			DebugNetworkedGame* game = reinterpret_cast<DebugNetworkedGame*>(SceneManager::GetSceneManager()->GetCurrentScene());
-			auto* localPlayer = game->GetLocalPlayer();
-			localPlayerId = localPlayer->GetPlayerID();
+			localPlayerId = game->GetLocalPlayerID();
 
 			//if it's server, inform clients
 			if (game->GetIsServer()) {
@@ -44,6 +44,8 @@ namespace InventoryBuffSystem
 		}
 
 		void Init();
+		//Slots the match numbers its players by, nothing past them is reset. Slots coming into use start empty.
+		void SetPlayerCount(int playerCount);
 		int AddItemToPlayer(const item &inItem, const int &playerNo);
 		int RemoveItemFromPlayer(const item& inItem, const int& playerNo);
 		void RemoveItemFromPlayer(const int& playerNo, const int& invSlot);
@@ -139,10 +141,11 @@ namespace InventoryBuffSystem
 
 		std::map<item, std::function<bool(int playerNo)>> mItemPreconditionsMet;
 
-		item mPlayerInventory[NCL::CSC8503::MAX_PLAYERS][MAX_INVENTORY_SLOTS];
-		int mItemUseCount[NCL::CSC8503::MAX_PLAYERS][MAX_INVENTORY_SLOTS];
+		item mPlayerInventory[NCL::CSC8503::MAX_PLAYER_SLOTS][MAX_INVENTORY_SLOTS];
+		int mPlayerCount = NCL::CSC8503::MAX_PLAYER_SLOTS;
+		int mItemUseCount[NCL::CSC8503::MAX_PLAYER_SLOTS][MAX_INVENTORY_SLOTS];
 		std::list<PlayerInventoryObserver*> mInventoryObserverList;
-		std::map < item ,bool[NCL::CSC8503::MAX_PLAYERS]> PlayerAbleToUseItem;
+		std::map < item ,bool[NCL::CSC8503::MAX_PLAYER_SLOTS]> PlayerAbleToUseItem;
 		void CreateItemPickup(item inItem, Maths::Vector3 Position) {}
 
 		void IncreaseUsageCount(const int& playerNo, const int& invSlot) {
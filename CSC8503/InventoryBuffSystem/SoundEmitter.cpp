@@ -29,7 +29,7 @@ void SoundEmitter::UpdateObject(float dt) {
 		NCL::Maths::Vector3 pos = GetTransform().GetPosition();
 		mLocationBasedSuspicionPTR->RemoveActiveLocationSusCause(LocationBasedSuspicion::continouousSound, pos);
 		this->SetActive(false);
-#ifdef USEGL
+#if defined(USEGL) && !defined(HEADLESS_SERVER)
 		this->GetSoundObject()->GetChannel()->setPaused(true);
 #endif
 	}
@@ -34,23 +34,31 @@
 #include "UISystem.h"
 #include "Assets.h"
 #include "Debug.h"
-#ifdef USEGL
+#if defined(USEGL) && !defined(HEADLESS_SERVER)
 #include "MiniMap.h"
 #endif
 #include <filesystem>
 #include <fstream>
 
 namespace {
-	constexpr int NETWORK_ID_BUFFER_START = 10;
+	//Player objects take their slot as network ID, so level objects start after the last one.
+	constexpr int NETWORK_ID_BUFFER_START = MAX_PLAYER_SLOTS;
+	constexpr float LEVEL_BOUNDS_MARGIN = 16.0f;
+	constexpr float LEVEL_BOUNDS_HEIGHT = 64.0f;
 }
 
 using namespace NCL::CSC8503;
 
 LevelManager* LevelManager::instance = nullptr;
+thread_local LevelManager* LevelManager::threadInstance = nullptr;
 
 LevelManager::LevelManager() {
 	mWorld = new GameWorld();
-#ifdef USEGL
+#ifdef HEADLESS_SERVER
+	mSoundManager = new NullSoundManager(mWorld);
+
+	mRenderer = new NullRenderer(*mWorld);
+#elif defined(USEGL)
 	std::thread loadSoundManager([this] {mSoundManager = new SoundManager(mWorld); });
 
 	mRenderer = new GameTechRenderer(*mWorld);
@@ -75,31 +83,44 @@ LevelManager::LevelManager() {
 	mDtSinceLastFixedUpdate = 0;
 
 	mActiveLevel = -1;
+	mTempPlayer = nullptr;
 
 	mGameState = MenuState;
 
 	mNetworkIdBuffer = NETWORK_ID_BUFFER_START;
 
 	mIsLevelInitialised = false;
-#ifdef USEGL
+#if defined(USEGL) && !defined(HEADLESS_SERVER)
 	loadSoundManager.join();
 
     InitialiseMiniMap();
 #endif
 }
 
-LevelManager::~LevelManager() {
-	mInventoryBuffSystemClassPtr->GetPlayerInventoryPtr()->Detach(this);
+LevelManager::LevelManager(const LevelManager& assetSource) : LevelManager() {
+	//Everything loaded from disk is read only once a level is running, so matches share it.
+	mLevelList = assetSource.mLevelList;
+	mRoomList = assetSource.mRoomList;
+	mMeshes = assetSource.mMeshes;
+	mTextures = assetSource.mTextures;
+	mShaders = assetSource.mShaders;
+	mMaterials = assetSource.mMaterials;
+	mAnimations = assetSource.mAnimations;
+	mMeshMaterials = assetSource.mMeshMaterials;
+	mPreAnimationList = assetSource.mPreAnimationList;
+	mOwnsAssets = false;
 
-	for (int i = 0; i < mRoomList.size(); i++) {
-		delete(mRoomList[i]);
-	}
-	mRoomList.clear();
+	InitialiseUITextures();
+	InitialiseIcons();
+	InitialiseDebug();
+	mAreAssetsInitialised = true;
+}
 
-	for (int i = 0; i < mLevelList.size(); i++) {
-		delete(mLevelList[i]);
+LevelManager::~LevelManager() {
+	if (mNavMeshThread.joinable()) {
+		mNavMeshThread.join();
 	}
-	mLevelList.clear();
+	mInventoryBuffSystemClassPtr->GetPlayerInventoryPtr()->Detach(this);
 
 	for (int i = 0; i < mLevelLayout.size(); i++) {
 		delete(mLevelLayout[i]);
@@ -111,35 +132,48 @@ LevelManager::~LevelManager() {
 	}
 	mUpdatableObjects.clear();
 
-	for (auto& mesh : mMeshes) {
-		delete mesh.second;
-	}
-	mMeshes.clear();
+	if (mOwnsAssets) {
+		for (int i = 0; i < mRoomList.size(); i++) {
+			delete(mRoomList[i]);
+		}
 
-	for (auto& texture : mTextures) {
-		delete texture.second;
-	}
-	mTextures.clear();
+		for (int i = 0; i < mLevelList.size(); i++) {
+			delete(mLevelList[i]);
+		}
 
-	for (auto& shader : mShaders) {
-		delete shader.second;
-	}
-	mShaders.clear();
+		for (auto& mesh : mMeshes) {
+			delete mesh.second;
+		}
 
-	for (auto& material : mMaterials) {
-		delete material.second;
-	}
-	mMaterials.clear();
+		for (auto& texture : mTextures) {
+			delete texture.second;
+		}
+
+		for (auto& shader : mShaders) {
+			delete shader.second;
+		}
+
+		for (auto& material : mMaterials) {
+			delete material.second;
+		}
 
-	for (auto& animation : mAnimations) {
-		delete animation.second;
+		for (auto& animation : mAnimations) {
+			delete animation.second;
+		}
 	}
+	mRoomList.clear();
+	mLevelList.clear();
+	mMeshes.clear();
+	mTextures.clear();
+	mShaders.clear();
+	mMaterials.clear();
 	mAnimations.clear();
 
 	delete mTempPlayer;
 	delete mUi;
 
 	delete mPhysics;
+	delete mBuilder;
 	delete mRenderer;
 	delete mWorld;
 
@@ -149,8 +183,7 @@ LevelManager::~LevelManager() {
 #endif
 	delete mInventoryBuffSystemClassPtr;
 	delete mSuspicionSystemClassPtr;
-#ifdef USEGL
-	delete mSoundManager;
+#if defined(USEGL) && !defined(HEADLESS_SERVER)
 	delete mMiniMap;
 #endif
 }
@@ -174,6 +207,8 @@ void LevelManager::ClearLevel() {
 	if(mTempPlayer)mTempPlayer->ResetPlayerPoints();
 	mGuardObjects.clear();
 	mCCTVTransformList.clear();
+	//every level starts from the same ID so server and client hand out matching IDs
+	mNetworkIdBuffer = NETWORK_ID_BUFFER_START;
 
 	ResetEquippedIconTexture();
 }
@@ -204,12 +239,19 @@ void LevelManager::InitialiseGameAssets() {
 }
 
 LevelManager* LevelManager::GetLevelManager() {
+	if (threadInstance != nullptr) {
+		return threadInstance;
+	}
 	if (instance == nullptr) {
 		instance = new LevelManager();
 	}
 	return instance;
 }
 
+void LevelManager::BindToThread(LevelManager* levelManager) {
+	threadInstance = levelManager;
+}
+
 void LevelManager::ResetLevel() {
 	if (mActiveLevel > -1) {
 		mTempPlayer->GetTransform().SetPosition((*mLevelList[mActiveLevel]).GetPlayerStartTransform(0).GetPosition())
@@ -264,6 +306,8 @@ void LevelManager::LoadLevel(int levelID, std::mt19937 seed, int playerID, bool
 		}
 	}
 	mNavMeshThread = std::thread([this] {
+		//the builder looks the level manager up, which has to find this one and not the shared one
+		BindToThread(this);
 		mBuilder->BuildNavMesh(mLevelLayout);
 		LoadDoorsInNavGrid();
 		std::cout << "Nav Mesh Set\n";
@@ -307,7 +351,7 @@ void LevelManager::LoadLevel(int levelID, std::mt19937 seed, int playerID, bool
 }
 
 void LevelManager::SendWallFloorInstancesToGPU() {
-#ifdef USEGL
+#if defined(USEGL) && !defined(HEADLESS_SERVER)
 	for (const auto& [key, val] : mInstanceMatrices) {
 		OGLMesh* instance = (OGLMesh*)mMeshes[key];
 		instance->SetInstanceMatrices(val);
@@ -317,6 +361,23 @@ void LevelManager::SendWallFloorInstancesToGPU() {
 #endif
 }
 
+void LevelManager::GetLevelBounds(Vector3& boundsMin, Vector3& boundsMax) const {
+	if (mLevelLayout.empty()) {
+		boundsMin = Vector3(0, 0, 0);
+		boundsMax = Vector3(0, 0, 0);
+		return;
+	}
+	boundsMin = mLevelLayout[0]->GetTransform().GetPosition();
+	boundsMax = boundsMin;
+	for (GameObject* layoutObject : mLevelLayout) {
+		const Vector3& position = layoutObject->GetTransform().GetPosition();
+		boundsMin = Vector3(std::min(boundsMin.x, position.x), std::min(boundsMin.y, position.y), std::min(boundsMin.z, position.z));
+		boundsMax = Vector3(std::max(boundsMax.x, position.x), std::max(boundsMax.y, position.y), std::max(boundsMax.z, position.z));
+	}
+	boundsMin -= Vector3(LEVEL_BOUNDS_MARGIN, LEVEL_BOUNDS_MARGIN, LEVEL_BOUNDS_MARGIN);
+	boundsMax += Vector3(LEVEL_BOUNDS_MARGIN, LEVEL_BOUNDS_HEIGHT, LEVEL_BOUNDS_MARGIN);
+}
+
 void LevelManager::AddNetworkObject(GameObject& objToAdd) {
 #ifdef USEGL
 	auto* networkObj = new NetworkObject(objToAdd, mNetworkIdBuffer);
@@ -345,7 +406,7 @@ void LevelManager::Update(float dt, bool isPlayingLevel, bool isPaused) {
 	if (isPlayingLevel) {
 		mGameState = LevelState;
 		if (mStartTimer > 0) {
-			if (mStartTimer == 5) {
+			if (mStartTimer == 5 && mTempPlayer) {
 				mTempPlayer->UpdateObject(dt);
 			}
 			mStartTimer -= dt;
@@ -420,7 +481,7 @@ void NCL::CSC8503::LevelManager::DebugUpdate(float dt, bool isPlayingLevel, bool
 	if (isPlayingLevel) {
 		mGameState = LevelState;
 		if (mStartTimer > 0) {
-			if (mStartTimer == 5) {
+			if (mStartTimer == 5 && mTempPlayer) {
 				mTempPlayer->UpdateObject(dt);
 			}
 			mStartTimer -= dt;
@@ -628,21 +689,7 @@ void LevelManager::InitialiseAssets() {
 	mPreAnimationList.insert(std::make_pair("PlayerWalk", mAnimations["PlayerWalk"]));
 	mPreAnimationList.insert(std::make_pair("PlayerSprint", mAnimations["PlayerSprint"]));
 
-	//icons
-	vector<Texture*> keyTexVec = {
-		{mTextures["KeyIcon1"]},
-		{mTextures["KeyIcon2"]},
-		{mTextures["KeyIcon3"]}
-	};
-
-	vector<Texture*> susTexVec = {
-		{mTextures["LowSusBar"]},
-		{mTextures["MidSusBar"]},
-		{mTextures["HighSusBar"]}
-	};
-
-	mUi->SetTextureVector("key", keyTexVec);
-	mUi->SetTextureVector("bar", susTexVec);
+	InitialiseUITextures();
 
 	matLoadThread.join();
 	/*for (auto const& [key, val] : mMaterials) {
@@ -1000,6 +1047,13 @@ void LevelManager::SetPlayersForGuards() const {
 #endif
 }
 
+void LevelManager::AddPlayerMidMatch(PlayerObject& player) const {
+	for (GuardObject* guard : mGuardObjects) {
+		guard->AddPlayer(&player);
+	}
+	mAnimation->AddPlayerObject(&player);
+}
+
 void LevelManager::InitAnimationSystemObjects() const {
 	mAnimation->SetGameObjectLists(mUpdatableObjects);
 }
@@ -1075,6 +1129,23 @@ PrisonDoor* LevelManager::GetPrisonDoor() const {
 	return mPrisonDoor;
 }
 
+void LevelManager::InitialiseUITextures() {
+	vector<Texture*> keyTexVec = {
+		{mTextures["KeyIcon1"]},
+		{mTextures["KeyIcon2"]},
+		{mTextures["KeyIcon3"]}
+	};
+
+	vector<Texture*> susTexVec = {
+		{mTextures["LowSusBar"]},
+		{mTextures["MidSusBar"]},
+		{mTextures["HighSusBar"]}
+	};
+
+	mUi->SetTextureVector("key", keyTexVec);
+	mUi->SetTextureVector("bar", susTexVec);
+}
+
 void LevelManager::InitialiseIcons() {
 	//Inventory
 	UISystem::Icon* mInventoryIcon1 = mUi->AddIcon(Vector2(45, 90), 4.5, 8, mTextures["InventorySlot"]);
@@ -1144,7 +1215,7 @@ void LevelManager::InitialiseIcons() {
 }
 
 void LevelManager::InitialiseMiniMap() {
-#ifdef USEGL
+#if defined(USEGL) && !defined(HEADLESS_SERVER)
     mMiniMap = new MiniMap(mRenderer);
 #endif
 }
@@ -1548,7 +1619,7 @@ PlayerObject* LevelManager::AddPlayerToWorld(const Transform& transform, const s
 	CreatePlayerObjectComponents(*mTempPlayer, transform);
 	mWorld->GetMainCamera().SetYaw(transform.GetOrientation().ToEuler().y);
 
-#ifdef USEGL
+#if defined(USEGL) && !defined(HEADLESS_SERVER)
     mInventoryBuffSystemClassPtr->GetPlayerBuffsPtr()->Attach(mMiniMap);
 #endif
 
@@ -1733,12 +1804,20 @@ SuspicionSystemClass* NCL::CSC8503::LevelManager::GetSuspicionSystem() {
 	return mSuspicionSystemClassPtr;
 }
 
+void NCL::CSC8503::LevelManager::SetPlayerSlotCount(int playerSlotCount) {
+	mInventoryBuffSystemClassPtr->SetPlayerCount(playerSlotCount);
+	mSuspicionSystemClassPtr->SetPlayerCount(playerSlotCount);
+}
+
 void LevelManager::UpdateInventoryObserver(InventoryEvent invEvent, int playerNo, int invSlot, bool isItemRemoved) {
 	switch (invEvent)
 	{
 	case soundEmitterUsed:
-		AddSoundEmitterToWorld(mTempPlayer->GetTransform().GetPosition(),
-			mSuspicionSystemClassPtr->GetLocationBasedSuspicion());
+		//a dedicated server has no player of its own to drop it at
+		if (mTempPlayer) {
+			AddSoundEmitterToWorld(mTempPlayer->GetTransform().GetPosition(),
+				mSuspicionSystemClassPtr->GetLocationBasedSuspicion());
+		}
 		break;
 	default:
 		break;
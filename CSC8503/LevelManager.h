@@ -1,6 +1,9 @@
 #pragma once
 #include "Level.h"
-#ifdef USEGL
+#ifdef HEADLESS_SERVER
+#include "NullRenderer.h"
+#include "NullSoundManager.h"
+#elif defined(USEGL)
 #include "GameTechRenderer.h"
 #endif
 #ifdef USEPROSPERO
@@ -12,7 +15,9 @@
 #include "InventoryBuffSystem/InventoryBuffSystem.h"
 #include "InventoryBuffSystem/PlayerInventory.h"
 #include "SuspicionSystem/SuspicionSystem.h"
+#ifndef HEADLESS_SERVER
 #include "SoundManager.h"
+#endif
 #include <thread>
 
 using namespace NCL::Maths;
@@ -61,7 +66,10 @@ namespace NCL {
 
 		class LevelManager : public PlayerInventoryObserver {
 		public:
+			//Returns the level manager bound to the calling thread, or the shared one if none is.
 			static LevelManager* GetLevelManager();
+			//A server hosting several matches binds each match's level manager to the thread ticking it.
+			static void BindToThread(LevelManager* levelManager);
 			void ResetLevel();
 			void ClearLevel();
 			void InitialiseGameAssets();
@@ -70,6 +78,9 @@ namespace NCL {
 			std::vector<Room*> GetRooms() { return mRoomList; }
 			Level* GetActiveLevel() const { return mLevelList[mActiveLevel]; }
 
+			//Box around the loaded level layout, padded for objects that leave the floor.
+			void GetLevelBounds(Vector3& boundsMin, Vector3& boundsMax) const;
+
 			Vector3 GetPlayerStartPosition(int player) const { return (*mLevelList[mActiveLevel]).GetPlayerStartTransform(player).GetPosition(); }
 			void LoadLevel(int levelID, std::mt19937 seed, int playerID,  bool isMultiplayer = false);
 			PlayerObject* GetTempPlayer() { return mTempPlayer; }
@@ -89,8 +100,13 @@ namespace NCL {
 
 			SuspicionSystemClass* GetSuspicionSystem();
 
+			//Player slots the inventory, buff and suspicion systems keep, their per tick work only covers these.
+			void SetPlayerSlotCount(int playerSlotCount);
+
 			UISystem* GetUiSystem() { return mUi; };
-#ifdef USEGL
+#ifdef HEADLESS_SERVER
+			NullSoundManager* GetSoundManager() { return mSoundManager; };
+#elif defined(USEGL)
 			SoundManager* GetSoundManager() { return mSoundManager; };
 #endif
 			AnimationSystem* GetAnimationSystem() { return mAnimation; }
@@ -137,6 +153,9 @@ namespace NCL {
 
 			void SetPlayersForGuards() const;
 
+			//Guards and animations only take in players at level start, a player joining later is added here.
+			void AddPlayerMidMatch(PlayerObject& player) const;
+
 			void InitAnimationSystemObjects() const;
 
 			PlayerObject* GetNearestPlayer(const Vector3& startPos) const;
@@ -154,10 +173,15 @@ namespace NCL {
 
 			PointGameObject* AddPointObjectToWorld(const Vector3& position, int pointsWorth = 5, float initCooldown = 10);
 		protected:
+			friend class MatchInstance;
+
 			LevelManager();
+			//Match instance that borrows the already loaded assets, levels and rooms of assetSource.
+			LevelManager(const LevelManager& assetSource);
 			~LevelManager();
 
 			static LevelManager* instance;
+			static thread_local LevelManager* threadInstance;
 
 			virtual void InitialiseAssets();
 
@@ -169,6 +193,8 @@ namespace NCL {
 
 			void InitialiseIcons();
 
+			void InitialiseUITextures();
+
             void InitialiseMiniMap();
 
 			void LoadMap(const std::unordered_map<Transform, TileType>& tileMap, const Vector3& startPosition, int rotation = 0);
@@ -227,7 +253,9 @@ namespace NCL {
 
 			RecastBuilder* mBuilder;
 
-#ifdef USEGL
+#ifdef HEADLESS_SERVER
+			NullRenderer* mRenderer;
+#elif defined(USEGL)
 			GameTechRenderer* mRenderer;
 #endif
 
@@ -240,7 +268,11 @@ namespace NCL {
 
 			AnimationSystem* mAnimation;
 
+#ifdef HEADLESS_SERVER
+			NullSoundManager* mSoundManager;
+#else
 			SoundManager* mSoundManager;
+#endif
 
 			vector<GameObject*> mUpdatableObjects;
 
@@ -254,7 +286,7 @@ namespace NCL {
 			std::vector<std::string> mShadersToLoad;
 
 			UISystem* mUi;
-#ifdef USEGL
+#if defined(USEGL) && !defined(HEADLESS_SERVER)
             MiniMap* mMiniMap;
 #endif
 			FlagGameObject* mMainFlag;
@@ -287,6 +319,8 @@ namespace NCL {
 
 			bool mIsLevelInitialised;
 			bool mAreAssetsInitialised = false;
+			//False for match instances, the assets belong to the level manager they were borrowed from.
+			bool mOwnsAssets = true;
 #ifdef USEGL
 			bool mShowDebug = false;
 			bool mShowVolumes = false;
@@ -0,0 +1,200 @@
+#include "Assets.h"
+#include "CookedLevel.h"
+#include "JsonParser.h"
+#include "LevelReader.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr int DEFAULT_ITERATIONS = 20;
+}
+
+struct LevelFile {
+    std::string path;
+    std::string name;
+    bool isRoom = false;
+    size_t size = 0;
+};
+
+std::vector<LevelFile> FindLevelFiles() {
+    std::vector<LevelFile> files;
+    for (const char* folder : { "Levels", "Rooms" }) {
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(Assets::LEVELDIR + folder)) {
+            if (entry.path().extension() != ".json") {
+                continue;
+            }
+            LevelFile file;
+            file.path = entry.path().string();
+            file.name = entry.path().filename().string();
+            file.isRoom = strcmp(folder, "Rooms") == 0;
+            file.size = (size_t)entry.file_size();
+            files.push_back(file);
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const LevelFile& a, const LevelFile& b) { return a.path < b.path; });
+    return files;
+}
+
+//The way Level and Room loaded before LevelReader, kept as the reference it has to match.
+void ParseWithJsonParser(const std::string& path, Level* level, Room* room) {
+    std::ifstream file(path);
+    std::string line;
+    getline(file, line);
+    JsonParser parser = JsonParser();
+    parser.ParseJson(line, level, room);
+}
+
+//Average milliseconds to load the file into an empty level or room, reading it from disk each time.
+template <typename Load>
+double TimeLoad(const LevelFile& file, int iterations, Load&& load) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        if (file.isRoom) {
+            Room room;
+            load(file.path, nullptr, &room);
+        }
+        else {
+            Level level;
+            load(file.path, &level, nullptr);
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+void ReadWithLevelReader(const std::string& path, Level* level, Room* room) {
+    LevelReader reader;
+    reader.ReadFile(path, level, room);
+}
+
+//False if the cooked copy is missing or stale.
+bool LoadCooked(const std::string& path, Level* level, Room* room) {
+    return CookedLevel::Load(path, level, room);
+}
+
+bool IsCooked(const LevelFile& file) {
+    if (file.isRoom) {
+        Room room;
+        return LoadCooked(file.path, nullptr, &room);
+    }
+    Level level;
+    return LoadCooked(file.path, &level, nullptr);
+}
+
+//Whether load fills the same level or room as the loader before it.
+template <typename Load>
+bool LoadsMatch(const LevelFile& file, void (*loadExpected)(const std::string&, Level*, Room*), Load&& load) {
+    if (file.isRoom) {
+        Room expected;
+        Room actual;
+        loadExpected(file.path, nullptr, &expected);
+        return load(file.path, nullptr, &actual) && CookedLevel::IsSameRoom(expected, actual);
+    }
+    Level expected;
+    Level actual;
+    loadExpected(file.path, &expected, nullptr);
+    return load(file.path, &actual, nullptr) && CookedLevel::IsSameLevel(expected, actual);
+}
+
+int RunBenchmark(int iterations) {
+    const std::vector<LevelFile> files = FindLevelFiles();
+    if (files.empty()) {
+        std::cout << "No level files in " << Assets::LEVELDIR << "\n";
+        return 1;
+    }
+
+    double jsonParserTotal = 0.0;
+    double levelReaderTotal = 0.0;
+    double cookedTotal = 0.0;
+    size_t bytesTotal = 0;
+    int cookedCount = 0;
+    int mismatchCount = 0;
+    for (const LevelFile& file : files) {
+        const double jsonParserMs = TimeLoad(file, iterations, ParseWithJsonParser);
+        const double levelReaderMs = TimeLoad(file, iterations, ReadWithLevelReader);
+        const bool isMatch = LoadsMatch(file, ParseWithJsonParser, [](const std::string& path, Level* level, Room* room) {
+            LevelReader reader;
+            return reader.ReadFile(path, level, room);
+        });
+        if (!isMatch) {
+            mismatchCount++;
+        }
+        jsonParserTotal += jsonParserMs;
+        levelReaderTotal += levelReaderMs;
+        bytesTotal += file.size;
+
+        std::cout << file.name << " bytes " << file.size << " json_parser_ms " << jsonParserMs << " level_reader_ms " << levelReaderMs
+            << " speedup " << jsonParserMs / std::max(levelReaderMs, 1e-9) << " match " << (isMatch ? 1 : 0);
+        //only files with a fresh cooked copy, the rest would time the fallback to JSON
+        if (IsCooked(file)) {
+            const double cookedMs = TimeLoad(file, iterations, LoadCooked);
+            cookedTotal += cookedMs;
+            cookedCount++;
+            std::cout << " cooked_ms " << cookedMs;
+        }
+        std::cout << "\n";
+    }
+    std::cout << "files " << files.size() << "\n";
+    std::cout << "bytes " << bytesTotal << "\n";
+    std::cout << "json_parser_ms " << jsonParserTotal << "\n";
+    std::cout << "level_reader_ms " << levelReaderTotal << "\n";
+    std::cout << "speedup " << jsonParserTotal / std::max(levelReaderTotal, 1e-9) << "\n";
+    std::cout << "level_reader_mb_per_s " << bytesTotal / 1e6 / std::max(levelReaderTotal / 1000.0, 1e-9) << "\n";
+    if (cookedCount > 0) {
+        std::cout << "cooked_files " << cookedCount << "\n";
+        std::cout << "cooked_ms " << cookedTotal << "\n";
+    }
+    std::cout << "mismatches " << mismatchCount << "\n";
+    return mismatchCount > 0 ? 1 : 0;
+}
+
+//Cooks every level and room, then checks each cooked copy loads back the same as its JSON.
+int RunCook() {
+    const std::vector<LevelFile> files = FindLevelFiles();
+    if (files.empty()) {
+        std::cout << "No level files in " << Assets::LEVELDIR << "\n";
+        return 1;
+    }
+    int failedCount = 0;
+    for (const LevelFile& file : files) {
+        const bool isCooked = CookedLevel::Cook(file.path, file.isRoom);
+        const bool isMatch = isCooked && LoadsMatch(file, ReadWithLevelReader, LoadCooked);
+        if (!isMatch) {
+            failedCount++;
+        }
+        const std::string cookedPath = CookedLevel::GetCookedPath(file.path);
+        std::cout << file.name << " cooked_bytes " << (isCooked ? std::filesystem::file_size(cookedPath) : 0) << " match " << (isMatch ? 1 : 0) << "\n";
+    }
+    std::cout << "failures " << failedCount << "\n";
+    return failedCount > 0 ? 1 : 0;
+}
+
+int RunLevelTool(int argc, char** argv) {
+    if (argc < 2 || (strcmp(argv[1], "bench") != 0 && strcmp(argv[1], "cook") != 0)) {
+        std::cout << "Usage: bench [--iterations n]\n";
+        std::cout << "       cook\n";
+        return 1;
+    }
+    if (strcmp(argv[1], "cook") == 0) {
+        return RunCook();
+    }
+
+    int iterations = DEFAULT_ITERATIONS;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::max(1, atoi(argv[++i]));
+        }
+    }
+    return RunBenchmark(iterations);
+}
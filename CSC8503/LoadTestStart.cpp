@@ -0,0 +1,545 @@
+#include "../NCLCoreClasses/Window.h"
+
+#include "BotClient.h"
+#include "LoopbackTransport.h"
+#include "MatchHost.h"
+#include "PhysicsSystem.h"
+#include "SceneManager.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+namespace {
+    constexpr int DEFAULT_BOT_COUNT = 30;
+    constexpr int DEFAULT_PLAYERS_PER_MATCH = 3;
+    constexpr float DEFAULT_DURATION = 60.0f;
+    constexpr float DEFAULT_INPUT_RATE = 30.0f;
+    constexpr float DEFAULT_CONNECT_RATE = 20.0f;
+    constexpr int DEFAULT_TICK_RATE = 60;
+    constexpr float DEFAULT_TOLERANCE = 0.1f;
+    //Late joiners connect this far into the run unless told otherwise.
+    constexpr float DEFAULT_LATE_JOIN_SHARE = 0.5f;
+
+    //How often the bots service their connections, well above any input or snapshot rate.
+    constexpr float BOT_UPDATE_RATE = 500.0f;
+}
+
+struct LoadTestArgs {
+    int botCount = DEFAULT_BOT_COUNT;
+    int playersPerMatch = DEFAULT_PLAYERS_PER_MATCH;
+    //Extra bots that connect once the matches are under way, each match gets room for its share of them.
+    int lateJoinerCount = 0;
+    //-1 for DEFAULT_LATE_JOIN_SHARE of the duration.
+    float lateJoinTime = -1.0f;
+    float duration = DEFAULT_DURATION;
+    float inputRate = DEFAULT_INPUT_RATE;
+    float connectRate = DEFAULT_CONNECT_RATE;
+    int tickRate = DEFAULT_TICK_RATE;
+    //-1 picks one per core, as the server does.
+    int workerCount = -1;
+    unsigned int seed = 1;
+    std::string scriptPath;
+    //Empty hosts the server in this process, otherwise the bots connect to this IPv4 address.
+    std::string serverAddress;
+    //Runs bots and server over a simulated network instead of sockets.
+    bool isLoopback = false;
+    //Steps the server, bots and simulated network together on this thread by simulated time, so a run with the
+    //same seed sends the same packets. Needs --loopback.
+    bool isFixedStep = false;
+    //Runs twice with fixed steps and fails if the two reports differ.
+    bool isRepeatCheck = false;
+    NetworkConditions conditions;
+    std::string reportPath;
+    std::string baselinePath;
+    float tolerance = DEFAULT_TOLERANCE;
+};
+
+LoadTestArgs ParseLoadTestArgs(int argc, char** argv) {
+    LoadTestArgs args;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--bots") == 0 && hasValue) {
+            args.botCount = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--players") == 0 && hasValue) {
+            args.playersPerMatch = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--late-joiners") == 0 && hasValue) {
+            args.lateJoinerCount = std::max(0, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--late-join-time") == 0 && hasValue) {
+            args.lateJoinTime = std::max(0.0f, (float)atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--duration") == 0 && hasValue) {
+            args.duration = std::max(1.0f, (float)atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--input-rate") == 0 && hasValue) {
+            args.inputRate = std::max(1.0f, (float)atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--connect-rate") == 0 && hasValue) {
+            args.connectRate = std::max(1.0f, (float)atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--tick-rate") == 0 && hasValue) {
+            args.tickRate = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--workers") == 0 && hasValue) {
+            args.workerCount = std::max(0, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            args.seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--script") == 0 && hasValue) {
+            args.scriptPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--server") == 0 && hasValue) {
+            args.serverAddress = argv[++i];
+        }
+        else if (strcmp(argv[i], "--loopback") == 0) {
+            args.isLoopback = true;
+        }
+        else if (strcmp(argv[i], "--fixed-step") == 0) {
+            args.isFixedStep = true;
+        }
+        else if (strcmp(argv[i], "--repeat-check") == 0) {
+            args.isFixedStep = true;
+            args.isRepeatCheck = true;
+        }
+        else if (strcmp(argv[i], "--latency") == 0 && hasValue) {
+            args.conditions.latencyMs = std::max(0.0f, (float)atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--jitter") == 0 && hasValue) {
+            args.conditions.jitterMs = std::max(0.0f, (float)atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--loss") == 0 && hasValue) {
+            args.conditions.lossRate = std::clamp((float)atof(argv[++i]), 0.0f, 1.0f);
+        }
+        else if (strcmp(argv[i], "--duplicate") == 0 && hasValue) {
+            args.conditions.duplicateRate = std::clamp((float)atof(argv[++i]), 0.0f, 1.0f);
+        }
+        else if (strcmp(argv[i], "--bandwidth") == 0 && hasValue) {
+            args.conditions.bytesPerSecond = std::max(0, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--report") == 0 && hasValue) {
+            args.reportPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            args.baselinePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--tolerance") == 0 && hasValue) {
+            args.tolerance = std::max(0.0f, (float)atof(argv[++i]));
+        }
+        else {
+            std::cout << "Unknown load test argument: " << argv[i] << "\n";
+        }
+    }
+    if (args.lateJoinTime < 0.0f) {
+        args.lateJoinTime = args.duration * DEFAULT_LATE_JOIN_SHARE;
+    }
+    return args;
+}
+
+bool ParseAddress(const std::string& text, uint8_t address[4]) {
+    int parts[4];
+    char dot[3];
+    std::istringstream stream(text);
+    if (!(stream >> parts[0] >> dot[0] >> parts[1] >> dot[1] >> parts[2] >> dot[2] >> parts[3])) {
+        return false;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (parts[i] < 0 || parts[i] > 255 || (i < 3 && dot[i] != '.')) {
+            return false;
+        }
+        address[i] = (uint8_t)parts[i];
+    }
+    return true;
+}
+
+float GetAverage(const std::vector<float>& values) {
+    if (values.empty()) {
+        return 0.0f;
+    }
+    double total = 0.0;
+    for (float value : values) {
+        total += value;
+    }
+    return (float)(total / values.size());
+}
+
+//Sorts values in place.
+float GetPercentile(std::vector<float>& values, float percentile) {
+    if (values.empty()) {
+        return 0.0f;
+    }
+    std::sort(values.begin(), values.end());
+    const int index = std::min((int)values.size() - 1, (int)(percentile * values.size()));
+    return values[index];
+}
+
+float GetMax(const std::vector<float>& values) {
+    return values.empty() ? 0.0f : *std::max_element(values.begin(), values.end());
+}
+
+//One number in the report, and which way it has to move to count as a regression.
+struct LoadTestMetric {
+    std::string name;
+    float value = 0.0f;
+    bool isHigherWorse = true;
+};
+
+std::vector<LoadTestMetric> BuildReport(const std::vector<BotClient*>& bots, std::vector<float>& tickTimesMs, int maxMatches, bool hasLateJoiners) {
+    std::vector<float> bytesPerSecond;
+    std::vector<float> snapshotsPerSecond;
+    std::vector<float> jitters;
+    std::vector<float> rtts;
+    std::vector<float> joinTimes;
+    std::vector<float> joinBytes;
+    int connectedCount = 0;
+    int startedCount = 0;
+    for (const BotClient* bot : bots) {
+        const BotStats& stats = bot->GetStats();
+        if (stats.connectedTime <= 0.0f) {
+            continue;
+        }
+        connectedCount++;
+        startedCount += stats.isGameStarted ? 1 : 0;
+        bytesPerSecond.push_back(stats.bytesReceived / stats.connectedTime);
+        snapshotsPerSecond.push_back(stats.snapshotsReceived / stats.connectedTime);
+        if (stats.snapshotsReceived > 1) {
+            jitters.push_back(stats.jitterMs);
+        }
+        for (int rtt : stats.rttSamplesMs) {
+            rtts.push_back((float)rtt);
+        }
+        if (stats.joinTimeMs >= 0.0f) {
+            joinTimes.push_back(stats.joinTimeMs);
+            joinBytes.push_back((float)stats.joinBytesReceived);
+        }
+    }
+
+    std::vector<LoadTestMetric> report;
+    report.push_back({ "bots_connected", (float)connectedCount, false });
+    report.push_back({ "bots_in_game", (float)startedCount, false });
+    //An external server has no tick times to report.
+    if (!tickTimesMs.empty()) {
+        report.push_back({ "matches_max", (float)maxMatches, false });
+        report.push_back({ "tick_ms_avg", GetAverage(tickTimesMs) });
+        report.push_back({ "tick_ms_p95", GetPercentile(tickTimesMs, 0.95f) });
+        report.push_back({ "tick_ms_max", GetMax(tickTimesMs) });
+    }
+    report.push_back({ "bytes_per_sec_per_bot_avg", GetAverage(bytesPerSecond) });
+    report.push_back({ "bytes_per_sec_per_bot_max", GetMax(bytesPerSecond) });
+    report.push_back({ "snapshots_per_sec_per_bot_avg", GetAverage(snapshotsPerSecond), false });
+    report.push_back({ "rtt_ms_avg", GetAverage(rtts) });
+    report.push_back({ "rtt_ms_p95", GetPercentile(rtts, 0.95f) });
+    report.push_back({ "jitter_ms_avg", GetAverage(jitters) });
+    report.push_back({ "jitter_ms_p95", GetPercentile(jitters, 0.95f) });
+    if (hasLateJoiners) {
+        report.push_back({ "late_joins", (float)joinTimes.size(), false });
+        report.push_back({ "join_ms_avg", GetAverage(joinTimes) });
+        report.push_back({ "join_ms_max", GetMax(joinTimes) });
+        report.push_back({ "join_bytes_avg", GetAverage(joinBytes) });
+    }
+    return report;
+}
+
+void WriteReport(std::ostream& stream, const std::vector<LoadTestMetric>& report) {
+    for (const LoadTestMetric& metric : report) {
+        stream << metric.name << " " << metric.value << "\n";
+    }
+}
+
+//Wall clock timings, which no two runs share.
+bool IsTimingMetric(const LoadTestMetric& metric) {
+    return metric.name.starts_with("tick_ms_");
+}
+
+//Returns how many metrics differ between two runs of the same seed.
+int CompareRuns(const std::vector<LoadTestMetric>& first, const std::vector<LoadTestMetric>& second) {
+    int mismatchCount = first.size() == second.size() ? 0 : 1;
+    for (int i = 0; i < (int)std::min(first.size(), second.size()); i++) {
+        if (IsTimingMetric(first[i]) || (first[i].name == second[i].name && first[i].value == second[i].value)) {
+            continue;
+        }
+        std::cout << "MISMATCH " << first[i].name << ": " << first[i].value << " then " << second[i].name << " " << second[i].value << "\n";
+        mismatchCount++;
+    }
+    return mismatchCount;
+}
+
+//Returns how many metrics moved the wrong way by more than the tolerance.
+int CompareWithBaseline(const std::string& baselinePath, const std::vector<LoadTestMetric>& report, float tolerance) {
+    std::ifstream file(baselinePath);
+    if (!file) {
+        std::cout << "Baseline " << baselinePath << " could not be opened\n";
+        return 1;
+    }
+    std::map<std::string, float> baseline;
+    std::string name;
+    float value;
+    while (file >> name >> value) {
+        baseline[name] = value;
+    }
+
+    int regressionCount = 0;
+    for (const LoadTestMetric& metric : report) {
+        auto it = baseline.find(metric.name);
+        if (it == baseline.end()) {
+            continue;
+        }
+        const float limit = metric.isHigherWorse ? it->second * (1.0f + tolerance) : it->second * (1.0f - tolerance);
+        const bool isRegression = metric.isHigherWorse ? metric.value > limit : metric.value < limit;
+        if (isRegression) {
+            std::cout << "REGRESSION " << metric.name << ": " << metric.value << " against baseline " << it->second << "\n";
+            regressionCount++;
+        }
+    }
+    return regressionCount;
+}
+
+//Runs the bots for the duration and reports on them. Returns false if the in-process server could not start.
+bool RunBots(const LoadTestArgs& args, const BotScript& script, const uint8_t address[4], Window* w, std::vector<LoadTestMetric>& report) {
+    const bool isServerHosted = args.serverAddress.empty();
+
+    //Must be in place before the first host is made.
+    LoopbackTransport* loopback = nullptr;
+    if (args.isLoopback) {
+        loopback = new LoopbackTransport(args.seed, args.conditions);
+        loopback->SetAllowsNetworkThreads(!args.isFixedStep);
+        NetworkBase::SetTransport(loopback);
+    }
+
+    //The server ticks on its own thread like a real one would, the bots share this one. With fixed steps
+    //the server ticks here between bot updates instead.
+    std::vector<float> tickTimesMs;
+    std::atomic<bool> isServerRunning = true;
+    std::atomic<bool> isServerReady = false;
+    std::atomic<bool> hasServerFailed = false;
+    int maxMatches = 0;
+    std::thread serverThread;
+    MatchHost* steppedHost = nullptr;
+    const float tickDt = 1.0f / args.tickRate;
+    const auto tickServer = [&](MatchHost& matchHost) {
+        const auto tickStart = std::chrono::steady_clock::now();
+        matchHost.Update(tickDt);
+        const std::chrono::duration<float, std::milli> tickTime = std::chrono::steady_clock::now() - tickStart;
+        //matches only exist once their first bot has connected, idle ticks would flatter the average
+        if (matchHost.GetMatchCount() > 0) {
+            tickTimesMs.push_back(tickTime.count());
+        }
+        maxMatches = std::max(maxMatches, matchHost.GetMatchCount());
+    };
+    if (isServerHosted) {
+        SceneManager* sceneManager = SceneManager::GetSceneManager();
+        sceneManager->SetIsServer(true);
+
+        const int matchCount = (args.botCount + args.playersPerMatch - 1) / args.playersPerMatch;
+        const int maxPlayers = args.playersPerMatch + (args.lateJoinerCount + matchCount - 1) / matchCount;
+        int workerCount = args.workerCount;
+        if (workerCount < 0) {
+            //the bots keep one core busy
+            const int coreCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+            workerCount = std::min(matchCount, coreCount) - 1;
+        }
+
+        if (args.isFixedStep) {
+            //physics would otherwise drop iterations whenever a step happened to run long on the wall clock
+            PhysicsSystem::SetIsIterationRateAdaptive(false);
+            //matches on worker threads would still send in whatever order they finished
+            steppedHost = new MatchHost(matchCount, args.playersPerMatch, maxPlayers, 0);
+            steppedHost->SetLevelSeed(args.seed);
+            hasServerFailed = !steppedHost->Initialise();
+        }
+        else {
+            serverThread = std::thread([&, matchCount, maxPlayers, workerCount]() {
+                MatchHost matchHost(matchCount, args.playersPerMatch, maxPlayers, workerCount);
+                if (!matchHost.Initialise()) {
+                    hasServerFailed = true;
+                    return;
+                }
+                isServerReady = true;
+
+                const auto tickDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(tickDt));
+                auto nextTick = std::chrono::steady_clock::now();
+                while (isServerRunning) {
+                    tickServer(matchHost);
+
+                    nextTick += tickDuration;
+                    if (std::chrono::steady_clock::now() > nextTick) {
+                        nextTick = std::chrono::steady_clock::now();
+                    }
+                    std::this_thread::sleep_until(nextTick);
+                }
+            });
+
+            while (!isServerReady && !hasServerFailed) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        if (hasServerFailed) {
+            std::cout << "Server failed to start\n";
+            if (serverThread.joinable()) {
+                serverThread.join();
+            }
+            delete steppedHost;
+            PhysicsSystem::SetIsIterationRateAdaptive(true);
+            NetworkBase::SetTransport(nullptr);
+            delete loopback;
+            return false;
+        }
+    }
+    else {
+        NetworkBase::Initialise();
+    }
+
+    std::cout << "Running " << args.botCount << " bot(s) for " << args.duration << "s against "
+        << (isServerHosted ? "an in-process server" : args.serverAddress) << (args.isFixedStep ? " in fixed steps" : "") << "\n";
+
+    std::vector<BotClient*> bots;
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto botUpdateInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / BOT_UPDATE_RATE));
+    auto nextBotUpdate = startTime;
+    int stepCount = 0;
+    int serverTickCount = 0;
+    float time = 0.0f;
+    while (time < args.duration && w->UpdateWindow()) {
+        const float lastTime = time;
+        if (args.isFixedStep) {
+            //counted rather than summed, so rounding can't drift between runs of different lengths
+            time = ++stepCount / BOT_UPDATE_RATE;
+        }
+        else {
+            time = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+        }
+        //without fixed steps the simulated network follows the wall clock, so runs are not repeatable packet for packet
+        if (loopback) {
+            loopback->AdvanceTime(time - lastTime);
+        }
+        while (steppedHost && time >= serverTickCount * tickDt) {
+            tickServer(*steppedHost);
+            serverTickCount++;
+        }
+
+        //Bots join gradually, the way players would, rather than as one burst of handshakes.
+        int botsDue = std::min(args.botCount, 1 + (int)(time * args.connectRate));
+        //late joiners come once every match is under way, to be streamed its world
+        if (botsDue == args.botCount && time >= args.lateJoinTime) {
+            botsDue += std::min(args.lateJoinerCount, 1 + (int)((time - args.lateJoinTime) * args.connectRate));
+        }
+        while ((int)bots.size() < botsDue) {
+            const int botId = (int)bots.size();
+            BotClient* bot = new BotClient(botId, args.seed + botId, script.steps.empty() ? nullptr : &script);
+            if (!bot->Connect(address[0], address[1], address[2], address[3], NetworkBase::GetDefaultPort())) {
+                std::cout << "Bot " << botId << " could not start connecting\n";
+            }
+            bots.push_back(bot);
+        }
+
+        for (BotClient* bot : bots) {
+            bot->Update(time, args.inputRate);
+        }
+
+        if (!args.isFixedStep) {
+            nextBotUpdate += botUpdateInterval;
+            std::this_thread::sleep_until(nextBotUpdate);
+        }
+    }
+
+    for (BotClient* bot : bots) {
+        bot->Disconnect();
+    }
+    if (serverThread.joinable()) {
+        isServerRunning = false;
+        serverThread.join();
+    }
+    delete steppedHost;
+    PhysicsSystem::SetIsIterationRateAdaptive(true);
+
+    report = BuildReport(bots, tickTimesMs, maxMatches, args.lateJoinerCount > 0);
+    if (loopback) {
+        const LoopbackStats stats = loopback->GetStats();
+        report.push_back({ "sim_packets_sent", (float)stats.packetsSent, false });
+        report.push_back({ "sim_packets_lost", (float)stats.packetsLost });
+        report.push_back({ "sim_packets_over_bandwidth", (float)stats.packetsOverBandwidth });
+        report.push_back({ "sim_bytes_delivered", (float)stats.bytesDelivered, false });
+    }
+
+    for (BotClient* bot : bots) {
+        delete bot;
+    }
+    NetworkBase::SetTransport(nullptr);
+    delete loopback;
+    return true;
+}
+
+int RunLoadTest(int argc, char** argv) {
+    LoadTestArgs args = ParseLoadTestArgs(argc, argv);
+    const bool isServerHosted = args.serverAddress.empty();
+
+    uint8_t address[4] = { 127, 0, 0, 1 };
+    if (!isServerHosted && !ParseAddress(args.serverAddress, address)) {
+        std::cout << "Server address " << args.serverAddress << " is not an IPv4 address\n";
+        return 1;
+    }
+
+    if (args.isLoopback && !isServerHosted) {
+        std::cout << "A simulated network needs the server in this process, --loopback and --server can't be combined\n";
+        return 1;
+    }
+    if (args.isFixedStep && !args.isLoopback) {
+        std::cout << "Only a simulated network can be stepped, --fixed-step and --repeat-check need --loopback\n";
+        return 1;
+    }
+
+    BotScript script;
+    if (!args.scriptPath.empty() && !BotScript::LoadFromFile(args.scriptPath, script)) {
+        std::cout << "Bot script has no usable steps\n";
+        return 1;
+    }
+
+    Window* w = Window::CreateGameWindow("CSC8503 Load Test", 0, 0, false);
+
+    std::vector<LoadTestMetric> report;
+    if (!RunBots(args, script, address, w, report)) {
+        Window::DestroyGameWindow();
+        return 1;
+    }
+    WriteReport(std::cout, report);
+    if (!args.reportPath.empty()) {
+        std::ofstream reportFile(args.reportPath);
+        WriteReport(reportFile, report);
+    }
+
+    int mismatchCount = 0;
+    if (args.isRepeatCheck) {
+        std::vector<LoadTestMetric> repeatReport;
+        if (!RunBots(args, script, address, w, repeatReport)) {
+            Window::DestroyGameWindow();
+            return 1;
+        }
+        mismatchCount = CompareRuns(report, repeatReport);
+        std::cout << mismatchCount << " mismatch(es) running seed " << args.seed << " again\n";
+    }
+
+    int regressionCount = 0;
+    if (!args.baselinePath.empty()) {
+        regressionCount = CompareWithBaseline(args.baselinePath, report, args.tolerance);
+        std::cout << regressionCount << " regression(s) against " << args.baselinePath << "\n";
+    }
+
+    Window::DestroyGameWindow();
+
+    if (mismatchCount > 0) {
+        return 3;
+    }
+    return regressionCount > 0 ? 2 : 0;
+}
@@ -0,0 +1,227 @@
+#ifdef HEADLESS_SERVER
+#include "MatchHost.h"
+
+#include "DebugNetworkedGame.h"
+#include "GameServer.h"
+#include "LevelManager.h"
+#include "SceneManager.h"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	//Player peer IDs are replicated in 8 bits, so the shared host cannot hand out more than this.
+	constexpr int MAX_HOST_PEERS = 254;
+	constexpr uint32_t FIRST_SESSION_ID = 1;
+}
+
+MatchInstance::MatchInstance(uint32_t sessionId, int playersToStart, int maxPlayers, SessionHost& sessionHost) {
+	mSessionId = sessionId;
+	//an unbound thread still sees the level manager that loaded the assets
+	mLevelManager = new LevelManager(*LevelManager::GetLevelManager());
+
+	LevelManager::BindToThread(mLevelManager);
+	mGame = new DebugNetworkedGame();
+	BindToThread();
+	mGame->StartAsDedicatedServer(playersToStart, maxPlayers, sessionHost);
+	mLevelManager->SetGameState(GameStates::LevelState);
+	UnbindFromThread();
+}
+
+MatchInstance::~MatchInstance() {
+	BindToThread();
+	mGame->ClearNetworkGame();
+	delete mGame;
+	delete mLevelManager;
+	UnbindFromThread();
+}
+
+void MatchInstance::Update(float dt) {
+	BindToThread();
+	mGame->UpdateGame(dt);
+	UnbindFromThread();
+}
+
+void MatchInstance::SetLevelSeed(unsigned int levelSeed) {
+	mGame->SetServerLevelSeed(levelSeed);
+}
+
+GameServer* MatchInstance::GetServer() const {
+	return mGame->GetServer();
+}
+
+bool MatchInstance::GetIsOpen() const {
+	return !mGame->GetIsGameStarted() && !mGame->GetIsMatchOver();
+}
+
+bool MatchInstance::GetIsMatchOver() const {
+	return mGame->GetIsMatchOver();
+}
+
+void MatchInstance::BindToThread() {
+	LevelManager::BindToThread(mLevelManager);
+	SceneManager::BindSceneToThread(mGame);
+}
+
+void MatchInstance::UnbindFromThread() {
+	LevelManager::BindToThread(nullptr);
+	SceneManager::BindSceneToThread(nullptr);
+}
+
+MatchHost::MatchHost(int maxMatches, int playersToStart, int maxPlayers, int workerCount) :
+	mSessionHost(NetworkBase::GetDefaultPort(), MAX_HOST_PEERS), mTickBarrier(workerCount + 1) {
+	mMaxMatches = maxMatches;
+	mPlayersToStart = playersToStart;
+	mMaxPlayers = std::max(maxPlayers, playersToStart);
+	if (mMaxPlayers > DebugNetworkedGame::GetMaxDedicatedPlayers()) {
+		std::cout << "Match host: " << mMaxPlayers << " players won't fit in a match, capped at " << DebugNetworkedGame::GetMaxDedicatedPlayers() << "\n";
+		mMaxPlayers = DebugNetworkedGame::GetMaxDedicatedPlayers();
+		mPlayersToStart = std::min(mPlayersToStart, mMaxPlayers);
+	}
+	mNextSessionId = FIRST_SESSION_ID;
+	mLevelSeed = 0;
+	mHasLevelSeed = false;
+	mNextTickMatch = 0;
+	mTickDt = 0.0f;
+	mIsRunning = true;
+
+	mSessionHost.SetSessionResolver([this](uint32_t sessionId) { return ResolveSession(sessionId); });
+
+	for (int i = 0; i < workerCount; i++) {
+		mWorkers.emplace_back(&MatchHost::WorkerThread, this);
+	}
+}
+
+MatchHost::~MatchHost() {
+	mIsRunning = false;
+	if (!mWorkers.empty()) {
+		mTickBarrier.arrive_and_wait();
+	}
+	for (std::thread& worker : mWorkers) {
+		worker.join();
+	}
+
+	for (auto& [sessionId, match] : mMatches) {
+		delete match;
+	}
+	mMatches.clear();
+}
+
+bool MatchHost::Initialise() {
+	return mSessionHost.Initialise();
+}
+
+void MatchHost::Update(float dt) {
+	//Routing happens while no match is ticking, so matches are only created and removed on this thread.
+	mSessionHost.Update();
+
+	mTickMatches.clear();
+	for (auto& [sessionId, match] : mMatches) {
+		mTickMatches.push_back(match);
+	}
+	mTickDt = dt;
+	mNextTickMatch = 0;
+
+	if (!mWorkers.empty()) {
+		mTickBarrier.arrive_and_wait();
+	}
+	UpdateMatches();
+	if (!mWorkers.empty()) {
+		mTickBarrier.arrive_and_wait();
+	}
+
+	RemoveFinishedMatches();
+}
+
+void MatchHost::WorkerThread() {
+	while (true) {
+		mTickBarrier.arrive_and_wait();
+		if (!mIsRunning) {
+			return;
+		}
+		UpdateMatches();
+		mTickBarrier.arrive_and_wait();
+	}
+}
+
+void MatchHost::UpdateMatches() {
+	int matchIndex = mNextTickMatch++;
+	while (matchIndex < (int)mTickMatches.size()) {
+		mTickMatches[matchIndex]->Update(mTickDt);
+		matchIndex = mNextTickMatch++;
+	}
+}
+
+GameServer* MatchHost::ResolveSession(uint32_t sessionId) {
+	if (sessionId != 0) {
+		auto it = mMatches.find(sessionId);
+		if (it != mMatches.end()) {
+			//a match in progress streams its world to whoever takes a free slot
+			return !it->second->GetIsMatchOver() && HasFreeSlot(*it->second) ? it->second->GetServer() : nullptr;
+		}
+		MatchInstance* match = CreateMatch(sessionId);
+		return match ? match->GetServer() : nullptr;
+	}
+
+	for (auto& [id, match] : mMatches) {
+		if (match->GetIsOpen() && HasFreeSlot(*match)) {
+			return match->GetServer();
+		}
+	}
+	if ((int)mMatches.size() < mMaxMatches) {
+		while (mMatches.contains(mNextSessionId)) {
+			mNextSessionId++;
+		}
+		MatchInstance* match = CreateMatch(mNextSessionId++);
+		return match ? match->GetServer() : nullptr;
+	}
+	//better a match that has already started than none at all
+	for (auto& [id, match] : mMatches) {
+		if (!match->GetIsMatchOver() && HasFreeSlot(*match)) {
+			return match->GetServer();
+		}
+	}
+	std::cout << "Match host: Every match is full, a player was refused\n";
+	return nullptr;
+}
+
+bool MatchHost::HasFreeSlot(const MatchInstance& match) const {
+	GameServer* server = match.GetServer();
+	return mSessionHost.GetSessionPeerCount(*server) < server->GetClientMax();
+}
+
+MatchInstance* MatchHost::CreateMatch(uint32_t sessionId) {
+	if ((int)mMatches.size() >= mMaxMatches) {
+		std::cout << "Match host: Already running " << mMaxMatches << " matches, session " << sessionId << " refused\n";
+		return nullptr;
+	}
+	MatchInstance* match = new MatchInstance(sessionId, mPlayersToStart, mMaxPlayers, mSessionHost);
+	mMatches.emplace(sessionId, match);
+	if (mHasLevelSeed) {
+		match->SetLevelSeed(mLevelSeed + sessionId);
+	}
+	if (!mRecordPath.empty()) {
+		match->GetServer()->StartRecording(mRecordPath + std::to_string(sessionId) + ".replay");
+	}
+	std::cout << "Match host: Started session " << sessionId << ", " << mMatches.size() << " matches running\n";
+	return match;
+}
+
+void MatchHost::RemoveFinishedMatches() {
+	for (auto it = mMatches.begin(); it != mMatches.end();) {
+		MatchInstance* match = it->second;
+		//everyone leaving ends a match as surely as someone winning it
+		if (match->GetIsMatchOver() || mSessionHost.GetSessionPeerCount(*match->GetServer()) == 0) {
+			std::cout << "Match host: Session " << it->first << " finished\n";
+			delete match;
+			it = mMatches.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+#endif
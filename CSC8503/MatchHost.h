@@ -0,0 +1,95 @@
+#ifdef HEADLESS_SERVER
+#pragma once
+#include <atomic>
+#include <barrier>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SessionHost.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		class LevelManager;
+		class DebugNetworkedGame;
+		class GameServer;
+
+		//One match on a server hosting several. It has its own level manager, so its own world, physics,
+		//navmesh, suspicion and inventory, while the levels, rooms, meshes and animations are shared.
+		class MatchInstance {
+		public:
+			MatchInstance(uint32_t sessionId, int playersToStart, int maxPlayers, SessionHost& sessionHost);
+			~MatchInstance();
+
+			void Update(float dt);
+
+			uint32_t GetSessionId() const { return mSessionId; }
+			//Set before the match starts.
+			void SetLevelSeed(unsigned int levelSeed);
+			GameServer* GetServer() const;
+			//Still in the lobby, so new players can be matched into it.
+			bool GetIsOpen() const;
+			bool GetIsMatchOver() const;
+
+		protected:
+			//Points the level manager and scene lookups on this thread at this match.
+			void BindToThread();
+			void UnbindFromThread();
+
+			uint32_t mSessionId;
+			LevelManager* mLevelManager;
+			DebugNetworkedGame* mGame;
+		};
+
+		//Serves every match in the process from one port. Clients are routed to a match by the session ID they
+		//connect with, 0 joins the first open match, or a new one, or once no more can start, a match in progress
+		//with a free slot. Each tick the matches are spread over the worker threads.
+		class MatchHost {
+		public:
+			//Matches start with playersToStart clients and take up to maxPlayers.
+			MatchHost(int maxMatches, int playersToStart, int maxPlayers, int workerCount);
+			~MatchHost();
+
+			bool Initialise();
+
+			void Update(float dt);
+
+			int GetMatchCount() const { return (int)mMatches.size(); }
+			//Each match from now on records to this path with its session ID and .replay on the end.
+			void SetRecordPath(const std::string& recordPath) { mRecordPath = recordPath; }
+			//Each match from now on plays the level from this seed plus its session ID, instead of a random one.
+			void SetLevelSeed(unsigned int levelSeed) { mLevelSeed = levelSeed; mHasLevelSeed = true; }
+
+		protected:
+			GameServer* ResolveSession(uint32_t sessionId);
+			bool HasFreeSlot(const MatchInstance& match) const;
+			MatchInstance* CreateMatch(uint32_t sessionId);
+			void RemoveFinishedMatches();
+
+			void WorkerThread();
+			void UpdateMatches();
+
+			int mMaxMatches;
+			int mPlayersToStart;
+			int mMaxPlayers;
+			uint32_t mNextSessionId;
+			std::string mRecordPath;
+			unsigned int mLevelSeed;
+			bool mHasLevelSeed;
+
+			SessionHost mSessionHost;
+			std::map<uint32_t, MatchInstance*> mMatches;
+
+			//Workers pick matches off this list until it runs out, so one slow match does not hold up a whole share.
+			std::vector<MatchInstance*> mTickMatches;
+			std::atomic<int> mNextTickMatch;
+			float mTickDt;
+
+			std::vector<std::thread> mWorkers;
+			std::barrier<> mTickBarrier;
+			std::atomic<bool> mIsRunning;
+		};
+	}
+}
+#endif
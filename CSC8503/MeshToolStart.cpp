@@ -0,0 +1,216 @@
+#include "Assets.h"
+#include "CookedAnimation.h"
+#include "CookedMesh.h"
+#include "MeshAnimation.h"
+#include "MshLoader.h"
+#include "NullRenderer.h"
+
+using namespace NCL;
+using namespace CSC8503;
+using namespace Rendering;
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr int DEFAULT_ITERATIONS = 5;
+}
+
+struct MeshFile {
+    //relative to Assets::MESHDIR, as MshLoader and MeshAnimation take it
+    std::string name;
+    size_t size = 0;
+};
+
+//.msh or .anm files anywhere under Assets::MESHDIR.
+std::vector<MeshFile> FindMeshFiles(const char* extension) {
+    std::vector<MeshFile> files;
+    const std::filesystem::path meshDir(Assets::MESHDIR);
+    for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(meshDir)) {
+        if (!entry.is_regular_file() || entry.path().extension() != extension) {
+            continue;
+        }
+        MeshFile file;
+        file.name = std::filesystem::relative(entry.path(), meshDir).generic_string();
+        file.size = (size_t)entry.file_size();
+        files.push_back(file);
+    }
+    std::sort(files.begin(), files.end(), [](const MeshFile& a, const MeshFile& b) { return a.name < b.name; });
+    return files;
+}
+
+//Average milliseconds for load to read the file from disk into a new mesh or clip.
+template <typename Load>
+double TimeLoad(const MeshFile& file, int iterations, Load&& load) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        load(file.name);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+//False if the cooked copy is missing, stale, or loads differently to the text.
+bool IsCookedMatch(const MeshFile& file) {
+    NullMesh expected;
+    NullMesh actual;
+    MshLoader::LoadTextMesh(file.name, expected);
+    return CookedMesh::Load(file.name, actual) && CookedMesh::IsSameMesh(expected, actual);
+}
+
+//Bytes the clip's matrices take once the text is parsed.
+size_t GetTextClipBytes(const MeshAnimation& anim) {
+    return anim.GetFrameCount() * anim.GetJointCount() * sizeof(Matrix4);
+}
+
+//Clips the text parser can't read, the older whitespace separated ones, are skipped. The game loads none of them.
+int CookClips(float tolerance, size_t& textBytesTotal, size_t& cookedBytesTotal) {
+    int failedCount = 0;
+    for (const MeshFile& file : FindMeshFiles(".anm")) {
+        MeshAnimation text;
+        if (!text.LoadTextAnimation(file.name) || !CookedAnimation::HasAllFrames(text)) {
+            std::cout << file.name << " skipped\n";
+            continue;
+        }
+        const bool isCooked = CookedAnimation::Cook(file.name, text, tolerance);
+        MeshAnimation cooked;
+        const bool isLoaded = isCooked && CookedAnimation::Load(file.name, cooked);
+        const float maxError = isLoaded ? CookedAnimation::GetMaxError(text, cooked) : 0.0f;
+        const bool isMatch = isLoaded && maxError <= CookedAnimation::MAX_ERROR + 4.0f * tolerance;
+        if (!isMatch) {
+            failedCount++;
+        }
+        const size_t cookedBytes = isCooked ? (size_t)std::filesystem::file_size(CookedAnimation::GetCookedPath(file.name)) : 0;
+        textBytesTotal += GetTextClipBytes(text);
+        cookedBytesTotal += cookedBytes;
+        std::cout << file.name << " matrix_bytes " << GetTextClipBytes(text) << " cooked_bytes " << cookedBytes << " max_error " << maxError
+            << " match " << (isMatch ? 1 : 0) << "\n";
+    }
+    return failedCount;
+}
+
+int RunBenchmark(int iterations) {
+    const std::vector<MeshFile> files = FindMeshFiles(".msh");
+    if (files.empty()) {
+        std::cout << "No mesh files in " << Assets::MESHDIR << "\n";
+        return 1;
+    }
+
+    double textTotal = 0.0;
+    double cookedTotal = 0.0;
+    size_t bytesTotal = 0;
+    int cookedCount = 0;
+    for (const MeshFile& file : files) {
+        const double textMs = TimeLoad(file, iterations, [](const std::string& name) {
+            NullMesh mesh;
+            MshLoader::LoadTextMesh(name, mesh);
+        });
+        textTotal += textMs;
+        bytesTotal += file.size;
+        std::cout << file.name << " bytes " << file.size << " text_ms " << textMs;
+        //only meshes with a fresh cooked copy, the rest would time the fallback to text
+        if (IsCookedMatch(file)) {
+            const double cookedMs = TimeLoad(file, iterations, [](const std::string& name) {
+                NullMesh mesh;
+                CookedMesh::Load(name, mesh);
+            });
+            cookedTotal += cookedMs;
+            cookedCount++;
+            std::cout << " cooked_ms " << cookedMs << " speedup " << textMs / std::max(cookedMs, 1e-9);
+        }
+        std::cout << "\n";
+    }
+    std::cout << "files " << files.size() << "\n";
+    std::cout << "bytes " << bytesTotal << "\n";
+    std::cout << "text_ms " << textTotal << "\n";
+    std::cout << "text_mb_per_s " << bytesTotal / 1e6 / std::max(textTotal / 1000.0, 1e-9) << "\n";
+    if (cookedCount > 0) {
+        std::cout << "cooked_files " << cookedCount << "\n";
+        std::cout << "cooked_ms " << cookedTotal << "\n";
+    }
+
+    double clipTextTotal = 0.0;
+    double clipCookedTotal = 0.0;
+    for (const MeshFile& file : FindMeshFiles(".anm")) {
+        MeshAnimation text;
+        if (!text.LoadTextAnimation(file.name) || !CookedAnimation::HasAllFrames(text)) {
+            continue;
+        }
+        const double textMs = TimeLoad(file, iterations, [](const std::string& name) {
+            MeshAnimation anim;
+            anim.LoadTextAnimation(name);
+        });
+        clipTextTotal += textMs;
+        std::cout << file.name << " bytes " << file.size << " text_ms " << textMs;
+        MeshAnimation cooked;
+        if (CookedAnimation::Load(file.name, cooked)) {
+            const double cookedMs = TimeLoad(file, iterations, [](const std::string& name) {
+                MeshAnimation anim(name);
+            });
+            clipCookedTotal += cookedMs;
+            std::cout << " cooked_ms " << cookedMs << " speedup " << textMs / std::max(cookedMs, 1e-9);
+        }
+        std::cout << "\n";
+    }
+    std::cout << "clip_text_ms " << clipTextTotal << "\n";
+    std::cout << "clip_cooked_ms " << clipCookedTotal << "\n";
+    return 0;
+}
+
+//Converts every .msh and .anm, then checks each cooked copy loads back the same as its text,
+//or for clips within the error that quantising rotations and dropping keys allows.
+int RunCook(float tolerance) {
+    const std::vector<MeshFile> files = FindMeshFiles(".msh");
+    if (files.empty()) {
+        std::cout << "No mesh files in " << Assets::MESHDIR << "\n";
+        return 1;
+    }
+    int failedCount = 0;
+    for (const MeshFile& file : files) {
+        NullMesh mesh;
+        const bool isCooked = MshLoader::LoadTextMesh(file.name, mesh) && CookedMesh::Cook(file.name, mesh);
+        const bool isMatch = isCooked && IsCookedMatch(file);
+        if (!isMatch) {
+            failedCount++;
+        }
+        const std::string cookedPath = CookedMesh::GetCookedPath(file.name);
+        std::cout << file.name << " bytes " << file.size << " cooked_bytes " << (isCooked ? std::filesystem::file_size(cookedPath) : 0)
+            << " match " << (isMatch ? 1 : 0) << "\n";
+    }
+    size_t clipTextBytes = 0;
+    size_t clipCookedBytes = 0;
+    failedCount += CookClips(tolerance, clipTextBytes, clipCookedBytes);
+    std::cout << "clip_matrix_bytes " << clipTextBytes << "\n";
+    std::cout << "clip_cooked_bytes " << clipCookedBytes << "\n";
+    std::cout << "failures " << failedCount << "\n";
+    return failedCount > 0 ? 1 : 0;
+}
+
+int RunMeshTool(int argc, char** argv) {
+    if (argc < 2 || (strcmp(argv[1], "bench") != 0 && strcmp(argv[1], "cook") != 0)) {
+        std::cout << "Usage: bench [--iterations n]\n";
+        std::cout << "       cook [--tolerance t]\n";
+        return 1;
+    }
+
+    int iterations = DEFAULT_ITERATIONS;
+    float tolerance = 0.0f;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = std::max(0.0f, (float)atof(argv[++i]));
+        }
+    }
+    if (strcmp(argv[1], "cook") == 0) {
+        return RunCook(tolerance);
+    }
+    return RunBenchmark(iterations);
+}
@@ -15,7 +15,11 @@ PushdownState::PushdownResult MultiplayerLobby::OnUpdate(float dt, PushdownState
 	const bool isServer = mGameSceneManager->GetServer() != nullptr;
 	if (isServer) {
 		Debug::Print(" Waiting for player to join ...", Vector2(5, 95), Debug::RED);
-		if (Window::GetKeyboard()->KeyPressed(KeyCodes::S)) {
+		//nobody is at a dedicated server to press start
+		const bool isStartRequested = mGameSceneManager->GetIsDedicatedServer() ?
+			mGameSceneManager->GetConnectedPlayerCount() >= mGameSceneManager->GetPlayersToStart() :
+			Window::GetKeyboard()->KeyPressed(KeyCodes::S);
+		if (isStartRequested) {
 
 			mGameSceneManager->SetIsGameStarted(true);
 			*newState = new InitialisingMultiplayerLevel(mGameSceneManager);
@@ -83,6 +87,10 @@ void PlayingMultiplayerLevel::OnAwake() {
 }
 
 PushdownState::PushdownResult MultiplayerVictory::OnUpdate(float dt, PushdownState** newState) {
+	if (mGameSceneManager->GetIsDedicatedServer()) {
+		mGameSceneManager->SetIsMatchOver(true);
+		return PushdownResult::NoChange;
+	}
 	Debug::Print("You Win! :))))))", Vector2(25, 50), Debug::RED);
 	Debug::Print("Press escape to return main menu", Vector2(25, 60), Debug::WHITE);
 	if (Window::GetKeyboard()->KeyPressed(KeyCodes::ESCAPE)) {
@@ -105,6 +113,11 @@ MultiplayerDefeat::MultiplayerDefeat(DebugNetworkedGame* currentGameState) {
 }
 
 PushdownState::PushdownResult MultiplayerDefeat::OnUpdate(float dt, PushdownState** newState) {
+	//a dedicated server has no player who can win, so its matches end here once over
+	if (mGameSceneManager->GetIsDedicatedServer()) {
+		mGameSceneManager->SetIsMatchOver(true);
+		return PushdownResult::NoChange;
+	}
 	Debug::Print("You lost! :(", Vector2(25, 50), Debug::RED);
 	Debug::Print("Press escape to return main menu", Vector2(25, 60), Debug::WHITE);
 	if (Window::GetKeyboard()->KeyPressed(KeyCodes::ESCAPE)) {
@@ -9,6 +9,7 @@
 #include "NetworkedGame.h"
 #include "NetworkObject.h"
 #include "PhysicsObject.h"
+#include "CapsuleVolume.h"
 #include "InventoryBuffSystem/Item.h"
 #include "SoundManager.h"
 #include "PrisonDoor.h"
@@ -29,6 +30,19 @@ namespace {
 
 	constexpr float MAX_PICKPOCKET_PITCH_DIFF = 20;
 
+	//Prediction errors smaller than this are left alone rather than snapping the player.
+	constexpr float RECONCILE_THRESHOLD = 0.25f;
+	//Per second, the same damping PhysicsSystem::IntegrateVelocity applies.
+	constexpr float REPLAY_LINEAR_DAMPING = 0.4f;
+	//Replayed moves are checked for walls at the middle of the player's capsule.
+	constexpr float REPLAY_RAY_HEIGHT = 2.0f;
+	constexpr float REPLAY_MIN_MOVE = 0.001f;
+	constexpr int INPUT_ACK_MASK = 0xFFFF;
+	//Inputs go out at a fixed rate whatever the framerate, so a fast client can't flood the server.
+	constexpr float INPUT_SEND_INTERVAL = 1.0f / NETWORK_TICK_RATE;
+	//About four server ticks of buffering, more than this and the client is running ahead of the server.
+	constexpr int MAX_QUEUED_INPUTS = 4;
+
 	constexpr bool DEBUG_MODE = false;
 }
 
@@ -65,6 +79,58 @@ void NetworkPlayer::SetPlayerInput(const PlayerInputs& playerInputs) {
 	mCameraYaw = playerInputs.cameraYaw;
 }
 
+void NetworkPlayer::QueueInputs(int firstInputId, const PlayerInputs* inputs, int inputCount) {
+	for (int i = 0; i < inputCount; i++) {
+		const int inputId = firstInputId + i;
+		if (inputId <= mLastQueuedInputId) {
+			continue;
+		}
+		mQueuedInputs.push_back({ inputId, inputs[i] });
+		mLastQueuedInputId = inputId;
+	}
+
+	while (mQueuedInputs.size() > MAX_QUEUED_INPUTS) {
+		//a dropped input's presses carry over so they still happen, an interact along with where it was aimed
+		const PlayerInputs& dropped = mQueuedInputs.front().inputs;
+		PlayerInputs& next = mQueuedInputs[1].inputs;
+		if (dropped.isInteractButtonPressed && !next.isInteractButtonPressed) {
+			next.isInteractButtonPressed = true;
+			next.rayFromPlayer = dropped.rayFromPlayer;
+		}
+		//crouch toggles, so two presses cancel out
+		next.isCrouching = next.isCrouching != dropped.isCrouching;
+		mQueuedInputs.pop_front();
+	}
+}
+
+void NetworkPlayer::ApplyQueuedInput(float dt) {
+	if (mQueuedInputs.empty()) {
+		//keep moving on the last input until the next arrives, but a press only happens once
+		mPlayerInputs.isInteractButtonPressed = false;
+		mPlayerInputs.isCrouching = false;
+	}
+	else {
+		const QueuedInput& queuedInput = mQueuedInputs.front();
+		SetPlayerInput(queuedInput.inputs);
+		GetNetworkObject()->SetInputAck(queuedInput.inputId);
+		mQueuedInputs.pop_front();
+	}
+
+	if (mPlayerSpeedState != Stunned) {
+		const GameObjectState previousObjectState = mObjectState;
+		HandleMovement(dt, mPlayerInputs);
+		ChangeActiveSusCausesBasedOnState(previousObjectState, mObjectState);
+	}
+}
+
+void NetworkPlayer::ResetInputState() {
+	mQueuedInputs.clear();
+	mLastQueuedInputId = -1;
+	if (GetNetworkObject() != nullptr) {
+		GetNetworkObject()->SetInputAck(-1);
+	}
+}
+
 void NetworkPlayer::SetIsLocalPlayer(bool isLocalPlayer) {
 	mIsLocalPlayer = isLocalPlayer;
 }
@@ -78,6 +144,10 @@ void NetworkPlayer::ResetPlayerInput() {
 }
 
 void NetworkPlayer::UpdateObject(float dt) {
+	if (mIsLocalPlayer && !game->GetIsServer()) {
+		ReconcileWithServer();
+	}
+
 	if (mPlayerSpeedState != Stunned) {
 		MovePlayer(dt);
 
@@ -87,6 +157,9 @@ void NetworkPlayer::UpdateObject(float dt) {
 			RayCastFromPlayer(mGameWorld, interactType, dt);
 		else
 			PlayerObject::RayCastFromPlayerForUI(mGameWorld,dt);
+		//a client's interact came with one tick's input, it happens on the first frame of that tick only
+		if (!mIsLocalPlayer && game->GetIsServer())
+			mPlayerInputs.isInteractButtonPressed = false;
 
 		if (mInventoryBuffSystemClassPtr != nullptr)
 			ControlInventory();
@@ -200,11 +273,16 @@ void NetworkPlayer::MovePlayer(float dt) {
 		const Vector3 rightAxis = mGameWorld->GetMainCamera().GetRightVector();
 		mPlayerInputs.fwdAxis = fwdAxis;
 		mPlayerInputs.rightAxis = rightAxis;
-		game->GetClient()->WriteAndSendClientInputPacket(game->GetClientLastFullID(), mPlayerInputs);
-	}
-	else if (isServer) {
+		SendInputs(dt);
 
+		//move straight away instead of waiting a round trip for the server to do it
 		HandleMovement(dt, mPlayerInputs);
+	}
+	else if (isServer) {
+		//a client's player moves on the network tick instead, see ApplyQueuedInput
+		if (mIsLocalPlayer) {
+			HandleMovement(dt, mPlayerInputs);
+		}
 
 		mIsClientInputReceived = false;
 	}
@@ -242,17 +320,16 @@ void NetworkPlayer::HandleMovement(float dt, const PlayerInputs& playerInputs) {
 		rightAxis = playerInputs.rightAxis;
 	}
 
-	if (playerInputs.movementButtons[MOVE_FORWARD_INDEX])
-		mPhysicsObject->AddForce(fwdAxis * mMovementSpeed);
-
-	if (playerInputs.movementButtons[MOVE_LEFT_INDEX])
-		mPhysicsObject->AddForce(-rightAxis * mMovementSpeed);
+	const Vector3 movement = GetMovementDirection(playerInputs, fwdAxis, rightAxis);
 
-	if (playerInputs.movementButtons[MOVE_BACKWARDS_INDEX])
-		mPhysicsObject->AddForce(-fwdAxis * mMovementSpeed);
-
-	if (playerInputs.movementButtons[MOVE_RIGHT_INDEX])
-		mPhysicsObject->AddForce(rightAxis * mMovementSpeed);
+	if (mIsLocalPlayer) {
+		//integrated over however long this frame is
+		mPhysicsObject->AddForce(movement * mMovementSpeed);
+	}
+	else {
+		//a client's input lasts one network tick, a force would last one server frame
+		mPhysicsObject->ApplyLinearImpulse(movement * mMovementSpeed * dt);
+	}
 
 	bool isIdle = true;
 	for (auto buttonState : mPlayerInputs.movementButtons)
@@ -275,6 +352,143 @@ void NetworkPlayer::HandleMovement(float dt, const PlayerInputs& playerInputs) {
 	StopSliding();
 }
 
+Vector3 NetworkPlayer::GetMovementDirection(const PlayerInputs& playerInputs, const Vector3& fwdAxis, const Vector3& rightAxis) const {
+	Vector3 movement;
+	if (playerInputs.movementButtons[MOVE_FORWARD_INDEX])
+		movement += fwdAxis;
+
+	if (playerInputs.movementButtons[MOVE_LEFT_INDEX])
+		movement -= rightAxis;
+
+	if (playerInputs.movementButtons[MOVE_BACKWARDS_INDEX])
+		movement -= fwdAxis;
+
+	if (playerInputs.movementButtons[MOVE_RIGHT_INDEX])
+		movement += rightAxis;
+
+	return movement;
+}
+
+void NetworkPlayer::SendInputs(float dt) {
+	//held buttons are sent as they are now, presses are kept until they have gone out
+	const PlayerInputs pending = mPendingInputs;
+	mPendingInputs = mPlayerInputs;
+	mPendingInputs.isInteractButtonPressed |= pending.isInteractButtonPressed;
+	mPendingInputs.isCrouching |= pending.isCrouching;
+	if (pending.isInteractButtonPressed && !mPlayerInputs.isInteractButtonPressed) {
+		mPendingInputs.rayFromPlayer = pending.rayFromPlayer;
+	}
+
+	mInputSendTimer += dt;
+	if (mInputSendTimer < INPUT_SEND_INTERVAL) {
+		return;
+	}
+	//a long frame sends once rather than catching up
+	mInputSendTimer = std::min(mInputSendTimer - INPUT_SEND_INTERVAL, INPUT_SEND_INTERVAL);
+
+	const int inputId = mNextInputId++;
+	PredictedInput& predictedInput = mInputHistory[inputId % INPUT_HISTORY_SIZE];
+	predictedInput.inputId = inputId;
+	predictedInput.positionBeforeInput = mTransform.GetPosition();
+	predictedInput.velocityBeforeInput = mPhysicsObject->GetLinearVelocity();
+	predictedInput.inputs = mPendingInputs;
+	mPendingInputs.isInteractButtonPressed = false;
+	mPendingInputs.isCrouching = false;
+
+	//everything the server hasn't acknowledged goes again, so one lost packet loses no input
+	const int firstInputId = std::max(mLastAckedInputId + 1, inputId - MAX_INPUTS_PER_PACKET + 1);
+	PlayerInputs inputs[MAX_INPUTS_PER_PACKET];
+	int inputCount = 0;
+	for (int id = firstInputId; id <= inputId; id++) {
+		inputs[inputCount++] = mInputHistory[id % INPUT_HISTORY_SIZE].inputs;
+	}
+
+	const ReplicatedProperties& replicatedProperties = game->GetReplicatedProperties();
+	game->GetClient()->WriteAndSendClientInputPacket(game->GetClientLastFullID(), firstInputId,
+		replicatedProperties.GetReceivedSequence(), (int)replicatedProperties.GetReceivedAckBits(), inputs, inputCount);
+}
+
+void NetworkPlayer::ReconcileWithServer() {
+	NetworkObject* networkObject = GetNetworkObject();
+	Vector3 serverPosition;
+	int wrappedAck;
+	if (networkObject == nullptr || !networkObject->ConsumeAuthoritativeState(serverPosition, wrappedAck)) {
+		return;
+	}
+
+	//the ack only carries the low bits, it can't be ahead of the newest input we sent
+	const int newestInputId = mNextInputId - 1;
+	const int ackedInputId = newestInputId - ((newestInputId - wrappedAck) & INPUT_ACK_MASK);
+	if (ackedInputId <= mLastAckedInputId) {
+		return;
+	}
+	mLastAckedInputId = ackedInputId;
+
+	//the server's position after the acked input is where we predicted to be when sending the next one
+	Vector3 predictedPosition = mTransform.GetPosition();
+	const int nextInputId = ackedInputId + 1;
+	if (nextInputId <= newestInputId) {
+		const PredictedInput& nextInput = mInputHistory[nextInputId % INPUT_HISTORY_SIZE];
+		if (nextInput.inputId != nextInputId) {
+			return;
+		}
+		predictedPosition = nextInput.positionBeforeInput;
+	}
+
+	const Vector3 error = serverPosition - predictedPosition;
+	if (error.Length() < RECONCILE_THRESHOLD) {
+		return;
+	}
+
+	//rewind to where the server has the player and replay every input it hasn't run yet. Each was held for one
+	//send interval, apart from the newest which has only been held since it went out.
+	Vector3 position = serverPosition;
+	Vector3 velocity = mPhysicsObject->GetLinearVelocity();
+	if (nextInputId <= newestInputId) {
+		velocity = mInputHistory[nextInputId % INPUT_HISTORY_SIZE].velocityBeforeInput;
+	}
+	for (int inputId = nextInputId; inputId <= newestInputId; inputId++) {
+		PredictedInput& input = mInputHistory[inputId % INPUT_HISTORY_SIZE];
+		input.positionBeforeInput = position;
+		input.velocityBeforeInput = velocity;
+		const float duration = inputId == newestInputId ? mInputSendTimer : INPUT_SEND_INTERVAL;
+		ReplayInput(input.inputs, duration, position, velocity);
+	}
+
+	//the replay only moves the player across the floor, height is the server's and falling is left to the physics
+	mTransform.SetPosition(position);
+	mPhysicsObject->SetLinearVelocity(Vector3(velocity.x, mPhysicsObject->GetLinearVelocity().y, velocity.z));
+}
+
+void NetworkPlayer::ReplayInput(const PlayerInputs& playerInputs, float duration, Vector3& position, Vector3& velocity) const {
+	Vector3 movement = GetMovementDirection(playerInputs, playerInputs.fwdAxis, playerInputs.rightAxis);
+	movement.y = 0.0f;
+	velocity.y = 0.0f;
+	//the server gives a client's input as one impulse, the force a local player is pushed by adds up to the same
+	velocity += movement * (float)mMovementSpeed * duration * mPhysicsObject->GetInverseMass();
+	const float maxSpeed = GetMaxSpeed();
+	if (maxSpeed > 0.0f && velocity.Length() > maxSpeed) {
+		velocity = velocity.Normalised() * maxSpeed;
+	}
+
+	Vector3 move = velocity * duration;
+	const float moveLength = move.Length();
+	if (moveLength > REPLAY_MIN_MOVE) {
+		const Vector3 moveDirection = move / moveLength;
+		const float radius = ((const CapsuleVolume*)GetBoundingVolume())->GetRadius();
+		Ray ray(position + Vector3(0, REPLAY_RAY_HEIGHT, 0), moveDirection);
+		RayCollision collision;
+		if (mGameWorld->Raycast(ray, collision, true, (GameObject*)this) && collision.rayDistance < moveLength + radius &&
+			((GameObject*)collision.node)->GetCollisionLayer() == StaticObj) {
+			//stop against the wall, and lose the speed that was going into it
+			move = moveDirection * std::max(collision.rayDistance - radius, 0.0f);
+			velocity -= moveDirection * Vector3::Dot(velocity, moveDirection);
+		}
+	}
+	position += move;
+	velocity = velocity * std::max(1.0f - REPLAY_LINEAR_DAMPING * duration, 0.0f);
+}
+
 bool NCL::CSC8503::NetworkPlayer::GotRaycastInput(NCL::CSC8503::InteractType& interactType, const float dt){
 	bool isThereAnyInputFromUser = (Window::GetKeyboard()->KeyPressed(KeyCodes::E) && mIsLocalPlayer) || (mPlayerInputs.isInteractButtonPressed && !mIsLocalPlayer);
 	bool isPlayerHoldingInteract = (Window::GetKeyboard()->KeyHeld(KeyCodes::E)) || (!mIsLocalPlayer && mPlayerInputs.isHoldingInteractButton);
@@ -6,6 +6,8 @@
 #include "../CSC8503/SuspicionSystem/SuspicionSystem.h"
 #include "Ray.h"
 
+#include <deque>
+
 namespace NCL::CSC8503{
 	class DebugNetworkedGame;
 }
@@ -32,6 +34,23 @@ namespace NCL {
 			Vector3 rightAxis;
 			Ray rayFromPlayer;
 		};
+
+		constexpr int INPUT_HISTORY_SIZE = 128;
+
+		//Where the local player was and how it was moving when an input was sent, so a server correction can be
+		//measured against it, and the input itself so it can be sent again and replayed until the server acknowledges it.
+		struct PredictedInput {
+			int inputId = -1;
+			Vector3 positionBeforeInput;
+			Vector3 velocityBeforeInput;
+			PlayerInputs inputs;
+		};
+
+		//An input from a client waiting for the server tick that runs it.
+		struct QueuedInput {
+			int inputId = -1;
+			PlayerInputs inputs;
+		};
 		
 		class NetworkPlayer : public PlayerObject, public PlayerBuffsObserver, public PlayerInventoryObserver {
 		public:
@@ -42,6 +61,13 @@ namespace NCL {
 			void OnCollisionBegin(GameObject* otherObject) override;
 
 			void SetPlayerInput(const PlayerInputs& playerInputs);
+			//Called by servers with every input in a client's packet, ones already queued are skipped.
+			void QueueInputs(int firstInputId, const PlayerInputs* inputs, int inputCount);
+			//Called by servers once per network tick for a client's player, runs its next input for dt.
+			void ApplyQueuedInput(float dt);
+			//Forgets the inputs queued and acked for the client driving this player, so whoever drives it next
+			//can start its input IDs from 0.
+			void ResetInputState();
 			void SetIsLocalPlayer(bool isLocalPlayer);
 			void SetCameraYaw(float cameraYaw);
 			void ResetPlayerInput();
@@ -65,8 +91,24 @@ namespace NCL {
 			DebugNetworkedGame* game;
 
 			PlayerInputs mPlayerInputs;
+
+			int mNextInputId = 0;
+			int mLastAckedInputId = -1;
+			PredictedInput mInputHistory[INPUT_HISTORY_SIZE];
+			//What has been pressed since the last input went out.
+			PlayerInputs mPendingInputs;
+			float mInputSendTimer = 0.f;
+
+			std::deque<QueuedInput> mQueuedInputs;
+			int mLastQueuedInputId = -1;
 			
 			void HandleMovement(float dt, const PlayerInputs& playerInputs);
+			Vector3 GetMovementDirection(const PlayerInputs& playerInputs, const Vector3& fwdAxis, const Vector3& rightAxis) const;
+			void SendInputs(float dt);
+			void ReconcileWithServer();
+			//Moves position and velocity on by one input held for duration, as the server would have without
+			//stepping the physics world: the input's impulse, the speed cap and damping, stopped by anything solid.
+			void ReplayInput(const PlayerInputs& playerInputs, float duration, Vector3& position, Vector3& velocity) const;
 			bool GotRaycastInput(NCL::CSC8503::InteractType& interactType,const float dt) override;
 			void RayCastFromPlayer(GameWorld* world, const NCL::CSC8503::InteractType& interactType, const float dt) override;
 
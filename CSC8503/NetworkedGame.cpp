@@ -44,8 +44,6 @@ void NetworkedGame::StartAsClient(char a, char b, char c, char d) {
 	mThisClient = new GameClient();
 	mThisClient->Connect(a, b, c, d, NetworkBase::GetDefaultPort(), "");
 
-	mThisClient->RegisterPacketHandler(Delta_State, this);
-	mThisClient->RegisterPacketHandler(Full_State, this);
 	mThisClient->RegisterPacketHandler(Player_Connected, this);
 	mThisClient->RegisterPacketHandler(Player_Disconnected, this);
 
@@ -75,20 +73,6 @@ void NetworkedGame::UpdateGame(float dt) {
 }
 
 void NetworkedGame::UpdateAsServer(float dt) {
-	mPacketsToSnapshot--;
-	if (mPacketsToSnapshot < 0) {
-	// full packet
-	BroadcastSnapshot(false);
-	mPacketsToSnapshot = 5;
-	}
-	else {
-		// use delta packets
-		//BroadcastSnapshot(true);
-		
-		// dont use delta packets
-		BroadcastSnapshot(false);
-	}
-
 	mThisServer->UpdateServer();
 }
 
@@ -112,29 +96,6 @@ void NetworkedGame::UpdateAsClient(float dt) {
 	}
 }
 
-void NetworkedGame::BroadcastSnapshot(bool deltaFrame) {
-	std::vector<GameObject*>::const_iterator first;
-	std::vector<GameObject*>::const_iterator last;
-
-	mLevelManager->GetGameWorld()->GetObjectIterators(first, last);
-
-	for (auto i = first; i != last; ++i) {
-		NetworkObject* o = (*i)->GetNetworkObject();
-		if (!o) {
-			continue;
-		}
-		// line added by me
-		int playerState = 0;
-		// line added by me
-		GamePacket* newPacket = nullptr;
-		if (o->WritePacket(&newPacket, deltaFrame, playerState)) {
-			mThisServer->SendGlobalPacket(*newPacket);
-			delete newPacket;
-		}
-
-	}
-}
-
 void NetworkedGame::UpdateMinimumState() {
 	//Periodically remove old data from the server
 	int minID = INT_MAX;
@@ -188,6 +149,32 @@ void NetworkedGame::OnPlayerCollision(NetworkPlayer* a, NetworkPlayer* b) {
 }
 
 void NetworkedGame::AddNetworkObjectToNetworkObjects(NetworkObject* networkObj) {
-	mNetworkObjects.push_back(networkObj);
+	const int networkID = networkObj->GetnetworkID();
+	if (networkID < 0) {
+		return;
+	}
+	if (networkID >= mNetworkObjects.size()) {
+		mNetworkObjects.resize(networkID + 1, nullptr);
+	}
+#ifndef NDEBUG
+	// server and client assign IDs in the same order, so a collision here means they have drifted apart
+	NetworkObject* existingObj = mNetworkObjects[networkID];
+	if (existingObj != nullptr && existingObj != networkObj) {
+		std::cout << "Network ID " << networkID << " collision: " << existingObj->GetGameObject().GetName()
+			<< " replaced by " << networkObj->GetGameObject().GetName() << std::endl;
+	}
+#endif
+	mNetworkObjects[networkID] = networkObj;
+}
+
+NetworkObject* NetworkedGame::GetNetworkObjectByID(int networkID) const {
+	if (networkID < 0 || networkID >= mNetworkObjects.size()) {
+		return nullptr;
+	}
+	return mNetworkObjects[networkID];
+}
+
+void NetworkedGame::ClearNetworkObjects() {
+	mNetworkObjects.clear();
 }
 #endif
\ No newline at end of file
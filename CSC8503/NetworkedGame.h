@@ -54,6 +54,8 @@ namespace NCL {
 			void OnPlayerCollision(NetworkPlayer* a, NetworkPlayer* b);
 
 			void AddNetworkObjectToNetworkObjects(NetworkObject* networkObj);
+			NetworkObject* GetNetworkObjectByID(int networkID) const;
+			void ClearNetworkObjects();
 
 			std::map<int, NetworkPlayer*>* GetServerPlayersPtr() { return &mServerPlayers;  };
 
@@ -61,7 +63,6 @@ namespace NCL {
 			void UpdateAsServer(float dt);
 			void UpdateAsClient(float dt);
 
-			void BroadcastSnapshot(bool deltaFrame);
 			void UpdateMinimumState();
 
 			virtual void SetItemsLeftToZero() = 0;
@@ -73,6 +74,7 @@ namespace NCL {
             float mTimeToNextPacket;
             int mPacketsToSnapshot;
 
+            //Indexed by network ID, so unused IDs are null.
             std::vector<NetworkObject*> mNetworkObjects;
 
             std::vector<int> mPlayerList;
@@ -0,0 +1,37 @@
+#include "NullRenderer.h"
+
+#include "MshLoader.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+NullRenderer::NullRenderer(GameWorld& world) : RendererBase(*Window::GetWindow()), gameWorld(world) {
+}
+
+NullRenderer::~NullRenderer() {
+	ClearLights();
+}
+
+Mesh* NullRenderer::LoadMesh(const std::string& name) {
+	NullMesh* mesh = new NullMesh();
+	MshLoader::LoadMesh(name, *mesh);
+	mesh->SetPrimitiveType(GeometryPrimitive::Triangles);
+	return mesh;
+}
+
+void NullRenderer::LoadMeshes(std::unordered_map<std::string, Mesh*>& meshMap, const std::vector<std::string>& details) {
+	for (int i = 0; i < details.size(); i += 3) {
+		meshMap[details[i]] = LoadMesh(details[i + 1]);
+	}
+}
+
+void NullRenderer::LoadTextures(std::unordered_map<std::string, Texture*>& textureMap, const std::vector<std::string>& details) {
+	//Keys still exist so lookups by name behave the same, there is just no texture behind them.
+	for (int i = 0; i < details.size(); i += 3) {
+		textureMap[details[i]] = nullptr;
+	}
+}
+
+MeshAnimation* NullRenderer::LoadAnimation(const std::string& name) {
+	return new MeshAnimation(name);
+}
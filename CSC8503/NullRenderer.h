@@ -0,0 +1,38 @@
+#pragma once
+#include "RendererBase.h"
+#include "GameWorld.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		//Mesh data kept on the CPU only, the navmesh and collision still read positions and indices from it.
+		class NullMesh : public Mesh {
+		public:
+			void UploadToGPU(Rendering::RendererBase* renderer = nullptr) override {}
+		};
+
+		//Takes the GameTechRenderer's place on the dedicated server. Meshes and animations are loaded
+		//because simulation needs them, everything that only exists to be drawn is skipped.
+		class NullRenderer : public RendererBase {
+		public:
+			NullRenderer(GameWorld& world);
+			~NullRenderer();
+
+			Mesh*	LoadMesh(const std::string& name) override;
+			void	LoadMeshes(std::unordered_map<std::string, Mesh*>& meshMap, const std::vector<std::string>& details) override;
+			void	LoadTextures(std::unordered_map<std::string, Texture*>& textureMap, const std::vector<std::string>& details);
+			MeshAnimation* LoadAnimation(const std::string& name) override;
+			void	LoadMeshMaterials(std::unordered_map<std::string, Mesh*>& meshMap, std::unordered_map<std::string, MeshMaterial*>& materialMap,
+				std::unordered_map<std::string, vector<int>>& meshMaterialMap) {}
+
+		protected:
+			void OnWindowResize(int w, int h) override {}
+
+			void BeginFrame()	override {}
+			void RenderFrame()	override {}
+			void EndFrame()		override {}
+			void SwapBuffers()	override {}
+
+			GameWorld& gameWorld;
+		};
+	}
+}
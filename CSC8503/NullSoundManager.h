@@ -0,0 +1,27 @@
+#pragma once
+#include "Vector3.h"
+#include "../CSC8503CoreClasses/SoundObject.h"
+#include "../CSC8503CoreClasses/GameObject.h"
+#include "../CSC8503CoreClasses/GameWorld.h"
+
+namespace NCL{
+	using namespace Maths;
+	namespace CSC8503 {
+		//Takes the SoundManager's place on the dedicated server, FMOD is never initialised and every
+		//sound object is handed a null channel.
+		class NullSoundManager {
+		public:
+			NullSoundManager(GameWorld* GameWorld) {}
+
+			FMOD::Channel* AddWalkSound() { return nullptr; }
+
+			FMOD::Channel* AddSoundEmitterSound(Vector3 soundPos) { return nullptr; }
+
+			FMOD::Channel* AddCCTVSpotSound() { return nullptr; }
+
+			void UpdateSounds(const vector<GameObject*>& object) {}
+
+			void PlaySpottedSound() {}
+		};
+	}
+}
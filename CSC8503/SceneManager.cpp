@@ -9,6 +9,7 @@
 using namespace NCL::CSC8503;
 
 SceneManager* SceneManager::instance = nullptr;
+thread_local Scene* SceneManager::threadScene = nullptr;
 
 SceneManager::SceneManager() {
 	currentScene = nullptr;
@@ -21,6 +22,10 @@ SceneManager::~SceneManager() {
 }
 
 void SceneManager::InitScenes() {
+#ifdef HEADLESS_SERVER
+	//The dedicated server has no menus, MatchHost creates a game per match as sessions connect.
+	mCurrentSceneType = Scenes::Multiplayer;
+#else
 	MainMenuScene* mainMenuScene = new MainMenuScene();
 	GameSceneManager* singlePlayerScene = new GameSceneManager();
 #ifdef USEGL
@@ -36,16 +41,19 @@ void SceneManager::InitScenes() {
 #endif
 		{Scenes::MainMenu, (Scene*)mainMenuScene}
 	};
+#endif
 	LevelManager::GetLevelManager()->InitialiseGameAssets();
 }
 
 void SceneManager::InitPushdownMachine() {
+#ifndef HEADLESS_SERVER
 	pushdownMachine = new PushdownMachine(new MainMenuSceneState());
+#endif
 }
 
 void SceneManager::SetCurrentScene(Scenes scene) {
 
-#ifdef USEGL
+#if defined(USEGL) && !defined(HEADLESS_SERVER)
 
 	GameTechRenderer* renderer = (GameTechRenderer*)(LevelManager::GetLevelManager()->GetRenderer());
 	renderer->SetImguiCanvasFunc([this]
@@ -89,6 +97,9 @@ PushdownMachine* SceneManager::GetScenePushdownMachine() {
 }
 
 Scene* SceneManager::GetCurrentScene() {
+	if (threadScene != nullptr) {
+		return threadScene;
+	}
 	return currentScene;
 }
 
@@ -106,3 +117,7 @@ SceneManager* SceneManager::GetSceneManager() {
 	}
 	return instance;
 }
+
+void SceneManager::BindSceneToThread(Scene* scene) {
+	threadScene = scene;
+}
@@ -30,10 +30,12 @@ namespace NCL {
             void SetChangeSceneTrigger(Scenes scene);
             
             PushdownMachine* GetScenePushdownMachine();
+            //The scene bound to the calling thread if there is one, so each hosted match finds its own game.
             Scene* GetCurrentScene();
             Scene* GetScene(Scenes sceneType);
             Scenes GetCurrentSceneType() const;
             static SceneManager* GetSceneManager();
+            static void BindSceneToThread(Scene* scene);
 
             ControllerInterface* GetControllerInterface() const { return mControllerInterface; }
 
@@ -45,6 +47,7 @@ namespace NCL {
             ~SceneManager();
 
             static SceneManager* instance;
+            static thread_local Scene* threadScene;
 
             Scenes mCurrentSceneType;
             Scene* currentScene = nullptr;
@@ -0,0 +1,216 @@
+#include "../NCLCoreClasses/Window.h"
+
+#include "MatchHost.h"
+#include "SceneManager.h"
+#include "DebugNetworkedGame.h"
+#include "LevelManager.h"
+#include "ReplayPlayer.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+
+namespace {
+    constexpr int DEFAULT_TICK_RATE = 60;
+    constexpr int DEFAULT_PLAYERS_TO_START = 1;
+    constexpr int DEFAULT_MAX_PLAYERS = 3;
+    constexpr int DEFAULT_MAX_MATCHES = 1;
+
+    //If the server falls further behind than this it drops the backlog instead of running ticks back to back.
+    constexpr int MAX_TICKS_BEHIND = 5;
+}
+
+struct ServerArgs {
+    int tickRate = DEFAULT_TICK_RATE;
+    int playersToStart = DEFAULT_PLAYERS_TO_START;
+    //Clients per match, never fewer than start it and never more than a dedicated server has slots for.
+    int maxPlayers = DEFAULT_MAX_PLAYERS;
+    int maxMatches = DEFAULT_MAX_MATCHES;
+    //-1 picks one per core, less the main thread which ticks matches too.
+    int workerCount = -1;
+    bool isSleepDisabled = false;
+    //Each match records to this plus its session ID and .replay, nothing is recorded when empty.
+    std::string recordPath;
+    //Plays this recording back through the client instead of serving.
+    std::string replayPath;
+    int replayPeer = 0;
+    //Plays it back through the server instead, with --players and --max-players as it was recorded with.
+    bool isReplayServer = false;
+    bool isReplayUnlimited = false;
+};
+
+ServerArgs ParseServerArgs(int argc, char** argv) {
+    ServerArgs args;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            args.tickRate = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
+            args.playersToStart = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--max-players") == 0 && i + 1 < argc) {
+            args.maxPlayers = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--max-matches") == 0 && i + 1 < argc) {
+            args.maxMatches = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            args.workerCount = std::max(0, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--no-sleep") == 0) {
+            args.isSleepDisabled = true;
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            args.recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            args.replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay-peer") == 0 && i + 1 < argc) {
+            args.replayPeer = std::max(0, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--replay-server") == 0) {
+            args.isReplayServer = true;
+        }
+        else if (strcmp(argv[i], "--replay-unlimited") == 0) {
+            args.isReplayUnlimited = true;
+        }
+        else {
+            std::cout << "Unknown server argument: " << argv[i] << "\n";
+        }
+    }
+    const int maxDedicatedPlayers = DebugNetworkedGame::GetMaxDedicatedPlayers();
+    if (args.maxPlayers > maxDedicatedPlayers || args.playersToStart > maxDedicatedPlayers) {
+        std::cout << "A match takes at most " << maxDedicatedPlayers << " players, --players and --max-players are capped to it\n";
+        args.maxPlayers = std::min(args.maxPlayers, maxDedicatedPlayers);
+        args.playersToStart = std::min(args.playersToStart, maxDedicatedPlayers);
+    }
+    return args;
+}
+
+//Feeds a recorded match through the client's packet handlers, or the server's, one tick at a time. Unlimited runs
+//the ticks back to back, so the time taken is all client or server work and the same recording always makes the
+//same workload.
+int RunReplay(const ServerArgs& args) {
+    Window* w = Window::CreateGameWindow("CSC8503 Replay", 0, 0, false);
+    SceneManager::GetSceneManager()->SetIsServer(args.isReplayServer);
+
+    DebugNetworkedGame* game = new DebugNetworkedGame();
+    SceneManager::BindSceneToThread(game);
+    const bool isReplaying = args.isReplayServer ?
+        game->StartAsServerReplay(args.replayPath, args.playersToStart, std::max(args.maxPlayers, args.playersToStart)) :
+        game->StartAsReplay(args.replayPath, args.replayPeer);
+    if (!isReplaying) {
+        std::cout << "Replay " << args.replayPath << " could not be played\n";
+        SceneManager::BindSceneToThread(nullptr);
+        delete game;
+        Window::DestroyGameWindow();
+        return 1;
+    }
+    if (args.isReplayServer) {
+        LevelManager::GetLevelManager()->SetGameState(GameStates::LevelState);
+    }
+    const ReplayPlayer* replay = game->GetReplay();
+    std::cout << "Replaying " << replay->GetDuration() << "s from " << args.replayPath << (args.isReplayServer ? " as the server" : "")
+        << (args.isReplayUnlimited ? " unlimited" : " in real time") << "\n";
+
+    const float tickDt = 1.0f / args.tickRate;
+    const auto tickDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(tickDt));
+    const auto replayStart = std::chrono::steady_clock::now();
+    auto nextTick = replayStart;
+    int tickCount = 0;
+    float maxTickMs = 0.0f;
+
+    while (w->UpdateWindow() && !replay->IsFinished()) {
+        const auto tickStart = std::chrono::steady_clock::now();
+        game->UpdateGame(tickDt);
+        const std::chrono::duration<float, std::milli> tickTime = std::chrono::steady_clock::now() - tickStart;
+        maxTickMs = std::max(maxTickMs, tickTime.count());
+        tickCount++;
+
+        if (!args.isReplayUnlimited) {
+            nextTick += tickDuration;
+            std::this_thread::sleep_until(nextTick);
+        }
+    }
+
+    const std::chrono::duration<float, std::milli> totalTime = std::chrono::steady_clock::now() - replayStart;
+    std::cout << "replay_ticks " << tickCount << "\n";
+    std::cout << "replay_packets " << replay->GetPacketsDispatched() << "\n";
+    std::cout << "replay_wall_ms " << totalTime.count() << "\n";
+    std::cout << "replay_tick_ms_avg " << (tickCount > 0 ? totalTime.count() / tickCount : 0.0f) << "\n";
+    std::cout << "replay_tick_ms_max " << maxTickMs << "\n";
+
+    game->ClearNetworkGame();
+    SceneManager::BindSceneToThread(nullptr);
+    delete game;
+    Window::DestroyGameWindow();
+    return 0;
+}
+
+int RunServer(int argc, char** argv) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    ServerArgs args = ParseServerArgs(argc, argv);
+    if (!args.replayPath.empty()) {
+        return RunReplay(args);
+    }
+    if (args.workerCount < 0) {
+        const int coreCount = std::max(1, (int)std::thread::hardware_concurrency());
+        args.workerCount = std::min(args.maxMatches, coreCount) - 1;
+    }
+
+    Window* w = Window::CreateGameWindow("CSC8503 Server", 0, 0, false);
+    //Loads the assets every match shares.
+    SceneManager* sceneManager = SceneManager::GetSceneManager();
+    sceneManager->SetIsServer(true);
+
+    MatchHost* matchHost = new MatchHost(args.maxMatches, args.playersToStart, args.maxPlayers, args.workerCount);
+    matchHost->SetRecordPath(args.recordPath);
+    if (!matchHost->Initialise()) {
+        std::cout << "Server failed to start\n";
+        delete matchHost;
+        Window::DestroyGameWindow();
+        return 1;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> msDouble = endTime - startTime;
+    std::cout << "Loading Complete: Time Taken: " << msDouble.count() << "ms\n";
+    std::cout << "Serving up to " << args.maxMatches << " match(es) of " << args.playersToStart << " to " << std::max(args.maxPlayers, args.playersToStart) << " player(s) at " << args.tickRate
+        << "Hz on " << args.workerCount + 1 << " thread(s)\n";
+
+    //The simulation always steps by the same dt, wall clock time only decides when the next step is due.
+    const float tickDt = 1.0f / args.tickRate;
+    const auto tickDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(tickDt));
+    auto nextTick = std::chrono::steady_clock::now();
+
+    while (w->UpdateWindow() && !sceneManager->GetIsForceQuit()) {
+        matchHost->Update(tickDt);
+
+        nextTick += tickDuration;
+        auto now = std::chrono::steady_clock::now();
+        if (now - nextTick > tickDuration * MAX_TICKS_BEHIND) {
+            std::cout << "Server running behind, skipping " << (now - nextTick) / tickDuration << " ticks\n";
+            nextTick = now;
+            continue;
+        }
+        if (args.isSleepDisabled) {
+            while (std::chrono::steady_clock::now() < nextTick) {
+                std::this_thread::yield();
+            }
+        }
+        else {
+            std::this_thread::sleep_until(nextTick);
+        }
+    }
+
+    delete matchHost;
+    Window::DestroyGameWindow();
+
+    return 0;
+}
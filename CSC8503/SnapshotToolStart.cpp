@@ -0,0 +1,455 @@
+#include "NetworkObject.h"
+#include "NetworkQuantizer.h"
+#include "ReplayPlayer.h"
+#include "SnapshotCompression.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    //Bytes per k-mer the trainer counts, long enough to be worth a match once the token is paid for.
+    constexpr int KMER_SIZE = 6;
+    //The trainer picks whole segments of this many bytes.
+    constexpr int SEGMENT_SIZE = 32;
+    //Candidate segments start this far apart, so big corpora stay quick to train.
+    constexpr int SEGMENT_STEP = 4;
+    constexpr float REPLAY_END_TIME = 1e9f;
+    //The quantizer's default bounds, set explicitly so the check knows where the corners are.
+    const Maths::Vector3 QUANTIZE_BOUNDS_MIN(-512.0f, -64.0f, -512.0f);
+    const Maths::Vector3 QUANTIZE_BOUNDS_MAX(512.0f, 192.0f, 512.0f);
+    //Float rounding in the reconstruction, on top of the quantisation error itself.
+    constexpr float POSITION_TOLERANCE = 1e-4f;
+    constexpr float ORIENTATION_TOLERANCE = 1e-6f;
+    //How far the delta base is moved from each transform, about what an object moves between snapshots.
+    constexpr float DELTA_MOVE_DISTANCE = 0.25f;
+    constexpr float DELTA_TURN_DEGREES = 5.0f;
+}
+
+struct SnapshotSample {
+    std::vector<char> payload;
+    bool isDeltaFrame = false;
+};
+
+//Every uncompressed snapshot the server sent in the recordings, to any client.
+bool LoadSnapshotSamples(const std::vector<std::string>& replayPaths, std::vector<SnapshotSample>& samples) {
+    int compressedCount = 0;
+    for (const std::string& path : replayPaths) {
+        ReplayPlayer replay;
+        if (!replay.Open(path)) {
+            std::cout << "Replay " << path << " could not be opened\n";
+            return false;
+        }
+        replay.SetPeerNumber(-1);
+        replay.AdvanceTime(REPLAY_END_TIME);
+        replay.Dispatch([&](GamePacket* packet) {
+            if (packet->type != BasicNetworkMessages::Snapshot_State) {
+                return;
+            }
+            const SnapshotPacket* snapshot = (const SnapshotPacket*)packet;
+            if (snapshot->isCompressed) {
+                compressedCount++;
+                return;
+            }
+            const int payloadSize = snapshot->GetPayloadSize();
+            if (payloadSize <= 0 || payloadSize > SNAPSHOT_MAX_PAYLOAD_SIZE) {
+                return;
+            }
+            SnapshotSample sample;
+            sample.payload.assign(snapshot->data, snapshot->data + payloadSize);
+            sample.isDeltaFrame = snapshot->isDeltaFrame;
+            samples.push_back(std::move(sample));
+        });
+    }
+    if (compressedCount > 0) {
+        std::cout << "Skipped " << compressedCount << " snapshot(s) that were recorded compressed\n";
+    }
+    return true;
+}
+
+uint64_t HashKmer(const char* data) {
+    uint64_t hash = 0;
+    memcpy(&hash, data, KMER_SIZE);
+    return hash * 0x9E3779B97F4A7C15ull;
+}
+
+// A cut down COVER trainer: k-mers score by how many samples contain them, segments by the k-mers in them that no
+// segment already chosen covers, and the best segments are taken greedily until the dictionary is full.
+SnapshotDictionary TrainDictionary(const std::vector<SnapshotSample>& samples, int dictionarySize) {
+    std::unordered_map<uint64_t, int> kmerFrequencies;
+    std::vector<uint64_t> seen;
+    for (const SnapshotSample& sample : samples) {
+        seen.clear();
+        for (int i = 0; i + KMER_SIZE <= (int)sample.payload.size(); i++) {
+            seen.push_back(HashKmer(&sample.payload[i]));
+        }
+        std::sort(seen.begin(), seen.end());
+        seen.erase(std::unique(seen.begin(), seen.end()), seen.end());
+        for (uint64_t kmer : seen) {
+            kmerFrequencies[kmer]++;
+        }
+    }
+
+    auto scoreSegment = [&](const char* segment) {
+        uint64_t kmers[SEGMENT_SIZE];
+        int kmerCount = 0;
+        int score = 0;
+        for (int i = 0; i + KMER_SIZE <= SEGMENT_SIZE; i++) {
+            const uint64_t kmer = HashKmer(segment + i);
+            if (std::find(kmers, kmers + kmerCount, kmer) != kmers + kmerCount) {
+                continue;
+            }
+            kmers[kmerCount++] = kmer;
+            auto it = kmerFrequencies.find(kmer);
+            //one sample on its own is noise, not something the next match will repeat
+            if (it != kmerFrequencies.end() && it->second > 1) {
+                score += it->second;
+            }
+        }
+        return score;
+    };
+
+    struct Candidate {
+        int score;
+        const char* segment;
+        bool operator<(const Candidate& other) const { return score < other.score; }
+    };
+    std::priority_queue<Candidate> candidates;
+    for (const SnapshotSample& sample : samples) {
+        for (int i = 0; i + SEGMENT_SIZE <= (int)sample.payload.size(); i += SEGMENT_STEP) {
+            const int score = scoreSegment(&sample.payload[i]);
+            if (score > 0) {
+                candidates.push({ score, &sample.payload[i] });
+            }
+        }
+    }
+
+    std::vector<const char*> chosen;
+    while (!candidates.empty() && (int)chosen.size() * SEGMENT_SIZE < dictionarySize) {
+        Candidate best = candidates.top();
+        candidates.pop();
+        //scores only ever fall, so one still ahead of the next best after rescoring is the best there is
+        best.score = scoreSegment(best.segment);
+        if (best.score <= 0) {
+            continue;
+        }
+        if (!candidates.empty() && best.score < candidates.top().score) {
+            candidates.push(best);
+            continue;
+        }
+        chosen.push_back(best.segment);
+        for (int i = 0; i + KMER_SIZE <= SEGMENT_SIZE; i++) {
+            kmerFrequencies.erase(HashKmer(best.segment + i));
+        }
+    }
+
+    //closest to the packet is cheapest to point at, so the best segments go last
+    std::vector<char> content;
+    for (auto it = chosen.rbegin(); it != chosen.rend(); ++it) {
+        content.insert(content.end(), *it, *it + SEGMENT_SIZE);
+    }
+    SnapshotDictionary dictionary;
+    dictionary.SetContent(content.data(), (int)content.size());
+    return dictionary;
+}
+
+struct CompressionReport {
+    int packetCount = 0;
+    int64_t originalBytes = 0;
+    int64_t compressedBytes = 0;
+    double compressSeconds = 0.0;
+    double decompressSeconds = 0.0;
+    int failedCount = 0;
+};
+
+//Packets that would not shrink count at their own size, as they would be sent.
+CompressionReport MeasureCompression(const std::vector<SnapshotSample>& samples, bool isDeltaFrame, const SnapshotDictionary* dictionary) {
+    SnapshotCodec codec;
+    codec.SetDictionary(dictionary);
+    std::vector<char> compressed(SNAPSHOT_MAX_PAYLOAD_SIZE);
+    std::vector<char> decompressed(SNAPSHOT_MAX_PAYLOAD_SIZE);
+
+    CompressionReport report;
+    for (const SnapshotSample& sample : samples) {
+        if (sample.isDeltaFrame != isDeltaFrame) {
+            continue;
+        }
+        const int originalSize = (int)sample.payload.size();
+        const auto compressStart = std::chrono::steady_clock::now();
+        const int compressedSize = codec.Compress(sample.payload.data(), originalSize, compressed.data(), SNAPSHOT_MAX_PAYLOAD_SIZE);
+        const auto compressEnd = std::chrono::steady_clock::now();
+        report.compressSeconds += std::chrono::duration<double>(compressEnd - compressStart).count();
+        report.packetCount++;
+        report.originalBytes += originalSize;
+
+        if (compressedSize < 0) {
+            report.compressedBytes += originalSize;
+            continue;
+        }
+        report.compressedBytes += compressedSize;
+
+        const auto decompressStart = std::chrono::steady_clock::now();
+        const int decompressedSize = codec.Decompress(compressed.data(), compressedSize, decompressed.data(), SNAPSHOT_MAX_PAYLOAD_SIZE);
+        const auto decompressEnd = std::chrono::steady_clock::now();
+        report.decompressSeconds += std::chrono::duration<double>(decompressEnd - decompressStart).count();
+        if (decompressedSize != originalSize || memcmp(decompressed.data(), sample.payload.data(), originalSize) != 0) {
+            report.failedCount++;
+        }
+    }
+    return report;
+}
+
+void WriteCompressionReport(const std::string& prefix, const CompressionReport& report) {
+    const int packetCount = std::max(report.packetCount, 1);
+    std::cout << prefix << "_packets " << report.packetCount << "\n";
+    std::cout << prefix << "_bytes_avg " << (float)report.originalBytes / packetCount << "\n";
+    std::cout << prefix << "_compressed_bytes_avg " << (float)report.compressedBytes / packetCount << "\n";
+    std::cout << prefix << "_ratio " << (report.originalBytes > 0 ? (float)report.compressedBytes / report.originalBytes : 1.0f) << "\n";
+    std::cout << prefix << "_compress_us_avg " << report.compressSeconds * 1e6 / packetCount << "\n";
+    std::cout << prefix << "_decompress_us_avg " << report.decompressSeconds * 1e6 / packetCount << "\n";
+    std::cout << prefix << "_verify_failures " << report.failedCount << "\n";
+}
+
+int RunTrain(const std::string& outputPath, const std::vector<std::string>& replayPaths, int dictionarySize) {
+    std::vector<SnapshotSample> samples;
+    if (!LoadSnapshotSamples(replayPaths, samples)) {
+        return 1;
+    }
+    if (samples.empty()) {
+        std::cout << "The replays have no snapshots to train on\n";
+        return 1;
+    }
+    const SnapshotDictionary dictionary = TrainDictionary(samples, dictionarySize);
+    if (!dictionary.SaveToFile(outputPath)) {
+        std::cout << "Dictionary " << outputPath << " could not be written\n";
+        return 1;
+    }
+    std::cout << "Trained a " << dictionary.GetContent().size() << " byte dictionary from " << samples.size() << " snapshot(s), id " << dictionary.GetId() << "\n";
+    return 0;
+}
+
+int RunReport(const std::string& dictionaryPath, const std::vector<std::string>& replayPaths) {
+    SnapshotDictionary dictionary;
+    if (!dictionary.LoadFromFile(dictionaryPath)) {
+        std::cout << "Dictionary " << dictionaryPath << " could not be loaded\n";
+        return 1;
+    }
+    std::vector<SnapshotSample> samples;
+    if (!LoadSnapshotSamples(replayPaths, samples)) {
+        return 1;
+    }
+
+    int failedCount = 0;
+    for (bool isDeltaFrame : { false, true }) {
+        const std::string frameType = isDeltaFrame ? "delta" : "full";
+        const CompressionReport withoutDictionary = MeasureCompression(samples, isDeltaFrame, nullptr);
+        const CompressionReport withDictionary = MeasureCompression(samples, isDeltaFrame, &dictionary);
+        WriteCompressionReport(frameType + "_nodict", withoutDictionary);
+        WriteCompressionReport(frameType + "_dict", withDictionary);
+        failedCount += withoutDictionary.failedCount + withDictionary.failedCount;
+    }
+    return failedCount > 0 ? 1 : 0;
+}
+
+struct QuantizeSample {
+    Maths::Vector3 position;
+    Maths::Quaternion orientation;
+};
+
+//Corners of the bounds and orientations at the edges of the smallest three encoding, then random transforms.
+std::vector<QuantizeSample> MakeQuantizeSamples(int count, unsigned int seed) {
+    std::vector<QuantizeSample> samples;
+    const Maths::Vector3 centre = (QUANTIZE_BOUNDS_MIN + QUANTIZE_BOUNDS_MAX) * 0.5f;
+    const Maths::Quaternion edgeOrientations[] = {
+        Maths::Quaternion(0.0f, 0.0f, 0.0f, 1.0f),
+        Maths::Quaternion(0.0f, 0.0f, 0.0f, -1.0f),
+        Maths::Quaternion(0.0f, 1.0f, 0.0f, 0.0f),
+        Maths::Quaternion(1.0f, 0.0f, 0.0f, 0.0f),
+        Maths::Quaternion(0.5f, 0.5f, 0.5f, 0.5f),
+        Maths::Quaternion(0.5f, -0.5f, 0.5f, -0.5f),
+        Maths::Quaternion(0.70710678f, 0.70710678f, 0.0f, 0.0f),
+        Maths::Quaternion(0.0f, 0.70710678f, 0.0f, -0.70710678f),
+        Maths::Quaternion(0.5f, 0.5f, 0.5f, 0.50001f).Normalised()
+    };
+    for (int corner = 0; corner < 8; corner++) {
+        const Maths::Vector3 position(corner & 1 ? QUANTIZE_BOUNDS_MAX.x : QUANTIZE_BOUNDS_MIN.x,
+            corner & 2 ? QUANTIZE_BOUNDS_MAX.y : QUANTIZE_BOUNDS_MIN.y,
+            corner & 4 ? QUANTIZE_BOUNDS_MAX.z : QUANTIZE_BOUNDS_MIN.z);
+        samples.push_back({ position, Maths::Quaternion(0.0f, 0.0f, 0.0f, 1.0f) });
+    }
+    for (const Maths::Quaternion& orientation : edgeOrientations) {
+        samples.push_back({ centre, orientation });
+    }
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> gaussian(0.0f, 1.0f);
+    while ((int)samples.size() < count) {
+        const Maths::Vector3 position(QUANTIZE_BOUNDS_MIN.x + unit(random) * (QUANTIZE_BOUNDS_MAX.x - QUANTIZE_BOUNDS_MIN.x),
+            QUANTIZE_BOUNDS_MIN.y + unit(random) * (QUANTIZE_BOUNDS_MAX.y - QUANTIZE_BOUNDS_MIN.y),
+            QUANTIZE_BOUNDS_MIN.z + unit(random) * (QUANTIZE_BOUNDS_MAX.z - QUANTIZE_BOUNDS_MIN.z));
+        //four gaussians normalised are uniform over the rotations
+        Maths::Quaternion orientation(gaussian(random), gaussian(random), gaussian(random), gaussian(random));
+        if (Maths::Quaternion::Dot(orientation, orientation) < 1e-6f) {
+            continue;
+        }
+        samples.push_back({ position, orientation.Normalised() });
+    }
+    return samples;
+}
+
+struct QuantizeReport {
+    float maxPositionError = 0.0f;
+    //Only the three components sent, the dropped one is rebuilt from them and errs by more.
+    float maxOrientationError = 0.0f;
+    float maxRebuiltComponentError = 0.0f;
+    int errorFailures = 0;
+    int roundTripFailures = 0;
+};
+
+void MeasureQuantizeError(const NetworkQuantizer& quantizer, const QuantizeSample& sample, const QuantizedTransform& quantized, QuantizeReport& report) {
+    const Maths::Vector3 position = quantizer.DequantizePosition(quantized);
+    float positionError = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+        positionError = std::max(positionError, std::abs(position[axis] - sample.position[axis]));
+    }
+
+    //q and -q are the same rotation, compare against whichever the encoding picked
+    Maths::Quaternion orientation = quantizer.DequantizeOrientation(quantized);
+    if (Maths::Quaternion::Dot(orientation, sample.orientation) < 0.0f) {
+        orientation = orientation * -1.0f;
+    }
+    float orientationError = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        const float error = std::abs(orientation[i] - sample.orientation[i]);
+        if (i == (int)quantized.largestComponent) {
+            report.maxRebuiltComponentError = std::max(report.maxRebuiltComponentError, error);
+        }
+        else {
+            orientationError = std::max(orientationError, error);
+        }
+    }
+
+    report.maxPositionError = std::max(report.maxPositionError, positionError);
+    report.maxOrientationError = std::max(report.maxOrientationError, orientationError);
+    if (positionError > quantizer.GetMaxPositionError() + POSITION_TOLERANCE ||
+        orientationError > quantizer.GetMaxOrientationComponentError() + ORIENTATION_TOLERANCE) {
+        report.errorFailures++;
+    }
+}
+
+//Encodes known transforms in full and as deltas from a nearby base, reads them back and checks nothing is lost
+//beyond the quantisation, which has to stay within half a step of where the transform was.
+int RunQuantize(int count, unsigned int seed) {
+    NetworkQuantizer quantizer;
+    quantizer.SetBounds(QUANTIZE_BOUNDS_MIN, QUANTIZE_BOUNDS_MAX);
+    const std::vector<QuantizeSample> samples = MakeQuantizeSamples(count, seed);
+    const int sampleCount = (int)samples.size();
+
+    std::vector<QuantizedTransform> quantized;
+    std::vector<QuantizedTransform> bases;
+    const Maths::Vector3 moves[] = { Maths::Vector3(1, 0, 0), Maths::Vector3(0, 1, 0), Maths::Vector3(0, 0, 1) };
+    for (int i = 0; i < sampleCount; i++) {
+        const QuantizeSample& sample = samples[i];
+        quantized.push_back(quantizer.Quantize(sample.position, sample.orientation));
+        const Maths::Quaternion turn = Maths::Quaternion::AxisAngleToQuaterion(moves[i % 3], DELTA_TURN_DEGREES);
+        bases.push_back(quantizer.Quantize(sample.position - moves[i % 3] * DELTA_MOVE_DISTANCE, (turn * sample.orientation).Normalised()));
+    }
+
+    const int fullCapacity = sampleCount * (quantizer.GetFullStateBits() / 8 + 1);
+    const int deltaCapacity = sampleCount * (quantizer.GetMaxDeltaStateBits() / 8 + 1);
+    std::vector<char> fullBuffer(fullCapacity);
+    std::vector<char> deltaBuffer(deltaCapacity);
+    BitStream fullWriter = BitStream::ForWriting(fullBuffer.data(), fullCapacity);
+    BitStream deltaWriter = BitStream::ForWriting(deltaBuffer.data(), deltaCapacity);
+    for (int i = 0; i < sampleCount; i++) {
+        quantizer.WriteFullPosition(fullWriter, quantized[i]);
+        quantizer.WriteFullOrientation(fullWriter, quantized[i]);
+        quantizer.WritePositionDelta(deltaWriter, bases[i], quantized[i]);
+        quantizer.WriteOrientationDelta(deltaWriter, bases[i], quantized[i]);
+    }
+    const int fullBytes = fullWriter.Flush();
+    const int deltaBytes = deltaWriter.Flush();
+
+    QuantizeReport report;
+    BitStream fullReader = BitStream::ForReading(fullBuffer.data(), fullBytes);
+    BitStream deltaReader = BitStream::ForReading(deltaBuffer.data(), deltaBytes);
+    for (int i = 0; i < sampleCount; i++) {
+        QuantizedTransform fromFull;
+        quantizer.ReadFullPosition(fullReader, fromFull);
+        quantizer.ReadFullOrientation(fullReader, fromFull);
+        QuantizedTransform fromDelta;
+        quantizer.ReadPositionDelta(deltaReader, bases[i], fromDelta);
+        quantizer.ReadOrientationDelta(deltaReader, bases[i], fromDelta);
+        if (!fromFull.PositionEquals(quantized[i]) || !fromFull.OrientationEquals(quantized[i]) ||
+            !fromDelta.PositionEquals(quantized[i]) || !fromDelta.OrientationEquals(quantized[i])) {
+            report.roundTripFailures++;
+        }
+        MeasureQuantizeError(quantizer, samples[i], fromFull, report);
+    }
+    if (fullWriter.HasOverflowed() || deltaWriter.HasOverflowed() || fullReader.HasOverflowed() || deltaReader.HasOverflowed()) {
+        std::cout << "The quantized transforms overflowed their buffers\n";
+        return 1;
+    }
+
+    std::cout << "quantize_objects " << sampleCount << "\n";
+    std::cout << "quantize_pos_error_max " << report.maxPositionError << "\n";
+    std::cout << "quantize_pos_error_bound " << quantizer.GetMaxPositionError() << "\n";
+    std::cout << "quantize_rot_error_max " << report.maxOrientationError << "\n";
+    std::cout << "quantize_rot_error_bound " << quantizer.GetMaxOrientationComponentError() << "\n";
+    std::cout << "quantize_rot_rebuilt_error_max " << report.maxRebuiltComponentError << "\n";
+    std::cout << "quantize_full_bytes_per_object " << (float)fullBytes / sampleCount << "\n";
+    std::cout << "quantize_delta_bytes_per_object " << (float)deltaBytes / sampleCount << "\n";
+    std::cout << "quantize_error_failures " << report.errorFailures << "\n";
+    std::cout << "quantize_round_trip_failures " << report.roundTripFailures << "\n";
+    return report.errorFailures + report.roundTripFailures > 0 ? 1 : 0;
+}
+
+int RunSnapshotTool(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "quantize") == 0) {
+        int count = 10000;
+        unsigned int seed = 1;
+        for (int i = 2; i + 1 < argc; i++) {
+            if (strcmp(argv[i], "--count") == 0) {
+                count = std::max(atoi(argv[++i]), 1);
+            }
+            else if (strcmp(argv[i], "--seed") == 0) {
+                seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+            }
+        }
+        return RunQuantize(count, seed);
+    }
+    if (argc < 4 || (strcmp(argv[1], "train") != 0 && strcmp(argv[1], "report") != 0)) {
+        std::cout << "Usage: train <out.dict> <replays...> [--size bytes]\n";
+        std::cout << "       report <dictionary> <replays...>\n";
+        std::cout << "       quantize [--count objects] [--seed seed]\n";
+        return 1;
+    }
+
+    int dictionarySize = SnapshotDictionary::MAX_SIZE;
+    std::vector<std::string> replayPaths;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            dictionarySize = std::clamp(atoi(argv[++i]), SEGMENT_SIZE, SnapshotDictionary::MAX_SIZE);
+        }
+        else {
+            replayPaths.push_back(argv[i]);
+        }
+    }
+
+    if (strcmp(argv[1], "train") == 0) {
+        return RunTrain(argv[2], replayPaths, dictionarySize);
+    }
+    return RunReport(argv[2], replayPaths);
+}
@@ -103,7 +103,7 @@ void GlobalSuspicionMetre::HandleGlobalSusChangeNetworking(const int& changedVal
     if (!SceneManager::GetSceneManager()->IsInSingleplayer()) {
         const bool isServer = game->GetIsServer();
         if (isServer) {
-            game->SendClientSyncGlobalSusChangePacket(changedValue);
+            game->ReplicateGlobalSusChange(changedValue);
         }
     }
 #endif
@@ -11,15 +11,28 @@
 using namespace SuspicionSystem;
 
 void LocalSuspicionMetre::Init(){
-    for (int i = 0; i < NCL::CSC8503::MAX_PLAYERS; i++)
+    for (int i = 0; i < mPlayerCount; i++)
     {
-        mPlayerMeters[i] = 0;
-        mRecoveryCooldowns[i] = DT_UNTIL_LOCAL_RECOVERY;
-        mActiveLocalSusCauseVector[i].clear();
-        mActiveLocalSusCausesToRemove[i].clear();
+        ClearPlayer(i);
     }
 }
 
+void LocalSuspicionMetre::SetPlayerCount(int playerCount){
+    playerCount = std::clamp(playerCount, 1, NCL::CSC8503::MAX_PLAYER_SLOTS);
+    for (int i = mPlayerCount; i < playerCount; i++)
+    {
+        ClearPlayer(i);
+    }
+    mPlayerCount = playerCount;
+}
+
+void LocalSuspicionMetre::ClearPlayer(int playerNo){
+    mPlayerMeters[playerNo] = 0;
+    mRecoveryCooldowns[playerNo] = DT_UNTIL_LOCAL_RECOVERY;
+    mActiveLocalSusCauseVector[playerNo].clear();
+    mActiveLocalSusCausesToRemove[playerNo].clear();
+}
+
 void LocalSuspicionMetre::AddInstantLocalSusCause(const instantLocalSusCause &inCause, const int &playerNo){
     const float guardDist = LevelManager::GetLevelManager()->GetNearestGuardToPlayerDistance(playerNo);
     const float guardDistPerc = GetPercentageBasedOnDistance(guardDist);
@@ -86,7 +99,7 @@ void LocalSuspicionMetre::HandleActiveSusCauseNetworking(const activeLocalSusCau
 
 
 void LocalSuspicionMetre::UpdateGlobalSuspicionObserver(SuspicionMetre::SusBreakpoint susBreakpoint){
-    for (int i = 0; i < NCL::CSC8503::MAX_PLAYERS; i++)
+    for (int i = 0; i < mPlayerCount; i++)
     {
         ChangePlayerLocalSusMetre(i, 0);
         HandleLocalSusChangeNetworking(mPlayerMeters[i], i);
@@ -111,7 +124,7 @@ void LocalSuspicionMetre::UpdatePlayerBuffsObserver(const BuffEvent buffEvent, c
 }
 
 void LocalSuspicionMetre::Update(float dt) {
-    for (int playerNo = 0; playerNo < NCL::CSC8503::MAX_PLAYERS; playerNo++)
+    for (int playerNo = 0; playerNo < mPlayerCount; playerNo++)
     {
         if (GetLocalSusMetreValue(playerNo) != 0.0f ||
             mActiveLocalSusCauseVector[playerNo].size() > 0) {
@@ -136,16 +149,15 @@ void LocalSuspicionMetre::Update(float dt) {
                 mRecoveryCooldowns[playerNo] = DT_UNTIL_LOCAL_RECOVERY;
             }
 
-            if ((int)(tempSusAmount) != 0)
-                HandleLocalSusChangeNetworking(mPlayerMeters[playerNo], playerNo);
+            HandleLocalSusChangeNetworking(mPlayerMeters[playerNo], playerNo);
         }
 
         for(const activeLocalSusCause activeSusCause:mActiveLocalSusCausesToRemove[playerNo])
             mActiveLocalSusCauseVector[playerNo].erase(std::remove(
             mActiveLocalSusCauseVector[playerNo].begin(), mActiveLocalSusCauseVector[playerNo].end(), activeSusCause),
             mActiveLocalSusCauseVector[playerNo].end());
+        mActiveLocalSusCausesToRemove[playerNo].clear();
     }
-    mActiveLocalSusCausesToRemove->clear();
 }
 
 void LocalSuspicionMetre::SyncActiveSusCauses(int playerID, int localPlayerID, activeLocalSusCause inCause, bool toApply){
@@ -169,12 +181,11 @@ void LocalSuspicionMetre::HandleLocalSusChangeNetworking(const int& changedValue
     int localPlayerId = 0;
     DebugNetworkedGame* game = reinterpret_cast<DebugNetworkedGame*>(SceneManager::GetSceneManager()->GetCurrentScene());
     if (!SceneManager::GetSceneManager()->IsInSingleplayer()) {
-        const auto* localPlayer = game->GetLocalPlayer();
-        localPlayerId = localPlayer->GetPlayerID();
+        localPlayerId = game->GetLocalPlayerID();
 
         const bool isServer = game->GetIsServer();
         if (isServer) {
-            game->SendClientSyncLocalSusChangePacket(playerNo, changedValue);
+            game->ReplicateLocalSusChange(playerNo, changedValue);
         }
     }
 #endif
@@ -31,6 +31,8 @@ namespace SuspicionSystem
         }
 
         void Init();
+        //Slots the match numbers its players by, nothing past them is updated. Slots coming into use start clear.
+        void SetPlayerCount(int playerCount);
 
         void AddInstantLocalSusCause(const instantLocalSusCause &inCause, const int &playerNo);
 
@@ -54,6 +56,9 @@ namespace SuspicionSystem
         void Update(float dt);
         void SyncActiveSusCauses(int playerID, int localPlayerID, activeLocalSusCause buffToSync, bool toApply);
         void SyncSusChange(int playerID, int localPlayerID, int changedValue);
+        const std::vector<activeLocalSusCause>& GetActiveSusCauses(const int playerNo) const {
+            return mActiveLocalSusCauseVector[playerNo];
+        }
     private:
         std::map<const instantLocalSusCause, const float>  mInstantLocalSusCauseSeverityMap =
         {
@@ -65,12 +70,15 @@ namespace SuspicionSystem
             {guardsLOS, 3}, {cameraLOS, 3}, {disguiseBuff, -20}, {playerWalk,3}, {playerSprint,9}, {passiveRecovery,-10}
         };
 
-        float mPlayerMeters[NCL::CSC8503::MAX_PLAYERS];
-        float mRecoveryCooldowns[NCL::CSC8503::MAX_PLAYERS];
+        float mPlayerMeters[NCL::CSC8503::MAX_PLAYER_SLOTS];
+        float mRecoveryCooldowns[NCL::CSC8503::MAX_PLAYER_SLOTS];
         GlobalSuspicionMetre* mGlobalSusMeterPTR = nullptr;
 
-        std::vector<activeLocalSusCause> mActiveLocalSusCauseVector[NCL::CSC8503::MAX_PLAYERS];
-        std::vector<activeLocalSusCause> mActiveLocalSusCausesToRemove[NCL::CSC8503::MAX_PLAYERS];
+        std::vector<activeLocalSusCause> mActiveLocalSusCauseVector[NCL::CSC8503::MAX_PLAYER_SLOTS];
+        std::vector<activeLocalSusCause> mActiveLocalSusCausesToRemove[NCL::CSC8503::MAX_PLAYER_SLOTS];
+        int mPlayerCount = NCL::CSC8503::MAX_PLAYER_SLOTS;
+
+        void ClearPlayer(int playerNo);
 
         void ChangePlayerLocalSusMetre(const int &playerNo, const float &ammount);
         void HandleActiveSusCauseNetworking(const activeLocalSusCause& inCause, const int& playerNo, const bool& toApply);
@@ -272,7 +272,7 @@ void LocationBasedSuspicion::HandleSusChangeNetworking(const int& changedValue,
 	if (!SceneManager::GetSceneManager()->IsInSingleplayer()) {
 		const bool isServer = game->GetIsServer();
 		if (isServer) {
-			game->SendClientSyncLocationSusChangePacket(pairedLocation, changedValue);
+			game->ReplicateLocationSusChange(pairedLocation, changedValue);
 		}
 		else{
 			game->GetClient()->WriteAndSendSyncLocationSusChangePacket(pairedLocation, changedValue);
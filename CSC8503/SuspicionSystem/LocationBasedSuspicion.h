@@ -103,6 +103,9 @@ namespace SuspicionSystem
         void SyncActiveSusCauses(const activeLocationSusCause& inCause, const int& pairedLocation, const bool& toApply);
         void SyncSusChange(const int& pairedLocation, const int& changedValue);
         void RemoveSusLocation(const Vector3 pos);
+        const std::map<CantorPair, std::vector<activeLocationSusCause>>& GetActiveSusCauses() const {
+            return mActiveLocationSusCauseMap;
+        }
 
     private:
 
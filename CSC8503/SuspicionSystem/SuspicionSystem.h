@@ -37,6 +37,11 @@ namespace SuspicionSystem
 			mLocationBasedSuspicionPtr->Update(dt);
 		}
 
+		void SetPlayerCount(int playerCount)
+		{
+			mLocalSuspicionMetrePtr->SetPlayerCount(playerCount);
+		}
+
 		~SuspicionSystemClass() {
 			mInventoryBuffSystemClassPtr->GetPlayerBuffsPtr()->Detach(mLocalSuspicionMetrePtr);
 			delete mLocalSuspicionMetrePtr;
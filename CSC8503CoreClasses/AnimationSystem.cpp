@@ -44,7 +44,6 @@ void AnimationSystem::UpdateAllAnimationObjects(float dt, vector<GameObject*> up
 				mAnim = animObj->GetAnimation();
 
 				const Matrix4* invBindPose = mMesh->GetInverseBindPose().data();
-				const Matrix4* frameData = mAnim->GetJointData(currentFrame);
 
 				const int* bindPoseIndices = mMesh->GetBindPoseIndices();
 				std::vector<std::vector<Matrix4>> frameMatricesVec;
@@ -58,7 +57,7 @@ void AnimationSystem::UpdateAllAnimationObjects(float dt, vector<GameObject*> up
 					vector<Matrix4> frameMatrices;
 					for (unsigned int i = 0; i < pose.count; ++i) {
 						int jointID = bindPoseIndices[pose.start + i];
-						Matrix4 mat = frameData[jointID] * invBindPose[pose.start + i];
+						Matrix4 mat = mAnim->GetJointMatrix(currentFrame, jointID) * invBindPose[pose.start + i];
 						frameMatrices.emplace_back(mat);
 					}
 					frameMatricesVec.emplace_back(frameMatrices);
@@ -94,6 +93,11 @@ void AnimationSystem::SetGameObjectLists(vector<GameObject*> updatableObjects) {
 	}
 }
 
+void AnimationSystem::AddPlayerObject(PlayerObject* player) {
+	mPlayerList.emplace_back(player);
+	mAnimationList.emplace_back(player->GetRenderObject()->GetAnimationObject());
+}
+
 void AnimationSystem::SetAnimationState(GameObject* gameObject, GameObject::GameObjectState objState) {
 	gameObject->GetRenderObject()->GetAnimationObject()->ReSetCurrentFrame();
 
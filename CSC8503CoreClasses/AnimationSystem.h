@@ -43,6 +43,8 @@ namespace NCL {
 			void UpdateAnimations(std::map<std::string, MeshAnimation*> preAnimationList);
 
 			void SetGameObjectLists(vector<GameObject*> UpdatableObjects);
+			//For a player that joins after the lists were set.
+			void AddPlayerObject(PlayerObject* player);
 
 			void SetAnimationState(GameObject* gameObject, GameObject::GameObjectState objState);
 
@@ -0,0 +1,194 @@
+#ifdef USEGL
+#include "BitStream.h"
+
+#include <cstring>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	constexpr int VARINT_GROUP_BITS = 7;
+	constexpr uint32_t VARINT_GROUP_MASK = (1u << VARINT_GROUP_BITS) - 1;
+	//A 32 bit value never needs more than 5 groups, anything longer is a corrupt packet.
+	constexpr int VARINT_MAX_GROUPS = 5;
+}
+
+BitStream BitStream::ForWriting(char* buffer, int capacityBytes) {
+	return BitStream(buffer, capacityBytes, true);
+}
+
+BitStream BitStream::ForReading(const char* buffer, int sizeBytes) {
+	return BitStream(const_cast<char*>(buffer), sizeBytes, false);
+}
+
+BitStream::BitStream(char* buffer, int sizeBytes, bool isWriting) {
+	mBuffer = buffer;
+	mSizeBytes = sizeBytes;
+	mBytePos = 0;
+	mBitsProcessed = 0;
+	mScratch = 0;
+	mScratchBits = 0;
+	mIsWriting = isWriting;
+	mHasOverflowed = false;
+}
+
+bool BitStream::CanWrite(int bits) const {
+	return mBitsProcessed + bits <= mSizeBytes * 8;
+}
+
+int BitStream::GetBitsRemaining() const {
+	return mSizeBytes * 8 - mBitsProcessed;
+}
+
+void BitStream::WriteBits(uint32_t value, int bits) {
+	if (!CanWrite(bits)) {
+		mHasOverflowed = true;
+		return;
+	}
+	const uint64_t mask = (bits == 32) ? 0xFFFFFFFFull : ((1ull << bits) - 1);
+	mScratch |= ((uint64_t)value & mask) << mScratchBits;
+	mScratchBits += bits;
+	mBitsProcessed += bits;
+
+	while (mScratchBits >= 8) {
+		mBuffer[mBytePos++] = (char)(mScratch & 0xFF);
+		mScratch >>= 8;
+		mScratchBits -= 8;
+	}
+}
+
+uint32_t BitStream::ReadBits(int bits) {
+	if (!CanWrite(bits)) {
+		mHasOverflowed = true;
+		return 0;
+	}
+	while (mScratchBits < bits) {
+		mScratch |= (uint64_t)(uint8_t)mBuffer[mBytePos++] << mScratchBits;
+		mScratchBits += 8;
+	}
+	const uint64_t mask = (bits == 32) ? 0xFFFFFFFFull : ((1ull << bits) - 1);
+	const uint32_t value = (uint32_t)(mScratch & mask);
+	mScratch >>= bits;
+	mScratchBits -= bits;
+	mBitsProcessed += bits;
+	return value;
+}
+
+void BitStream::WriteFloat(float value) {
+	uint32_t asInt;
+	memcpy(&asInt, &value, sizeof(float));
+	WriteBits(asInt, 32);
+}
+
+float BitStream::ReadFloat() {
+	const uint32_t asInt = ReadBits(32);
+	float value;
+	memcpy(&value, &asInt, sizeof(float));
+	return value;
+}
+
+void BitStream::WriteVarUInt(uint32_t value) {
+	while (value > VARINT_GROUP_MASK) {
+		WriteBits((value & VARINT_GROUP_MASK) | (VARINT_GROUP_MASK + 1), VARINT_GROUP_BITS + 1);
+		value >>= VARINT_GROUP_BITS;
+	}
+	WriteBits(value, VARINT_GROUP_BITS + 1);
+}
+
+uint32_t BitStream::ReadVarUInt() {
+	uint32_t value = 0;
+	for (int i = 0; i < VARINT_MAX_GROUPS; i++) {
+		const uint32_t group = ReadBits(VARINT_GROUP_BITS + 1);
+		value |= (group & VARINT_GROUP_MASK) << (i * VARINT_GROUP_BITS);
+		if ((group & (VARINT_GROUP_MASK + 1)) == 0 || mHasOverflowed) {
+			return value;
+		}
+	}
+	mHasOverflowed = true;
+	return 0;
+}
+
+void BitStream::WriteVarInt(int value) {
+	WriteVarUInt(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+int BitStream::ReadVarInt() {
+	const uint32_t zigzag = ReadVarUInt();
+	return (int)(zigzag >> 1) ^ -(int)(zigzag & 1);
+}
+
+void BitStream::WriteString(const std::string& value, int maxLength) {
+	const int length = std::min((int)value.length(), maxLength);
+	WriteVarUInt(length);
+	for (int i = 0; i < length; i++) {
+		WriteBits((uint8_t)value[i], 8);
+	}
+}
+
+std::string BitStream::ReadString(int maxLength) {
+	const uint32_t length = ReadVarUInt();
+	if (length > (uint32_t)maxLength || !CanWrite(length * 8)) {
+		mHasOverflowed = true;
+		return std::string();
+	}
+	std::string value(length, '\0');
+	for (uint32_t i = 0; i < length; i++) {
+		value[i] = (char)ReadBits(8);
+	}
+	return value;
+}
+
+void BitStream::SerializeBits(int& value, int bits) {
+	if (mIsWriting) {
+		WriteBits((uint32_t)value, bits);
+	}
+	else {
+		value = (int)ReadBits(bits);
+	}
+}
+
+void BitStream::SerializeBool(bool& value) {
+	if (mIsWriting) {
+		WriteBool(value);
+	}
+	else {
+		value = ReadBool();
+	}
+}
+
+void BitStream::SerializeFloat(float& value) {
+	if (mIsWriting) {
+		WriteFloat(value);
+	}
+	else {
+		value = ReadFloat();
+	}
+}
+
+void BitStream::SerializeVarInt(int& value) {
+	if (mIsWriting) {
+		WriteVarInt(value);
+	}
+	else {
+		value = ReadVarInt();
+	}
+}
+
+void BitStream::SerializeString(std::string& value, int maxLength) {
+	if (mIsWriting) {
+		WriteString(value, maxLength);
+	}
+	else {
+		value = ReadString(maxLength);
+	}
+}
+
+int BitStream::Flush() {
+	if (mIsWriting && mScratchBits > 0) {
+		mBuffer[mBytePos++] = (char)(mScratch & 0xFF);
+		mScratch = 0;
+		mScratchBits = 0;
+	}
+	return mIsWriting ? mBytePos : (mBitsProcessed + 7) / 8;
+}
+#endif
@@ -0,0 +1,69 @@
+#ifdef USEGL
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace NCL::CSC8503 {
+	// Packs values into a byte buffer at bit granularity, least significant bit first.
+	// The same class reads back what it wrote so that packet layouts only need describing once.
+	class BitStream {
+	public:
+		static BitStream ForWriting(char* buffer, int capacityBytes);
+		static BitStream ForReading(const char* buffer, int sizeBytes);
+
+		bool IsWriting() const { return mIsWriting; }
+		bool IsReading() const { return !mIsWriting; }
+		bool HasOverflowed() const { return mHasOverflowed; }
+		//For values read in range of the stream but out of range for the packet, HasOverflowed then reports it.
+		void Invalidate() { mHasOverflowed = true; }
+
+		bool CanWrite(int bits) const;
+		int GetBitsRemaining() const;
+
+		void WriteBits(uint32_t value, int bits);
+		uint32_t ReadBits(int bits);
+
+		void WriteBool(bool value) { WriteBits(value ? 1 : 0, 1); }
+		bool ReadBool() { return ReadBits(1) != 0; }
+
+		void WriteFloat(float value);
+		float ReadFloat();
+
+		//7 bits per byte with a continuation bit, small values take a single byte.
+		void WriteVarUInt(uint32_t value);
+		uint32_t ReadVarUInt();
+		//Zigzag encoded so small negative values stay small.
+		void WriteVarInt(int value);
+		int ReadVarInt();
+
+		//Length prefixed, longer strings are cut to maxLength on write and rejected on read.
+		void WriteString(const std::string& value, int maxLength);
+		std::string ReadString(int maxLength);
+
+		//Write or read depending on the stream, so a packet describes its layout once in Serialize.
+		void SerializeBits(int& value, int bits);
+		void SerializeBool(bool& value);
+		void SerializeFloat(float& value);
+		void SerializeVarInt(int& value);
+		void SerializeString(std::string& value, int maxLength);
+
+		//Writes any bits still held in the scratch word, returns bytes used in the buffer.
+		int Flush();
+		int GetBitsProcessed() const { return mBitsProcessed; }
+
+	protected:
+		BitStream(char* buffer, int sizeBytes, bool isWriting);
+
+		char* mBuffer;
+		int mSizeBytes;
+		int mBytePos;
+		int mBitsProcessed;
+
+		uint64_t mScratch;
+		int mScratchBits;
+
+		bool mIsWriting;
+		bool mHasOverflowed;
+	};
+}
+#endif
@@ -74,8 +74,14 @@ function(Create_CSC8503CoreClasses_Files_PS5)
     set(Level_Creation
         "JsonParser.h"
         "JsonParser.cpp"
+        "JsonReader.h"
+        "JsonReader.cpp"
         "Level.h"
         "Level.cpp"
+        "LevelReader.h"
+        "LevelReader.cpp"
+        "CookedLevel.h"
+        "CookedLevel.cpp"
         "LevelEnums.h"
         "LevelEnums.cpp"
         "Room.h"
@@ -112,12 +118,49 @@ function(Create_CSC8503CoreClasses_Files_PS5)
         "GameClient.cpp"
         "GameServer.h"
         "GameServer.cpp"
+        "SessionHost.h"
+        "SessionHost.cpp"
         "NetworkBase.h"
         "NetworkBase.cpp"
+        "NetworkTransport.h"
+        "EnetTransport.h"
+        "EnetTransport.cpp"
+        "LoopbackTransport.h"
+        "LoopbackTransport.cpp"
         "NetworkObject.h"
         "NetworkObject.cpp"
         "NetworkState.h"
         "NetworkState.cpp"
+        "NetworkStateHistory.h"
+        "NetworkStateHistory.cpp"
+        "BitStream.h"
+        "BitStream.cpp"
+        "SnapshotWriter.h"
+        "SnapshotWriter.cpp"
+        "SnapshotInterpolation.h"
+        "SnapshotInterpolation.cpp"
+        "InterestManager.h"
+        "InterestManager.cpp"
+        "NetworkQuantizer.h"
+        "NetworkQuantizer.cpp"
+        "MPSCRingBuffer.h"
+        "PacketSender.h"
+        "PacketSender.cpp"
+        "NetworkReceiver.h"
+        "NetworkReceiver.cpp"
+        "ReplayRecorder.h"
+        "ReplayRecorder.cpp"
+        "ReplayPlayer.h"
+        "ReplayPlayer.cpp"
+        "PacketPool.h"
+        "SnapshotCompression.h"
+        "SnapshotCompression.cpp"
+        "JoinState.h"
+        "JoinState.cpp"
+        "PacketSerializer.h"
+        "PacketSerializer.cpp"
+        "ReplicatedProperties.h"
+        "ReplicatedProperties.cpp"
     )
     source_group("Networking" FILES ${Networking})
 
@@ -0,0 +1,492 @@
+#include "CookedLevel.h"
+#include "AssetCache.h"
+#include "Level.h"
+#include "LevelReader.h"
+#include "MappedFile.h"
+#include "PointLight.h"
+#include "SpotLight.h"
+#include "PrisonDoor.h"
+#include "Vent.h"
+#include "InteractableDoor.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	//"CLVL" at the start of the file.
+	constexpr uint32_t COOKED_LEVEL_MAGIC = 0x4C564C43;
+
+	static_assert(std::endian::native == std::endian::little, "Cooked levels are little-endian and used in place");
+
+	struct CookedVector3 {
+		float x;
+		float y;
+		float z;
+	};
+
+	struct CookedTransform {
+		CookedVector3 position;
+		float orientation[4];
+	};
+
+	struct CookedTile {
+		CookedTransform transform;
+		int32_t type;
+	};
+
+	struct CookedRoomPlacement {
+		CookedVector3 position;
+		int32_t type;
+		int32_t doorConfig;
+		int32_t primaryDoor;
+	};
+
+	//A run of guardPathNodes.
+	struct CookedGuardPath {
+		uint32_t firstNode;
+		uint32_t nodeCount;
+	};
+
+	//Point and spot lights share one array so they come back in the order they were placed.
+	struct CookedLight {
+		int32_t type;
+		CookedVector3 position;
+		float colour[4];
+		CookedVector3 direction;
+		float radius;
+		float angle;
+	};
+
+	struct CookedVent {
+		CookedTransform transform;
+		int32_t connectedVentID;
+	};
+
+	struct CookedDecoration {
+		CookedTransform transform;
+		int32_t type;
+	};
+
+	struct CookedArray {
+		uint32_t offset;
+		uint32_t count;
+	};
+
+	struct CookedLevelHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t isRoom;
+		int32_t roomType;
+		int32_t doorConfig;
+		int32_t primaryDoor;
+		int32_t guardCount;
+		int32_t cctvCount;
+		CookedVector3 prisonPosition;
+		CookedVector3 helipadPosition;
+		uint32_t hasPrisonDoor;
+		CookedTransform prisonDoor;
+		CookedArray tiles;
+		CookedArray rooms;
+		CookedArray guardPaths;
+		CookedArray guardPathNodes;
+		CookedArray cctvTransforms;
+		CookedArray playerStarts;
+		CookedArray lights;
+		CookedArray itemPositions;
+		CookedArray vents;
+		CookedArray doors;
+		CookedArray decorations;
+	};
+	//every array element is a whole number of floats, so arrays written one after another stay aligned
+	static_assert(sizeof(CookedLevelHeader) == 176 && sizeof(CookedLevelHeader) % alignof(CookedLevelHeader) == 0, "Cooked level header layout changed, bump VERSION");
+
+	CookedVector3 ToCooked(const Vector3& vector) {
+		return { vector.x, vector.y, vector.z };
+	}
+
+	CookedTransform ToCooked(const Transform& transform) {
+		const Quaternion orientation = transform.GetOrientation();
+		return { ToCooked(transform.GetPosition()), { orientation.x, orientation.y, orientation.z, orientation.w } };
+	}
+
+	Vector3 ToVector3(const CookedVector3& cooked) {
+		return Vector3(cooked.x, cooked.y, cooked.z);
+	}
+
+	void SetTransform(Transform& transform, const CookedTransform& cooked) {
+		transform.SetPosition(ToVector3(cooked.position))
+			.SetOrientation(Quaternion(cooked.orientation[0], cooked.orientation[1], cooked.orientation[2], cooked.orientation[3]));
+	}
+
+	Transform ToTransform(const CookedTransform& cooked) {
+		Transform transform = Transform();
+		SetTransform(transform, cooked);
+		return transform;
+	}
+
+	template <typename T>
+	CookedArray AppendArray(std::vector<char>& blob, const std::vector<T>& elements) {
+		static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % sizeof(float) == 0);
+		const CookedArray array = { (uint32_t)blob.size(), (uint32_t)elements.size() };
+		const char* bytes = (const char*)elements.data();
+		blob.insert(blob.end(), bytes, bytes + elements.size() * sizeof(T));
+		return array;
+	}
+
+	//Null if the array runs off the end of the blob.
+	template <typename T>
+	const T* GetArray(const MappedFile& file, const CookedArray& array) {
+		if ((size_t)array.offset + (size_t)array.count * sizeof(T) > file.GetSize() || array.offset % alignof(T) != 0) {
+			return nullptr;
+		}
+		return (const T*)(file.GetData() + array.offset);
+	}
+
+	std::vector<CookedLight> CookLights(const std::vector<Light*>& lights) {
+		std::vector<CookedLight> cookedLights;
+		for (const Light* light : lights) {
+			const PointLight* pointLight = (const PointLight*)light;
+			const Vector4 colour = light->GetColour();
+			CookedLight cooked = {};
+			cooked.type = light->GetType();
+			cooked.position = ToCooked(pointLight->GetPosition());
+			cooked.colour[0] = colour.x;
+			cooked.colour[1] = colour.y;
+			cooked.colour[2] = colour.z;
+			cooked.colour[3] = colour.w;
+			cooked.radius = pointLight->GetRadius();
+			if (light->GetType() == Light::Spot) {
+				const SpotLight* spotLight = (const SpotLight*)light;
+				cooked.direction = ToCooked(spotLight->GetDirection());
+				cooked.angle = spotLight->GetAngle();
+			}
+			cookedLights.push_back(cooked);
+		}
+		return cookedLights;
+	}
+
+	void LoadLights(const CookedLight* cookedLights, uint32_t count, std::vector<Light*>& lights) {
+		for (uint32_t i = 0; i < count; i++) {
+			const CookedLight& cooked = cookedLights[i];
+			const Vector4 colour(cooked.colour[0], cooked.colour[1], cooked.colour[2], cooked.colour[3]);
+			if (cooked.type == Light::Spot) {
+				SpotLight* spotLight = new SpotLight(ToVector3(cooked.direction), ToVector3(cooked.position), colour, cooked.radius, cooked.angle, 1.0f);
+				//already normalised when it was cooked, normalising again can move the last bit
+				spotLight->SetDirection(ToVector3(cooked.direction));
+				lights.push_back((Light*)spotLight);
+			}
+			else {
+				lights.push_back((Light*)new PointLight(ToVector3(cooked.position), colour, cooked.radius));
+			}
+		}
+	}
+
+	template <typename T>
+	std::vector<CookedTransform> CookObjectTransforms(const std::vector<T*>& objects) {
+		std::vector<CookedTransform> transforms;
+		for (T* object : objects) {
+			transforms.push_back(ToCooked(object->GetTransform()));
+		}
+		return transforms;
+	}
+
+	bool IsSameTransform(const Transform& a, const Transform& b) {
+		return a.GetPosition() == b.GetPosition() && a.GetOrientation() == b.GetOrientation();
+	}
+
+	bool IsSameTransforms(const std::vector<Transform>& a, const std::vector<Transform>& b) {
+		return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), IsSameTransform);
+	}
+
+	bool IsSameLights(const std::vector<Light*>& a, const std::vector<Light*>& b) {
+		if (a.size() != b.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); i++) {
+			if (a[i]->GetType() != b[i]->GetType() || !(a[i]->GetColour() == b[i]->GetColour())) {
+				return false;
+			}
+			const PointLight* pointA = (const PointLight*)a[i];
+			const PointLight* pointB = (const PointLight*)b[i];
+			if (!(pointA->GetPosition() == pointB->GetPosition()) || pointA->GetRadius() != pointB->GetRadius()) {
+				return false;
+			}
+			if (a[i]->GetType() == Light::Spot) {
+				const SpotLight* spotA = (const SpotLight*)a[i];
+				const SpotLight* spotB = (const SpotLight*)b[i];
+				if (!(spotA->GetDirection() == spotB->GetDirection()) || spotA->GetAngle() != spotB->GetAngle()) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	template <typename T>
+	bool IsSameObjects(const std::vector<T*>& a, const std::vector<T*>& b) {
+		if (a.size() != b.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); i++) {
+			if (!IsSameTransform(a[i]->GetTransform(), b[i]->GetTransform())) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool IsSameDecorations(const std::unordered_map<DecorationType, std::vector<Transform>>& a, const std::unordered_map<DecorationType, std::vector<Transform>>& b) {
+		if (a.size() != b.size()) {
+			return false;
+		}
+		for (const auto& [type, transforms] : a) {
+			auto it = b.find(type);
+			if (it == b.end() || !IsSameTransforms(transforms, it->second)) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+std::string CookedLevel::GetCookedPath(const std::string& jsonPath) {
+	return AssetCache::GetArtifactPath(jsonPath, IMPORTER, VERSION);
+}
+
+bool CookedLevel::Cook(const std::string& jsonPath, bool isRoom) {
+	MappedFile json;
+	if (!json.Open(jsonPath)) {
+		return false;
+	}
+	Level level;
+	Room room;
+	LevelReader reader;
+	if (!reader.Read(json.GetData(), json.GetSize(), isRoom ? nullptr : &level, isRoom ? &room : nullptr)) {
+		return false;
+	}
+
+	CookedLevelHeader header = {};
+	header.magic = COOKED_LEVEL_MAGIC;
+	header.version = VERSION;
+	header.isRoom = isRoom ? 1 : 0;
+	std::vector<char> blob(sizeof(CookedLevelHeader));
+
+	//rooms have these too, with the same names
+	const std::unordered_map<Transform, TileType>& tileMap = isRoom ? room.mTileMap : level.mTileMap;
+	const std::vector<Transform>& cctvTransforms = isRoom ? room.mCCTVTransforms : level.mCCTVTransforms;
+	const std::vector<Light*>& lights = isRoom ? room.mLights : level.mLights;
+	const std::vector<Vector3>& itemPositions = isRoom ? room.mItemPositions : level.mItemPositions;
+	const std::vector<Door*>& doors = isRoom ? room.mDoors : level.mDoors;
+	const std::unordered_map<DecorationType, std::vector<Transform>>& decorationMap = isRoom ? room.mDecorationMap : level.mDecorationMap;
+
+	std::vector<CookedTile> tiles;
+	tiles.reserve(tileMap.size());
+	for (const auto& [transform, type] : tileMap) {
+		tiles.push_back({ ToCooked(transform), (int32_t)type });
+	}
+	header.tiles = AppendArray(blob, tiles);
+
+	std::vector<CookedTransform> cookedCCTVTransforms;
+	for (const Transform& transform : cctvTransforms) {
+		cookedCCTVTransforms.push_back(ToCooked(transform));
+	}
+	header.cctvTransforms = AppendArray(blob, cookedCCTVTransforms);
+	header.lights = AppendArray(blob, CookLights(lights));
+
+	std::vector<CookedVector3> cookedItemPositions;
+	for (const Vector3& position : itemPositions) {
+		cookedItemPositions.push_back(ToCooked(position));
+	}
+	header.itemPositions = AppendArray(blob, cookedItemPositions);
+	header.doors = AppendArray(blob, CookObjectTransforms(doors));
+
+	std::vector<CookedDecoration> decorations;
+	for (const auto& [type, transforms] : decorationMap) {
+		for (const Transform& transform : transforms) {
+			decorations.push_back({ ToCooked(transform), (int32_t)type });
+		}
+	}
+	header.decorations = AppendArray(blob, decorations);
+
+	if (isRoom) {
+		header.roomType = room.mType;
+		header.doorConfig = room.mDoorConfig;
+		header.primaryDoor = room.mPrimaryDoor;
+	}
+	else {
+		header.guardCount = level.mGuardCount;
+		header.cctvCount = level.mCCTVCount;
+		header.prisonPosition = ToCooked(level.mPrisonPosition);
+		header.helipadPosition = ToCooked(level.mHelipadPosition);
+		if (level.mPrisonDoor) {
+			header.hasPrisonDoor = 1;
+			header.prisonDoor = ToCooked(level.mPrisonDoor->GetTransform());
+		}
+
+		std::vector<CookedRoomPlacement> rooms;
+		for (const auto& [position, placedRoom] : level.mRoomList) {
+			rooms.push_back({ ToCooked(position), placedRoom->GetType(), placedRoom->GetDoorConfig(), placedRoom->GetPrimaryDoor() });
+		}
+		header.rooms = AppendArray(blob, rooms);
+
+		std::vector<CookedGuardPath> guardPaths;
+		std::vector<CookedVector3> guardPathNodes;
+		for (const std::vector<Vector3>& path : level.mGuardPaths) {
+			guardPaths.push_back({ (uint32_t)guardPathNodes.size(), (uint32_t)path.size() });
+			for (const Vector3& node : path) {
+				guardPathNodes.push_back(ToCooked(node));
+			}
+		}
+		header.guardPaths = AppendArray(blob, guardPaths);
+		header.guardPathNodes = AppendArray(blob, guardPathNodes);
+
+		std::vector<CookedTransform> playerStarts;
+		for (int i = 0; i < level.mPlayerStartCount; i++) {
+			playerStarts.push_back(ToCooked(level.mPlayerStartTransforms[i]));
+		}
+		header.playerStarts = AppendArray(blob, playerStarts);
+
+		std::vector<CookedVent> vents;
+		for (size_t i = 0; i < level.mVents.size(); i++) {
+			vents.push_back({ ToCooked(level.mVents[i]->GetTransform()), i < level.mVentConnections.size() ? level.mVentConnections[i] : -1 });
+		}
+		header.vents = AppendArray(blob, vents);
+	}
+	memcpy(blob.data(), &header, sizeof(CookedLevelHeader));
+	return AssetCache::WriteArtifact(GetCookedPath(jsonPath), blob.data(), blob.size());
+}
+
+bool CookedLevel::Load(const std::string& jsonPath, Level* level, Room* room) {
+	if ((!level && !room) || (level && room)) return false;
+	const std::string cookedPath = GetCookedPath(jsonPath);
+	MappedFile cooked;
+	//not cooked isn't worth a message, MappedFile would print one
+	if (cookedPath.empty() || !std::filesystem::exists(cookedPath) || !cooked.Open(cookedPath) || cooked.GetSize() < sizeof(CookedLevelHeader)) {
+		return false;
+	}
+	const CookedLevelHeader& header = *(const CookedLevelHeader*)cooked.GetData();
+	if (header.magic != COOKED_LEVEL_MAGIC || header.version != VERSION || header.isRoom != (room ? 1u : 0u)) {
+		return false;
+	}
+
+	const CookedTile* tiles = GetArray<CookedTile>(cooked, header.tiles);
+	const CookedTransform* cctvTransforms = GetArray<CookedTransform>(cooked, header.cctvTransforms);
+	const CookedLight* lights = GetArray<CookedLight>(cooked, header.lights);
+	const CookedVector3* itemPositions = GetArray<CookedVector3>(cooked, header.itemPositions);
+	const CookedTransform* doors = GetArray<CookedTransform>(cooked, header.doors);
+	const CookedDecoration* decorations = GetArray<CookedDecoration>(cooked, header.decorations);
+	const CookedRoomPlacement* rooms = GetArray<CookedRoomPlacement>(cooked, header.rooms);
+	const CookedGuardPath* guardPaths = GetArray<CookedGuardPath>(cooked, header.guardPaths);
+	const CookedVector3* guardPathNodes = GetArray<CookedVector3>(cooked, header.guardPathNodes);
+	const CookedTransform* playerStarts = GetArray<CookedTransform>(cooked, header.playerStarts);
+	const CookedVent* vents = GetArray<CookedVent>(cooked, header.vents);
+	if (!tiles || !cctvTransforms || !lights || !itemPositions || !doors || !decorations || !rooms || !guardPaths || !guardPathNodes || !playerStarts || !vents) {
+		return false;
+	}
+	for (uint32_t i = 0; i < header.guardPaths.count; i++) {
+		if ((uint64_t)guardPaths[i].firstNode + guardPaths[i].nodeCount > header.guardPathNodes.count) {
+			return false;
+		}
+	}
+
+	std::unordered_map<Transform, TileType>& tileMap = room ? room->mTileMap : level->mTileMap;
+	std::vector<Transform>& cctvTransformList = room ? room->mCCTVTransforms : level->mCCTVTransforms;
+	std::vector<Light*>& lightList = room ? room->mLights : level->mLights;
+	std::vector<Vector3>& itemPositionList = room ? room->mItemPositions : level->mItemPositions;
+	std::vector<Door*>& doorList = room ? room->mDoors : level->mDoors;
+	std::unordered_map<DecorationType, std::vector<Transform>>& decorationMap = room ? room->mDecorationMap : level->mDecorationMap;
+
+	tileMap.reserve(header.tiles.count);
+	for (uint32_t i = 0; i < header.tiles.count; i++) {
+		tileMap[ToTransform(tiles[i].transform)] = (TileType)tiles[i].type;
+	}
+	for (uint32_t i = 0; i < header.cctvTransforms.count; i++) {
+		cctvTransformList.push_back(ToTransform(cctvTransforms[i]));
+	}
+	LoadLights(lights, header.lights.count, lightList);
+	for (uint32_t i = 0; i < header.itemPositions.count; i++) {
+		itemPositionList.push_back(ToVector3(itemPositions[i]));
+	}
+	for (uint32_t i = 0; i < header.doors.count; i++) {
+		InteractableDoor* door = new InteractableDoor();
+		SetTransform(door->GetTransform(), doors[i]);
+		doorList.push_back(door);
+	}
+	for (uint32_t i = 0; i < header.decorations.count; i++) {
+		decorationMap[(DecorationType)decorations[i].type].push_back(ToTransform(decorations[i].transform));
+	}
+
+	if (room) {
+		room->mType = (RoomType)header.roomType;
+		room->mDoorConfig = header.doorConfig;
+		room->mPrimaryDoor = header.primaryDoor;
+		return true;
+	}
+
+	level->mGuardCount = header.guardCount;
+	level->mCCTVCount = header.cctvCount;
+	level->mPrisonPosition = ToVector3(header.prisonPosition);
+	level->mHelipadPosition = ToVector3(header.helipadPosition);
+	if (header.hasPrisonDoor) {
+		level->mPrisonDoor = new PrisonDoor();
+		SetTransform(level->mPrisonDoor->GetTransform(), header.prisonDoor);
+	}
+	for (uint32_t i = 0; i < header.rooms.count; i++) {
+		level->mRoomList[ToVector3(rooms[i].position)] = new Room(rooms[i].type, rooms[i].doorConfig, rooms[i].primaryDoor);
+	}
+	for (uint32_t i = 0; i < header.guardPaths.count; i++) {
+		const CookedVector3* nodes = guardPathNodes + guardPaths[i].firstNode;
+		std::vector<Vector3>& path = level->mGuardPaths.emplace_back();
+		for (uint32_t node = 0; node < guardPaths[i].nodeCount; node++) {
+			path.push_back(ToVector3(nodes[node]));
+		}
+	}
+	level->mPlayerStartCount = std::min((int)header.playerStarts.count, MAX_PLAYERS);
+	for (int i = 0; i < level->mPlayerStartCount; i++) {
+		level->mPlayerStartTransforms[i] = ToTransform(playerStarts[i]);
+	}
+	for (uint32_t i = 0; i < header.vents.count; i++) {
+		Vent* vent = new Vent();
+		SetTransform(vent->GetTransform(), vents[i].transform);
+		level->mVents.push_back(vent);
+		level->mVentConnections.push_back(vents[i].connectedVentID);
+	}
+	return true;
+}
+
+bool CookedLevel::IsSameRoom(Room& a, Room& b) {
+	return a.GetType() == b.GetType() && a.GetDoorConfig() == b.GetDoorConfig() && a.GetPrimaryDoor() == b.GetPrimaryDoor() &&
+		a.GetTileMap() == b.GetTileMap() && IsSameLights(a.GetLights(), b.GetLights()) && IsSameTransforms(a.GetCCTVTransforms(), b.GetCCTVTransforms()) &&
+		a.GetItemPositions() == b.GetItemPositions() && IsSameObjects(a.GetDoors(), b.GetDoors()) &&
+		IsSameDecorations(a.GetDecorationMap(), b.GetDecorationMap());
+}
+
+bool CookedLevel::IsSameLevel(Level& a, Level& b) {
+	if (a.GetTileMap() != b.GetTileMap() || a.GetRooms().size() != b.GetRooms().size()) {
+		return false;
+	}
+	for (const auto& [position, room] : a.GetRooms()) {
+		auto it = b.GetRooms().find(position);
+		if (it == b.GetRooms().end() || !IsSameRoom(*room, *it->second)) {
+			return false;
+		}
+	}
+	for (int i = 0; i < MAX_PLAYERS; i++) {
+		if (!IsSameTransform(a.GetPlayerStartTransform(i), b.GetPlayerStartTransform(i))) {
+			return false;
+		}
+	}
+	const bool isSamePrisonDoor = (a.GetPrisonDoor() == nullptr) == (b.GetPrisonDoor() == nullptr) &&
+		(a.GetPrisonDoor() == nullptr || IsSameTransform(a.GetPrisonDoor()->GetTransform(), b.GetPrisonDoor()->GetTransform()));
+	return a.GetGuardPaths() == b.GetGuardPaths() && a.GetGuardCount() == b.GetGuardCount() && a.GetCCTVCount() == b.GetCCTVCount() &&
+		IsSameTransforms(a.GetCCTVTransforms(), b.GetCCTVTransforms()) && a.GetPrisonPosition() == b.GetPrisonPosition() && IsSameLights(a.GetLights(), b.GetLights()) &&
+		a.GetItemPositions() == b.GetItemPositions() && IsSameObjects(a.GetVents(), b.GetVents()) &&
+		a.GetVentConnections() == b.GetVentConnections() && a.GetHelipadPosition() == b.GetHelipadPosition() &&
+		IsSameObjects(a.GetDoors(), b.GetDoors()) && isSamePrisonDoor && IsSameDecorations(a.GetDecorationMap(), b.GetDecorationMap());
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace NCL {
+	namespace CSC8503 {
+		class Level;
+		class Room;
+
+		// A level or room file cooked offline into one little-endian blob: a header, then flat arrays of tiles, lights,
+		// transforms and so on that the header finds by offset. Loading maps the blob and builds the level straight
+		// from the arrays, nothing is parsed. It is kept in the AssetCache under a hash of the JSON, so an edited
+		// level is read from JSON and cooked again.
+		class CookedLevel {
+		public:
+			static constexpr uint32_t VERSION = 2;
+			static constexpr const char* IMPORTER = "level";
+
+			//The AssetCache artifact for jsonPath, empty if the JSON can't be read.
+			static std::string GetCookedPath(const std::string& jsonPath);
+
+			static bool Cook(const std::string& jsonPath, bool isRoom);
+			//Fills exactly one of level and room. False, with nothing filled, when the JSON hasn't been cooked as it is now.
+			static bool Load(const std::string& jsonPath, Level* level, Room* room);
+
+			//Whether two loads of the same file came out the same.
+			static bool IsSameLevel(Level& a, Level& b);
+			static bool IsSameRoom(Room& a, Room& b);
+		};
+	}
+}
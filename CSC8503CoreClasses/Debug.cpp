@@ -18,6 +18,10 @@ const Vector4 Debug::MAGENTA	= Vector4(1, 0, 1, 1);
 const Vector4 Debug::CYAN		= Vector4(0, 1, 1, 1);
 
 void Debug::Print(const std::string& text, const Vector2& pos, const Vector4& colour, float fontSize) {
+#ifdef HEADLESS_SERVER
+	//nothing draws these on a dedicated server, and its matches print from several threads at once
+	return;
+#endif
 	DebugStringEntry newEntry;
 
 	newEntry.data = text;
@@ -29,6 +33,9 @@ void Debug::Print(const std::string& text, const Vector2& pos, const Vector4& co
 }
 
 void Debug::DrawLine(const Vector3& startpoint, const Vector3& endpoint, const Vector4& colour, float time) {
+#ifdef HEADLESS_SERVER
+	return;
+#endif
 	DebugLineEntry newEntry;
 
 	newEntry.start = startpoint;
@@ -0,0 +1,133 @@
+#ifdef USEGL
+#include "EnetTransport.h"
+#include "./enet/enet.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	constexpr int CHANNEL_COUNT = 2;
+	constexpr int SEND_CHANNEL = 0;
+
+	TransportPacket WrapPacket(ENetPacket* packet) {
+		TransportPacket wrapped;
+		if (packet) {
+			wrapped.data = (char*)packet->data;
+			wrapped.size = (int)packet->dataLength;
+			wrapped.handle = packet;
+		}
+		return wrapped;
+	}
+}
+
+EnetHost::EnetHost(_ENetHost* host) {
+	mHost = host;
+}
+
+EnetHost::~EnetHost() {
+	enet_host_destroy(mHost);
+}
+
+int EnetHost::Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int port, uint32_t data) {
+	ENetAddress address;
+	address.port = port;
+	address.host = (d << 24) | (c << 16) | (b << 8) | (a);
+
+	ENetPeer* peer = enet_host_connect(mHost, &address, CHANNEL_COUNT, data);
+	return peer ? (int)(peer - mHost->peers) : -1;
+}
+
+bool EnetHost::Service(TransportEvent& event, int timeoutMs) {
+	ENetEvent enetEvent;
+	if (enet_host_service(mHost, &enetEvent, timeoutMs) <= 0) {
+		return false;
+	}
+	switch (enetEvent.type) {
+	case ENET_EVENT_TYPE_CONNECT:		event.type = TransportEventType::Connect; break;
+	case ENET_EVENT_TYPE_DISCONNECT:	event.type = TransportEventType::Disconnect; break;
+	case ENET_EVENT_TYPE_RECEIVE:		event.type = TransportEventType::Receive; break;
+	default:							event.type = TransportEventType::None; break;
+	}
+	event.peer = (int)(enetEvent.peer - mHost->peers);
+	event.data = enetEvent.data;
+	event.packet = WrapPacket(enetEvent.packet);
+	return true;
+}
+
+TransportPacket EnetHost::CreatePacket(const void* data, int size) {
+	return WrapPacket(enet_packet_create(data, size, 0));
+}
+
+void EnetHost::ReleasePacket(const TransportPacket& packet) {
+	ENetPacket* enetPacket = (ENetPacket*)packet.handle;
+	//peers still holding it free it once it has gone out
+	if (enetPacket && enetPacket->referenceCount == 0) {
+		enet_packet_destroy(enetPacket);
+	}
+}
+
+bool EnetHost::Send(int peer, const TransportPacket& packet) {
+	if (!GetIsValidPeer(peer) || !packet.handle) {
+		return false;
+	}
+	return enet_peer_send(&mHost->peers[peer], SEND_CHANNEL, (ENetPacket*)packet.handle) == 0;
+}
+
+void EnetHost::Broadcast(const TransportPacket& packet) {
+	//enet_host_broadcast frees a packet nobody took, which would leave the caller's release dangling
+	for (size_t i = 0; i < mHost->peerCount; i++) {
+		if (mHost->peers[i].state == ENET_PEER_STATE_CONNECTED) {
+			enet_peer_send(&mHost->peers[i], SEND_CHANNEL, (ENetPacket*)packet.handle);
+		}
+	}
+}
+
+void EnetHost::Flush() {
+	enet_host_flush(mHost);
+}
+
+void EnetHost::Disconnect(int peer) {
+	if (GetIsValidPeer(peer)) {
+		enet_peer_disconnect(&mHost->peers[peer], 0);
+	}
+}
+
+void EnetHost::DisconnectLater(int peer) {
+	if (GetIsValidPeer(peer)) {
+		enet_peer_disconnect_later(&mHost->peers[peer], 0);
+	}
+}
+
+int EnetHost::GetMaxPeers() const {
+	return (int)mHost->peerCount;
+}
+
+int EnetHost::GetRoundTripTime(int peer) const {
+	return GetIsValidPeer(peer) ? (int)mHost->peers[peer].roundTripTime : 0;
+}
+
+int EnetHost::GetRemotePeerID(int peer) const {
+	return GetIsValidPeer(peer) ? (int)mHost->peers[peer].outgoingPeerID : -1;
+}
+
+bool EnetHost::GetIsValidPeer(int peer) const {
+	return peer >= 0 && peer < (int)mHost->peerCount;
+}
+
+bool EnetTransport::Initialise() {
+	return enet_initialize() == 0;
+}
+
+void EnetTransport::Destroy() {
+	enet_deinitialize();
+}
+
+TransportHost* EnetTransport::CreateHost(int port, int maxPeers) {
+	ENetAddress address;
+	address.host = ENET_HOST_ANY;
+	address.port = port;
+
+	ENetHost* host = enet_host_create(port < 0 ? nullptr : &address, maxPeers, CHANNEL_COUNT, 0, 0);
+	return host ? new EnetHost(host) : nullptr;
+}
+#endif
@@ -0,0 +1,46 @@
+#ifdef USEGL
+#pragma once
+#include "NetworkTransport.h"
+
+struct _ENetHost;
+
+namespace NCL {
+	namespace CSC8503 {
+		//Real UDP sockets through ENet. Everything is sent unreliable and sequenced on channel 0.
+		class EnetHost : public TransportHost {
+		public:
+			EnetHost(_ENetHost* host);
+			~EnetHost();
+
+			int Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int port, uint32_t data) override;
+			bool Service(TransportEvent& event, int timeoutMs = 0) override;
+
+			TransportPacket CreatePacket(const void* data, int size) override;
+			void ReleasePacket(const TransportPacket& packet) override;
+			bool Send(int peer, const TransportPacket& packet) override;
+			void Broadcast(const TransportPacket& packet) override;
+			void Flush() override;
+
+			void Disconnect(int peer) override;
+			void DisconnectLater(int peer) override;
+
+			int GetMaxPeers() const override;
+			int GetRoundTripTime(int peer) const override;
+			int GetRemotePeerID(int peer) const override;
+
+		protected:
+			bool GetIsValidPeer(int peer) const;
+
+			_ENetHost* mHost;
+		};
+
+		class EnetTransport : public NetworkTransport {
+		public:
+			bool Initialise() override;
+			void Destroy() override;
+
+			TransportHost* CreateHost(int port, int maxPeers) override;
+		};
+	}
+}
+#endif
@@ -4,35 +4,56 @@
 
 #include "NetworkObject.h"
 #include "../CSC8503/NetworkPlayer.h"
-#include "./enet/enet.h"
+#include "NetworkReceiver.h"
+#include "ReplayPlayer.h"
 using namespace NCL;
 using namespace CSC8503;
 
 GameClient::GameClient()	{
-	netHandle = enet_host_create(nullptr, 1, 1, 0, 0);
+	netHandle = GetTransport().CreateHost(-1, 1);
 	mTimerSinceLastPacket = 0.0f;
 	mPeerId = -1;
 	mIsConnected = false;
+	mServerPeer = -1;
+	mReceiver = nullptr;
+	mReplay = nullptr;
+	mCurrentPacketAge = 0.0f;
 }
 
 GameClient::~GameClient()	{
-	enet_host_destroy(netHandle);
+	//NetworkBase destroys the host, the thread has to be gone first
+	delete mReceiver;
 }
 
 int GameClient::GetPeerID() const {
 	return mPeerId;
 }
 
-bool GameClient::Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int portNum, const std::string& playerName) {
-	ENetAddress address;
-	address.port = portNum;
-	address.host = (d << 24) | (c << 16) | (b << 8) | (a);
+bool GameClient::Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int portNum, const std::string& playerName, uint32_t sessionId) {
+	if (netHandle == nullptr)
+		return false;
 
-	mNetPeer = enet_host_connect(netHandle, &address, 2, 0);
+	std::lock_guard<std::mutex> lock(mHostMutex);
+	mServerPeer = netHandle->Connect(a, b, c, d, portNum, sessionId);
 	mPlayerName = playerName;
 
-	// returm false if net peer is null
-	return mNetPeer != nullptr;
+	// returm false if the connection could not be started
+	return mServerPeer >= 0;
+}
+
+void GameClient::StartReceiveThread() {
+	if (netHandle == nullptr || mReceiver != nullptr)
+		return;
+
+	mReceiver = new NetworkReceiver(*netHandle, mHostMutex);
+	mReceiver->Start();
+}
+
+void GameClient::StartReplay(ReplayPlayer& replay, int peerNumber) {
+	mReplay = &replay;
+	mReplay->SetPeerNumber(peerNumber);
+	mPeerId = peerNumber;
+	mIsConnected = true;
 }
 
 bool GameClient::UpdateClient() {
@@ -43,25 +64,28 @@ bool GameClient::UpdateClient() {
 	mTimerSinceLastPacket++;
 
 	// handle incoming packets
-	ENetEvent event;
-	while (enet_host_service(netHandle, &event, 0) > 0) {
-		if (event.type == ENET_EVENT_TYPE_CONNECT) {
-			//erendgrmnc: I remember +1 is needed because when counting server as a player, outgoing peer Id is not increasing.
-			mPeerId = mNetPeer->outgoingPeerID + 1;
-			mIsConnected = true;
-			std::cout << "Connected to server!" << std::endl;
-
-			//TODO(eren.degirmenci): send player init packet.
-			SendClientInitPacket();
-		}
-		else if (event.type == ENET_EVENT_TYPE_RECEIVE) {
-			//std::cout << "Client Packet recieved..." << std::endl;
-			GamePacket* packet = (GamePacket*)event.packet->data;
+	if (mReplay) {
+		mReplay->Dispatch([this](GamePacket* packet) {
 			ProcessPacket(packet);
 			mTimerSinceLastPacket = 0.0f;
+		});
+	}
+	else if (mReceiver) {
+		mReceiver->Dispatch([this](const NetworkReceiver::InboundMessage& message) {
+			const std::chrono::duration<float> age = std::chrono::steady_clock::now() - message.receivedAt;
+			mCurrentPacketAge = age.count();
+			HandleEvent(message.event);
+		});
+		mCurrentPacketAge = 0.0f;
+	}
+	else {
+		std::unique_lock<std::mutex> lock(mHostMutex);
+		TransportEvent event;
+		while (netHandle->Service(event)) {
+			lock.unlock();
+			HandleEvent(event);
+			lock.lock();
 		}
-		// once packet data is handled we can destroy packet and go to next
-		enet_packet_destroy(event.packet);
 	}
 	// return false if client is no longer receiving packets
 	if (mTimerSinceLastPacket > 20.0f) {
@@ -70,29 +94,73 @@ bool GameClient::UpdateClient() {
 	return true;
 }
 
-void GameClient::WriteAndSendClientInputPacket(int lastId, const PlayerInputs& playerInputs){
-	ClientPlayerInputPacket packet(lastId, playerInputs);
+void GameClient::HandleEvent(const TransportEvent& event) {
+	if (event.type == TransportEventType::Connect) {
+		//erendgrmnc: I remember +1 is needed because when counting server as a player, outgoing peer Id is not increasing.
+		{
+			std::lock_guard<std::mutex> lock(mHostMutex);
+			mPeerId = netHandle->GetRemotePeerID(mServerPeer) + 1;
+		}
+		mIsConnected = true;
+		std::cout << "Connected to server!" << std::endl;
+
+		//TODO(eren.degirmenci): send player init packet.
+		SendClientInitPacket();
+	}
+	else if (event.type == TransportEventType::Receive) {
+		//std::cout << "Client Packet recieved..." << std::endl;
+		GamePacket* packet = (GamePacket*)event.packet.data;
+		ProcessPacket(packet);
+		mTimerSinceLastPacket = 0.0f;
+	}
+	// once packet data is handled we can destroy packet and go to next
+	netHandle->ReleasePacket(event.packet);
+}
+
+void GameClient::WriteAndSendClientInputPacket(int lastId, int firstInputId, int propertyAck, int propertyAckBits, const PlayerInputs* inputs, int inputCount){
+	ClientPlayerInputPacket packet(lastId, firstInputId, propertyAck, propertyAckBits, inputs, inputCount);
 	this->SendPacket(packet);
 }
 
 void GameClient::SendPacket(GamePacket&  payload) {
+	// nowhere to send to while playing back a replay
+	if (mServerPeer < 0)
+		return;
+
 	// defines packet to send and sends packet
-	ENetPacket* dataPacket = enet_packet_create(&payload, payload.GetTotalSize(), 0);
-	enet_peer_send(mNetPeer, 0, dataPacket);
+	std::lock_guard<std::mutex> lock(mHostMutex);
+	TransportPacket dataPacket = netHandle->CreatePacket(&payload, payload.GetTotalSize());
+	netHandle->Send(mServerPeer, dataPacket);
+	netHandle->ReleasePacket(dataPacket);
+}
+
+void GameClient::SendPacket(SerializablePacket& payload) {
+	SerializedPacket* serialized = mPacketSerializer.Write(payload);
+	if (!serialized) {
+		return;
+	}
+	SendPacket(*static_cast<GamePacket*>(serialized));
+	mPacketSerializer.Release(serialized);
 }
+
 void GameClient::Disconnect() {
-	if (mNetPeer != nullptr) {
+	// the receive thread would take the disconnect event this waits for
+	delete mReceiver;
+	mReceiver = nullptr;
+
+	if (mServerPeer >= 0) {
 		// Disconnect from the server with a disconnect notification
-		enet_peer_disconnect(mNetPeer, 0);
+		netHandle->Disconnect(mServerPeer);
 
 		// Allow up to 3 seconds for the disconnect to succeed and flush outgoing packets
 		// You can adjust the timeout value as needed
-		enet_host_flush(netHandle);
+		netHandle->Flush();
 
 		// Wait until the disconnect process is complete or the timeout occurs
-		ENetEvent event;
-		if (enet_host_service(netHandle, &event, 3000) > 0 &&
-			event.type == ENET_EVENT_TYPE_DISCONNECT) {
+		TransportEvent event;
+		const bool isEventReceived = netHandle->Service(event, 3000);
+		netHandle->ReleasePacket(event.packet);
+		if (isEventReceived && event.type == TransportEventType::Disconnect) {
 			// Disconnect successful
 			std::cout << "Disconnected from the server." << std::endl;
 		}
@@ -101,8 +169,8 @@ void GameClient::Disconnect() {
 			std::cerr << "Failed to disconnect from the server." << std::endl;
 		}
 
-		// Reset the peer to nullptr after disconnecting
-		mNetPeer = nullptr;
+		// Forget the peer after disconnecting
+		mServerPeer = -1;
 	}
 	mIsConnected = false;
 }
@@ -111,8 +179,16 @@ bool GameClient::GetIsConnected() const {
 	return mIsConnected;
 }
 
+int GameClient::GetRoundTripTime() const {
+	if (!mIsConnected || mServerPeer < 0) {
+		return 0;
+	}
+	std::lock_guard<std::mutex> lock(mHostMutex);
+	return netHandle->GetRoundTripTime(mServerPeer);
+}
+
 void GameClient::SendClientInitPacket() {
-	ClientInitPacket packet(mPlayerName);
+	ClientInitPacket packet(mPlayerName, mSnapshotDictionaryId);
 	SendPacket(packet);
 }
 
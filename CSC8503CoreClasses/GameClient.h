@@ -1,9 +1,12 @@
 #ifdef USEGL
 #pragma once
 #include "NetworkBase.h"
+#include "PacketSerializer.h"
+#include "NetworkTransport.h"
 #include <stdint.h>
 #include <thread>
 #include <atomic>
+#include <mutex>
 
 namespace NCL::CSC8503{
 	struct PlayerInputs;
@@ -12,6 +15,8 @@ namespace NCL::CSC8503{
 namespace NCL {
 	namespace CSC8503 {
 		class GameObject;
+		class NetworkReceiver;
+		class ReplayPlayer;
 		class GameClient : public NetworkBase {
 		public:
 			GameClient();
@@ -19,13 +24,27 @@ namespace NCL {
 
 			int GetPeerID() const;
 
-			bool Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int portNum, const std::string& playerName);
+			//The session ID picks the match on a server hosting several, see SessionHost.
+			bool Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int portNum, const std::string& playerName, uint32_t sessionId = 0);
+			//Offered to the server on connect, which then compresses snapshots with it if it has the same one.
+			void SetSnapshotDictionaryId(uint32_t dictionaryId) { mSnapshotDictionaryId = dictionaryId; }
 
 			void SendPacket(GamePacket&  payload);
+			void SendPacket(SerializablePacket& payload);
+
+			//Services the host on its own thread from now on, UpdateClient then only dispatches what it received.
+			void StartReceiveThread();
+			const NetworkReceiver* GetReceiver() const { return mReceiver; }
+
+			//Plays a recorded match back through the packet handlers as if it were this peer, instead of connecting.
+			void StartReplay(ReplayPlayer& replay, int peerNumber);
 
 			bool UpdateClient();
+			//How long ago the packet being handled arrived, in seconds. Always 0 without a receive thread.
+			float GetCurrentPacketAge() const { return mCurrentPacketAge; }
 
-			void WriteAndSendClientInputPacket(int lastId, const PlayerInputs& playerInputs);
+			//inputs holds inputCount inputs in order, starting from firstInputId.
+			void WriteAndSendClientInputPacket(int lastId, int firstInputId, int propertyAck, int propertyAckBits, const PlayerInputs* inputs, int inputCount);
 
 			void WriteAndSendClientUseItemPacket(int playerID, int objectID);
 
@@ -33,6 +52,9 @@ namespace NCL {
 
 			bool GetIsConnected() const;
 
+			//Smoothed round trip time to the server in milliseconds, 0 until connected.
+			int GetRoundTripTime() const;
+
 			void WriteAndSendAnnouncementSyncPacket(int annType, float time, int playerNo);
 
 			void WriteAndSendInteractablePacket(int networkObjectId, bool isOpen, int interactableItemType);
@@ -46,10 +68,19 @@ namespace NCL {
 			int mPeerId;
 
 			std::string mPlayerName;
+			uint32_t mSnapshotDictionaryId = 0;
+
+			PacketSerializer mPacketSerializer;
 			
-			_ENetPeer*	mNetPeer;
+			int			mServerPeer;
 			float mTimerSinceLastPacket;
 
+			mutable std::mutex mHostMutex;
+			NetworkReceiver* mReceiver;
+			ReplayPlayer* mReplay;
+			float mCurrentPacketAge;
+
+			void HandleEvent(const TransportEvent& event);
 			void SendClientInitPacket();
 		};
 	}
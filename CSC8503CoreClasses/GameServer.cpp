@@ -1,7 +1,10 @@
 #ifdef USEGL
 #include "GameServer.h"
 #include "GameWorld.h"
-#include "./enet/enet.h"
+#include "SessionHost.h"
+#include "NetworkReceiver.h"
+#include "ReplayPlayer.h"
+#include "ReplayRecorder.h"
 using namespace NCL;
 using namespace CSC8503;
 
@@ -17,23 +20,71 @@ GameServer::GameServer(int onPort, int maxClients)	{
 	Initialise();
 }
 
+GameServer::GameServer(SessionHost& sessionHost, int maxClients) {
+	mPort		= NetworkBase::GetDefaultPort();
+	mClientMax	= maxClients;
+	mClientCount = 0;
+	mSessionHost = &sessionHost;
+	netHandle	= sessionHost.GetHost();
+	mPeers = new int[mClientMax];
+	for (int i = 0; i < mClientMax; ++i){
+		mPeers[i] = -1;
+	}
+}
+
+GameServer::GameServer(ReplayPlayer& replay, int maxClients) {
+	mPort		= NetworkBase::GetDefaultPort();
+	mClientMax	= maxClients;
+	mClientCount = 0;
+	mReplay = &replay;
+	netHandle	= nullptr;
+	mPeers = new int[mClientMax];
+	for (int i = 0; i < mClientMax; ++i){
+		mPeers[i] = -1;
+	}
+}
+
 GameServer::~GameServer()	{
 	Shutdown();
+	StopRecording();
+
+	for (const TransportEvent& incomingEvent : mIncomingEvents) {
+		mSessionHost->GetHost()->ReleasePacket(incomingEvent.packet);
+	}
+	delete[] mPeers;
 }
 
 void GameServer::Shutdown() {
+	if (!netHandle) { return; }
+
 	SendGlobalPacket(BasicNetworkMessages::Shutdown);
-	enet_host_destroy(netHandle);
+	if (mSessionHost) {
+		//the host outlives this session, only this session's peers are let go
+		std::unique_lock<std::mutex> lock = LockHost();
+		for (int i = 0; i < mClientMax; i++) {
+			if (mPeers[i] != -1) {
+				netHandle->DisconnectLater(mPeers[i] - 1);
+			}
+		}
+		lock.unlock();
+		mSessionHost->RemoveSession(*this);
+	}
+	else {
+		//the thread has to be gone before the host it services
+		delete mReceiver;
+		mReceiver = nullptr;
+		delete netHandle;
+	}
 	netHandle = nullptr;
 }
 
 bool GameServer::Initialise() {
-	// create game server
-	ENetAddress address;
-	address.host = ENET_HOST_ANY;
-	address.port = mPort;
+	if (mSessionHost) {
+		return netHandle != nullptr;
+	}
 
-	netHandle = enet_host_create(&address, mClientMax, 1, 0, 0);
+	// create game server
+	netHandle = GetTransport().CreateHost(mPort, mClientMax);
 
 	// if server is not set up then diplay error message and return false
 	if (!netHandle) {
@@ -51,18 +102,147 @@ bool GameServer::SendGlobalPacket(int msgID) {
 }
 
 bool GameServer::SendGlobalPacket(GamePacket& packet) {
+	if (!netHandle) {
+		return false;
+	}
+	if (mRecorder) {
+		mRecorder->Record(ReplayDirection::ServerToClient, 0, &packet, packet.GetTotalSize());
+	}
 	// define and send packet
-	ENetPacket* dataPacket = enet_packet_create(&packet, packet.GetTotalSize(), 0);
-	enet_host_broadcast(netHandle, 0, dataPacket);
+	BroadcastToPeers(netHandle->CreatePacket(&packet, packet.GetTotalSize()));
 	return true;
 }
 
+bool GameServer::SendGlobalPacket(SerializablePacket& packet) {
+	SerializedPacket* serialized = mPacketSerializer.Write(packet);
+	if (!serialized) {
+		return false;
+	}
+	const bool isSent = SendGlobalPacket(*static_cast<GamePacket*>(serialized));
+	mPacketSerializer.Release(serialized);
+	return isSent;
+}
+
+bool GameServer::SendPacketToPeer(SerializablePacket& packet, int peerNumber) {
+	SerializedPacket* serialized = mPacketSerializer.Write(packet);
+	if (!serialized) {
+		return false;
+	}
+	const bool isSent = SendPacketToPeer(*static_cast<GamePacket*>(serialized), peerNumber);
+	mPacketSerializer.Release(serialized);
+	return isSent;
+}
+
+bool GameServer::SendPacketToPeer(GamePacket& packet, int peerNumber) {
+	const int peerIndex = peerNumber - 1;
+	if (!netHandle || peerIndex < 0 || peerIndex >= netHandle->GetMaxPeers()) {
+		return false;
+	}
+	if (mRecorder) {
+		mRecorder->Record(ReplayDirection::ServerToClient, peerNumber, &packet, packet.GetTotalSize());
+	}
+	std::unique_lock<std::mutex> lock = LockHost();
+	TransportPacket dataPacket = netHandle->CreatePacket(&packet, packet.GetTotalSize());
+	const bool isSent = netHandle->Send(peerIndex, dataPacket);
+	netHandle->ReleasePacket(dataPacket);
+	return isSent;
+}
+
 bool GameServer::SendVariableUpdatePacket(VariablePacket& packet) {
-	ENetPacket* dataPacket = enet_packet_create(&packet, packet.GetTotalSize(), 0);
-	enet_host_broadcast(netHandle, 0, dataPacket);
+	if (!netHandle) {
+		return false;
+	}
+	if (mRecorder) {
+		mRecorder->Record(ReplayDirection::ServerToClient, 0, &packet, packet.GetTotalSize());
+	}
+	BroadcastToPeers(netHandle->CreatePacket(&packet, packet.GetTotalSize()));
 	return true;
 }
 
+void GameServer::BroadcastToPeers(const TransportPacket& dataPacket) {
+	std::unique_lock<std::mutex> lock = LockHost();
+	if (!mSessionHost && mHeldPackets.empty()) {
+		netHandle->Broadcast(dataPacket);
+	}
+	else {
+		//everyone else on a shared host is in another match
+		for (int i = 0; i < mClientMax; i++) {
+			if (mPeers[i] == -1) {
+				continue;
+			}
+			auto heldPackets = mHeldPackets.find(mPeers[i]);
+			if (heldPackets != mHeldPackets.end()) {
+				heldPackets->second.emplace_back(dataPacket.data, dataPacket.data + dataPacket.size);
+			}
+			else {
+				netHandle->Send(mPeers[i] - 1, dataPacket);
+			}
+		}
+	}
+	netHandle->ReleasePacket(dataPacket);
+}
+
+void GameServer::HoldPeer(int peerNumber) {
+	std::unique_lock<std::mutex> lock = LockHost();
+	mHeldPackets.try_emplace(peerNumber);
+}
+
+void GameServer::ReleasePeer(int peerNumber) {
+	std::unique_lock<std::mutex> lock = LockHost();
+	auto heldPackets = mHeldPackets.find(peerNumber);
+	if (heldPackets == mHeldPackets.end()) {
+		return;
+	}
+	if (netHandle) {
+		for (std::vector<char>& packetData : heldPackets->second) {
+			TransportPacket dataPacket = netHandle->CreatePacket(packetData.data(), (int)packetData.size());
+			netHandle->Send(peerNumber - 1, dataPacket);
+			netHandle->ReleasePacket(dataPacket);
+		}
+	}
+	mHeldPackets.erase(heldPackets);
+}
+
+std::unique_lock<std::mutex> GameServer::LockHost() const {
+	if (!mSessionHost) {
+		return std::unique_lock<std::mutex>(mHostMutex);
+	}
+	return std::unique_lock<std::mutex>(mSessionHost->GetHostMutex());
+}
+
+bool GameServer::StartRecording(const std::string& filepath) {
+	StopRecording();
+	ReplayRecorder* recorder = new ReplayRecorder();
+	if (!recorder->Open(filepath)) {
+		delete recorder;
+		return false;
+	}
+	mRecorder = recorder;
+	return true;
+}
+
+void GameServer::StopRecording() {
+	delete mRecorder;
+	mRecorder = nullptr;
+}
+
+bool GameServer::StartReceiveThread() {
+	if (!netHandle || mSessionHost) {
+		return false;
+	}
+	if (!mReceiver) {
+		mReceiver = new NetworkReceiver(*netHandle, mHostMutex);
+		mReceiver->Start();
+	}
+	return true;
+}
+
+void GameServer::Flush() {
+	if (!netHandle) { return; }
+	std::unique_lock<std::mutex> lock = LockHost();
+	netHandle->Flush();
+}
+
 bool GameServer::GetPeer(int peerNumber, int& peerId) const
 {
 	if (peerNumber >= mClientMax)
@@ -75,33 +255,100 @@ bool GameServer::GetPeer(int peerNumber, int& peerId) const
 }
 
 void GameServer::UpdateServer() {
+	if (mReplay) {
+		mReplay->DispatchRecords([this](const ReplayRecordHeader& record, GamePacket* packet) {
+			if (record.direction == ReplayDirection::ServerToClient) {
+				return;
+			}
+			TransportEvent event;
+			event.type = record.direction == ReplayDirection::ClientConnected ? TransportEventType::Connect :
+				record.direction == ReplayDirection::ClientDisconnected ? TransportEventType::Disconnect : TransportEventType::Receive;
+			event.peer = record.peerNumber - 1;
+			if (event.type == TransportEventType::Receive) {
+				//the mapping is only borrowed, HandleEvent has no host to release it to
+				event.packet.data = (char*)packet;
+				event.packet.size = record.size;
+			}
+			HandleEvent(event);
+		});
+		return;
+	}
 	if (!netHandle) { return; }
 
-	ENetEvent event;
-	while (enet_host_service(netHandle, &event, 0) > 0) {
-		int type = event.type;
-		ENetPeer* p = event.peer;
-		int peer = p->incomingPeerID;
+	if (mSessionHost) {
+		std::vector<TransportEvent> incomingEvents;
+		{
+			std::lock_guard<std::mutex> lock(mIncomingEventsMutex);
+			incomingEvents.swap(mIncomingEvents);
+		}
+		for (const TransportEvent& incomingEvent : incomingEvents) {
+			HandleEvent(incomingEvent);
+		}
+		return;
+	}
 
-		if (type == ENetEventType::ENET_EVENT_TYPE_CONNECT) {
-			std::cout << "Server: New client has connected" << std::endl;
-			AddPeer(peer + 1);
+	if (mReceiver) {
+		mReceiver->Dispatch([this](const NetworkReceiver::InboundMessage& message) { HandleEvent(message.event); });
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock = LockHost();
+	TransportEvent event;
+	while (netHandle->Service(event)) {
+		lock.unlock();
+		HandleEvent(event);
+		lock.lock();
+	}
+}
+
+void GameServer::QueueIncomingEvent(const TransportEvent& event) {
+	std::lock_guard<std::mutex> lock(mIncomingEventsMutex);
+	mIncomingEvents.push_back(event);
+}
+
+void GameServer::HandleEvent(const TransportEvent& event) {
+	const int peer = event.peer;
+	if (event.type == TransportEventType::Connect) {
+		std::cout << "Server: New client has connected" << std::endl;
+		if (mRecorder) {
+			GamePacket connected;
+			mRecorder->Record(ReplayDirection::ClientConnected, peer + 1, &connected, connected.GetTotalSize());
+		}
+		AddPeer(peer + 1);
+	}
+	else if (event.type == TransportEventType::Disconnect) {
+		std::cout << "Server: Client has disconnected" << std::endl;
+		if (mRecorder) {
+			GamePacket disconnected;
+			mRecorder->Record(ReplayDirection::ClientDisconnected, peer + 1, &disconnected, disconnected.GetTotalSize());
 		}
-		else if (type == ENetEventType::ENET_EVENT_TYPE_DISCONNECT) {
-			std::cout << "Server: Client has disconnected" << std::endl;
-			for (int i = 0; i < 3; ++i){
-				if (mPeers[i] == peer+1) {
-					mPeers[i] = -1;
-				}
+		for (int i = 0; i < mClientMax; ++i){
+			if (mPeers[i] == peer+1) {
+				mPeers[i] = -1;
 			}
+		}
+		std::unique_lock<std::mutex> lock = LockHost();
+		mHeldPackets.erase(peer + 1);
+		lock.unlock();
 
+		//the peer number goes to the next client to connect, so the game is told to forget what it kept for it
+		PacketHandlerIterator firstHandler;
+		PacketHandlerIterator lastHandler;
+		if (GetPacketHandlers(BasicNetworkMessages::Player_Disconnected, firstHandler, lastHandler)) {
+			GamePacket disconnected(BasicNetworkMessages::Player_Disconnected);
+			ProcessPacket(&disconnected, peer);
 		}
-		else if (type == ENetEventType::ENET_EVENT_TYPE_RECEIVE) {
-			//std::cout << "Server: Has recieved packet" << std::endl;
-			GamePacket* packet = (GamePacket*)event.packet->data;
-			ProcessPacket(packet, peer);
+	}
+	else if (event.type == TransportEventType::Receive) {
+		//std::cout << "Server: Has recieved packet" << std::endl;
+		GamePacket* gamePacket = (GamePacket*)event.packet.data;
+		if (mRecorder) {
+			mRecorder->Record(ReplayDirection::ClientToServer, peer + 1, event.packet.data, event.packet.size);
 		}
-		enet_packet_destroy(event.packet);
+		ProcessPacket(gamePacket, peer);
+	}
+	if (netHandle) {
+		netHandle->ReleasePacket(event.packet);
 	}
 }
 
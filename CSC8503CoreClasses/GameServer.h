@@ -1,13 +1,26 @@
 #ifdef USEGL
 #pragma once
 #include "NetworkBase.h"
+#include "PacketSerializer.h"
+#include "NetworkTransport.h"
+#include <map>
+#include <mutex>
+#include <vector>
 
 namespace NCL {
 	namespace CSC8503 {
 		class GameWorld;
+		class SessionHost;
+		class NetworkReceiver;
+		class ReplayRecorder;
+		class ReplayPlayer;
 		class GameServer : public NetworkBase {
 		public:
 			GameServer(int onPort, int maxClients);
+			//Serves one session on a host shared with other matches, the host routes this server's peers to it.
+			GameServer(SessionHost& sessionHost, int maxClients);
+			//Plays back what a recorded server received, connections and all, instead of serving. Nothing is sent.
+			GameServer(ReplayPlayer& replay, int maxClients);
 			~GameServer();
 
 			bool Initialise();
@@ -18,20 +31,63 @@ namespace NCL {
 
 			bool SendGlobalPacket(int msgID);
 			bool SendGlobalPacket(GamePacket& packet);
+			//peerNumber is the same +1 numbering AddPeer and the packet handlers use.
+			bool SendPacketToPeer(GamePacket& packet, int peerNumber);
+			//Serializable packets are written field by field into a pooled buffer instead of copied raw.
+			bool SendGlobalPacket(SerializablePacket& packet);
+			bool SendPacketToPeer(SerializablePacket& packet, int peerNumber);
 			bool SendVariableUpdatePacket(VariablePacket& packet);
+			//Pushes out everything broadcast so far without waiting for the next UpdateServer.
+			void Flush();
 			bool GetPeer(int peerNumber, int& peerId) const;
+			//Broadcasts to a held peer are kept back, in order, until it is released. For a peer that has to be
+			//brought up to date before anything else it is sent makes sense.
+			void HoldPeer(int peerNumber);
+			void ReleasePeer(int peerNumber);
+			int GetClientMax() const { return mClientMax; }
+
+			//Called by the session host, the event is handled on the next UpdateServer. Takes ownership of the packet.
+			void QueueIncomingEvent(const TransportEvent& event);
+
+			//Services the host on its own thread from now on, UpdateServer then only dispatches what it received.
+			//Not for a shared host, the session host services that.
+			bool StartReceiveThread();
+			const NetworkReceiver* GetReceiver() const { return mReceiver; }
+
+			//Records every packet sent and received from now on, for a ReplayPlayer to play back.
+			bool StartRecording(const std::string& filepath);
+			void StopRecording();
 
 			virtual void UpdateServer();
 
 		protected:
+			void HandleEvent(const TransportEvent& event);
+			//Hosts are not thread safe, a shared host is locked by whichever match is using it.
+			std::unique_lock<std::mutex> LockHost() const;
+			//Releases the packet once it is queued for everyone.
+			void BroadcastToPeers(const TransportPacket& dataPacket);
+
 			int			mPort;
 			int			mClientMax;
 			int			mClientCount;
 			int*        mPeers;
 			GameWorld*	mGameWorld;
 
+			PacketSerializer mPacketSerializer;
+
 			int mIncomingDataRate;
 			int mOutgoingDataRate;
+
+			SessionHost* mSessionHost = nullptr;
+			//Guards a host this server owns, a shared host has the session host's.
+			mutable std::mutex mHostMutex;
+			NetworkReceiver* mReceiver = nullptr;
+			ReplayRecorder* mRecorder = nullptr;
+			ReplayPlayer* mReplay = nullptr;
+			std::mutex mIncomingEventsMutex;
+			std::vector<TransportEvent> mIncomingEvents;
+			//Guarded by the host lock, broadcasts can come from the packet sender's thread.
+			std::map<int, std::vector<std::vector<char>>> mHeldPackets;
 		};
 	}
 }
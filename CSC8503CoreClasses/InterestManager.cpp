@@ -0,0 +1,149 @@
+#ifdef USEGL
+#include "InterestManager.h"
+
+#include <algorithm>
+
+using namespace NCL;
+using namespace CSC8503;
+using namespace Maths;
+
+namespace {
+	//Everything inside this radius gets full priority.
+	constexpr float NEAR_RADIUS = 40.0f;
+	//Beyond this, objects outside the client's room and its neighbours only go out when starved.
+	constexpr float CULL_RADIUS = 150.0f;
+
+	constexpr float SAME_ROOM_MULTIPLIER = 2.0f;
+	constexpr float ADJACENT_ROOM_MULTIPLIER = 1.5f;
+
+	//Rooms are laid out on a 63 unit grid, so this takes in diagonal neighbours.
+	constexpr float ROOM_RADIUS = 45.0f;
+	constexpr float ROOM_ADJACENCY_DISTANCE = 96.0f;
+
+	//Nothing goes unsent for longer than this, however far away it is.
+	constexpr int MAX_STARVED_TICKS = 120;
+	constexpr float STARVED_PRIORITY = 1000.0f;
+
+	constexpr int DEFAULT_BANDWIDTH_BYTES_PER_SECOND = 32 * 1024;
+	constexpr float DEFAULT_TICK_RATE = 60.0f;
+}
+
+InterestManager::InterestManager() {
+	SetBandwidthBudget(DEFAULT_BANDWIDTH_BYTES_PER_SECOND, DEFAULT_TICK_RATE);
+}
+
+void InterestManager::SetRooms(const std::vector<Vector3>& roomPositions) {
+	mRoomPositions = roomPositions;
+	mRoomAdjacency.assign(roomPositions.size(), std::vector<bool>(roomPositions.size(), false));
+	for (int a = 0; a < roomPositions.size(); a++) {
+		for (int b = 0; b < roomPositions.size(); b++) {
+			mRoomAdjacency[a][b] = (roomPositions[a] - roomPositions[b]).Length() <= ROOM_ADJACENCY_DISTANCE;
+		}
+	}
+}
+
+void InterestManager::SetBandwidthBudget(int bytesPerSecond, float tickRate) {
+	mBudgetBitsPerTick = (int)((bytesPerSecond * 8) / std::max(tickRate, 1.0f));
+}
+
+void InterestManager::AddClient(int peerID) {
+	GetClient(peerID);
+}
+
+void InterestManager::RemoveClient(int peerID) {
+	mClients.erase(peerID);
+}
+
+void InterestManager::Clear() {
+	mClients.clear();
+	mRoomPositions.clear();
+	mRoomAdjacency.clear();
+}
+
+InterestManager::ClientInterest& InterestManager::GetClient(int peerID) {
+	return mClients[peerID];
+}
+
+InterestManager::ObjectInterest& InterestManager::GetObjectInterest(ClientInterest& client, int networkID) {
+	if (networkID >= client.objects.size()) {
+		client.objects.resize(networkID + 1);
+	}
+	return client.objects[networkID];
+}
+
+SnapshotSendState& InterestManager::GetSendState(int peerID, int networkID) {
+	return GetObjectInterest(GetClient(peerID), networkID).sendState;
+}
+
+void InterestManager::GetPrioritisedObjects(int peerID, const Vector3& viewerPosition, const std::vector<NetworkObject*>& networkObjects,
+	std::vector<NetworkObject*>& prioritised) {
+	ClientInterest& client = GetClient(peerID);
+	const int viewerRoom = GetRoomIndex(viewerPosition);
+
+	prioritised.clear();
+	for (NetworkObject* networkObject : networkObjects) {
+		if (networkObject == nullptr) {
+			continue;
+		}
+		ObjectInterest& interest = GetObjectInterest(client, networkObject->GetnetworkID());
+		interest.ticksSinceSent++;
+		if (interest.ticksSinceSent >= MAX_STARVED_TICKS) {
+			interest.accumulatedPriority += STARVED_PRIORITY;
+		}
+		else {
+			interest.accumulatedPriority += GetPriority(viewerPosition, viewerRoom, networkObject->GetGameObject().GetTransform().GetPosition());
+		}
+		if (interest.accumulatedPriority > 0.0f) {
+			prioritised.push_back(networkObject);
+		}
+	}
+
+	std::sort(prioritised.begin(), prioritised.end(), [&client](NetworkObject* a, NetworkObject* b) {
+		return client.objects[a->GetnetworkID()].accumulatedPriority > client.objects[b->GetnetworkID()].accumulatedPriority;
+	});
+}
+
+void InterestManager::MarkSent(int peerID, int networkID) {
+	ObjectInterest& interest = GetObjectInterest(GetClient(peerID), networkID);
+	interest.accumulatedPriority = 0.0f;
+	interest.ticksSinceSent = 0;
+}
+
+float InterestManager::GetPriority(const Vector3& viewerPosition, int viewerRoom, const Vector3& objectPosition) const {
+	const float distance = (objectPosition - viewerPosition).Length();
+
+	float roomMultiplier = 1.0f;
+	bool isInNearbyRoom = false;
+	if (viewerRoom >= 0) {
+		const int objectRoom = GetRoomIndex(objectPosition);
+		if (objectRoom == viewerRoom) {
+			roomMultiplier = SAME_ROOM_MULTIPLIER;
+			isInNearbyRoom = true;
+		}
+		else if (objectRoom >= 0 && mRoomAdjacency[viewerRoom][objectRoom]) {
+			roomMultiplier = ADJACENT_ROOM_MULTIPLIER;
+			isInNearbyRoom = true;
+		}
+	}
+
+	if (distance > CULL_RADIUS && !isInNearbyRoom) {
+		return 0.0f;
+	}
+	const float distanceFalloff = distance <= NEAR_RADIUS ? 1.0f : (NEAR_RADIUS * NEAR_RADIUS) / (distance * distance);
+	return distanceFalloff * roomMultiplier;
+}
+
+int InterestManager::GetRoomIndex(const Vector3& position) const {
+	int closestRoom = -1;
+	float closestDistance = ROOM_RADIUS;
+	for (int i = 0; i < mRoomPositions.size(); i++) {
+		const Vector3 offset = position - mRoomPositions[i];
+		const float distance = Vector2(offset.x, offset.z).Length();
+		if (distance < closestDistance) {
+			closestDistance = distance;
+			closestRoom = i;
+		}
+	}
+	return closestRoom;
+}
+#endif
@@ -0,0 +1,55 @@
+#ifdef USEGL
+#pragma once
+#include "NetworkObject.h"
+
+namespace NCL::CSC8503 {
+	// Decides which network objects each client hears about this tick. Every object accumulates
+	// priority from distance and room adjacency to the client's player until it is sent, so the
+	// nearby objects go every tick and far ones still go eventually instead of never.
+	class InterestManager {
+	public:
+		InterestManager();
+
+		//Room positions from the level, rooms close to each other count as adjacent.
+		void SetRooms(const std::vector<Maths::Vector3>& roomPositions);
+		void SetBandwidthBudget(int bytesPerSecond, float tickRate);
+
+		void AddClient(int peerID);
+		void RemoveClient(int peerID);
+		void Clear();
+
+		//Candidates for the client this tick, highest priority first. The caller stops once the budget is spent.
+		void GetPrioritisedObjects(int peerID, const Maths::Vector3& viewerPosition, const std::vector<NetworkObject*>& networkObjects,
+			std::vector<NetworkObject*>& prioritised);
+		//Called for every object the client is now up to date with, written or skipped as unchanged.
+		void MarkSent(int peerID, int networkID);
+
+		SnapshotSendState& GetSendState(int peerID, int networkID);
+		int GetBudgetBitsPerTick() const { return mBudgetBitsPerTick; }
+
+	protected:
+		struct ObjectInterest {
+			float accumulatedPriority = 0.0f;
+			int ticksSinceSent = 0;
+			SnapshotSendState sendState;
+		};
+
+		struct ClientInterest {
+			std::vector<ObjectInterest> objects;	//Indexed by network ID
+		};
+
+		ClientInterest& GetClient(int peerID);
+		ObjectInterest& GetObjectInterest(ClientInterest& client, int networkID);
+
+		float GetPriority(const Maths::Vector3& viewerPosition, int viewerRoom, const Maths::Vector3& objectPosition) const;
+		int GetRoomIndex(const Maths::Vector3& position) const;
+
+		std::map<int, ClientInterest> mClients;
+
+		std::vector<Maths::Vector3> mRoomPositions;
+		std::vector<std::vector<bool>> mRoomAdjacency;
+
+		int mBudgetBitsPerTick;
+	};
+}
+#endif
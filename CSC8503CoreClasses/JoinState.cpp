@@ -0,0 +1,182 @@
+#ifdef USEGL
+#include "JoinState.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	constexpr int ACK_BITS = 32;
+}
+
+JoinStateAckPacket::JoinStateAckPacket() : SerializablePacket(BasicNetworkMessages::JoinState_Ack) {
+}
+
+void JoinStateAckPacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(streamID);
+	stream.SerializeVarInt(nextChunk);
+	int bits = (int)receivedBits;
+	stream.SerializeBits(bits, ACK_BITS);
+	receivedBits = (uint32_t)bits;
+}
+
+JoinStateSender::JoinStateSender(int streamID, const char* image, int imageSize, const SnapshotDictionary* dictionary, float startTime) {
+	mStreamID = streamID;
+	mImageSize = imageSize;
+	mStreamSize = 0;
+	mStartTime = startTime;
+
+	SnapshotCodec codec;
+	codec.SetDictionary(dictionary);
+	const bool hasDictionary = dictionary != nullptr && !dictionary->IsEmpty();
+
+	const int chunkCount = std::max(1, (imageSize + JOIN_STATE_CHUNK_SIZE - 1) / JOIN_STATE_CHUNK_SIZE);
+	mChunks.resize(chunkCount);
+	for (int i = 0; i < chunkCount; i++) {
+		JoinStateChunkPacket& chunk = mChunks[i];
+		chunk.streamID = streamID;
+		chunk.imageSize = imageSize;
+		chunk.chunkIndex = (short)i;
+		chunk.chunkCount = (short)chunkCount;
+
+		const char* block = image + i * JOIN_STATE_CHUNK_SIZE;
+		const int blockSize = std::min(JOIN_STATE_CHUNK_SIZE, imageSize - i * JOIN_STATE_CHUNK_SIZE);
+		const int compressedSize = blockSize > 0 ? codec.Compress(block, blockSize, chunk.data, JOIN_STATE_CHUNK_SIZE) : -1;
+		if (compressedSize >= 0) {
+			chunk.isCompressed = true;
+			chunk.usesDictionary = hasDictionary;
+			chunk.SetPayloadSize(compressedSize);
+		}
+		else {
+			memcpy(chunk.data, block, std::max(blockSize, 0));
+			chunk.SetPayloadSize(std::max(blockSize, 0));
+		}
+		mStreamSize += chunk.GetTotalSize();
+	}
+
+	mSentTimes.assign(chunkCount, -1.0f);
+	mIsAcked.assign(chunkCount, false);
+	mAckedCount = 0;
+	mFirstUnacked = 0;
+}
+
+int JoinStateSender::Update(float time, int byteBudget, float resendDelay, const std::function<void(JoinStateChunkPacket& chunk)>& send) {
+	int bytesSent = 0;
+	for (int i = mFirstUnacked; i < (int)mChunks.size(); i++) {
+		if (mIsAcked[i]) {
+			continue;
+		}
+		if (mSentTimes[i] >= 0.0f && time - mSentTimes[i] < resendDelay) {
+			continue;
+		}
+		const int chunkBytes = mChunks[i].GetTotalSize();
+		//a budget smaller than a chunk would never send anything, so the first always goes
+		if (bytesSent > 0 && bytesSent + chunkBytes > byteBudget) {
+			break;
+		}
+		send(mChunks[i]);
+		mSentTimes[i] = time;
+		bytesSent += chunkBytes;
+	}
+	return bytesSent;
+}
+
+void JoinStateSender::Acknowledge(const JoinStateAckPacket& ack) {
+	if (ack.streamID != mStreamID) {
+		return;
+	}
+	auto markAcked = [&](int chunkIndex) {
+		if (chunkIndex >= 0 && chunkIndex < (int)mChunks.size() && !mIsAcked[chunkIndex]) {
+			mIsAcked[chunkIndex] = true;
+			mAckedCount++;
+		}
+	};
+	const int nextChunk = std::min(ack.nextChunk, (int)mChunks.size());
+	for (int i = mFirstUnacked; i < nextChunk; i++) {
+		markAcked(i);
+	}
+	for (int bit = 0; bit < ACK_BITS; bit++) {
+		if (ack.receivedBits & (1u << bit)) {
+			markAcked(ack.nextChunk + 1 + bit);
+		}
+	}
+	while (mFirstUnacked < (int)mChunks.size() && mIsAcked[mFirstUnacked]) {
+		mFirstUnacked++;
+	}
+}
+
+JoinStateReceiver::JoinStateReceiver() {
+	Reset();
+}
+
+void JoinStateReceiver::SetDictionary(const SnapshotDictionary* dictionary) {
+	mDictionaryCodec.SetDictionary(dictionary);
+}
+
+void JoinStateReceiver::Reset() {
+	mStreamID = -1;
+	mImage.clear();
+	mIsReceived.clear();
+	mReceivedCount = 0;
+}
+
+bool JoinStateReceiver::ReceiveChunk(const JoinStateChunkPacket& chunk) {
+	const int chunkCount = (chunk.imageSize + JOIN_STATE_CHUNK_SIZE - 1) / JOIN_STATE_CHUNK_SIZE;
+	if (chunk.streamID < 0 || chunk.imageSize <= 0 || chunk.imageSize > JOIN_STATE_MAX_IMAGE_SIZE || chunk.chunkCount != chunkCount ||
+		chunk.chunkIndex < 0 || chunk.chunkIndex >= chunkCount) {
+		return false;
+	}
+	const int payloadSize = chunk.GetPayloadSize();
+	if (payloadSize < 0 || payloadSize > JOIN_STATE_CHUNK_SIZE) {
+		return false;
+	}
+
+	if (chunk.streamID != mStreamID) {
+		mStreamID = chunk.streamID;
+		mImage.assign(chunk.imageSize, 0);
+		mIsReceived.assign(chunkCount, false);
+		mReceivedCount = 0;
+	}
+	else if ((int)mImage.size() != chunk.imageSize) {
+		return false;
+	}
+	if (mIsReceived[chunk.chunkIndex]) {
+		return true;
+	}
+
+	char* block = mImage.data() + chunk.chunkIndex * JOIN_STATE_CHUNK_SIZE;
+	const int blockSize = std::min(JOIN_STATE_CHUNK_SIZE, chunk.imageSize - chunk.chunkIndex * JOIN_STATE_CHUNK_SIZE);
+	if (chunk.isCompressed) {
+		SnapshotCodec& codec = chunk.usesDictionary ? mDictionaryCodec : mCodec;
+		if (codec.Decompress(chunk.data, payloadSize, block, blockSize) != blockSize) {
+			return false;
+		}
+	}
+	else {
+		if (payloadSize != blockSize) {
+			return false;
+		}
+		memcpy(block, chunk.data, blockSize);
+	}
+	mIsReceived[chunk.chunkIndex] = true;
+	mReceivedCount++;
+	return true;
+}
+
+void JoinStateReceiver::FillAck(JoinStateAckPacket& ack) const {
+	ack.streamID = mStreamID;
+	ack.nextChunk = 0;
+	while (ack.nextChunk < (int)mIsReceived.size() && mIsReceived[ack.nextChunk]) {
+		ack.nextChunk++;
+	}
+	ack.receivedBits = 0;
+	for (int bit = 0; bit < ACK_BITS; bit++) {
+		const int chunkIndex = ack.nextChunk + 1 + bit;
+		if (chunkIndex < (int)mIsReceived.size() && mIsReceived[chunkIndex]) {
+			ack.receivedBits |= 1u << bit;
+		}
+	}
+}
+#endif
@@ -0,0 +1,115 @@
+#ifdef USEGL
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "NetworkBase.h"
+#include "PacketSerializer.h"
+#include "SnapshotCompression.h"
+
+namespace NCL::CSC8503 {
+	//Bytes of the image each chunk covers, small enough for the snapshot codec to take in one go.
+	constexpr int JOIN_STATE_CHUNK_SIZE = 1024;
+	//Far more than a level needs, chunk indices still fit in a short.
+	constexpr int JOIN_STATE_MAX_IMAGE_SIZE = 1024 * 1024;
+
+	//One block of a join image, compressed on its own so it can be unpacked whatever order chunks arrive in.
+	struct JoinStateChunkPacket : public GamePacket {
+		int		streamID = -1;
+		int		imageSize = 0;
+		short	chunkIndex = 0;
+		short	chunkCount = 0;
+		bool	isCompressed = false;
+		bool	usesDictionary = false;	//Compressed against the snapshot dictionary the client offered at connect
+		char	data[JOIN_STATE_CHUNK_SIZE];
+
+		JoinStateChunkPacket() {
+			type = JoinState_Chunk;
+			SetPayloadSize(0);
+		}
+
+		int GetHeaderSize() const {
+			return (int)(data - reinterpret_cast<const char*>(this));
+		}
+
+		void SetPayloadSize(int payloadBytes) {
+			size = (short)(GetHeaderSize() - sizeof(GamePacket) + payloadBytes);
+		}
+
+		int GetPayloadSize() const {
+			return size - (GetHeaderSize() - (int)sizeof(GamePacket));
+		}
+	};
+
+	struct JoinStateAckPacket : public SerializablePacket {
+		int streamID = -1;
+		int nextChunk = 0;			//Every chunk before this has arrived
+		uint32_t receivedBits = 0;	//Bit n is chunk nextChunk + 1 + n
+
+		JoinStateAckPacket();
+		void Serialize(BitStream& stream) override;
+	};
+
+	// Sends one join image to one client. The transport drops what it likes, so a chunk goes out again until
+	// the client acknowledges it, and only so many bytes go out a tick so everyone already playing keeps
+	// getting their snapshots on time.
+	class JoinStateSender {
+	public:
+		//The image is chunked and compressed up front, null dictionary compresses without one.
+		JoinStateSender(int streamID, const char* image, int imageSize, const SnapshotDictionary* dictionary, float startTime);
+
+		//Sends, in order, every chunk not sent yet or unacknowledged for resendDelay until byteBudget is used. Returns bytes sent.
+		int Update(float time, int byteBudget, float resendDelay, const std::function<void(JoinStateChunkPacket& chunk)>& send);
+		void Acknowledge(const JoinStateAckPacket& ack);
+
+		bool IsComplete() const { return mAckedCount == (int)mChunks.size(); }
+		int GetStreamID() const { return mStreamID; }
+		float GetStartTime() const { return mStartTime; }
+		int GetImageSize() const { return mImageSize; }
+		//Header and payload of every chunk, as they first go out.
+		int GetStreamSize() const { return mStreamSize; }
+
+	protected:
+		int mStreamID;
+		int mImageSize;
+		int mStreamSize;
+		float mStartTime;
+
+		std::vector<JoinStateChunkPacket> mChunks;
+		//-1 for a chunk not sent yet.
+		std::vector<float> mSentTimes;
+		std::vector<bool> mIsAcked;
+		int mAckedCount;
+		//Chunks before this are all acknowledged.
+		int mFirstUnacked;
+	};
+
+	//Puts a join image back together on the client.
+	class JoinStateReceiver {
+	public:
+		JoinStateReceiver();
+
+		//Only needed for chunks the server packed against it.
+		void SetDictionary(const SnapshotDictionary* dictionary);
+
+		//A chunk from another stream starts over. False for one that is malformed or doesn't unpack.
+		bool ReceiveChunk(const JoinStateChunkPacket& chunk);
+		void Reset();
+
+		bool IsStarted() const { return mStreamID != -1; }
+		bool IsComplete() const { return IsStarted() && mReceivedCount == (int)mIsReceived.size(); }
+		const std::vector<char>& GetImage() const { return mImage; }
+		void FillAck(JoinStateAckPacket& ack) const;
+
+	protected:
+		SnapshotCodec mCodec;
+		SnapshotCodec mDictionaryCodec;
+
+		int mStreamID;
+		std::vector<char> mImage;
+		std::vector<bool> mIsReceived;
+		int mReceivedCount;
+	};
+}
+#endif
@@ -192,6 +192,7 @@ void JsonParser::WritePlayerStartTransforms(std::vector<std::unordered_map<std::
 			.SetOrientation(Quaternion::EulerAnglesToQuaternion(direction.x, direction.y, direction.z));
 		level->mPlayerStartTransforms[mPlayerCount] = newTransform;
 		mPlayerCount++;
+		level->mPlayerStartCount = mPlayerCount;
 	}
 }
 
@@ -0,0 +1,233 @@
+#include "JsonReader.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+using namespace NCL::CSC8503;
+
+namespace {
+	//Every power of ten a double holds exactly.
+	constexpr double EXACT_POWERS_OF_TEN[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	constexpr int MAX_EXACT_POWER = 22;
+	//Mantissas past this lose bits when made a double.
+	constexpr uint64_t MAX_EXACT_MANTISSA = 1ull << 53;
+	//As many decimal digits as a uint64_t always holds.
+	constexpr int MAX_MANTISSA_DIGITS = 19;
+	constexpr int MAX_EXPONENT = 10000;
+	//Longer than any number a level exporter writes.
+	constexpr int MAX_NUMBER_LENGTH = 64;
+
+	bool IsDigit(char c) {
+		return c >= '0' && c <= '9';
+	}
+}
+
+JsonReader::JsonReader(const char* json, size_t size) {
+	mStart = json;
+	mCursor = json;
+	mEnd = json + size;
+	mHasError = false;
+}
+
+bool JsonReader::Fail() {
+	mHasError = true;
+	return false;
+}
+
+void JsonReader::SkipWhitespace() {
+	while (mCursor < mEnd && (*mCursor == ' ' || *mCursor == '\n' || *mCursor == '\r' || *mCursor == '\t')) {
+		mCursor++;
+	}
+}
+
+bool JsonReader::Expect(char c) {
+	SkipWhitespace();
+	if (mCursor < mEnd && *mCursor == c) {
+		mCursor++;
+		return true;
+	}
+	return Fail();
+}
+
+bool JsonReader::IsClosing(char closing) {
+	SkipWhitespace();
+	if (mCursor < mEnd && *mCursor == closing) {
+		mCursor++;
+		return true;
+	}
+	//separators aren't checked for, the exporter always writes them
+	if (mCursor < mEnd && *mCursor == ',') {
+		mCursor++;
+	}
+	return false;
+}
+
+bool JsonReader::BeginObject() {
+	return !mHasError && Expect('{');
+}
+
+bool JsonReader::NextMember(std::string_view& key) {
+	if (mHasError || IsClosing('}')) {
+		return false;
+	}
+	return ReadString(key) && Expect(':');
+}
+
+bool JsonReader::BeginArray() {
+	return !mHasError && Expect('[');
+}
+
+bool JsonReader::NextElement() {
+	if (mHasError || IsClosing(']')) {
+		return false;
+	}
+	SkipWhitespace();
+	return mCursor < mEnd || Fail();
+}
+
+// Exact for the common case: a mantissa that fits in a double scaled by a power of ten that does too is one
+// correctly rounded multiply or divide. Anything else is handed to strtod, which is slow but always right.
+bool JsonReader::ReadNumber(double& value) {
+	SkipWhitespace();
+	const char* numberStart = mCursor;
+	const bool isNegative = mCursor < mEnd && *mCursor == '-';
+	if (isNegative) {
+		mCursor++;
+	}
+
+	uint64_t mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+	bool hasDigits = false;
+	auto addDigit = [&](char c) {
+		hasDigits = true;
+		if (mantissa == 0 && c == '0') {
+			return;
+		}
+		significantDigits++;
+		if (significantDigits <= MAX_MANTISSA_DIGITS) {
+			mantissa = mantissa * 10 + (c - '0');
+		}
+	};
+	while (mCursor < mEnd && IsDigit(*mCursor)) {
+		addDigit(*mCursor++);
+	}
+	if (mCursor < mEnd && *mCursor == '.') {
+		mCursor++;
+		while (mCursor < mEnd && IsDigit(*mCursor)) {
+			addDigit(*mCursor++);
+			exponent--;
+		}
+	}
+	if (!hasDigits) {
+		return Fail();
+	}
+	if (mCursor < mEnd && (*mCursor == 'e' || *mCursor == 'E')) {
+		mCursor++;
+		const bool isExponentNegative = mCursor < mEnd && *mCursor == '-';
+		if (mCursor < mEnd && (*mCursor == '-' || *mCursor == '+')) {
+			mCursor++;
+		}
+		if (mCursor >= mEnd || !IsDigit(*mCursor)) {
+			return Fail();
+		}
+		int writtenExponent = 0;
+		while (mCursor < mEnd && IsDigit(*mCursor)) {
+			if (writtenExponent < MAX_EXPONENT) {
+				writtenExponent = writtenExponent * 10 + (*mCursor - '0');
+			}
+			mCursor++;
+		}
+		exponent += isExponentNegative ? -writtenExponent : writtenExponent;
+	}
+
+	if (significantDigits <= MAX_MANTISSA_DIGITS && mantissa <= MAX_EXACT_MANTISSA && exponent >= -MAX_EXACT_POWER && exponent <= MAX_EXACT_POWER) {
+		double result = (double)mantissa;
+		result = exponent < 0 ? result / EXACT_POWERS_OF_TEN[-exponent] : result * EXACT_POWERS_OF_TEN[exponent];
+		value = isNegative ? -result : result;
+		return true;
+	}
+
+	const size_t length = mCursor - numberStart;
+	if (length > MAX_NUMBER_LENGTH) {
+		return Fail();
+	}
+	//the buffer isn't terminated, strtod needs a copy that is
+	char number[MAX_NUMBER_LENGTH + 1];
+	memcpy(number, numberStart, length);
+	number[length] = '\0';
+	value = strtod(number, nullptr);
+	return true;
+}
+
+bool JsonReader::ReadFloat(float& value) {
+	double number;
+	if (!ReadNumber(number)) {
+		return false;
+	}
+	value = (float)number;
+	return true;
+}
+
+bool JsonReader::ReadInt(int& value) {
+	double number;
+	if (!ReadNumber(number)) {
+		return false;
+	}
+	value = (int)number;
+	return true;
+}
+
+bool JsonReader::ReadString(std::string_view& value) {
+	if (!Expect('"')) {
+		return false;
+	}
+	const char* stringStart = mCursor;
+	while (mCursor < mEnd && *mCursor != '"') {
+		if (*mCursor == '\\') {
+			mCursor++;
+		}
+		mCursor++;
+	}
+	if (mCursor >= mEnd) {
+		return Fail();
+	}
+	value = std::string_view(stringStart, mCursor - stringStart);
+	mCursor++;
+	return true;
+}
+
+bool JsonReader::SkipValue() {
+	SkipWhitespace();
+	if (mCursor >= mEnd) {
+		return Fail();
+	}
+	switch (*mCursor) {
+	case '{':
+		return ReadObject([this](std::string_view) { return SkipValue(); });
+	case '[':
+		return ReadArray([this]() { return SkipValue(); });
+	case '"': {
+		std::string_view ignored;
+		return ReadString(ignored);
+	}
+	case 't':
+	case 'f':
+	case 'n': {
+		const char* literalStart = mCursor;
+		while (mCursor < mEnd && *mCursor >= 'a' && *mCursor <= 'z') {
+			mCursor++;
+		}
+		const std::string_view literal(literalStart, mCursor - literalStart);
+		return literal == "true" || literal == "false" || literal == "null" || Fail();
+	}
+	default: {
+		double ignored;
+		return ReadNumber(ignored);
+	}
+	}
+}
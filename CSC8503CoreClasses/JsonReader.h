@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+namespace NCL {
+	namespace CSC8503 {
+		// Walks a JSON document in place, one token at a time. Keys come back as views into the buffer, so nothing
+		// is copied or allocated, and the caller decides what each value is by reading it as that type. String escapes
+		// are not decoded, level files never have any.
+		class JsonReader {
+		public:
+			JsonReader(const char* json, size_t size);
+
+			bool BeginObject();
+			//False once the closing brace is consumed.
+			bool NextMember(std::string_view& key);
+			bool BeginArray();
+			//False once the closing bracket is consumed.
+			bool NextElement();
+
+			bool ReadNumber(double& value);
+			bool ReadFloat(float& value);
+			bool ReadInt(int& value);
+			bool ReadString(std::string_view& value);
+			bool SkipValue();
+
+			//Calls readMember(key) for every member of the next object, it must consume the member's value.
+			template <typename ReadMember>
+			bool ReadObject(ReadMember&& readMember) {
+				if (!BeginObject()) {
+					return false;
+				}
+				std::string_view key;
+				while (NextMember(key)) {
+					if (!readMember(key)) {
+						return Fail();
+					}
+				}
+				return !mHasError;
+			}
+
+			//Calls readElement() for every element of the next array, it must consume the element.
+			template <typename ReadElement>
+			bool ReadArray(ReadElement&& readElement) {
+				if (!BeginArray()) {
+					return false;
+				}
+				while (NextElement()) {
+					if (!readElement()) {
+						return Fail();
+					}
+				}
+				return !mHasError;
+			}
+
+			bool HasError() const { return mHasError; }
+			//Bytes into the document, where the error was if there was one.
+			size_t GetOffset() const { return mCursor - mStart; }
+
+		protected:
+			bool Fail();
+			void SkipWhitespace();
+			bool Expect(char c);
+			//Skips the comma between members or elements, true if the container closes instead.
+			bool IsClosing(char closing);
+
+			const char* mStart;
+			const char* mCursor;
+			const char* mEnd;
+			bool mHasError;
+		};
+	}
+}
@@ -1,27 +1,50 @@
 #include "Level.h"
-#include "JsonParser.h"
-#include <fstream>
+#include "LevelReader.h"
+#include "CookedLevel.h"
 
 using namespace NCL::CSC8503;
 
+namespace {
+	constexpr float SHARED_PLAYER_START_SPACING = 2.0f;
+}
 
-Level::Level(std::string levelPath) {
-	mLevelName = levelPath.substr(24, levelPath.size()-29);
+Level::Level() {
 	mPlayerStartTransforms = new Transform[MAX_PLAYERS];
-	std::ifstream levelFile(levelPath);
-	std::string line;
-	getline(levelFile, line);
+	mGuardCount = 0;
+	mCCTVCount = 0;
+	mPrisonDoor = nullptr;
+}
 
-	JsonParser parser = JsonParser();
+Level::Level(std::string levelPath) : Level() {
+	mLevelName = levelPath.substr(24, levelPath.size()-29);
+
+	if (CookedLevel::Load(levelPath, this, nullptr)) {
+		return;
+	}
+	LevelReader reader = LevelReader();
 
-	parser.ParseJson(line, this, nullptr);
+	if (reader.ReadFile(levelPath, this, nullptr)) {
+		CookedLevel::Cook(levelPath, false);
+	}
+}
+
+Transform Level::GetPlayerStartTransform(int player) const {
+	if (player < 0 || mPlayerStartCount == 0) {
+		return Transform();
+	}
+	Transform start = mPlayerStartTransforms[player % mPlayerStartCount];
+	const int lap = player / mPlayerStartCount;
+	if (lap > 0) {
+		start.SetPosition(start.GetPosition() + Vector3(lap * SHARED_PLAYER_START_SPACING, 0, 0));
+	}
+	return start;
 }
 
 Level::~Level() {
 	for (auto const& [key, val] : mRoomList) {
 		delete(val);
-		mRoomList.erase(key);
 	}
+	mRoomList.clear();
 	for (int i = 0; i < mLights.size(); i++) {
 		delete(mLights[i]);
 	}
@@ -8,6 +8,8 @@ namespace NCL {
 		class PrisonDoor;
 		class Level {
 		public:
+			//Empty, for a reader to fill.
+			Level();
 			Level(std::string levelPath);
 			~Level();
 			const std::unordered_map<Transform, TileType>& GetTileMap() { return mTileMap; }
@@ -17,7 +19,8 @@ namespace NCL {
 			std::vector<Transform> GetCCTVTransforms() const { return mCCTVTransforms; }
 			int GetCCTVCount() const { return mCCTVCount; }
 			Vector3 GetPrisonPosition() const { return mPrisonPosition; }
-			Transform GetPlayerStartTransform(int player) const { if (player < 0 || player >= 4) return Transform(); return mPlayerStartTransforms[player]; }
+			//Levels only place a few starts, players past those share them a little further along.
+			Transform GetPlayerStartTransform(int player) const;
 			std::vector<Light*> GetLights() const { return mLights; }
 			std::vector<Vector3> GetItemPositions() const { return mItemPositions; }
 			std::vector<Vent*> GetVents() const { return mVents; }
@@ -28,6 +31,8 @@ namespace NCL {
 			const std::unordered_map<DecorationType, std::vector<Transform>>& GetDecorationMap() { return mDecorationMap; }
 
 			friend class JsonParser;
+			friend class LevelReader;
+			friend class CookedLevel;
 		protected:
 			std::string mLevelName;
 			std::unordered_map<Transform, TileType> mTileMap;
@@ -38,6 +43,7 @@ namespace NCL {
 			int mCCTVCount;
 			Vector3 mPrisonPosition;
 			Transform* mPlayerStartTransforms;
+			int mPlayerStartCount = 0;
 			std::vector<Light*> mLights;
 			std::vector<Vector3> mItemPositions;
 			std::vector<Vent*> mVents;
@@ -1,7 +1,11 @@
 #pragma once
 namespace NCL {
 	namespace CSC8503 {
-		constexpr int MAX_PLAYERS = 4;
+		//Most players a match can be set up for.
+		constexpr int MAX_PLAYERS = 16;
+		//Players are numbered by slot, and per player storage is sized by the slots. A dedicated server keeps
+		//slot 0 for the host it doesn't have, so needs one more slot than it has players.
+		constexpr int MAX_PLAYER_SLOTS = MAX_PLAYERS + 1;
 		enum TileType {
 			Wall,
 			Floor,
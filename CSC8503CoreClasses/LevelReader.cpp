@@ -0,0 +1,356 @@
+#include "LevelReader.h"
+#include "MappedFile.h"
+#include "PointLight.h"
+#include "SpotLight.h"
+#include "PrisonDoor.h"
+#include "Vent.h"
+#include "InteractableDoor.h"
+
+#include <iostream>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	bool ReadVector(JsonReader& reader, float* values, int count) {
+		return reader.ReadObject([&](std::string_view key) {
+			const int index = key == "x" ? 0 : key == "y" ? 1 : key == "z" ? 2 : key == "w" ? 3 : -1;
+			if (index < 0 || index >= count) {
+				return reader.SkipValue();
+			}
+			return reader.ReadFloat(values[index]);
+		});
+	}
+
+	bool ReadVector3(JsonReader& reader, Vector3& vector) {
+		float values[3] = { 0.0f, 0.0f, 0.0f };
+		if (!ReadVector(reader, values, 3)) {
+			return false;
+		}
+		vector = Vector3(values[0], values[1], values[2]);
+		return true;
+	}
+
+	bool ReadVector4(JsonReader& reader, Vector4& vector) {
+		float values[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		if (!ReadVector(reader, values, 4)) {
+			return false;
+		}
+		vector = Vector4(values[0], values[1], values[2], values[3]);
+		return true;
+	}
+
+	//The editor's z axis points the other way.
+	Vector3 ToWorldPosition(const Vector3& position) {
+		return Vector3(position.x, position.y, -position.z);
+	}
+
+	//Quaternions come out of the editor with y and w swapped.
+	Quaternion ToWorldOrientation(const Vector4& rotation) {
+		return Quaternion(rotation.x, rotation.w, rotation.z, rotation.y);
+	}
+
+	//Euler angles in the editor's axes, as the direction something placed with them faces.
+	Vector3 ToFacingDirection(const Vector3& rotation) {
+		Matrix4 xRot = Matrix4::Rotation(rotation.x, Vector3(1, 0, 0));
+		Matrix4 yRot = Matrix4::Rotation(rotation.y - 180, Vector3(0, -1, 0));
+		Matrix4 zRot = Matrix4::Rotation(-rotation.z, Vector3(0, 0, 1));
+		return yRot * xRot * zRot * Vector3(0, 0, 90);
+	}
+
+	//Doors face the opposite way to the editor's.
+	Quaternion ToDoorOrientation(const Vector3& rotation) {
+		return Quaternion::EulerAnglesToQuaternion(rotation.x, rotation.y - 180, -rotation.z);
+	}
+}
+
+bool LevelReader::ReadFile(const std::string& path, Level* level, Room* room) {
+	MappedFile file;
+	if (!file.Open(path)) {
+		return false;
+	}
+	return Read(file.GetData(), file.GetSize(), level, room);
+}
+
+bool LevelReader::Read(const char* json, size_t size, Level* level, Room* room) {
+	if ((!level && !room) || (level && room)) return false;
+	JsonReader reader(json, size);
+	const bool isRead = reader.ReadObject([&](std::string_view key) {
+		return level ? ReadLevelMember(reader, key, *level) : ReadRoomMember(reader, key, *room);
+	});
+	if (!isRead) {
+		std::cout << __FUNCTION__ << " malformed JSON at byte " << reader.GetOffset() << "\n";
+	}
+	return isRead;
+}
+
+bool LevelReader::ReadLevelMember(JsonReader& reader, std::string_view key, Level& level) {
+	if (key == "tiles") return ReadTiles(reader, level.mTileMap);
+	if (key == "rooms") return ReadRooms(reader, level.mRoomList);
+	if (key == "guardCount") return reader.ReadInt(level.mGuardCount);
+	if (key == "cctvCount") return reader.ReadInt(level.mCCTVCount);
+	if (key == "guardPaths") return ReadGuardPaths(reader, level.mGuardPaths);
+	if (key == "cctvPositions") return ReadCCTVTransforms(reader, level.mCCTVTransforms);
+	if (key == "prisonPosition") {
+		Vector3 position;
+		if (!ReadVector3(reader, position)) return false;
+		level.mPrisonPosition = ToWorldPosition(position);
+		return true;
+	}
+	if (key == "playerStartPositions") return ReadPlayerStartTransforms(reader, level);
+	if (key == "pointLights") return ReadPointLights(reader, level.mLights);
+	if (key == "spotlights") return ReadSpotlights(reader, level.mLights);
+	if (key == "itemPositions") return ReadItemPositions(reader, level.mItemPositions);
+	if (key == "vents") return ReadVents(reader, level);
+	if (key == "helipadPosition") {
+		Vector3 position;
+		if (!ReadVector3(reader, position)) return false;
+		level.mHelipadPosition = ToWorldPosition(position);
+		return true;
+	}
+	if (key == "prisonDoor") return ReadPrisonDoor(reader, level);
+	if (key == "doors") return ReadDoors(reader, level.mDoors);
+	if (key == "decorations") return ReadDecorations(reader, level.mDecorationMap);
+	//the directional light is written but the renderer sets its own
+	return reader.SkipValue();
+}
+
+bool LevelReader::ReadRoomMember(JsonReader& reader, std::string_view key, Room& room) {
+	if (key == "type") {
+		int type = 0;
+		if (!reader.ReadInt(type)) return false;
+		room.mType = (RoomType)type;
+		return true;
+	}
+	if (key == "doorPositions") {
+		room.mPrimaryDoor = 0;
+		return reader.ReadInt(room.mDoorConfig);
+	}
+	if (key == "tiles") return ReadTiles(reader, room.mTileMap);
+	if (key == "cctvPositions") return ReadCCTVTransforms(reader, room.mCCTVTransforms);
+	if (key == "pointLights") return ReadPointLights(reader, room.mLights);
+	if (key == "spotlights") return ReadSpotlights(reader, room.mLights);
+	if (key == "itemPositions") return ReadItemPositions(reader, room.mItemPositions);
+	if (key == "doors") return ReadDoors(reader, room.mDoors);
+	if (key == "decorations") return ReadDecorations(reader, room.mDecorationMap);
+	return reader.SkipValue();
+}
+
+bool LevelReader::ReadTiles(JsonReader& reader, std::unordered_map<Transform, TileType>& tileMap) {
+	return reader.ReadArray([&]() {
+		int type = 0;
+		Vector3 position;
+		Vector4 rotation;
+		const bool isRead = reader.ReadObject([&](std::string_view key) {
+			if (key == "type") return reader.ReadInt(type);
+			if (key == "position") return ReadVector3(reader, position);
+			if (key == "rotation") return ReadVector4(reader, rotation);
+			return reader.SkipValue();
+		});
+		if (isRead) {
+			Transform key = Transform();
+			key.SetPosition(ToWorldPosition(position)).SetOrientation(ToWorldOrientation(rotation));
+			tileMap[key] = (TileType)type;
+		}
+		return isRead;
+	});
+}
+
+bool LevelReader::ReadRooms(JsonReader& reader, std::unordered_map<Vector3, Room*>& roomList) {
+	return reader.ReadArray([&]() {
+		int type = 0;
+		int doorPositions = 0;
+		int primaryDoor = 0;
+		Vector3 position;
+		const bool isRead = reader.ReadObject([&](std::string_view key) {
+			if (key == "type") return reader.ReadInt(type);
+			if (key == "roomPosition") return ReadVector3(reader, position);
+			if (key == "doorPositions") return reader.ReadInt(doorPositions);
+			if (key == "primaryDoor") return reader.ReadInt(primaryDoor);
+			return reader.SkipValue();
+		});
+		if (isRead) {
+			roomList[ToWorldPosition(position)] = new Room(type, doorPositions, primaryDoor);
+		}
+		return isRead;
+	});
+}
+
+bool LevelReader::ReadGuardPaths(JsonReader& reader, std::vector<std::vector<Vector3>>& guardPaths) {
+	return reader.ReadArray([&]() {
+		std::vector<Vector3>& path = guardPaths.emplace_back();
+		return reader.ReadObject([&](std::string_view key) {
+			if (key != "nodes") return reader.SkipValue();
+			return reader.ReadArray([&]() {
+				Vector3 node;
+				if (!ReadVector3(reader, node)) return false;
+				path.push_back(ToWorldPosition(node));
+				return true;
+			});
+		});
+	});
+}
+
+bool LevelReader::ReadCCTVTransforms(JsonReader& reader, std::vector<Transform>& cctvTransforms) {
+	return reader.ReadArray([&]() {
+		Vector3 position;
+		Vector4 rotation;
+		const bool isRead = reader.ReadObject([&](std::string_view key) {
+			if (key == "position") return ReadVector3(reader, position);
+			if (key == "rotation") return ReadVector4(reader, rotation);
+			return reader.SkipValue();
+		});
+		if (isRead) {
+			Transform newTransform = Transform();
+			newTransform.SetPosition(ToWorldPosition(position)).SetOrientation(ToWorldOrientation(rotation));
+			cctvTransforms.push_back(newTransform);
+		}
+		return isRead;
+	});
+}
+
+bool LevelReader::ReadPlayerStartTransforms(JsonReader& reader, Level& level) {
+	return reader.ReadArray([&]() {
+		Vector3 position;
+		Vector3 rotation;
+		const bool isRead = reader.ReadObject([&](std::string_view key) {
+			if (key == "position") return ReadVector3(reader, position);
+			if (key == "rotation") return ReadVector3(reader, rotation);
+			return reader.SkipValue();
+		});
+		if (isRead && level.mPlayerStartCount < MAX_PLAYERS) {
+			const Vector3 direction = ToFacingDirection(rotation);
+			Transform newTransform = Transform();
+			newTransform.SetPosition(ToWorldPosition(position))
+				.SetOrientation(Quaternion::EulerAnglesToQuaternion(direction.x, direction.y, direction.z));
+			level.mPlayerStartTransforms[level.mPlayerStartCount] = newTransform;
+			level.mPlayerStartCount++;
+		}
+		return isRead;
+	});
+}
+
+bool LevelReader::ReadPointLights(JsonReader& reader, std::vector<Light*>& lights) {
+	return reader.ReadArray([&]() {
+		Vector3 position;
+		Vector4 colour;
+		float radius = 0.0f;
+		const bool isRead = reader.ReadObject([&](std::string_view key) {
+			if (key == "position") return ReadVector3(reader, position);
+			if (key == "colour") return ReadVector4(reader, colour);
+			if (key == "radius") return reader.ReadFloat(radius);
+			return reader.SkipValue();
+		});
+		if (isRead) {
+			lights.push_back((Light*)new PointLight(ToWorldPosition(position), colour, radius));
+		}
+		return isRead;
+	});
+}
+
+bool LevelReader::ReadSpotlights(JsonReader& reader, std::vector<Light*>& lights) {
+	return reader.ReadArray([&]() {
+		Vector3 position;
+		Vector4 colour;
+		Vector3 rotation;
+		float angle = 0.0f;
+		float radius = 0.0f;
+		const bool isRead = reader.ReadObject([&](std::string_view key) {
+			if (key == "position") return ReadVector3(reader, position);
+			if (key == "colour") return ReadVector4(reader, colour);
+			if (key == "direction") return ReadVector3(reader, rotation);
+			if (key == "angle") return reader.ReadFloat(angle);
+			if (key == "radius") return reader.ReadFloat(radius);
+			return reader.SkipValue();
+		});
+		if (isRead) {
+			lights.push_back((Light*)new SpotLight(ToFacingDirection(rotation), ToWorldPosition(position), colour, radius, angle, 1.0f));
+		}
+		return isRead;
+	});
+}
+
+bool LevelReader::ReadItemPositions(JsonReader& reader, std::vector<Vector3>& itemPositions) {
+	return reader.ReadArray([&]() {
+		Vector3 position;
+		if (!ReadVector3(reader, position)) return false;
+		itemPositions.push_back(ToWorldPosition(position));
+		return true;
+	});
+}
+
+bool LevelReader::ReadVents(JsonReader& reader, Level& level) {
+	return reader.ReadArray([&]() {
+		Vector3 position;
+		Vector3 rotation;
+		int connectedVentID = 0;
+		const bool isRead = reader.ReadObject([&](std::string_view key) {
+			if (key == "position") return ReadVector3(reader, position);
+			if (key == "rotation") return ReadVector3(reader, rotation);
+			if (key == "connectedVentID") return reader.ReadInt(connectedVentID);
+			return reader.SkipValue();
+		});
+		if (isRead) {
+			Vent* vent = new Vent();
+			vent->GetTransform().SetPosition(ToWorldPosition(position))
+				.SetOrientation(Quaternion::EulerAnglesToQuaternion(rotation.x, rotation.y, -rotation.z));
+			level.mVents.push_back(vent);
+			level.mVentConnections.push_back(connectedVentID);
+		}
+		return isRead;
+	});
+}
+
+bool LevelReader::ReadDoors(JsonReader& reader, std::vector<Door*>& doors) {
+	return reader.ReadArray([&]() {
+		Vector3 position;
+		Vector3 rotation;
+		const bool isRead = reader.ReadObject([&](std::string_view key) {
+			if (key == "position") return ReadVector3(reader, position);
+			if (key == "rotation") return ReadVector3(reader, rotation);
+			return reader.SkipValue();
+		});
+		if (isRead) {
+			InteractableDoor* door = new InteractableDoor();
+			door->GetTransform().SetPosition(ToWorldPosition(position)).SetOrientation(ToDoorOrientation(rotation));
+			doors.push_back(door);
+		}
+		return isRead;
+	});
+}
+
+bool LevelReader::ReadPrisonDoor(JsonReader& reader, Level& level) {
+	Vector3 position;
+	Vector3 rotation;
+	const bool isRead = reader.ReadObject([&](std::string_view key) {
+		if (key == "position") return ReadVector3(reader, position);
+		if (key == "rotation") return ReadVector3(reader, rotation);
+		return reader.SkipValue();
+	});
+	if (isRead) {
+		PrisonDoor* prisonDoor = new PrisonDoor();
+		prisonDoor->GetTransform().SetPosition(ToWorldPosition(position)).SetOrientation(ToDoorOrientation(rotation));
+		level.mPrisonDoor = prisonDoor;
+	}
+	return isRead;
+}
+
+bool LevelReader::ReadDecorations(JsonReader& reader, std::unordered_map<DecorationType, std::vector<Transform>>& decorationMap) {
+	return reader.ReadArray([&]() {
+		int type = 0;
+		Vector3 position;
+		Vector4 rotation;
+		const bool isRead = reader.ReadObject([&](std::string_view key) {
+			if (key == "type") return reader.ReadInt(type);
+			if (key == "position") return ReadVector3(reader, position);
+			if (key == "rotation") return ReadVector4(reader, rotation);
+			return reader.SkipValue();
+		});
+		if (isRead) {
+			Transform value = Transform();
+			value.SetPosition(ToWorldPosition(position)).SetOrientation(ToWorldOrientation(rotation));
+			decorationMap[(DecorationType)type].push_back(value);
+		}
+		return isRead;
+	});
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "Level.h"
+#include "JsonReader.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		class Door;
+		// Reads a level or room file straight into its fields in one pass over the JSON. Members are matched by
+		// name, so the order the editor writes them in doesn't matter, and anything unknown is skipped.
+		class LevelReader {
+		public:
+			//Fills exactly one of level and room, false if the JSON is malformed.
+			bool Read(const char* json, size_t size, Level* level, Room* room);
+			bool ReadFile(const std::string& path, Level* level, Room* room);
+
+		protected:
+			bool ReadLevelMember(JsonReader& reader, std::string_view key, Level& level);
+			bool ReadRoomMember(JsonReader& reader, std::string_view key, Room& room);
+
+			bool ReadTiles(JsonReader& reader, std::unordered_map<Transform, TileType>& tileMap);
+			bool ReadRooms(JsonReader& reader, std::unordered_map<Vector3, Room*>& roomList);
+			bool ReadGuardPaths(JsonReader& reader, std::vector<std::vector<Vector3>>& guardPaths);
+			bool ReadCCTVTransforms(JsonReader& reader, std::vector<Transform>& cctvTransforms);
+			bool ReadPlayerStartTransforms(JsonReader& reader, Level& level);
+			bool ReadPointLights(JsonReader& reader, std::vector<Light*>& lights);
+			bool ReadSpotlights(JsonReader& reader, std::vector<Light*>& lights);
+			bool ReadItemPositions(JsonReader& reader, std::vector<Vector3>& itemPositions);
+			bool ReadVents(JsonReader& reader, Level& level);
+			bool ReadDoors(JsonReader& reader, std::vector<Door*>& doors);
+			bool ReadPrisonDoor(JsonReader& reader, Level& level);
+			bool ReadDecorations(JsonReader& reader, std::unordered_map<DecorationType, std::vector<Transform>>& decorationMap);
+		};
+	}
+}
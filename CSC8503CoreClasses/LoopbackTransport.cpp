@@ -0,0 +1,382 @@
+#ifdef USEGL
+#include "LoopbackTransport.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	//A link that can't send what it is given within this long drops the rest, as a full router queue would.
+	constexpr float MAX_LINK_QUEUE_TIME = 1.0f;
+}
+
+LoopbackHost::LoopbackHost(LoopbackTransport& transport, int hostID, int port, int maxPeers) : mTransport(transport) {
+	mHostID = hostID;
+	mPort = port;
+	mPeers.resize(std::max(1, maxPeers));
+}
+
+LoopbackHost::~LoopbackHost() {
+	std::lock_guard<std::recursive_mutex> lock(mTransport.mMutex);
+	for (int i = 0; i < (int)mPeers.size(); i++) {
+		if (mPeers[i].state != PeerState::Free) {
+			Disconnect(i);
+		}
+	}
+	for (const TransportEvent& event : mEvents) {
+		mTransport.RemoveReference(event.packet);
+	}
+	mTransport.RemoveHost(*this);
+}
+
+int LoopbackHost::Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int port, uint32_t data) {
+	std::lock_guard<std::recursive_mutex> lock(mTransport.mMutex);
+	const int peer = GetFreePeer();
+	if (peer < 0) {
+		return -1;
+	}
+	mPeers[peer] = Peer();
+	mPeers[peer].state = PeerState::Connecting;
+
+	LoopbackTransport::Message message;
+	message.type = LoopbackTransport::MessageType::Connect;
+	message.fromHost = mHostID;
+	message.fromPeer = peer;
+	message.toPort = port;
+	message.data = data;
+	mTransport.PostControl(message);
+	return peer;
+}
+
+bool LoopbackHost::Service(TransportEvent& event, int timeoutMs) {
+	std::lock_guard<std::recursive_mutex> lock(mTransport.mMutex);
+	if (mEvents.empty()) {
+		return false;
+	}
+	event = mEvents.front();
+	mEvents.pop_front();
+	return true;
+}
+
+TransportPacket LoopbackHost::CreatePacket(const void* data, int size) {
+	std::lock_guard<std::recursive_mutex> lock(mTransport.mMutex);
+	LoopbackTransport::LoopbackPacket* loopbackPacket = new LoopbackTransport::LoopbackPacket();
+	loopbackPacket->bytes.resize(size);
+	memcpy(loopbackPacket->bytes.data(), data, size);
+	loopbackPacket->references = 1;
+
+	TransportPacket packet;
+	packet.data = loopbackPacket->bytes.data();
+	packet.size = size;
+	packet.handle = loopbackPacket;
+	return packet;
+}
+
+void LoopbackHost::ReleasePacket(const TransportPacket& packet) {
+	std::lock_guard<std::recursive_mutex> lock(mTransport.mMutex);
+	mTransport.RemoveReference(packet);
+}
+
+bool LoopbackHost::Send(int peer, const TransportPacket& packet) {
+	std::lock_guard<std::recursive_mutex> lock(mTransport.mMutex);
+	if (peer < 0 || peer >= (int)mPeers.size() || mPeers[peer].state != PeerState::Connected || !packet.handle) {
+		return false;
+	}
+	return mTransport.PostData(*this, peer, packet);
+}
+
+void LoopbackHost::Broadcast(const TransportPacket& packet) {
+	std::lock_guard<std::recursive_mutex> lock(mTransport.mMutex);
+	for (int i = 0; i < (int)mPeers.size(); i++) {
+		if (mPeers[i].state == PeerState::Connected) {
+			mTransport.PostData(*this, i, packet);
+		}
+	}
+}
+
+void LoopbackHost::Disconnect(int peer) {
+	ClosePeer(peer, false);
+}
+
+void LoopbackHost::DisconnectLater(int peer) {
+	ClosePeer(peer, true);
+}
+
+void LoopbackHost::ClosePeer(int peer, bool isAfterData) {
+	std::lock_guard<std::recursive_mutex> lock(mTransport.mMutex);
+	if (peer < 0 || peer >= (int)mPeers.size() || mPeers[peer].state == PeerState::Free) {
+		return;
+	}
+	//a connection still being set up is let go when its Accept arrives
+	if (mPeers[peer].state == PeerState::Connected) {
+		LoopbackTransport::Message message;
+		message.type = LoopbackTransport::MessageType::Disconnect;
+		message.fromHost = mHostID;
+		message.fromPeer = peer;
+		message.toHost = mPeers[peer].remoteHost;
+		message.toPeer = mPeers[peer].remotePeer;
+		mTransport.PostControl(message, isAfterData ? &mPeers[peer] : nullptr);
+	}
+	mPeers[peer] = Peer();
+	//nothing to wait on, so this side hears about it straight away
+	QueueEvent(TransportEventType::Disconnect, peer);
+}
+
+int LoopbackHost::GetRoundTripTime(int peer) const {
+	std::lock_guard<std::recursive_mutex> lock(mTransport.mMutex);
+	if (peer < 0 || peer >= (int)mPeers.size() || mPeers[peer].state != PeerState::Connected) {
+		return 0;
+	}
+	return (int)(mTransport.mConditions.latencyMs * 2.0f);
+}
+
+int LoopbackHost::GetRemotePeerID(int peer) const {
+	std::lock_guard<std::recursive_mutex> lock(mTransport.mMutex);
+	if (peer < 0 || peer >= (int)mPeers.size()) {
+		return -1;
+	}
+	return mPeers[peer].remotePeer;
+}
+
+int LoopbackHost::GetFreePeer() const {
+	for (int i = 0; i < (int)mPeers.size(); i++) {
+		if (mPeers[i].state == PeerState::Free) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void LoopbackHost::QueueEvent(TransportEventType type, int peer, uint32_t data, const TransportPacket& packet) {
+	TransportEvent event;
+	event.type = type;
+	event.peer = peer;
+	event.data = data;
+	event.packet = packet;
+	mEvents.push_back(event);
+}
+
+LoopbackTransport::LoopbackTransport(unsigned int seed, const NetworkConditions& conditions) : mRandom(seed) {
+	mConditions = conditions;
+	mTime = 0.0f;
+	mAllowsNetworkThreads = true;
+	mNextMessageOrder = 0;
+	mNextHostID = 0;
+}
+
+LoopbackTransport::~LoopbackTransport() {
+	while (!mInFlight.empty()) {
+		RemoveReference(mInFlight.top().packet);
+		mInFlight.pop();
+	}
+}
+
+TransportHost* LoopbackTransport::CreateHost(int port, int maxPeers) {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	if (port >= 0 && GetListeningHost(port)) {
+		std::cout << __FUNCTION__ << " port " << port << " is already in use" << std::endl;
+		return nullptr;
+	}
+	LoopbackHost* host = new LoopbackHost(*this, mNextHostID++, port, maxPeers);
+	mHosts.emplace(host->mHostID, host);
+	return host;
+}
+
+void LoopbackTransport::AdvanceTime(float seconds) {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	mTime += seconds;
+	while (!mInFlight.empty() && mInFlight.top().deliveryTime <= mTime) {
+		const Message message = mInFlight.top();
+		mInFlight.pop();
+		Deliver(message);
+	}
+}
+
+void LoopbackTransport::SetConditions(const NetworkConditions& conditions) {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	mConditions = conditions;
+}
+
+NetworkConditions LoopbackTransport::GetConditions() const {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	return mConditions;
+}
+
+LoopbackStats LoopbackTransport::GetStats() const {
+	std::lock_guard<std::recursive_mutex> lock(mMutex);
+	return mStats;
+}
+
+void LoopbackTransport::PostControl(Message& message, const LoopbackHost::Peer* link) {
+	if (!link) {
+		Post(message, mTime);
+		return;
+	}
+	//jitter can hold the last packet sent back past ones sent after it, so wait for the latest of them
+	const float sendTime = mConditions.bytesPerSecond > 0 ? std::max(mTime, link->linkFreeTime) : mTime;
+	Post(message, sendTime, link->lastDeliveryTime);
+}
+
+bool LoopbackTransport::PostData(LoopbackHost& from, int fromPeer, const TransportPacket& packet) {
+	mStats.packetsSent++;
+	LoopbackHost::Peer& peer = from.mPeers[fromPeer];
+
+	//the packet has to wait for the ones ahead of it to leave
+	float sendTime = mTime;
+	if (mConditions.bytesPerSecond > 0) {
+		sendTime = std::max(mTime, peer.linkFreeTime);
+		if (sendTime - mTime > MAX_LINK_QUEUE_TIME) {
+			mStats.packetsOverBandwidth++;
+			return true;
+		}
+		peer.linkFreeTime = sendTime + (float)packet.size / mConditions.bytesPerSecond;
+	}
+
+	//Lost packets still used the link, and like UDP the sender is never told.
+	std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+	if (chance(mRandom) < mConditions.lossRate) {
+		mStats.packetsLost++;
+		return true;
+	}
+	const int copies = chance(mRandom) < mConditions.duplicateRate ? 2 : 1;
+	mStats.packetsDuplicated += copies - 1;
+
+	for (int i = 0; i < copies; i++) {
+		Message message;
+		message.type = MessageType::Data;
+		message.fromHost = from.mHostID;
+		message.fromPeer = fromPeer;
+		message.toHost = peer.remoteHost;
+		message.toPeer = peer.remotePeer;
+		message.packet = packet;
+		AddReference(packet);
+		Post(message, sendTime);
+		peer.lastDeliveryTime = std::max(peer.lastDeliveryTime, message.deliveryTime);
+	}
+	return true;
+}
+
+void LoopbackTransport::Post(Message& message, float sendTime, float notBefore) {
+	float delay = mConditions.latencyMs;
+	//control messages keep their order, as a reliable channel would
+	if (message.type == MessageType::Data && mConditions.jitterMs > 0.0f) {
+		delay += std::uniform_real_distribution<float>(-mConditions.jitterMs, mConditions.jitterMs)(mRandom);
+	}
+	//anything due at the same time is delivered in send order
+	message.deliveryTime = std::max(notBefore, sendTime + std::max(0.0f, delay) / 1000.0f);
+	message.order = mNextMessageOrder++;
+	mInFlight.push(message);
+}
+
+void LoopbackTransport::Deliver(const Message& message) {
+	LoopbackHost* to = message.type == MessageType::Connect ? GetListeningHost(message.toPort) : GetHost(message.toHost);
+
+	switch (message.type) {
+	case MessageType::Connect: {
+		Message reply;
+		reply.fromHost = to ? to->mHostID : -1;
+		reply.toHost = message.fromHost;
+		reply.toPeer = message.fromPeer;
+
+		const int peer = to ? to->GetFreePeer() : -1;
+		if (peer < 0) {
+			reply.type = MessageType::Refuse;
+			PostControl(reply);
+			break;
+		}
+		LoopbackHost::Peer& accepted = to->mPeers[peer];
+		accepted = LoopbackHost::Peer();
+		accepted.state = LoopbackHost::PeerState::Connected;
+		accepted.remoteHost = message.fromHost;
+		accepted.remotePeer = message.fromPeer;
+		to->QueueEvent(TransportEventType::Connect, peer, message.data);
+
+		reply.type = MessageType::Accept;
+		reply.fromPeer = peer;
+		PostControl(reply);
+		break;
+	}
+	case MessageType::Accept: {
+		LoopbackHost::Peer* peer = to ? &to->mPeers[message.toPeer] : nullptr;
+		if (!peer || peer->state != LoopbackHost::PeerState::Connecting) {
+			//the client gave up before the server answered
+			Message reply;
+			reply.type = MessageType::Disconnect;
+			reply.fromHost = message.toHost;
+			reply.fromPeer = message.toPeer;
+			reply.toHost = message.fromHost;
+			reply.toPeer = message.fromPeer;
+			PostControl(reply);
+			break;
+		}
+		peer->state = LoopbackHost::PeerState::Connected;
+		peer->remoteHost = message.fromHost;
+		peer->remotePeer = message.fromPeer;
+		to->QueueEvent(TransportEventType::Connect, message.toPeer);
+		break;
+	}
+	case MessageType::Refuse:
+	case MessageType::Disconnect: {
+		if (!to) {
+			break;
+		}
+		LoopbackHost::Peer& peer = to->mPeers[message.toPeer];
+		const bool isRefused = message.type == MessageType::Refuse && peer.state == LoopbackHost::PeerState::Connecting;
+		const bool isDisconnected = peer.state == LoopbackHost::PeerState::Connected &&
+			peer.remoteHost == message.fromHost && peer.remotePeer == message.fromPeer;
+		if (isRefused || isDisconnected) {
+			peer = LoopbackHost::Peer();
+			to->QueueEvent(TransportEventType::Disconnect, message.toPeer);
+		}
+		break;
+	}
+	case MessageType::Data: {
+		//a connection can close while its packets are still on the way
+		const LoopbackHost::Peer* peer = to ? &to->mPeers[message.toPeer] : nullptr;
+		if (!peer || peer->state != LoopbackHost::PeerState::Connected ||
+			peer->remoteHost != message.fromHost || peer->remotePeer != message.fromPeer) {
+			RemoveReference(message.packet);
+			break;
+		}
+		mStats.packetsDelivered++;
+		mStats.bytesDelivered += message.packet.size;
+		//the in flight reference is handed to the receiver, who releases it
+		to->QueueEvent(TransportEventType::Receive, message.toPeer, 0, message.packet);
+		break;
+	}
+	}
+}
+
+void LoopbackTransport::AddReference(const TransportPacket& packet) {
+	if (packet.handle) {
+		((LoopbackPacket*)packet.handle)->references++;
+	}
+}
+
+void LoopbackTransport::RemoveReference(const TransportPacket& packet) {
+	LoopbackPacket* loopbackPacket = (LoopbackPacket*)packet.handle;
+	if (loopbackPacket && --loopbackPacket->references <= 0) {
+		delete loopbackPacket;
+	}
+}
+
+LoopbackHost* LoopbackTransport::GetHost(int hostID) const {
+	auto it = mHosts.find(hostID);
+	return it != mHosts.end() ? it->second : nullptr;
+}
+
+LoopbackHost* LoopbackTransport::GetListeningHost(int port) const {
+	for (const auto& [hostID, host] : mHosts) {
+		if (host->mPort == port && port >= 0) {
+			return host;
+		}
+	}
+	return nullptr;
+}
+
+void LoopbackTransport::RemoveHost(LoopbackHost& host) {
+	mHosts.erase(host.mHostID);
+}
+#endif
@@ -0,0 +1,171 @@
+#ifdef USEGL
+#pragma once
+#include <deque>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "NetworkTransport.h"
+
+namespace NCL {
+	namespace CSC8503 {
+		//Applied to every packet each way, so a round trip sees them twice.
+		struct NetworkConditions {
+			float latencyMs = 0.0f;
+			float jitterMs = 0.0f;		//Each packet is delayed up to this much more or less, so packets can reorder
+			float lossRate = 0.0f;
+			float duplicateRate = 0.0f;
+			int bytesPerSecond = 0;		//Per connection and direction, 0 for no cap
+		};
+
+		struct LoopbackStats {
+			int packetsSent = 0;
+			int packetsDelivered = 0;
+			int packetsLost = 0;
+			int packetsDuplicated = 0;
+			int packetsOverBandwidth = 0;	//Dropped because the link's queue was full
+			int64_t bytesDelivered = 0;
+		};
+
+		class LoopbackTransport;
+
+		class LoopbackHost : public TransportHost {
+		public:
+			LoopbackHost(LoopbackTransport& transport, int hostID, int port, int maxPeers);
+			~LoopbackHost();
+
+			int Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int port, uint32_t data) override;
+			//There is no wall clock to wait on, so the timeout is ignored.
+			bool Service(TransportEvent& event, int timeoutMs = 0) override;
+
+			TransportPacket CreatePacket(const void* data, int size) override;
+			void ReleasePacket(const TransportPacket& packet) override;
+			bool Send(int peer, const TransportPacket& packet) override;
+			void Broadcast(const TransportPacket& packet) override;
+			void Flush() override {}
+
+			void Disconnect(int peer) override;
+			void DisconnectLater(int peer) override;
+
+			int GetMaxPeers() const override { return (int)mPeers.size(); }
+			int GetRoundTripTime(int peer) const override;
+			int GetRemotePeerID(int peer) const override;
+
+		protected:
+			friend class LoopbackTransport;
+
+			enum class PeerState {
+				Free,
+				Connecting,
+				Connected
+			};
+
+			struct Peer {
+				PeerState state = PeerState::Free;
+				int remoteHost = -1;
+				int remotePeer = -1;
+				float linkFreeTime = 0.0f;	//When the bandwidth cap lets the next packet leave
+				float lastDeliveryTime = 0.0f;	//When the last packet sent on the link arrives
+			};
+
+			//A graceful close arrives after the data already sent on the link, Disconnect can overtake it like ENet's.
+			void ClosePeer(int peer, bool isAfterData);
+			int GetFreePeer() const;
+			void QueueEvent(TransportEventType type, int peer, uint32_t data = 0, const TransportPacket& packet = TransportPacket());
+
+			LoopbackTransport& mTransport;
+			int mHostID;
+			int mPort;
+			std::vector<Peer> mPeers;
+			std::deque<TransportEvent> mEvents;
+		};
+
+		// Connects hosts in the same process through a simulated network instead of sockets. Time only moves when
+		// AdvanceTime is called and every random choice comes from one seeded generator, so the same calls in the
+		// same order always deliver the same packets at the same times.
+		class LoopbackTransport : public NetworkTransport {
+		public:
+			LoopbackTransport(unsigned int seed, const NetworkConditions& conditions = NetworkConditions());
+			~LoopbackTransport();
+
+			TransportHost* CreateHost(int port, int maxPeers) override;
+
+			//Moves the simulated clock on and delivers everything due by then.
+			void AdvanceTime(float seconds);
+			float GetTime() const { return mTime; }
+
+			//Off keeps a run repeatable, a network thread sends whenever it happens to be scheduled.
+			void SetAllowsNetworkThreads(bool allowsNetworkThreads) { mAllowsNetworkThreads = allowsNetworkThreads; }
+			bool GetAllowsNetworkThreads() const override { return mAllowsNetworkThreads; }
+
+			void SetConditions(const NetworkConditions& conditions);
+			NetworkConditions GetConditions() const;
+			LoopbackStats GetStats() const;
+
+		protected:
+			friend class LoopbackHost;
+
+			enum class MessageType {
+				Connect,
+				Accept,
+				Refuse,
+				Disconnect,
+				Data
+			};
+
+			struct Message {
+				MessageType type = MessageType::Data;
+				float deliveryTime = 0.0f;
+				uint64_t order = 0;	//Ties on delivery time go out in the order they were sent
+				int fromHost = -1;
+				int fromPeer = -1;
+				int toHost = -1;
+				int toPeer = -1;
+				int toPort = -1;	//Connect only knows where it is going by port
+				uint32_t data = 0;
+				TransportPacket packet;
+			};
+
+			struct LaterMessage {
+				bool operator()(const Message& a, const Message& b) const {
+					return a.deliveryTime != b.deliveryTime ? a.deliveryTime > b.deliveryTime : a.order > b.order;
+				}
+			};
+
+			//Packets are shared by every send and every copy in flight.
+			struct LoopbackPacket {
+				std::vector<char> bytes;
+				int references = 0;
+			};
+
+			//Control messages are reliable, like ENet's, so only see latency. Given the link, one queues behind
+			//its data and arrives after all of it.
+			void PostControl(Message& message, const LoopbackHost::Peer* link = nullptr);
+			bool PostData(LoopbackHost& from, int fromPeer, const TransportPacket& packet);
+			void Post(Message& message, float sendTime, float notBefore = 0.0f);
+			void Deliver(const Message& message);
+
+			void AddReference(const TransportPacket& packet);
+			void RemoveReference(const TransportPacket& packet);
+
+			LoopbackHost* GetHost(int hostID) const;
+			LoopbackHost* GetListeningHost(int port) const;
+			void RemoveHost(LoopbackHost& host);
+
+			mutable std::recursive_mutex mMutex;
+			std::mt19937 mRandom;
+			NetworkConditions mConditions;
+			LoopbackStats mStats;
+
+			float mTime;
+			bool mAllowsNetworkThreads;
+			uint64_t mNextMessageOrder;
+			int mNextHostID;
+			std::map<int, LoopbackHost*> mHosts;
+			std::priority_queue<Message, std::vector<Message>, LaterMessage> mInFlight;
+		};
+	}
+}
+#endif
@@ -0,0 +1,98 @@
+#ifdef USEGL
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace NCL::CSC8503 {
+	// Bounded lock free queue for any number of producer threads and a single consumer.
+	// Every slot carries a sequence number so producers only contend on the tail index.
+	template <typename T>
+	class MPSCRingBuffer {
+	public:
+		MPSCRingBuffer(size_t capacity) : mSlots(RoundUpToPowerOfTwo(capacity)) {
+			mMask = mSlots.size() - 1;
+			for (size_t i = 0; i < mSlots.size(); i++) {
+				mSlots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+			mHead.store(0, std::memory_order_relaxed);
+			mTail.store(0, std::memory_order_relaxed);
+		}
+
+		MPSCRingBuffer(const MPSCRingBuffer&) = delete;
+		MPSCRingBuffer& operator=(const MPSCRingBuffer&) = delete;
+
+		//Returns false when the ring is full, the value is left untouched.
+		bool TryPush(const T& value) {
+			size_t tail = mTail.load(std::memory_order_relaxed);
+			while (true) {
+				Slot& slot = mSlots[tail & mMask];
+				const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+				const intptr_t difference = (intptr_t)sequence - (intptr_t)tail;
+				if (difference == 0) {
+					if (mTail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+						slot.value = value;
+						slot.sequence.store(tail + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (difference < 0) {
+					return false;
+				}
+				else {
+					tail = mTail.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		//Only ever call from the consumer thread.
+		bool TryPop(T& value) {
+			const size_t head = mHead.load(std::memory_order_relaxed);
+			Slot& slot = mSlots[head & mMask];
+			const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			if ((intptr_t)sequence - (intptr_t)(head + 1) < 0) {
+				return false;
+			}
+			value = slot.value;
+			slot.sequence.store(head + mSlots.size(), std::memory_order_release);
+			mHead.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		//Approximate while producers are active.
+		size_t GetSize() const {
+			const size_t tail = mTail.load(std::memory_order_acquire);
+			const size_t head = mHead.load(std::memory_order_acquire);
+			return tail > head ? tail - head : 0;
+		}
+
+		bool IsEmpty() const {
+			const size_t head = mHead.load(std::memory_order_acquire);
+			return (intptr_t)mSlots[head & mMask].sequence.load(std::memory_order_acquire) - (intptr_t)(head + 1) < 0;
+		}
+
+		size_t GetCapacity() const { return mSlots.size(); }
+
+	protected:
+		struct Slot {
+			std::atomic<size_t> sequence;
+			T value;
+		};
+
+		static size_t RoundUpToPowerOfTwo(size_t value) {
+			size_t result = 2;
+			while (result < value) {
+				result <<= 1;
+			}
+			return result;
+		}
+
+		std::vector<Slot> mSlots;
+		size_t mMask;
+
+		// kept on separate cache lines so the producers don't thrash the consumer
+		alignas(64) std::atomic<size_t> mTail;
+		alignas(64) std::atomic<size_t> mHead;
+	};
+}
+#endif
@@ -1,6 +1,14 @@
 #ifdef USEGL
 #include "NetworkBase.h"
-#include "./enet/enet.h"
+#include "EnetTransport.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	EnetTransport enetTransport;
+	NetworkTransport* activeTransport = &enetTransport;
+}
 
 void NetworkBase::ClearPacketHandlers() {
 	packetHandlers.clear();
@@ -11,17 +19,23 @@ NetworkBase::NetworkBase()	{
 }
 
 NetworkBase::~NetworkBase()	{
-	if (netHandle) {
-		enet_host_destroy(netHandle);
-	}
+	delete netHandle;
 }
 
 void NetworkBase::Initialise() {
-	enet_initialize();
+	activeTransport->Initialise();
 }
 
 void NetworkBase::Destroy() {
-	enet_deinitialize();
+	activeTransport->Destroy();
+}
+
+void NetworkBase::SetTransport(NetworkTransport* transport) {
+	activeTransport = transport ? transport : &enetTransport;
+}
+
+NetworkTransport& NetworkBase::GetTransport() {
+	return *activeTransport;
 }
 
 bool NetworkBase::ProcessPacket(GamePacket* packet, int peerID) {
@@ -1,17 +1,17 @@
 #ifdef USEGL
 #pragma once
-//#include "./enet/enet.h"
-struct _ENetHost;
-struct _ENetPeer;
-struct _ENetEvent;
+namespace NCL::CSC8503 {
+	class TransportHost;
+	class NetworkTransport;
+}
 
 enum BasicNetworkMessages {
 	None,
 	Hello,
 	Message,
 	String_Message,
-	Delta_State,	//1 byte per channel since the last state
-	Full_State,		//Full transform etc
+	Delta_State,	//Retired, object state only goes out in snapshots. Kept so the IDs after it don't move
+	Full_State,		//Retired, as above
 	Received_State, //received from a client, informs that its received packet n
 	Player_Connected,
 	Player_Disconnected,
@@ -34,7 +34,11 @@ enum BasicNetworkMessages {
 	ClientInit,
 	SyncPlayerIdNameMap,
 	SyncAnnouncements,
-	GuardSpotSound
+	GuardSpotSound,
+	Snapshot_State,	//Every changed object for a tick, bit packed
+	JoinState_Chunk,	//Part of the world as it was when a client joined a match in progress
+	JoinState_Ack,
+	MessageTypeCount	//Not a message, one past the last type
 };
 
 struct GamePacket {
@@ -93,6 +97,10 @@ public:
 	static void Initialise();
 	static void Destroy();
 
+	//Every host made after this goes through the given transport, ENet until one is set.
+	static void SetTransport(NCL::CSC8503::NetworkTransport* transport);
+	static NCL::CSC8503::NetworkTransport& GetTransport();
+
 	static int GetDefaultPort() {
 		return 1234;
 	}
@@ -121,7 +129,7 @@ protected:
 		return true;
 	}
 
-	_ENetHost* netHandle;
+	NCL::CSC8503::TransportHost* netHandle;
 
 	std::multimap<int, PacketReceiver*> packetHandlers;
 };
@@ -1,338 +1,577 @@
 #ifdef USEGL
 #include "NetworkObject.h"
 #include "./enet/enet.h"
+#include "LevelEnums.h"
 using namespace NCL;
 using namespace CSC8503;
 
-SyncPlayerListPacket::SyncPlayerListPacket(std::vector<int>& serverPlayers) {
-	type = BasicNetworkMessages::SyncPlayers;
-	size = sizeof(SyncPlayerListPacket);
+namespace {
+	constexpr int MAX_SERIALIZED_PLAYERS = MAX_PLAYER_SLOTS;
 
-	for (int i = 0; i < 4; i++) {
-		playerList[i] = serverPlayers[i];
+	void SerializeVector3(BitStream& stream, Vector3& vector) {
+		stream.SerializeFloat(vector.x);
+		stream.SerializeFloat(vector.y);
+		stream.SerializeFloat(vector.z);
 	}
+
+	//Counts are sent ahead of fixed size arrays so only filled slots go on the wire.
+	int SerializeCount(BitStream& stream, int count, int maxCount) {
+		stream.SerializeVarInt(count);
+		if (count < 0 || count > maxCount) {
+			stream.Invalidate();
+			return 0;
+		}
+		return count;
+	}
+
+	//Writes whether a group of fields differs from the previous input, and reads it back. The first input
+	//in a packet has nothing to be compared with, so it always carries every field.
+	bool SerializeIsChanged(BitStream& stream, const PlayerInputs* previous, bool isChanged) {
+		if (previous == nullptr) {
+			return true;
+		}
+		stream.SerializeBool(isChanged);
+		return isChanged;
+	}
+
+	void SerializeInputs(BitStream& stream, PlayerInputs& inputs, const PlayerInputs* previous) {
+		//the buttons take as many bits as a flag saying they changed would cost across a group
+		stream.SerializeBool(inputs.isSprinting);
+		stream.SerializeBool(inputs.isCrouching);
+		stream.SerializeBool(inputs.isEquippedItemUsed);
+		stream.SerializeBool(inputs.isInteractButtonPressed);
+		stream.SerializeBool(inputs.isHoldingInteractButton);
+		for (int i = 0; i < 4; i++) {
+			stream.SerializeBool(inputs.movementButtons[i]);
+		}
+
+		if (SerializeIsChanged(stream, previous, previous && (inputs.leftHandItemId != previous->leftHandItemId ||
+			inputs.rightHandItemId != previous->rightHandItemId))) {
+			stream.SerializeVarInt(inputs.leftHandItemId);
+			stream.SerializeVarInt(inputs.rightHandItemId);
+		}
+		else {
+			inputs.leftHandItemId = previous->leftHandItemId;
+			inputs.rightHandItemId = previous->rightHandItemId;
+		}
+
+		if (SerializeIsChanged(stream, previous, previous && (inputs.cameraYaw != previous->cameraYaw ||
+			inputs.fwdAxis != previous->fwdAxis || inputs.rightAxis != previous->rightAxis))) {
+			stream.SerializeFloat(inputs.cameraYaw);
+			SerializeVector3(stream, inputs.fwdAxis);
+			SerializeVector3(stream, inputs.rightAxis);
+		}
+		else {
+			inputs.cameraYaw = previous->cameraYaw;
+			inputs.fwdAxis = previous->fwdAxis;
+			inputs.rightAxis = previous->rightAxis;
+		}
+
+		Vector3 rayPosition = inputs.rayFromPlayer.GetPosition();
+		Vector3 rayDirection = inputs.rayFromPlayer.GetDirection();
+		if (SerializeIsChanged(stream, previous, previous && (rayPosition != previous->rayFromPlayer.GetPosition() ||
+			rayDirection != previous->rayFromPlayer.GetDirection()))) {
+			SerializeVector3(stream, rayPosition);
+			SerializeVector3(stream, rayDirection);
+			if (stream.IsReading()) {
+				inputs.rayFromPlayer = Ray(rayPosition, rayDirection);
+			}
+		}
+		else {
+			inputs.rayFromPlayer = previous->rayFromPlayer;
+		}
+	}
+}
+
+SyncPlayerListPacket::SyncPlayerListPacket() : SerializablePacket(BasicNetworkMessages::SyncPlayers) {
 }
 
-void SyncPlayerListPacket::SyncPlayerList(std::vector<int>& clientPlayerList) const
-{
-//TODO(erendgrmnc): Add config for max player number.
-	
-	for (int i = 0; i < 4; ++i) {
-		clientPlayerList[i] = playerList[i];
+SyncPlayerListPacket::SyncPlayerListPacket(const std::vector<int>& serverPlayers) : SyncPlayerListPacket() {
+	playerList.assign(serverPlayers.begin(), serverPlayers.begin() + std::min((int)serverPlayers.size(), MAX_SERIALIZED_PLAYERS));
+}
+
+void SyncPlayerListPacket::Serialize(BitStream& stream) {
+	const int count = SerializeCount(stream, (int)playerList.size(), MAX_SERIALIZED_PLAYERS);
+	if (stream.IsReading()) {
+		playerList.assign(count, -1);
+	}
+	for (int i = 0; i < count; i++) {
+		stream.SerializeVarInt(playerList[i]);
 	}
 }
 
-GameStartStatePacket::GameStartStatePacket(bool val, const std::string& seed) {
-	type = BasicNetworkMessages::GameStartState;
-	size = sizeof(GameStartStatePacket);
+GameStartStatePacket::GameStartStatePacket() : SerializablePacket(BasicNetworkMessages::GameStartState) {
+}
 
+GameStartStatePacket::GameStartStatePacket(bool val, const std::string& seed) : GameStartStatePacket() {
 	isGameStarted = val;
 	this->levelSeed = seed;
 }
 
-GameEndStatePacket::GameEndStatePacket(bool val, int winningPlayerId){
-	type = BasicNetworkMessages::GameEndState;
-	size = sizeof(GameEndStatePacket);
+void GameStartStatePacket::Serialize(BitStream& stream) {
+	stream.SerializeBool(isGameStarted);
+	stream.SerializeString(levelSeed, LEVEL_SEED_MAX_LENGTH);
+}
+
+GameEndStatePacket::GameEndStatePacket() : SerializablePacket(BasicNetworkMessages::GameEndState) {
+}
 
+GameEndStatePacket::GameEndStatePacket(bool val, int winningPlayerId) : GameEndStatePacket() {
 	this->isGameEnded = val;
 	this->winningPlayerId = winningPlayerId;
 }
 
-ClientPlayerInputPacket::ClientPlayerInputPacket(int lastId, const PlayerInputs& playerInputs){
-	type = BasicNetworkMessages::ClientPlayerInputState;
-	size = sizeof(ClientPlayerInputPacket);
+void GameEndStatePacket::Serialize(BitStream& stream) {
+	stream.SerializeBool(isGameEnded);
+	stream.SerializeVarInt(winningPlayerId);
+}
 
-	this->playerInputs.isCrouching = playerInputs.isCrouching;
-	this->playerInputs.isSprinting = playerInputs.isSprinting;
-	this->playerInputs.isEquippedItemUsed = playerInputs.isEquippedItemUsed;
-	this->playerInputs.isInteractButtonPressed = playerInputs.isInteractButtonPressed;
-	this->playerInputs.isHoldingInteractButton = playerInputs.isHoldingInteractButton;
+ClientPlayerInputPacket::ClientPlayerInputPacket() : SerializablePacket(BasicNetworkMessages::ClientPlayerInputState) {
+}
 
-	this->playerInputs.leftHandItemId = playerInputs.leftHandItemId;
-	this->playerInputs.rightHandItemId = playerInputs.rightHandItemId;
-	
-	this->playerInputs.movementButtons[0] = playerInputs.movementButtons[0];
-	this->playerInputs.movementButtons[1] = playerInputs.movementButtons[1];
-	this->playerInputs.movementButtons[2] = playerInputs.movementButtons[2];
-	this->playerInputs.movementButtons[3] = playerInputs.movementButtons[3];
+ClientPlayerInputPacket::ClientPlayerInputPacket(int lastId, int firstInputId, int propertyAck, int propertyAckBits, const PlayerInputs* inputs, int inputCount) : ClientPlayerInputPacket() {
+	this->lastId = lastId;
+	this->firstInputId = firstInputId;
+	this->inputCount = std::clamp(inputCount, 0, MAX_INPUTS_PER_PACKET);
+	this->propertyAck = propertyAck;
+	this->propertyAckBits = propertyAckBits;
+	for (int i = 0; i < this->inputCount; i++) {
+		this->inputs[i] = inputs[i];
+	}
+}
 
-	this->playerInputs.fwdAxis.x = playerInputs.fwdAxis.x;
-	this->playerInputs.fwdAxis.y = playerInputs.fwdAxis.y;
-	this->playerInputs.fwdAxis.z = playerInputs.fwdAxis.z;
+void ClientPlayerInputPacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(lastId);
+	stream.SerializeVarInt(firstInputId);
+	stream.SerializeVarInt(propertyAck);
+	stream.SerializeBits(propertyAckBits, 32);
 
-	this->playerInputs.rightAxis.x = playerInputs.rightAxis.x;
-	this->playerInputs.rightAxis.y = playerInputs.rightAxis.y;
-	this->playerInputs.rightAxis.z = playerInputs.rightAxis.z;
-	this->playerInputs.cameraYaw = playerInputs.cameraYaw;
+	inputCount = SerializeCount(stream, inputCount, MAX_INPUTS_PER_PACKET);
+	for (int i = 0; i < inputCount; i++) {
+		SerializeInputs(stream, inputs[i], i > 0 ? &inputs[i - 1] : nullptr);
+	}
 
-	this->playerInputs.rayFromPlayer = playerInputs.rayFromPlayer;
-	
-	this-> lastId = lastId;
-	this->mouseXLook = mouseXLook;
+	stream.SerializeFloat(mouseXLook);
 }
 
-ClientUseItemPacket::ClientUseItemPacket(int objectID, int playerID) {
+ClientUseItemPacket::ClientUseItemPacket() : SerializablePacket(BasicNetworkMessages::None) {
+}
+
+ClientUseItemPacket::ClientUseItemPacket(int objectID, int playerID) : ClientUseItemPacket() {
 	this->objectID = objectID;
 	this->playerID = playerID;
 }
 
-ClientSyncBuffPacket::ClientSyncBuffPacket(int playerID, int buffID, bool toApply) {
-	type = BasicNetworkMessages::ClientSyncBuffs;
-	size = sizeof(ClientSyncBuffPacket);
+void ClientUseItemPacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(objectID);
+	stream.SerializeVarInt(playerID);
+}
+
+ClientSyncBuffPacket::ClientSyncBuffPacket() : SerializablePacket(BasicNetworkMessages::ClientSyncBuffs) {
+}
 
+ClientSyncBuffPacket::ClientSyncBuffPacket(int playerID, int buffID, bool toApply) : ClientSyncBuffPacket() {
 	this->playerID = playerID;
 	this->buffID = buffID;
 	this->toApply = toApply;
 }
 
-ClientSyncLocalActiveSusCausePacket::ClientSyncLocalActiveSusCausePacket(int playerID, int activeLocalSusCauseID, bool toApply) {
-	type = BasicNetworkMessages::ClientSyncLocalActiveCause;
-	size = sizeof(ClientSyncLocalActiveSusCausePacket);
+void ClientSyncBuffPacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(playerID);
+	stream.SerializeVarInt(buffID);
+	stream.SerializeBool(toApply);
+}
+
+ClientSyncLocalActiveSusCausePacket::ClientSyncLocalActiveSusCausePacket() : SerializablePacket(BasicNetworkMessages::ClientSyncLocalActiveCause) {
+}
 
+ClientSyncLocalActiveSusCausePacket::ClientSyncLocalActiveSusCausePacket(int playerID, int activeLocalSusCauseID, bool toApply) : ClientSyncLocalActiveSusCausePacket() {
 	this->playerID = playerID;
 	this->activeLocalSusCauseID = activeLocalSusCauseID;
 	this->toApply = toApply;
 }
 
-ClientSyncLocalSusChangePacket::ClientSyncLocalSusChangePacket(int playerID, int changedValue) {
-	type = BasicNetworkMessages::ClientSyncLocalSusChange;
-	size = sizeof(ClientSyncLocalSusChangePacket);
+void ClientSyncLocalActiveSusCausePacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(playerID);
+	stream.SerializeVarInt(activeLocalSusCauseID);
+	stream.SerializeBool(toApply);
+}
+
+ClientSyncLocalSusChangePacket::ClientSyncLocalSusChangePacket() : SerializablePacket(BasicNetworkMessages::ClientSyncLocalSusChange) {
+}
 
+ClientSyncLocalSusChangePacket::ClientSyncLocalSusChangePacket(int playerID, int changedValue) : ClientSyncLocalSusChangePacket() {
 	this->playerID = playerID;
 	this->changedValue = changedValue;
 }
 
-ClientSyncGlobalSusChangePacket::ClientSyncGlobalSusChangePacket(int changedValue) {
-	type = BasicNetworkMessages::ClientSyncGlobalSusChange;
-	size = sizeof(ClientSyncGlobalSusChangePacket);
+void ClientSyncLocalSusChangePacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(playerID);
+	stream.SerializeVarInt(changedValue);
+}
+
+ClientSyncGlobalSusChangePacket::ClientSyncGlobalSusChangePacket() : SerializablePacket(BasicNetworkMessages::ClientSyncGlobalSusChange) {
+}
 
+ClientSyncGlobalSusChangePacket::ClientSyncGlobalSusChangePacket(int changedValue) : ClientSyncGlobalSusChangePacket() {
 	this->changedValue = changedValue;
 }
 
-ClientSyncLocationActiveSusCausePacket::ClientSyncLocationActiveSusCausePacket(int cantorPairedLocation, int activeLocationSusCauseID, bool toApply) {
-	type = BasicNetworkMessages::ClientSyncLocationActiveCause;
-	size = sizeof(ClientSyncLocationActiveSusCausePacket);
+void ClientSyncGlobalSusChangePacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(changedValue);
+}
+
+ClientSyncLocationActiveSusCausePacket::ClientSyncLocationActiveSusCausePacket() : SerializablePacket(BasicNetworkMessages::ClientSyncLocationActiveCause) {
+}
 
+ClientSyncLocationActiveSusCausePacket::ClientSyncLocationActiveSusCausePacket(int cantorPairedLocation, int activeLocationSusCauseID, bool toApply) : ClientSyncLocationActiveSusCausePacket() {
 	this->cantorPairedLocation = cantorPairedLocation;
 	this->activeLocationSusCauseID = activeLocationSusCauseID;
 	this->toApply = toApply;
 }
 
-ClientSyncLocationSusChangePacket::ClientSyncLocationSusChangePacket(int cantorPairedLocation, int changedValue) {
-	type = BasicNetworkMessages::ClientSyncLocationSusChange;
-	size = sizeof(ClientSyncLocationSusChangePacket);
+void ClientSyncLocationActiveSusCausePacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(cantorPairedLocation);
+	stream.SerializeVarInt(activeLocationSusCauseID);
+	stream.SerializeBool(toApply);
+}
+
+ClientSyncLocationSusChangePacket::ClientSyncLocationSusChangePacket() : SerializablePacket(BasicNetworkMessages::ClientSyncLocationSusChange) {
+}
 
+ClientSyncLocationSusChangePacket::ClientSyncLocationSusChangePacket(int cantorPairedLocation, int changedValue) : ClientSyncLocationSusChangePacket() {
 	this->cantorPairedLocation = cantorPairedLocation;
 	this->changedValue = changedValue;
 }
 
-ClientSyncItemSlotUsagePacket::ClientSyncItemSlotUsagePacket(int playerID, int firstItemUsage, int secondItemUsage) {
+void ClientSyncLocationSusChangePacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(cantorPairedLocation);
+	stream.SerializeVarInt(changedValue);
+}
+
+ClientSyncItemSlotUsagePacket::ClientSyncItemSlotUsagePacket() : SerializablePacket(BasicNetworkMessages::ClientSyncItemSlotUsage) {
+}
+
+ClientSyncItemSlotUsagePacket::ClientSyncItemSlotUsagePacket(int playerID, int firstItemUsage, int secondItemUsage) : ClientSyncItemSlotUsagePacket() {
 	this->firstItemUsage = firstItemUsage;
 	this->secondItemUsage = secondItemUsage;
 	this->playerID = playerID;
 }
 
-ClientSyncItemSlotPacket::ClientSyncItemSlotPacket(int playerID, int slotId, int equippedItem, int usageCount) {
-	type = BasicNetworkMessages::ClientSyncItemSlot;
-	size = sizeof(ClientSyncItemSlotPacket);
+void ClientSyncItemSlotUsagePacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(playerID);
+	stream.SerializeVarInt(firstItemUsage);
+	stream.SerializeVarInt(secondItemUsage);
+}
+
+ClientSyncItemSlotPacket::ClientSyncItemSlotPacket() : SerializablePacket(BasicNetworkMessages::ClientSyncItemSlot) {
+}
 
+ClientSyncItemSlotPacket::ClientSyncItemSlotPacket(int playerID, int slotId, int equippedItem, int usageCount) : ClientSyncItemSlotPacket() {
 	this->playerID = playerID;
 	this->slotId = slotId;
 	this->equippedItem = equippedItem;
 	this->usageCount = usageCount;
 }
 
-SyncInteractablePacket::SyncInteractablePacket(int networkObjectId, bool isOpen, int interactableItemType) {
-	type = BasicNetworkMessages::SyncInteractable;
-	size = sizeof(SyncInteractablePacket);
+void ClientSyncItemSlotPacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(playerID);
+	stream.SerializeVarInt(slotId);
+	stream.SerializeVarInt(equippedItem);
+	stream.SerializeVarInt(usageCount);
+}
+
+SyncInteractablePacket::SyncInteractablePacket() : SerializablePacket(BasicNetworkMessages::SyncInteractable) {
+}
 
+SyncInteractablePacket::SyncInteractablePacket(int networkObjectId, bool isOpen, int interactableItemType) : SyncInteractablePacket() {
 	this->networkObjId = networkObjectId;
 	this->isOpen = isOpen;
 	this->interactableItemType = interactableItemType;
 }
 
-SyncObjectStatePacket::SyncObjectStatePacket(int networkObjId, int objectState) {
-	type = SyncObjectState;
-	size = sizeof(SyncObjectStatePacket);
+void SyncInteractablePacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(networkObjId);
+	stream.SerializeBool(isOpen);
+	stream.SerializeVarInt(interactableItemType);
+}
 
+SyncObjectStatePacket::SyncObjectStatePacket() : SerializablePacket(BasicNetworkMessages::SyncObjectState) {
+}
+
+SyncObjectStatePacket::SyncObjectStatePacket(int networkObjId, int objectState) : SyncObjectStatePacket() {
 	this->networkObjId = networkObjId;
 	this->objectState = objectState;
 }
 
-ClientInitPacket::ClientInitPacket(const std::string& playerName) {
-	type = ClientInit;
-	size = sizeof(ClientInitPacket);
+void SyncObjectStatePacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(networkObjId);
+	stream.SerializeVarInt(objectState);
+}
+
+ClientInitPacket::ClientInitPacket() : SerializablePacket(BasicNetworkMessages::ClientInit) {
+}
 
+ClientInitPacket::ClientInitPacket(const std::string& playerName, uint32_t snapshotDictionaryId) : ClientInitPacket() {
 	this->playerName = playerName;
+	this->snapshotDictionaryId = snapshotDictionaryId;
 }
 
-SyncPlayerIdNameMapPacket::SyncPlayerIdNameMapPacket(const std::map<int, string>& playerIdNameMap) {
-	type = SyncPlayerIdNameMap;
-	size = sizeof(SyncPlayerIdNameMapPacket);
+void ClientInitPacket::Serialize(BitStream& stream) {
+	stream.SerializeString(playerName, PLAYER_NAME_MAX_LENGTH);
+	int dictionaryId = (int)snapshotDictionaryId;
+	stream.SerializeBits(dictionaryId, 32);
+	snapshotDictionaryId = (uint32_t)dictionaryId;
+}
+
+SyncPlayerIdNameMapPacket::SyncPlayerIdNameMapPacket() : SerializablePacket(BasicNetworkMessages::SyncPlayerIdNameMap) {
+}
 
-	int counter = 0;
-	for (std::pair<int, std::string> playerIdName : playerIdNameMap) {
-		playerIds[counter] = playerIdName.first;
-		playerNames[counter] = playerIdName.second;
-		counter++;
+SyncPlayerIdNameMapPacket::SyncPlayerIdNameMapPacket(const std::map<int, string>& playerIdNameMap) : SyncPlayerIdNameMapPacket() {
+	for (const std::pair<const int, std::string>& playerIdName : playerIdNameMap) {
+		if ((int)playerIds.size() >= MAX_SERIALIZED_PLAYERS) {
+			break;
+		}
+		playerIds.push_back(playerIdName.first);
+		playerNames.push_back(playerIdName.second);
 	}
+}
 
+void SyncPlayerIdNameMapPacket::Serialize(BitStream& stream) {
+	const int count = SerializeCount(stream, (int)playerIds.size(), MAX_SERIALIZED_PLAYERS);
+	if (stream.IsReading()) {
+		playerIds.assign(count, -1);
+		playerNames.assign(count, std::string());
+	}
+	for (int i = 0; i < count; i++) {
+		stream.SerializeVarInt(playerIds[i]);
+		stream.SerializeString(playerNames[i], PLAYER_NAME_MAX_LENGTH);
+	}
 }
 
-AnnouncementSyncPacket::AnnouncementSyncPacket(int annType, float time, int playerNo) {
-	type = SyncAnnouncements;
-	size = sizeof(AnnouncementSyncPacket);
+AnnouncementSyncPacket::AnnouncementSyncPacket() : SerializablePacket(BasicNetworkMessages::SyncAnnouncements) {
+}
 
+AnnouncementSyncPacket::AnnouncementSyncPacket(int annType, float time, int playerNo) : AnnouncementSyncPacket() {
 	this->annType = annType;
 	this->time = time;
 	this->playerNo = playerNo;
 }
 
-GuardSpotSoundPacket::GuardSpotSoundPacket(const int playerId) {
-	type = BasicNetworkMessages::GuardSpotSound;
-	size = sizeof(GuardSpotSoundPacket);
+void AnnouncementSyncPacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(annType);
+	stream.SerializeFloat(time);
+	stream.SerializeVarInt(playerNo);
+}
+
+GuardSpotSoundPacket::GuardSpotSoundPacket() : SerializablePacket(BasicNetworkMessages::GuardSpotSound) {
+}
+
+GuardSpotSoundPacket::GuardSpotSoundPacket(const int playerId) : GuardSpotSoundPacket() {
 	this->playerId = playerId;
 }
 
+void GuardSpotSoundPacket::Serialize(BitStream& stream) {
+	stream.SerializeVarInt(playerId);
+}
+
 NetworkObject::NetworkObject(GameObject& o, int id) : object(o) {
 	deltaErrors = 0;
 	fullErrors = 0;
+	isInterpolated = true;
+	inputAck = -1;
+	isPredicted = false;
+	hasAuthoritativeState = false;
+	authoritativeInputAck = -1;
 	networkID = id;
 }
 
 NetworkObject::~NetworkObject() {
 }
 
-bool NetworkObject::ReadPacket(GamePacket& p) {
-	// read packet depending on packet type
-	// if neither it returns false
-
-	if (p.type == Delta_State)
-		return ReadDeltaPacket((DeltaPacket&)p);
-
-	if (p.type == Full_State)
-		return ReadFullPacket((FullPacket&)p);
-
-	return false; //this isn't a packet we care about!
-}
-
-bool NetworkObject::WritePacket(GamePacket** p, bool deltaFrame, int stateID) {
-	if (deltaFrame) {
-		if (!WriteDeltaPacket(p, stateID)) {
-			return WriteFullPacket(p);
+bool NetworkObject::WriteSnapshot(BitStream& stream, bool deltaFrame, int stateID, int ackedStateID, const NetworkQuantizer& quantizer, SnapshotSendState& sendState) {
+	const QuantizedTransform current = quantizer.Quantize(object.GetTransform().GetPosition(), object.GetTransform().GetOrientation());
+
+	NetworkState baseState;
+	// without a base state the client has, every field has to be sent in full
+	const bool hasBaseState = deltaFrame && sendState.baseStateID >= 0 && sendState.baseStateID <= ackedStateID &&
+		GetNetworkState(sendState.baseStateID, baseState);
+
+	int changeMask = SnapshotAllFields;
+	if (hasBaseState) {
+		changeMask = SnapshotFromBase;
+		if (!baseState.quantized.PositionEquals(current))
+			changeMask |= SnapshotPosition;
+		if (!baseState.quantized.OrientationEquals(current))
+			changeMask |= SnapshotOrientation;
+
+		// the client was already told this object matches the base state
+		if (changeMask == SnapshotFromBase && sendState.lastMask == SnapshotFromBase && sendState.lastBaseID == baseState.stateID &&
+			inputAck == sendState.lastInputAck)
+			return false;
+	}
+	else if (!deltaFrame) {
+		// every client shares the same full state, only the first one written records it
+		if (lastFullState.stateID != stateID) {
+			lastFullState.quantized = current;
+			lastFullState.position = quantizer.DequantizePosition(current);
+			lastFullState.orientation = quantizer.DequantizeOrientation(current);
+			lastFullState.stateID = stateID;
+			stateHistory.Add(lastFullState);
 		}
-		return true;
+		sendState.baseStateID = stateID;
 	}
-	return WriteFullPacket(p);
-}
-//Client objects recieve these packets
-bool NetworkObject::ReadDeltaPacket(DeltaPacket &p) {
-	// if the delta packets full state is not the same as the last examined full state we discard it
-	if (p.fullID != lastFullState.stateID)
-		return false;
-	UpdateStateHistory(p.fullID);
-
-	Vector3 fullPos = lastFullState.position;
-	Quaternion fullOrientation = lastFullState.orientation;
 
-	fullPos.x += p.pos[0];
-	fullPos.y += p.pos[1];
-	fullPos.z += p.pos[2];
-
-	fullOrientation.x += ((float)p.orientation[0]) / 127.0f;
-	fullOrientation.y += ((float)p.orientation[1]) / 127.0f;
-	fullOrientation.z += ((float)p.orientation[2]) / 127.0f;
-	fullOrientation.w += ((float)p.orientation[3]) / 127.0f;
+	const int maskWithoutAck = changeMask;
+	if (inputAck >= 0)
+		changeMask |= SnapshotInputAck;
+
+	stream.WriteBits(networkID, SNAPSHOT_OBJECT_ID_BITS);
+	stream.WriteBits(changeMask, SNAPSHOT_CHANGE_MASK_BITS);
+	if (changeMask & SnapshotInputAck)
+		stream.WriteBits(inputAck, SNAPSHOT_INPUT_ACK_BITS);
+	if (changeMask & SnapshotFromBase) {
+		stream.WriteBits(baseState.stateID, SNAPSHOT_BASE_ID_BITS);
+		if (changeMask & SnapshotPosition)
+			quantizer.WritePositionDelta(stream, baseState.quantized, current);
+		if (changeMask & SnapshotOrientation)
+			quantizer.WriteOrientationDelta(stream, baseState.quantized, current);
+	}
+	else {
+		quantizer.WriteFullPosition(stream, current);
+		quantizer.WriteFullOrientation(stream, current);
+	}
 
-	object.GetTransform().SetPosition(fullPos);
-	object.GetTransform().SetOrientation(fullOrientation);
+	sendState.lastMask = maskWithoutAck;
+	sendState.lastBaseID = hasBaseState ? baseState.stateID : -1;
+	sendState.lastInputAck = inputAck;
 	return true;
 }
 
-bool NetworkObject::ReadFullPacket(FullPacket &p) {
-	// if packet is old discard
-	if (p.fullState.stateID < lastFullState.stateID)
+bool NetworkObject::ReadSnapshot(BitStream& stream, bool deltaFrame, int stateID, float serverTime, const NetworkQuantizer& quantizer) {
+	SnapshotObjectState state;
+	state.objectID = networkID;
+	ReadSnapshotFields(stream, quantizer, lastFullState.quantized, state);
+	if (stream.HasOverflowed())
 		return false;
+	return ApplySnapshotState(state, deltaFrame, stateID, serverTime, quantizer);
+}
 
-	lastFullState = p.fullState;
-
-	object.GetTransform().SetPosition(lastFullState.position);
-	object.GetTransform().SetOrientation(lastFullState.orientation);
+int NetworkObject::ReadSnapshotObjectID(BitStream& stream) {
+	return stream.ReadBits(SNAPSHOT_OBJECT_ID_BITS);
+}
 
-	stateHistory.emplace_back(lastFullState);
+void NetworkObject::SkipSnapshot(BitStream& stream, const NetworkQuantizer& quantizer) {
+	SnapshotObjectState state;
+	ReadSnapshotFields(stream, quantizer, QuantizedTransform(), state);
+}
 
-	return true;
+void NetworkObject::ReadSnapshotFields(BitStream& stream, const NetworkQuantizer& quantizer, const QuantizedTransform& base, SnapshotObjectState& state) {
+	state.changeMask = stream.ReadBits(SNAPSHOT_CHANGE_MASK_BITS);
+	if (state.changeMask & SnapshotInputAck)
+		state.inputAck = stream.ReadBits(SNAPSHOT_INPUT_ACK_BITS);
+	state.quantized = base;
+	if (state.changeMask & SnapshotFromBase) {
+		state.baseIDBits = stream.ReadBits(SNAPSHOT_BASE_ID_BITS);
+		if (state.changeMask & SnapshotPosition)
+			quantizer.ReadPositionDelta(stream, base, state.quantized);
+		if (state.changeMask & SnapshotOrientation)
+			quantizer.ReadOrientationDelta(stream, base, state.quantized);
+	}
+	else {
+		quantizer.ReadFullPosition(stream, state.quantized);
+		quantizer.ReadFullOrientation(stream, state.quantized);
+	}
 }
 
-bool NetworkObject::WriteDeltaPacket(GamePacket**p, int stateID) {
-	DeltaPacket* dp = new DeltaPacket();
-	NetworkState state;
+int NetworkObject::GetMaxSnapshotObjectBits(const NetworkQuantizer& quantizer) {
+	return SNAPSHOT_OBJECT_ID_BITS + SNAPSHOT_CHANGE_MASK_BITS + SNAPSHOT_INPUT_ACK_BITS + SNAPSHOT_BASE_ID_BITS + std::max(quantizer.GetFullStateBits(), quantizer.GetMaxDeltaStateBits());
+}
 
-	// if we cant get network objects state we fail
-	if (!GetNetworkState(stateID, state))
+bool NetworkObject::ApplySnapshotState(const SnapshotObjectState& state, bool deltaFrame, int stateID, float serverTime, const NetworkQuantizer& quantizer) {
+	const Vector3 position = quantizer.DequantizePosition(state.quantized);
+	const Quaternion orientation = quantizer.DequantizeOrientation(state.quantized);
+
+	if (!deltaFrame) {
+		// if packet is old discard
+		if (stateID < lastFullState.stateID)
+			return false;
+
+		lastFullState.quantized = state.quantized;
+		lastFullState.position = position;
+		lastFullState.orientation = orientation;
+		lastFullState.stateID = stateID;
+		stateHistory.Add(lastFullState);
+		UpdateStateHistory(stateID);
+	}
+	// deltas were decoded against our last full state, which has to be the base the server used
+	else if ((state.changeMask & SnapshotFromBase) && state.baseIDBits != (lastFullState.stateID & ((1 << SNAPSHOT_BASE_ID_BITS) - 1))) {
+		deltaErrors++;
 		return false;
+	}
 
-	// tells packet what state it is a delta of
-	dp->fullID = stateID;
-	dp->objectID = networkID;
-
-	Vector3 currentPos = object.GetTransform().GetPosition();
-	Quaternion currentOrientation = object.GetTransform().GetOrientation();
-
-	// find difference between current game states orientation + position and the selected states orientation + position
-	currentPos -= state.position;
-	currentOrientation -= state.orientation;
-
-	dp->pos[0] = (char)currentPos.x;
-	dp->pos[1] = (char)currentPos.y;
-	dp->pos[2] = (char)currentPos.z;
-
-	dp->orientation[0] = (char)(currentOrientation.x * 127.0f);
-	dp->orientation[1] = (char)(currentOrientation.y * 127.0f);
-	dp->orientation[2] = (char)(currentOrientation.z * 127.0f);
-	dp->orientation[3] = (char)(currentOrientation.w * 127.0f);
-	*p = dp;
-
+	if (isPredicted) {
+		// only worth reconciling against when we know which input it reflects
+		if (state.changeMask & SnapshotInputAck) {
+			authoritativePosition = position;
+			authoritativeInputAck = state.inputAck;
+			hasAuthoritativeState = true;
+		}
+		return true;
+	}
+	if (isInterpolated) {
+		interpolationBuffer.AddSample(serverTime, position, orientation);
+		return true;
+	}
+	object.GetTransform().SetPosition(position);
+	object.GetTransform().SetOrientation(orientation);
 	return true;
 }
 
-bool NetworkObject::WriteFullPacket(GamePacket**p) {
-	FullPacket* fp = new FullPacket();
-
+void NetworkObject::SetIsInterpolated(bool isInterpolated) {
+	this->isInterpolated = isInterpolated;
+	interpolationBuffer.Clear();
+}
 
-	fp->objectID = networkID;
-	fp->fullState.position = object.GetTransform().GetPosition();
-	fp->fullState.orientation = object.GetTransform().GetOrientation();
-	fp->fullState.stateID = lastFullState.stateID++;
-	stateHistory.emplace_back(fp->fullState);
-	*p = fp;
+void NetworkObject::SetIsPredicted(bool isPredicted) {
+	this->isPredicted = isPredicted;
+	hasAuthoritativeState = false;
+}
 
+bool NetworkObject::ConsumeAuthoritativeState(Vector3& position, int& ackedInput) {
+	if (!hasAuthoritativeState) {
+		return false;
+	}
+	position = authoritativePosition;
+	ackedInput = authoritativeInputAck;
+	hasAuthoritativeState = false;
 	return true;
 }
 
+void NetworkObject::UpdateInterpolation(float renderTime) {
+	if (!isInterpolated) {
+		return;
+	}
+	Vector3 position;
+	Quaternion orientation;
+	if (interpolationBuffer.Sample(renderTime, position, orientation)) {
+		object.GetTransform().SetPosition(position);
+		object.GetTransform().SetOrientation(orientation);
+	}
+}
+
 NetworkState& NetworkObject::GetLatestNetworkState() {
 	return lastFullState;
 }
 
 bool NetworkObject::GetNetworkState(int stateID, NetworkState& state) {
 	// get a state ID from state history if needed
-	for (auto i = stateHistory.begin(); i < stateHistory.end(); i++) {
-		if ((*i).stateID == stateID) {
-			state = (*i);
-			return true;
-		}
-	}
-	return false;
+	return stateHistory.Get(stateID, state);
 }
 
 void NetworkObject::UpdateStateHistory(int minID) {
 	// once a client has accepted a delta packet or a network state has been
 	// recieved then we can clear past state histories as they are not needed
-	for (auto i = stateHistory.begin(); i < stateHistory.end();) {
-		if ((*i).stateID < minID)
-			i = stateHistory.erase(i);
-		else
-			i++;
-	}
+	stateHistory.Trim(minID);
 }
 #endif
\ No newline at end of file
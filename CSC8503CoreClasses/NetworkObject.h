@@ -3,33 +3,78 @@
 #include "GameObject.h"
 #include "NetworkBase.h"
 #include "NetworkState.h"
+#include "NetworkStateHistory.h"
+#include "SnapshotInterpolation.h"
+#include "BitStream.h"
+#include "PacketSerializer.h"
+#include "NetworkQuantizer.h"
 #include "../CSC8503/NetworkPlayer.h"
 
 namespace NCL::CSC8503 {
 	class GameObject;
 
-	struct FullPacket : public GamePacket {
-		int		objectID = -1;
-		NetworkState fullState;
+	constexpr int SNAPSHOT_MAX_PACKET_SIZE = 1200;
+	constexpr int SNAPSHOT_MAX_PAYLOAD_SIZE = SNAPSHOT_MAX_PACKET_SIZE - 24;
 
-		FullPacket() {
-			type = Full_State;
-			size = sizeof(FullPacket) - sizeof(GamePacket);
-		}
+	enum SnapshotChangeMask {
+		SnapshotPosition = 1,
+		SnapshotOrientation = 2,
+		SnapshotAllFields = SnapshotPosition | SnapshotOrientation,
+		SnapshotFromBase = 4,	//Fields are deltas against the base state rather than absolute
+		SnapshotInputAck = 8	//Last client input the server applied to this object
 	};
+	constexpr int SNAPSHOT_CHANGE_MASK_BITS = 4;
+	constexpr int SNAPSHOT_OBJECT_ID_BITS = 16;
+	constexpr int SNAPSHOT_INPUT_ACK_BITS = 16;
+	//Low bits of the base state ID a delta was taken against, so clients can spot a base they don't have.
+	constexpr int SNAPSHOT_BASE_ID_BITS = 8;
+
+	//Holds every changed network object for a tick, packed by a SnapshotWriter.
+	//Only the used part of data is sent, so size is kept in step with the payload.
+	struct SnapshotPacket : public GamePacket {
+		int		stateID = -1;		//Full state this snapshot creates, or the base a delta frame is relative to
+		float	serverTime = 0.0f;	//Server clock when the snapshot was taken, for client interpolation
+		int		propertySequence = -1;	//Replicated property block the client acknowledges, if propertyCount > 0
+		short	propertyCount = 0;		//Written ahead of the objects
+		short	objectCount = 0;
+		bool	isDeltaFrame = false;
+		bool	isCompressed = false;	//Payload is packed by a SnapshotCodec with the dictionary agreed at connect
+		char	data[SNAPSHOT_MAX_PAYLOAD_SIZE];
+
+		SnapshotPacket() {
+			type = Snapshot_State;
+			SetPayloadSize(0);
+		}
 
-	struct DeltaPacket : public GamePacket {
-		int		fullID		= -1;
-		int		objectID	= -1;
-		char	pos[3];
-		char	orientation[4];
+		int GetHeaderSize() const {
+			return (int)(data - reinterpret_cast<const char*>(this));
+		}
+
+		void SetPayloadSize(int payloadBytes) {
+			size = (short)(GetHeaderSize() - sizeof(GamePacket) + payloadBytes);
+		}
 
-		DeltaPacket() {
-			type = Delta_State;
-			size = sizeof(DeltaPacket) - sizeof(GamePacket);
+		int GetPayloadSize() const {
+			return size - (GetHeaderSize() - (int)sizeof(GamePacket));
 		}
 	};
 
+	struct SnapshotObjectState {
+		int			objectID = -1;
+		int			changeMask = 0;
+		QuantizedTransform quantized;
+		int			inputAck = -1;
+		int			baseIDBits = -1;
+	};
+
+	//What the server has sent one client about one object.
+	struct SnapshotSendState {
+		int baseStateID = -1;	//Last full state of the object written to the client
+		int lastMask = -1;
+		int lastBaseID = -1;
+		int lastInputAck = -1;
+	};
+
 	struct ClientPacket : public GamePacket {
 		int		lastID;
 		char	buttonstates[8];
@@ -42,141 +87,195 @@ namespace NCL::CSC8503 {
 		}
 	};
 	
-	struct SyncPlayerListPacket : public GamePacket {
-		int playerList[4];
+	constexpr int LEVEL_SEED_MAX_LENGTH = 32;
+	constexpr int PLAYER_NAME_MAX_LENGTH = 32;
+
+	struct SyncPlayerListPacket : public SerializablePacket {
+		std::vector<int> playerList;	//Peer in each player slot, -1 for an empty one
 		
-		SyncPlayerListPacket(std::vector<int>& serverPlayers);
-		void SyncPlayerList(std::vector<int>& clientPlayerList) const;
+		SyncPlayerListPacket();
+		SyncPlayerListPacket(const std::vector<int>& serverPlayers);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct GameStartStatePacket : public GamePacket {
+	struct GameStartStatePacket : public SerializablePacket {
 		bool isGameStarted = false;
 		std::string levelSeed;
+
+		GameStartStatePacket();
 		GameStartStatePacket(bool val, const std::string& seed);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct GameEndStatePacket : public GamePacket{
+	struct GameEndStatePacket : public SerializablePacket {
 		bool isGameEnded = false;
-		int winningPlayerId;
+		int winningPlayerId = -1;
 
+		GameEndStatePacket();
 		GameEndStatePacket(bool val, int winningPlayerId);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct ClientPlayerInputPacket : public GamePacket{
-		int lastId;
-		PlayerInputs playerInputs;
+	//Every input packet repeats the inputs the server hasn't acknowledged yet, so a lost packet costs nothing
+	//as long as a later one arrives.
+	constexpr int MAX_INPUTS_PER_PACKET = 8;
+	//Servers tick the network this often, running one of each client's inputs per tick, and clients send their
+	//inputs at the same rate. Clients interpolate between snapshots, so this can drop without remote objects stuttering.
+	constexpr float NETWORK_TICK_RATE = 60.0f;
+
+	struct ClientPlayerInputPacket : public SerializablePacket {
+		int lastId = -1;
+		int firstInputId = -1;	//ID of inputs[0], the rest follow on by one. Acked back through the snapshots
+		int inputCount = 0;
+		int propertyAck = -1;	//Newest replicated property block received
+		int propertyAckBits = 0;	//Bit n set if block propertyAck - 1 - n was received too
+		PlayerInputs inputs[MAX_INPUTS_PER_PACKET];	//Oldest first, each written as changes from the one before
 		float mouseXLook = 0.0f;
 		
-		ClientPlayerInputPacket(int lastId,  const PlayerInputs& playerInputs);
+		ClientPlayerInputPacket();
+		ClientPlayerInputPacket(int lastId, int firstInputId, int propertyAck, int propertyAckBits, const PlayerInputs* inputs, int inputCount);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct ClientUseItemPacket : public GamePacket {
-		int objectID;
-		int playerID;
+	struct ClientUseItemPacket : public SerializablePacket {
+		int objectID = -1;
+		int playerID = -1;
 
+		ClientUseItemPacket();
 		ClientUseItemPacket(int objectID, int playerID);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct ClientSyncBuffPacket : public GamePacket {
-		int playerID;
-		int buffID;
-		bool toApply;
+	struct ClientSyncBuffPacket : public SerializablePacket {
+		int playerID = -1;
+		int buffID = -1;
+		bool toApply = false;
 
+		ClientSyncBuffPacket();
 		ClientSyncBuffPacket(int playerID, int buffID, bool toApply);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct ClientSyncItemSlotUsagePacket : public GamePacket {
-		int playerID;
-		int firstItemUsage;
-		int secondItemUsage;
+	struct ClientSyncItemSlotUsagePacket : public SerializablePacket {
+		int playerID = -1;
+		int firstItemUsage = 0;
+		int secondItemUsage = 0;
 
+		ClientSyncItemSlotUsagePacket();
 		ClientSyncItemSlotUsagePacket(int playerID, int firstItemUsage, int secondItemUsage);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct ClientSyncItemSlotPacket : public GamePacket {
-		int playerID;
-		int slotId;
-		int equippedItem;
-		int usageCount;
+	struct ClientSyncItemSlotPacket : public SerializablePacket {
+		int playerID = -1;
+		int slotId = -1;
+		int equippedItem = 0;
+		int usageCount = 0;
 
+		ClientSyncItemSlotPacket();
 		ClientSyncItemSlotPacket(int playerID, int slotId, int equippedItem, int usageCount);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct ClientSyncLocalActiveSusCausePacket : public GamePacket {
-		int playerID;
-		int activeLocalSusCauseID;
-		bool toApply;
+	struct ClientSyncLocalActiveSusCausePacket : public SerializablePacket {
+		int playerID = -1;
+		int activeLocalSusCauseID = -1;
+		bool toApply = false;
 
+		ClientSyncLocalActiveSusCausePacket();
 		ClientSyncLocalActiveSusCausePacket(int playerID, int activeLocalSusCauseID, bool toApply);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct ClientSyncLocalSusChangePacket : public GamePacket {
-		int playerID;
-		int changedValue;
+	struct ClientSyncLocalSusChangePacket : public SerializablePacket {
+		int playerID = -1;
+		int changedValue = 0;
 
+		ClientSyncLocalSusChangePacket();
 		ClientSyncLocalSusChangePacket(int playerID, int changedValue);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct ClientSyncGlobalSusChangePacket : public GamePacket {
-		int changedValue;
+	struct ClientSyncGlobalSusChangePacket : public SerializablePacket {
+		int changedValue = 0;
 
+		ClientSyncGlobalSusChangePacket();
 		ClientSyncGlobalSusChangePacket(int changedValue);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct ClientSyncLocationActiveSusCausePacket : public GamePacket {
-		int cantorPairedLocation;
-		int activeLocationSusCauseID;
-		bool toApply;
+	struct ClientSyncLocationActiveSusCausePacket : public SerializablePacket {
+		int cantorPairedLocation = 0;
+		int activeLocationSusCauseID = -1;
+		bool toApply = false;
 
+		ClientSyncLocationActiveSusCausePacket();
 		ClientSyncLocationActiveSusCausePacket(int playerID, int activeLocationSusCauseID, bool toApply);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct ClientSyncLocationSusChangePacket : public GamePacket {
-		int cantorPairedLocation;
-		int changedValue;
+	struct ClientSyncLocationSusChangePacket : public SerializablePacket {
+		int cantorPairedLocation = 0;
+		int changedValue = 0;
 
+		ClientSyncLocationSusChangePacket();
 		ClientSyncLocationSusChangePacket(int cantorPairedLocation, int changedValue);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct SyncInteractablePacket : public GamePacket {
-		int networkObjId;
-		bool isOpen;
-		int interactableItemType;
+	struct SyncInteractablePacket : public SerializablePacket {
+		int networkObjId = -1;
+		bool isOpen = false;
+		int interactableItemType = 0;
 
+		SyncInteractablePacket();
 		SyncInteractablePacket(int networkObjectId, bool isOpen, int interactableItemType);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct SyncObjectStatePacket : public GamePacket {
-		int networkObjId;
-		int objectState;
+	struct SyncObjectStatePacket : public SerializablePacket {
+		int networkObjId = -1;
+		int objectState = 0;
 
+		SyncObjectStatePacket();
 		SyncObjectStatePacket(int networkObjId, int objectState);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct AnnouncementSyncPacket : public GamePacket {
-		int annType;
-		float time;
-		int playerNo;
+	struct AnnouncementSyncPacket : public SerializablePacket {
+		int annType = 0;
+		float time = 0.0f;
+		int playerNo = -1;
+
+		AnnouncementSyncPacket();
 		AnnouncementSyncPacket(int annType, float time, int playerNo);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct ClientInitPacket : public GamePacket {
+	struct ClientInitPacket : public SerializablePacket {
 		std::string playerName;
+		uint32_t snapshotDictionaryId = 0;	//The client can decompress snapshots packed with this dictionary, 0 for none
 
-		ClientInitPacket(const std::string& playerName);
+		ClientInitPacket();
+		ClientInitPacket(const std::string& playerName, uint32_t snapshotDictionaryId = 0);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct SyncPlayerIdNameMapPacket : public GamePacket {
-		int playerIds[4] = { -1 , -1, -1,-1 };
-		std::string playerNames[4];
+	struct SyncPlayerIdNameMapPacket : public SerializablePacket {
+		std::vector<int> playerIds;
+		std::vector<std::string> playerNames;
 
+		SyncPlayerIdNameMapPacket();
 		SyncPlayerIdNameMapPacket(const std::map<int, string>& playerIdNameMap);
+		void Serialize(BitStream& stream) override;
 	};
 
-	struct GuardSpotSoundPacket : public GamePacket {
-		int playerId;
+	struct GuardSpotSoundPacket : public SerializablePacket {
+		int playerId = -1;
 
+		GuardSpotSoundPacket();
 		GuardSpotSoundPacket(const int playerId);
+		void Serialize(BitStream& stream) override;
 	};
 
 	class NetworkObject {
@@ -184,10 +283,16 @@ namespace NCL::CSC8503 {
 		NetworkObject(GameObject& o, int id);
 		virtual ~NetworkObject();
 
-		//Called by clients
-		virtual bool ReadPacket(GamePacket& p);
-		//Called by servers
-		virtual bool WritePacket(GamePacket** p, bool deltaFrame, int stateID);
+		//Called by servers once per client, returns false if the object was left out of the snapshot.
+		//Deltas are only taken against a full state the client has acknowledged.
+		virtual bool WriteSnapshot(BitStream& stream, bool deltaFrame, int stateID, int ackedStateID, const NetworkQuantizer& quantizer, SnapshotSendState& sendState);
+		//Called by clients once ReadSnapshotObjectID has matched this object
+		virtual bool ReadSnapshot(BitStream& stream, bool deltaFrame, int stateID, float serverTime, const NetworkQuantizer& quantizer);
+
+		static int ReadSnapshotObjectID(BitStream& stream);
+		//Consumes the fields of an object this client doesn't know about
+		static void SkipSnapshot(BitStream& stream, const NetworkQuantizer& quantizer);
+		static int GetMaxSnapshotObjectBits(const NetworkQuantizer& quantizer);
 
 		GameObject& GetGameObject() { return object; }
 
@@ -199,25 +304,45 @@ namespace NCL::CSC8503 {
 
 		NetworkState& GetLatestNetworkState();
 
+		//Interpolated objects buffer received transforms and are moved by UpdateInterpolation instead.
+		void SetIsInterpolated(bool isInterpolated);
+		void UpdateInterpolation(float renderTime);
+
+		//Set by servers to the last client input applied to this object, sent along with its snapshots.
+		void SetInputAck(int inputId) { inputAck = inputId; }
+		//Predicted objects are moved by their owner, snapshots only report where the server has them.
+		void SetIsPredicted(bool isPredicted);
+		bool ConsumeAuthoritativeState(Maths::Vector3& position, int& ackedInput);
+
+		//Deltas that had to fall back to a full state because the base was no longer in the history.
+		int GetHistoryMisses() const { return stateHistory.GetMisses(); }
+
 	protected:
 
 		bool GetNetworkState(int frameID, NetworkState& state);
 
-		virtual bool ReadDeltaPacket(DeltaPacket &p);
-		virtual bool ReadFullPacket(FullPacket &p);
-
-		virtual bool WriteDeltaPacket(GamePacket**p, int stateID);
-		virtual bool WriteFullPacket(GamePacket**p);
+		virtual bool ApplySnapshotState(const SnapshotObjectState& state, bool deltaFrame, int stateID, float serverTime, const NetworkQuantizer& quantizer);
+		static void ReadSnapshotFields(BitStream& stream, const NetworkQuantizer& quantizer, const QuantizedTransform& base, SnapshotObjectState& state);
 
 		GameObject& object;
 
 		NetworkState lastFullState;
 
-		std::vector<NetworkState> stateHistory;
+		NetworkStateHistory stateHistory;
+
+		InterpolationBuffer interpolationBuffer;
+		bool isInterpolated;
+
+		int inputAck;
+		bool isPredicted;
+		bool hasAuthoritativeState;
+		Maths::Vector3 authoritativePosition;
+		int authoritativeInputAck;
 
 		int deltaErrors;
 		int fullErrors;
 
+
 		int networkID;
 	};
 }
@@ -0,0 +1,226 @@
+#ifdef USEGL
+#include "NetworkQuantizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace NCL;
+using namespace CSC8503;
+using namespace Maths;
+
+namespace {
+	constexpr float DEFAULT_POSITION_RESOLUTION = 1.0f / 128.0f;
+	constexpr int DEFAULT_ORIENTATION_BITS = 10;
+	constexpr int MIN_ORIENTATION_BITS = 6;
+	constexpr int MAX_ORIENTATION_BITS = 15;
+	constexpr int MAX_POSITION_BITS = 30;
+	constexpr int LARGEST_COMPONENT_BITS = 2;
+
+	//The three smallest components of a unit quaternion always lie within +-1/sqrt(2)
+	constexpr float SMALLEST_THREE_RANGE = 0.707106781f;
+
+	constexpr int SMALL_DELTA_BITS = 4;
+	constexpr int MEDIUM_DELTA_BITS = 8;
+
+	uint32_t ZigZag(int32_t value) {
+		return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+	}
+
+	int32_t UnZigZag(uint32_t value) {
+		return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+	}
+}
+
+NetworkQuantizer::NetworkQuantizer() {
+	mBoundsMin = Vector3(-512, -64, -512);
+	mBoundsMax = Vector3(512, 192, 512);
+	mPositionResolution = DEFAULT_POSITION_RESOLUTION;
+	mOrientationBits = DEFAULT_ORIENTATION_BITS;
+	UpdatePositionBits();
+}
+
+void NetworkQuantizer::SetBounds(const Vector3& boundsMin, const Vector3& boundsMax) {
+	mBoundsMin = boundsMin;
+	mBoundsMax = boundsMax;
+	UpdatePositionBits();
+}
+
+void NetworkQuantizer::SetPositionResolution(float unitsPerStep) {
+	mPositionResolution = unitsPerStep > 0.0f ? unitsPerStep : DEFAULT_POSITION_RESOLUTION;
+	UpdatePositionBits();
+}
+
+void NetworkQuantizer::SetOrientationBits(int bitsPerComponent) {
+	mOrientationBits = std::clamp(bitsPerComponent, MIN_ORIENTATION_BITS, MAX_ORIENTATION_BITS);
+}
+
+void NetworkQuantizer::UpdatePositionBits() {
+	for (int axis = 0; axis < 3; axis++) {
+		const float range = std::max(mBoundsMax[axis] - mBoundsMin[axis], mPositionResolution);
+		const double steps = std::ceil(range / mPositionResolution) + 1.0;
+		mPositionBits[axis] = std::clamp((int)std::ceil(std::log2(steps)), 1, MAX_POSITION_BITS);
+	}
+}
+
+QuantizedTransform NetworkQuantizer::Quantize(const Vector3& position, const Quaternion& orientation) const {
+	QuantizedTransform quantized;
+
+	for (int axis = 0; axis < 3; axis++) {
+		const uint32_t maxValue = (1u << mPositionBits[axis]) - 1;
+		const double steps = std::round((position[axis] - mBoundsMin[axis]) / mPositionResolution);
+		quantized.position[axis] = (uint32_t)std::clamp(steps, 0.0, (double)maxValue);
+	}
+
+	const Quaternion normalised = orientation.Normalised();
+	int largest = 0;
+	for (int i = 1; i < 4; i++) {
+		if (std::abs(normalised[i]) > std::abs(normalised[largest])) {
+			largest = i;
+		}
+	}
+	// q and -q are the same rotation, so flip to keep the dropped component positive
+	const float sign = normalised[largest] < 0.0f ? -1.0f : 1.0f;
+	const float maxValue = (float)((1u << mOrientationBits) - 1);
+
+	quantized.largestComponent = largest;
+	int written = 0;
+	for (int i = 0; i < 4; i++) {
+		if (i == largest) {
+			continue;
+		}
+		const float normalisedComponent = (normalised[i] * sign + SMALLEST_THREE_RANGE) / (2.0f * SMALLEST_THREE_RANGE);
+		quantized.orientation[written++] = (uint32_t)std::clamp(std::round(normalisedComponent * maxValue), 0.0f, maxValue);
+	}
+	return quantized;
+}
+
+Vector3 NetworkQuantizer::DequantizePosition(const QuantizedTransform& quantized) const {
+	return Vector3(
+		mBoundsMin.x + quantized.position[0] * mPositionResolution,
+		mBoundsMin.y + quantized.position[1] * mPositionResolution,
+		mBoundsMin.z + quantized.position[2] * mPositionResolution);
+}
+
+Quaternion NetworkQuantizer::DequantizeOrientation(const QuantizedTransform& quantized) const {
+	const float maxValue = (float)((1u << mOrientationBits) - 1);
+	float components[4];
+	float sumOfSquares = 0.0f;
+	int read = 0;
+	for (int i = 0; i < 4; i++) {
+		if (i == (int)quantized.largestComponent) {
+			continue;
+		}
+		components[i] = (quantized.orientation[read++] / maxValue) * (2.0f * SMALLEST_THREE_RANGE) - SMALLEST_THREE_RANGE;
+		sumOfSquares += components[i] * components[i];
+	}
+	components[quantized.largestComponent] = std::sqrt(std::max(0.0f, 1.0f - sumOfSquares));
+
+	Quaternion orientation(components[0], components[1], components[2], components[3]);
+	orientation.Normalise();
+	return orientation;
+}
+
+void NetworkQuantizer::WriteFullPosition(BitStream& stream, const QuantizedTransform& quantized) const {
+	for (int axis = 0; axis < 3; axis++) {
+		stream.WriteBits(quantized.position[axis], mPositionBits[axis]);
+	}
+}
+
+void NetworkQuantizer::ReadFullPosition(BitStream& stream, QuantizedTransform& quantized) const {
+	for (int axis = 0; axis < 3; axis++) {
+		quantized.position[axis] = stream.ReadBits(mPositionBits[axis]);
+	}
+}
+
+void NetworkQuantizer::WriteFullOrientation(BitStream& stream, const QuantizedTransform& quantized) const {
+	stream.WriteBits(quantized.largestComponent, LARGEST_COMPONENT_BITS);
+	for (int i = 0; i < 3; i++) {
+		stream.WriteBits(quantized.orientation[i], mOrientationBits);
+	}
+}
+
+void NetworkQuantizer::ReadFullOrientation(BitStream& stream, QuantizedTransform& quantized) const {
+	quantized.largestComponent = stream.ReadBits(LARGEST_COMPONENT_BITS);
+	for (int i = 0; i < 3; i++) {
+		quantized.orientation[i] = stream.ReadBits(mOrientationBits);
+	}
+}
+
+void NetworkQuantizer::WritePositionDelta(BitStream& stream, const QuantizedTransform& base, const QuantizedTransform& current) const {
+	for (int axis = 0; axis < 3; axis++) {
+		WriteComponentDelta(stream, base.position[axis], current.position[axis], mPositionBits[axis]);
+	}
+}
+
+void NetworkQuantizer::ReadPositionDelta(BitStream& stream, const QuantizedTransform& base, QuantizedTransform& current) const {
+	for (int axis = 0; axis < 3; axis++) {
+		current.position[axis] = ReadComponentDelta(stream, base.position[axis], mPositionBits[axis]);
+	}
+}
+
+void NetworkQuantizer::WriteOrientationDelta(BitStream& stream, const QuantizedTransform& base, const QuantizedTransform& current) const {
+	// components can only be compared while the same one is being dropped
+	const bool isSameLargest = base.largestComponent == current.largestComponent;
+	stream.WriteBool(isSameLargest);
+	if (!isSameLargest) {
+		WriteFullOrientation(stream, current);
+		return;
+	}
+	for (int i = 0; i < 3; i++) {
+		WriteComponentDelta(stream, base.orientation[i], current.orientation[i], mOrientationBits);
+	}
+}
+
+void NetworkQuantizer::ReadOrientationDelta(BitStream& stream, const QuantizedTransform& base, QuantizedTransform& current) const {
+	if (!stream.ReadBool()) {
+		ReadFullOrientation(stream, current);
+		return;
+	}
+	current.largestComponent = base.largestComponent;
+	for (int i = 0; i < 3; i++) {
+		current.orientation[i] = ReadComponentDelta(stream, base.orientation[i], mOrientationBits);
+	}
+}
+
+// Prefix coded: 0 = small delta, 10 = medium delta, 11 = absolute value.
+void NetworkQuantizer::WriteComponentDelta(BitStream& stream, uint32_t base, uint32_t current, int fullBits) const {
+	const uint32_t zigZagged = ZigZag((int32_t)(current - base));
+	if (zigZagged < (1u << SMALL_DELTA_BITS) && SMALL_DELTA_BITS < fullBits) {
+		stream.WriteBool(false);
+		stream.WriteBits(zigZagged, SMALL_DELTA_BITS);
+		return;
+	}
+	stream.WriteBool(true);
+	if (zigZagged < (1u << MEDIUM_DELTA_BITS) && MEDIUM_DELTA_BITS < fullBits) {
+		stream.WriteBool(false);
+		stream.WriteBits(zigZagged, MEDIUM_DELTA_BITS);
+		return;
+	}
+	stream.WriteBool(true);
+	stream.WriteBits(current, fullBits);
+}
+
+uint32_t NetworkQuantizer::ReadComponentDelta(BitStream& stream, uint32_t base, int fullBits) const {
+	if (!stream.ReadBool()) {
+		return base + UnZigZag(stream.ReadBits(SMALL_DELTA_BITS));
+	}
+	if (!stream.ReadBool()) {
+		return base + UnZigZag(stream.ReadBits(MEDIUM_DELTA_BITS));
+	}
+	return stream.ReadBits(fullBits);
+}
+
+int NetworkQuantizer::GetFullStateBits() const {
+	return GetPositionBits() + LARGEST_COMPONENT_BITS + 3 * mOrientationBits;
+}
+
+int NetworkQuantizer::GetMaxDeltaStateBits() const {
+	const int positionBits = GetPositionBits() + 3 * 2;
+	const int orientationBits = 1 + std::max(3 * (mOrientationBits + 2), LARGEST_COMPONENT_BITS + 3 * mOrientationBits);
+	return positionBits + orientationBits;
+}
+
+float NetworkQuantizer::GetMaxOrientationComponentError() const {
+	return SMALLEST_THREE_RANGE / (float)((1u << mOrientationBits) - 1);
+}
+#endif
@@ -0,0 +1,69 @@
+#ifdef USEGL
+#pragma once
+#include "BitStream.h"
+
+namespace NCL::CSC8503 {
+	//Transform snapped to the network grid. Server and client agree on these values exactly,
+	//deltas are taken between them so nothing is lost on top of the quantisation itself.
+	struct QuantizedTransform {
+		uint32_t position[3] = { 0, 0, 0 };
+		uint32_t largestComponent = 3;
+		uint32_t orientation[3] = { 0, 0, 0 };
+
+		bool PositionEquals(const QuantizedTransform& other) const {
+			return position[0] == other.position[0] && position[1] == other.position[1] && position[2] == other.position[2];
+		}
+
+		bool OrientationEquals(const QuantizedTransform& other) const {
+			return largestComponent == other.largestComponent && orientation[0] == other.orientation[0] &&
+				orientation[1] == other.orientation[1] && orientation[2] == other.orientation[2];
+		}
+	};
+
+	// Positions are fixed point relative to the level bounds, orientations use the
+	// smallest three form: the largest component is dropped and rebuilt from the others.
+	class NetworkQuantizer {
+	public:
+		NetworkQuantizer();
+
+		void SetBounds(const Maths::Vector3& boundsMin, const Maths::Vector3& boundsMax);
+		void SetPositionResolution(float unitsPerStep);
+		void SetOrientationBits(int bitsPerComponent);
+
+		QuantizedTransform Quantize(const Maths::Vector3& position, const Maths::Quaternion& orientation) const;
+		Maths::Vector3 DequantizePosition(const QuantizedTransform& quantized) const;
+		Maths::Quaternion DequantizeOrientation(const QuantizedTransform& quantized) const;
+
+		void WriteFullPosition(BitStream& stream, const QuantizedTransform& quantized) const;
+		void ReadFullPosition(BitStream& stream, QuantizedTransform& quantized) const;
+		void WriteFullOrientation(BitStream& stream, const QuantizedTransform& quantized) const;
+		void ReadFullOrientation(BitStream& stream, QuantizedTransform& quantized) const;
+
+		//Deltas fall back to the full encoding when they wouldn't be any smaller.
+		void WritePositionDelta(BitStream& stream, const QuantizedTransform& base, const QuantizedTransform& current) const;
+		void ReadPositionDelta(BitStream& stream, const QuantizedTransform& base, QuantizedTransform& current) const;
+		void WriteOrientationDelta(BitStream& stream, const QuantizedTransform& base, const QuantizedTransform& current) const;
+		void ReadOrientationDelta(BitStream& stream, const QuantizedTransform& base, QuantizedTransform& current) const;
+
+		int GetPositionBits() const { return mPositionBits[0] + mPositionBits[1] + mPositionBits[2]; }
+		int GetOrientationBits() const { return mOrientationBits; }
+		int GetFullStateBits() const;
+		int GetMaxDeltaStateBits() const;
+		//Worst case reconstruction error per axis, in world units and quaternion component units.
+		float GetMaxPositionError() const { return mPositionResolution * 0.5f; }
+		float GetMaxOrientationComponentError() const;
+
+	protected:
+		void UpdatePositionBits();
+
+		void WriteComponentDelta(BitStream& stream, uint32_t base, uint32_t current, int fullBits) const;
+		uint32_t ReadComponentDelta(BitStream& stream, uint32_t base, int fullBits) const;
+
+		Maths::Vector3 mBoundsMin;
+		Maths::Vector3 mBoundsMax;
+		float mPositionResolution;
+		int mPositionBits[3];
+		int mOrientationBits;
+	};
+}
+#endif
@@ -0,0 +1,153 @@
+#ifdef USEGL
+#include "NetworkReceiver.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	//Per type, enough for a few seconds of snapshots or every player's inputs through a long frame.
+	constexpr int QUEUE_CAPACITY = 512;
+	constexpr std::chrono::milliseconds SERVICE_INTERVAL(1);
+}
+
+NetworkReceiver::NetworkReceiver(TransportHost& host, std::mutex& hostMutex) : mHost(host), mHostMutex(hostMutex) {
+	for (int i = 0; i < QUEUE_COUNT; i++) {
+		mQueues[i] = std::make_unique<MPSCRingBuffer<InboundMessage>>(QUEUE_CAPACITY);
+		mHasQueueFront[i] = false;
+	}
+	mNextSequence = 0;
+	mHasStalledMessage = false;
+	mPublishedCount = 0;
+	mNextDispatch = 0;
+	mIsRunning = false;
+	mPeakQueueDepth = 0;
+	mStallCount = 0;
+	mAverageQueueTimeMs = 0.0f;
+}
+
+NetworkReceiver::~NetworkReceiver() {
+	Stop();
+
+	for (int i = 0; i < QUEUE_COUNT; i++) {
+		if (mHasQueueFront[i]) {
+			mHost.ReleasePacket(mQueueFronts[i].event.packet);
+		}
+		InboundMessage message;
+		while (mQueues[i]->TryPop(message)) {
+			mHost.ReleasePacket(message.event.packet);
+		}
+	}
+	if (mHasStalledMessage) {
+		mHost.ReleasePacket(mStalledMessage.event.packet);
+	}
+}
+
+void NetworkReceiver::Start() {
+	if (mIsRunning) {
+		return;
+	}
+	mIsRunning = true;
+	mThread = std::thread(&NetworkReceiver::ReceiveThread, this);
+}
+
+void NetworkReceiver::Stop() {
+	mIsRunning = false;
+	if (mThread.joinable()) {
+		mThread.join();
+	}
+}
+
+void NetworkReceiver::ReceiveThread() {
+	while (mIsRunning) {
+		{
+			std::lock_guard<std::mutex> lock(mHostMutex);
+			//a full queue leaves the rest with the host until the game thread catches up
+			if (!mHasStalledMessage || Push(mStalledMessage)) {
+				mHasStalledMessage = false;
+
+				InboundMessage message;
+				while (mHost.Service(message.event)) {
+					message.receivedAt = std::chrono::steady_clock::now();
+					message.sequence = mNextSequence;
+					if (!Push(message)) {
+						mStalledMessage = message;
+						mHasStalledMessage = true;
+						mStallCount++;
+						break;
+					}
+				}
+			}
+		}
+		std::this_thread::sleep_for(SERVICE_INTERVAL);
+	}
+}
+
+bool NetworkReceiver::Push(const InboundMessage& message) {
+	if (!mQueues[GetQueueIndex(message.event)]->TryPush(message)) {
+		return false;
+	}
+	mNextSequence++;
+	mPublishedCount.store(mNextSequence, std::memory_order_release);
+
+	const int depth = (int)(mNextSequence - mNextDispatch.load(std::memory_order_acquire));
+	if (depth > mPeakQueueDepth) {
+		mPeakQueueDepth = depth;
+	}
+	return true;
+}
+
+int NetworkReceiver::GetQueueIndex(const TransportEvent& event) {
+	if (event.type != TransportEventType::Receive) {
+		return CONNECTION_QUEUE;
+	}
+	if (event.packet.size < (int)sizeof(GamePacket)) {
+		return UNKNOWN_TYPE_QUEUE;
+	}
+	const int type = ((const GamePacket*)event.packet.data)->type;
+	if (type < 0 || type >= BasicNetworkMessages::MessageTypeCount) {
+		return UNKNOWN_TYPE_QUEUE;
+	}
+	return type + 1;
+}
+
+int NetworkReceiver::Dispatch(const MessageHandler& handler) {
+	//messages that land while dispatching wait for the next tick
+	const uint64_t publishedCount = mPublishedCount.load(std::memory_order_acquire);
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	int dispatched = 0;
+	float totalQueueTimeMs = 0.0f;
+
+	while (mNextDispatch < publishedCount) {
+		//each queue is in arrival order, so the next message is at the front of one of them
+		int nextQueue = -1;
+		for (int i = 0; i < QUEUE_COUNT && nextQueue < 0; i++) {
+			if (!mHasQueueFront[i]) {
+				mHasQueueFront[i] = mQueues[i]->TryPop(mQueueFronts[i]);
+			}
+			if (mHasQueueFront[i] && mQueueFronts[i].sequence == mNextDispatch) {
+				nextQueue = i;
+			}
+		}
+		if (nextQueue < 0) {
+			break;
+		}
+		mHasQueueFront[nextQueue] = false;
+		mNextDispatch.store(mNextDispatch + 1, std::memory_order_release);
+
+		const InboundMessage message = mQueueFronts[nextQueue];
+		const std::chrono::duration<float, std::milli> queueTime = now - message.receivedAt;
+		totalQueueTimeMs += std::max(queueTime.count(), 0.0f);
+		dispatched++;
+		handler(message);
+	}
+
+	if (dispatched > 0) {
+		mAverageQueueTimeMs = totalQueueTimeMs / dispatched;
+	}
+	return dispatched;
+}
+
+int NetworkReceiver::GetQueueDepth() const {
+	return (int)(mPublishedCount.load(std::memory_order_acquire) - mNextDispatch);
+}
+#endif
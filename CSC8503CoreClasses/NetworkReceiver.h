@@ -0,0 +1,78 @@
+#ifdef USEGL
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "MPSCRingBuffer.h"
+#include "NetworkBase.h"
+#include "NetworkTransport.h"
+
+namespace NCL::CSC8503 {
+	// Owns a host's network receive thread. The host is serviced every millisecond whatever the game thread is doing,
+	// so acks go out and round trip times are measured on time, and each message is queued by type until the game
+	// thread dispatches them all, in the order they arrived, at a fixed point in its tick.
+	class NetworkReceiver {
+	public:
+		struct InboundMessage {
+			TransportEvent event;
+			uint64_t sequence = 0;	//Arrival order across every queue
+			std::chrono::steady_clock::time_point receivedAt;
+		};
+		typedef std::function<void(const InboundMessage& message)> MessageHandler;
+
+		//Everything else using the host has to hold hostMutex while it does.
+		NetworkReceiver(TransportHost& host, std::mutex& hostMutex);
+		~NetworkReceiver();
+
+		void Start();
+		void Stop();
+
+		//Game thread only. Hands on every message queued so far, the handler releases their packets.
+		int Dispatch(const MessageHandler& handler);
+
+		int GetQueueDepth() const;
+		int GetPeakQueueDepth() const { return mPeakQueueDepth; }
+		//Times the thread stopped taking events from the host because a queue was full.
+		int GetStallCount() const { return mStallCount; }
+		//Time from arrival until the game thread handled it, over the last dispatch.
+		float GetAverageQueueTimeMs() const { return mAverageQueueTimeMs; }
+
+	protected:
+		//Connection events first, one per message type, then one for anything unrecognised.
+		static constexpr int CONNECTION_QUEUE = 0;
+		static constexpr int UNKNOWN_TYPE_QUEUE = BasicNetworkMessages::MessageTypeCount + 1;
+		static constexpr int QUEUE_COUNT = UNKNOWN_TYPE_QUEUE + 1;
+
+		void ReceiveThread();
+		bool Push(const InboundMessage& message);
+		static int GetQueueIndex(const TransportEvent& event);
+
+		TransportHost& mHost;
+		std::mutex& mHostMutex;
+
+		std::unique_ptr<MPSCRingBuffer<InboundMessage>> mQueues[QUEUE_COUNT];
+		//Popped but not yet dispatched because an earlier message is in another queue.
+		InboundMessage mQueueFronts[QUEUE_COUNT];
+		bool mHasQueueFront[QUEUE_COUNT];
+
+		//Receive thread only.
+		uint64_t mNextSequence;
+		bool mHasStalledMessage;
+		InboundMessage mStalledMessage;
+
+		std::atomic<uint64_t> mPublishedCount;
+		std::atomic<uint64_t> mNextDispatch;
+
+		std::thread mThread;
+		std::atomic<bool> mIsRunning;
+
+		std::atomic<int> mPeakQueueDepth;
+		std::atomic<int> mStallCount;
+		std::atomic<float> mAverageQueueTimeMs;
+	};
+}
+#endif
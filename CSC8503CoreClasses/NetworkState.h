@@ -1,5 +1,6 @@
 #ifdef USEGL
 #pragma once
+#include "NetworkQuantizer.h"
 
 namespace NCL {
 	using namespace Maths;
@@ -21,6 +22,7 @@ namespace NCL {
 
 			Vector3		position;
 			Quaternion	orientation;
+			QuantizedTransform quantized;
 			int			stateID;
 		};
 	}
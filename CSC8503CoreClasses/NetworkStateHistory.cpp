@@ -0,0 +1,41 @@
+#ifdef USEGL
+#include "NetworkStateHistory.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+NetworkStateHistory::NetworkStateHistory() {
+	for (int i = 0; i < STATE_HISTORY_CAPACITY; i++) {
+		mIsSlotUsed[i] = false;
+	}
+	mMinStateID = 0;
+	mMisses = 0;
+}
+
+void NetworkStateHistory::Add(const NetworkState& state) {
+	if (state.stateID < 0) {
+		return;
+	}
+	const int slot = state.stateID % STATE_HISTORY_CAPACITY;
+	mStates[slot] = state;
+	mIsSlotUsed[slot] = true;
+}
+
+bool NetworkStateHistory::Get(int stateID, NetworkState& state) {
+	if (stateID < mMinStateID || stateID < 0) {
+		mMisses++;
+		return false;
+	}
+	const int slot = stateID % STATE_HISTORY_CAPACITY;
+	if (!mIsSlotUsed[slot] || mStates[slot].stateID != stateID) {
+		mMisses++;
+		return false;
+	}
+	state = mStates[slot];
+	return true;
+}
+
+void NetworkStateHistory::Trim(int minID) {
+	mMinStateID = std::max(mMinStateID, minID);
+}
+#endif
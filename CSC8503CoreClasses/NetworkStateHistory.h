@@ -0,0 +1,33 @@
+#ifdef USEGL
+#pragma once
+#include "NetworkState.h"
+
+namespace NCL::CSC8503 {
+	//Full snapshots go out every 6th tick of the 60hz network update.
+	constexpr int STATE_HISTORY_FULL_STATES_PER_SECOND = 10;
+	//Acks older than this are treated as lost and the object is resent in full.
+	constexpr int STATE_HISTORY_MAX_RTT_MS = 1000;
+	constexpr int STATE_HISTORY_CAPACITY = STATE_HISTORY_FULL_STATES_PER_SECOND * STATE_HISTORY_MAX_RTT_MS / 1000 + 2;
+
+	// Fixed size history of full states, slot = stateID % capacity. Full state IDs are consecutive,
+	// so a newer state only ever overwrites one that is too old to be acknowledged anyway.
+	class NetworkStateHistory {
+	public:
+		NetworkStateHistory();
+
+		void Add(const NetworkState& state);
+		//Counts a miss when the state has been trimmed or overwritten.
+		bool Get(int stateID, NetworkState& state);
+		//Drops every state older than minID.
+		void Trim(int minID);
+
+		int GetMisses() const { return mMisses; }
+
+	protected:
+		NetworkState mStates[STATE_HISTORY_CAPACITY];
+		bool mIsSlotUsed[STATE_HISTORY_CAPACITY];
+		int mMinStateID;
+		int mMisses;
+	};
+}
+#endif
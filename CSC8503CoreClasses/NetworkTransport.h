@@ -0,0 +1,74 @@
+#ifdef USEGL
+#pragma once
+#include <cstdint>
+
+namespace NCL {
+	namespace CSC8503 {
+		//A message owned by the host that made it. data stays valid until the packet is released.
+		struct TransportPacket {
+			char* data = nullptr;
+			int size = 0;
+			void* handle = nullptr;	//The transport's own representation, null for no packet
+		};
+
+		enum class TransportEventType {
+			None,
+			Connect,
+			Disconnect,
+			Receive
+		};
+
+		struct TransportEvent {
+			TransportEventType type = TransportEventType::None;
+			int peer = -1;		//Index of the connection on this host
+			uint32_t data = 0;	//What the remote side passed to Connect
+			TransportPacket packet;	//Only set for Receive, release it once handled
+		};
+
+		// One endpoint: a listening server or a client with a single outgoing connection. Peers are slots
+		// numbered from 0 up to GetMaxPeers, the same numbering ENet uses for incoming peer IDs.
+		class TransportHost {
+		public:
+			virtual ~TransportHost() {}
+
+			//Starts connecting and returns the new peer, or -1. Connect or Disconnect comes back as an event.
+			virtual int Connect(uint8_t a, uint8_t b, uint8_t c, uint8_t d, int port, uint32_t data) = 0;
+			//Sends queued packets and returns the next event, waiting up to timeoutMs for one.
+			virtual bool Service(TransportEvent& event, int timeoutMs = 0) = 0;
+
+			//Packets are shared between every send they are used for, release once the last one is queued.
+			virtual TransportPacket CreatePacket(const void* data, int size) = 0;
+			virtual void ReleasePacket(const TransportPacket& packet) = 0;
+			virtual bool Send(int peer, const TransportPacket& packet) = 0;
+			//Sends to every connected peer.
+			virtual void Broadcast(const TransportPacket& packet) = 0;
+			virtual void Flush() = 0;
+
+			virtual void Disconnect(int peer) = 0;
+			//Disconnects once everything already queued for the peer has gone out.
+			virtual void DisconnectLater(int peer) = 0;
+
+			virtual int GetMaxPeers() const = 0;
+			virtual int GetRoundTripTime(int peer) const = 0;
+			//What the other end of the connection numbers it as.
+			virtual int GetRemotePeerID(int peer) const = 0;
+		};
+
+		//Makes hosts, so the game can run on real sockets or on a simulated network without changing.
+		class NetworkTransport {
+		public:
+			virtual ~NetworkTransport() {}
+
+			virtual bool Initialise() { return true; }
+			virtual void Destroy() {}
+
+			//A port of -1 makes a client host that only connects out.
+			virtual TransportHost* CreateHost(int port, int maxPeers) = 0;
+
+			//Whether games may send and receive on threads of their own. Without them everything happens on the
+			//game thread, in the same order every run.
+			virtual bool GetAllowsNetworkThreads() const { return true; }
+		};
+	}
+}
+#endif
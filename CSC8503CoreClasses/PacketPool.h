@@ -0,0 +1,64 @@
+#ifdef USEGL
+#pragma once
+#include <atomic>
+
+#include "MPSCRingBuffer.h"
+
+namespace NCL::CSC8503 {
+	struct SnapshotPacket;
+	struct SerializedPacket;
+
+	// Recycles packet buffers so sending doesn't allocate every tick. Release is safe from any
+	// thread, Acquire must stay on one thread at a time.
+	template <typename T>
+	class PacketPool {
+	public:
+		PacketPool(int capacity, int preallocated) : mFreePackets(capacity) {
+			mPacketsAllocated = 0;
+			for (int i = 0; i < preallocated; i++) {
+				mPacketsAllocated++;
+				Release(new T());
+			}
+		}
+
+		~PacketPool() {
+			T* packet = nullptr;
+			while (mFreePackets.TryPop(packet)) {
+				delete packet;
+			}
+		}
+
+		PacketPool(const PacketPool&) = delete;
+		PacketPool& operator=(const PacketPool&) = delete;
+
+		T* Acquire() {
+			T* packet = nullptr;
+			if (mFreePackets.TryPop(packet)) {
+				*packet = T();
+				return packet;
+			}
+			mPacketsAllocated++;
+			return new T();
+		}
+
+		void Release(T* packet) {
+			if (packet == nullptr) {
+				return;
+			}
+			if (!mFreePackets.TryPush(packet)) {
+				mPacketsAllocated--;
+				delete packet;
+			}
+		}
+
+		int GetPacketsAllocated() const { return mPacketsAllocated; }
+
+	protected:
+		MPSCRingBuffer<T*> mFreePackets;
+		std::atomic<int> mPacketsAllocated;
+	};
+
+	using SnapshotPacketPool = PacketPool<SnapshotPacket>;
+	using SerializedPacketPool = PacketPool<SerializedPacket>;
+}
+#endif
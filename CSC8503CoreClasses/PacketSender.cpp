@@ -0,0 +1,159 @@
+#ifdef USEGL
+#include "PacketSender.h"
+
+#include "GameServer.h"
+#include "NetworkObject.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	constexpr int SEND_QUEUE_CAPACITY = 256;
+	constexpr int SNAPSHOT_POOL_PREALLOCATED = 32;
+	//Fallback so a missed wake up can never stall sending for long.
+	constexpr std::chrono::milliseconds MAX_PARK_TIME(100);
+}
+
+PacketSender::PacketSender(GameServer& server) : mServer(server), mSnapshotPool(SEND_QUEUE_CAPACITY, SNAPSHOT_POOL_PREALLOCATED), mQueue(SEND_QUEUE_CAPACITY) {
+	mIsRunning = false;
+	mIsParked = false;
+	mPeakQueueDepth = 0;
+	mPacketsDropped = 0;
+	mAverageSendLatencyMs = 0.0f;
+	mMaxSendLatencyMs = 0.0f;
+	mCompressionRatio = 1.0f;
+	mCompressedPacket = new SnapshotPacket();
+}
+
+PacketSender::~PacketSender() {
+	Stop();
+
+	QueuedPacket queued;
+	while (mQueue.TryPop(queued)) {
+		mSnapshotPool.Release(queued.packet);
+	}
+	delete mCompressedPacket;
+}
+
+void PacketSender::SetDictionary(const SnapshotDictionary* dictionary) {
+	mCodec.SetDictionary(dictionary);
+}
+
+void PacketSender::Start() {
+	if (mIsRunning) {
+		return;
+	}
+	mIsRunning = true;
+	mThread = std::thread(&PacketSender::SendThread, this);
+}
+
+void PacketSender::Stop() {
+	if (!mIsRunning) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mParkMutex);
+		mIsRunning = false;
+	}
+	mWakeCondition.notify_one();
+	if (mThread.joinable()) {
+		mThread.join();
+	}
+}
+
+bool PacketSender::Enqueue(SnapshotPacket* packet, int peerNumber, bool isCompressed) {
+	QueuedPacket queued;
+	queued.packet = packet;
+	queued.peerNumber = peerNumber;
+	queued.isCompressed = isCompressed;
+	queued.queuedAt = std::chrono::steady_clock::now();
+
+	if (!mQueue.TryPush(queued)) {
+		// snapshots are superseded by the next tick, so dropping one beats blocking the game thread
+		mPacketsDropped++;
+		mSnapshotPool.Release(packet);
+		return false;
+	}
+
+	const int depth = (int)mQueue.GetSize();
+	if (depth > mPeakQueueDepth) {
+		mPeakQueueDepth = depth;
+	}
+	return true;
+}
+
+void PacketSender::Wake() {
+	if (!mIsRunning) {
+		if (SendQueuedPackets() > 0) {
+			mServer.Flush();
+		}
+		return;
+	}
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (mIsParked) {
+		std::lock_guard<std::mutex> lock(mParkMutex);
+		mWakeCondition.notify_one();
+	}
+}
+
+void PacketSender::SendThread() {
+	while (mIsRunning) {
+		Park();
+		if (SendQueuedPackets() > 0) {
+			mServer.Flush();
+		}
+	}
+}
+
+void PacketSender::Park() {
+	std::unique_lock<std::mutex> lock(mParkMutex);
+	mIsParked = true;
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	mWakeCondition.wait_for(lock, MAX_PARK_TIME, [this] { return !mIsRunning || !mQueue.IsEmpty(); });
+	mIsParked = false;
+}
+
+int PacketSender::SendQueuedPackets() {
+	int packetsSent = 0;
+	float totalLatencyMs = 0.0f;
+	float maxLatencyMs = 0.0f;
+	int bytesBeforeCompression = 0;
+	int bytesAfterCompression = 0;
+
+	QueuedPacket queued;
+	while (mQueue.TryPop(queued)) {
+		SnapshotPacket* packet = queued.packet;
+		if (queued.isCompressed) {
+			bytesBeforeCompression += packet->GetTotalSize();
+			if (mCodec.CompressPacket(*packet, *mCompressedPacket)) {
+				packet = mCompressedPacket;
+			}
+			bytesAfterCompression += packet->GetTotalSize();
+		}
+
+		if (queued.peerNumber < 0) {
+			mServer.SendGlobalPacket(*packet);
+		}
+		else {
+			mServer.SendPacketToPeer(*packet, queued.peerNumber);
+		}
+
+		const std::chrono::duration<float, std::milli> latency = std::chrono::steady_clock::now() - queued.queuedAt;
+		totalLatencyMs += latency.count();
+		maxLatencyMs = std::max(maxLatencyMs, latency.count());
+		packetsSent++;
+
+		// ENet copies the data on create, the buffer is free to reuse straight away
+		mSnapshotPool.Release(queued.packet);
+	}
+
+	if (packetsSent > 0) {
+		mAverageSendLatencyMs = totalLatencyMs / packetsSent;
+		mMaxSendLatencyMs = maxLatencyMs;
+	}
+	if (bytesBeforeCompression > 0) {
+		mCompressionRatio = (float)bytesAfterCompression / bytesBeforeCompression;
+	}
+	return packetsSent;
+}
+#endif
@@ -0,0 +1,79 @@
+#ifdef USEGL
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "MPSCRingBuffer.h"
+#include "PacketPool.h"
+#include "SnapshotCompression.h"
+
+namespace NCL::CSC8503 {
+	class GameServer;
+	class SnapshotDictionary;
+
+	// Owns the server's network send thread. The game thread queues packets without taking a lock,
+	// the sender thread parks until woken, broadcasts everything queued and flushes ENet once per batch.
+	class PacketSender {
+	public:
+		PacketSender(GameServer& server);
+		~PacketSender();
+
+		void Start();
+		void Stop();
+
+		SnapshotPacketPool& GetSnapshotPool() { return mSnapshotPool; }
+
+		//Set before Start. Packets queued as compressed are packed with it on the sender thread.
+		void SetDictionary(const SnapshotDictionary* dictionary);
+
+		//Takes ownership of the packet, it goes back to the pool once sent. A peer of -1 sends to everyone.
+		bool Enqueue(SnapshotPacket* packet, int peerNumber = -1, bool isCompressed = false);
+		//Never started, the queue is sent on the calling thread instead.
+		void Wake();
+
+		int GetQueueDepth() const { return (int)mQueue.GetSize(); }
+		int GetPeakQueueDepth() const { return mPeakQueueDepth; }
+		int GetPacketsDropped() const { return mPacketsDropped; }
+		//Time from Enqueue until the packet is handed to ENet, over the last batch.
+		float GetAverageSendLatencyMs() const { return mAverageSendLatencyMs; }
+		float GetMaxSendLatencyMs() const { return mMaxSendLatencyMs; }
+		//Compressed size over original size for the compressed packets in the last batch.
+		float GetCompressionRatio() const { return mCompressionRatio; }
+
+	protected:
+		struct QueuedPacket {
+			SnapshotPacket* packet = nullptr;
+			int peerNumber = -1;
+			bool isCompressed = false;
+			std::chrono::steady_clock::time_point queuedAt;
+		};
+
+		void SendThread();
+		void Park();
+		int SendQueuedPackets();
+
+		GameServer& mServer;
+		SnapshotPacketPool mSnapshotPool;
+		MPSCRingBuffer<QueuedPacket> mQueue;
+
+		//Sender thread only.
+		SnapshotCodec mCodec;
+		SnapshotPacket* mCompressedPacket;
+
+		std::thread mThread;
+		std::atomic<bool> mIsRunning;
+		std::atomic<bool> mIsParked;
+		std::mutex mParkMutex;
+		std::condition_variable mWakeCondition;
+
+		std::atomic<int> mPeakQueueDepth;
+		std::atomic<int> mPacketsDropped;
+		std::atomic<float> mAverageSendLatencyMs;
+		std::atomic<float> mMaxSendLatencyMs;
+		std::atomic<float> mCompressionRatio;
+	};
+}
+#endif
@@ -0,0 +1,53 @@
+#ifdef USEGL
+#include "PacketSerializer.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	constexpr int SERIALIZED_POOL_CAPACITY = 16;
+	constexpr int SERIALIZED_POOL_PREALLOCATED = 4;
+}
+
+PacketSerializer::PacketSerializer() : mPacketPool(SERIALIZED_POOL_CAPACITY, SERIALIZED_POOL_PREALLOCATED) {
+}
+
+SerializedPacket* PacketSerializer::Write(SerializablePacket& packet) {
+	SerializedPacket* serialized = mPacketPool.Acquire();
+	serialized->type = packet.type;
+
+	BitStream stream = BitStream::ForWriting(serialized->data, SERIALIZED_PACKET_MAX_PAYLOAD_SIZE);
+	stream.WriteBits(NETWORK_PROTOCOL_VERSION, NETWORK_PROTOCOL_VERSION_BITS);
+	packet.Serialize(stream);
+	const int payloadBytes = stream.Flush();
+
+	if (stream.HasOverflowed()) {
+		std::cout << __FUNCTION__ << " packet type " << packet.type << " is too large to send" << std::endl;
+		mPacketPool.Release(serialized);
+		return nullptr;
+	}
+	serialized->size = (short)payloadBytes;
+	return serialized;
+}
+
+void PacketSerializer::Release(SerializedPacket* packet) {
+	mPacketPool.Release(packet);
+}
+
+bool PacketSerializer::Read(const GamePacket& payload, SerializablePacket& packet) {
+	if (payload.size <= 0 || payload.size > SERIALIZED_PACKET_MAX_PAYLOAD_SIZE) {
+		return false;
+	}
+	const SerializedPacket& serialized = static_cast<const SerializedPacket&>(payload);
+	BitStream stream = BitStream::ForReading(serialized.data, payload.size);
+
+	const int version = (int)stream.ReadBits(NETWORK_PROTOCOL_VERSION_BITS);
+	if (version != NETWORK_PROTOCOL_VERSION) {
+		std::cout << __FUNCTION__ << " dropped packet type " << payload.type << " from protocol version " << version << std::endl;
+		return false;
+	}
+	packet.type = payload.type;
+	packet.Serialize(stream);
+	return !stream.HasOverflowed();
+}
+#endif
@@ -0,0 +1,43 @@
+#ifdef USEGL
+#pragma once
+#include "NetworkBase.h"
+#include "BitStream.h"
+#include "PacketPool.h"
+
+namespace NCL::CSC8503 {
+	//Bumped whenever a Serialize layout changes, peers on another version have their packets dropped.
+	constexpr int NETWORK_PROTOCOL_VERSION = 1;
+	constexpr int NETWORK_PROTOCOL_VERSION_BITS = 8;
+
+	constexpr int SERIALIZED_PACKET_MAX_SIZE = 1200;
+	constexpr int SERIALIZED_PACKET_MAX_PAYLOAD_SIZE = SERIALIZED_PACKET_MAX_SIZE - (int)sizeof(GamePacket);
+
+	//Packets that are written field by field instead of copied, so they can hold strings and containers.
+	struct SerializablePacket : public GamePacket {
+		SerializablePacket(short type) : GamePacket(type) {}
+		virtual ~SerializablePacket() = default;
+
+		virtual void Serialize(BitStream& stream) = 0;
+	};
+
+	//What actually goes on the wire for a SerializablePacket, type is kept so handlers dispatch as before.
+	struct SerializedPacket : public GamePacket {
+		char data[SERIALIZED_PACKET_MAX_PAYLOAD_SIZE];
+	};
+
+	class PacketSerializer {
+	public:
+		PacketSerializer();
+
+		//Returns nullptr if the packet didn't fit, otherwise hand the result back with Release once sent.
+		SerializedPacket* Write(SerializablePacket& packet);
+		void Release(SerializedPacket* packet);
+
+		//Fills packet from a received payload, false if it was truncated or from another protocol version.
+		static bool Read(const GamePacket& payload, SerializablePacket& packet);
+
+	protected:
+		SerializedPacketPool mPacketPool;
+	};
+}
+#endif
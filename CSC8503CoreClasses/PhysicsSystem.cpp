@@ -75,6 +75,15 @@ being at a low rate.
 */
 int realHZ = idealHZ;
 float realDT = idealDT;
+bool isIterationRateAdaptive = true;
+
+void PhysicsSystem::SetIsIterationRateAdaptive(bool isAdaptive) {
+	isIterationRateAdaptive = isAdaptive;
+	if (!isAdaptive) {
+		realHZ = idealHZ;
+		realDT = idealDT;
+	}
+}
 
 void PhysicsSystem::Update(float dt) {
 	mDTOffset += dt; //We accumulate time delta here - there might be remainders from previous frame!
@@ -113,6 +122,9 @@ void PhysicsSystem::Update(float dt) {
 
 	UpdateCollisionList(); //Remove any old collisions
 
+	if (!isIterationRateAdaptive) {
+		return;
+	}
 	t.Tick();
 	float updateTime = t.GetTimeDeltaSeconds();
 
@@ -24,6 +24,9 @@ namespace NCL {
 			void SetGravity(const Vector3& g);
 
 			void SetNewBroadphaseSize(const Vector3& levelSize);
+
+			//Off keeps the ideal iteration rate however long a step takes, so a run can be repeated exactly.
+			static void SetIsIterationRateAdaptive(bool isAdaptive);
 		protected:
 			bool AreBothCollidersStatic(const CollisionDetection::CollisionInfo info);
 			bool IsEitherColliderNoCollide(const CollisionDetection::CollisionInfo& info);
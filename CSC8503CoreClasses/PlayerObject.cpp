@@ -615,6 +615,20 @@ void PlayerObject::EnforceMaxSpeeds() {
 	}
 }
 
+float PlayerObject::GetMaxSpeed() const {
+	const bool isSpedUp = mPlayerSpeedState == SpedUp;
+	switch (mObjectState) {
+	case(Crouch):
+		return isSpedUp ? SPED_UP_MAX_CROUCH_SPEED : MAX_CROUCH_SPEED;
+	case(Walk):
+		return isSpedUp ? SPED_UP_MAX_WALK_SPEED : MAX_WALK_SPEED;
+	case(Sprint):
+		return isSpedUp ? SPED_UP_MAX_SPRINT_SPEED : MAX_SPRINT_SPEED;
+	default:
+		return 0.0f;
+	}
+}
+
 void PlayerObject::ChangeTransparency(bool isUp, float& transparency)
 {
 	if (isUp == true && transparency < 1) {
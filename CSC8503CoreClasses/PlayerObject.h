@@ -132,6 +132,8 @@ namespace NCL {
 			void	ChangeToStunned();
 			void	UseItemForInteractable(Interactable* interactable);
 			void	EnforceMaxSpeeds();
+			//What EnforceMaxSpeeds or EnforceSpedUpMaxSpeeds would cap the velocity at now, 0 if nothing.
+			float	GetMaxSpeed() const;
 			void    ChangeTransparency(bool isUp,float& transparency);
 			void    RayCastIcon(GameObject* objectHit, float distance);
 			void    ResetRayCastIcon();
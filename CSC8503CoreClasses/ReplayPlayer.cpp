@@ -0,0 +1,120 @@
+#ifdef USEGL
+#include "ReplayPlayer.h"
+
+#include "NetworkBase.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace NCL;
+using namespace CSC8503;
+
+ReplayPlayer::ReplayPlayer() {
+	mNextRecord = 0;
+	mPeerNumber = 1;
+	mTime = 0.0f;
+	mDuration = 0.0f;
+	mFirstPeerNumber = 0;
+	mPacketsDispatched = 0;
+}
+
+bool ReplayPlayer::Open(const std::string& filepath) {
+	if (!mFile.Open(filepath)) {
+		return false;
+	}
+	const ReplayFileHeader* header = (const ReplayFileHeader*)mFile.GetData();
+	if (mFile.GetSize() < sizeof(ReplayFileHeader) || memcmp(header->magic, REPLAY_FILE_MAGIC, sizeof(header->magic)) != 0) {
+		std::cout << __FUNCTION__ << " " << filepath << " is not a replay\n";
+		mFile.Close();
+		return false;
+	}
+	if (header->version != REPLAY_FILE_VERSION) {
+		std::cout << __FUNCTION__ << " " << filepath << " is replay version " << header->version << ", expected " << REPLAY_FILE_VERSION << "\n";
+		mFile.Close();
+		return false;
+	}
+
+	mNextRecord = sizeof(ReplayFileHeader);
+	mTime = 0.0f;
+	mPacketsDispatched = 0;
+
+	//one pass over the headers finds the length, and where a crash cut the file short
+	mDuration = 0.0f;
+	mFirstPeerNumber = 0;
+	size_t offset = mNextRecord;
+	while (const ReplayRecordHeader* record = GetRecord(offset)) {
+		mDuration = record->time;
+		if (mFirstPeerNumber == 0 && record->direction == ReplayDirection::ServerToClient) {
+			mFirstPeerNumber = record->peerNumber;
+		}
+		offset += GetRecordSize(*record);
+	}
+	if (offset < mFile.GetSize()) {
+		std::cout << __FUNCTION__ << " " << filepath << " ends partway through a packet, playing up to it\n";
+	}
+	return true;
+}
+
+int ReplayPlayer::Dispatch(const PacketHandler& handler) {
+	int dispatched = 0;
+	ForEachDueRecord([&](const ReplayRecordHeader& record, GamePacket* packet) {
+		if (record.direction != ReplayDirection::ServerToClient || (mPeerNumber >= 0 && record.peerNumber != 0 && record.peerNumber != mPeerNumber)) {
+			return;
+		}
+		handler(packet);
+		dispatched++;
+	});
+	mPacketsDispatched += dispatched;
+	return dispatched;
+}
+
+int ReplayPlayer::DispatchRecords(const RecordHandler& handler) {
+	const int dispatched = ForEachDueRecord(handler);
+	mPacketsDispatched += dispatched;
+	return dispatched;
+}
+
+int ReplayPlayer::ForEachDueRecord(const RecordHandler& handler) {
+	int dispatched = 0;
+	while (const ReplayRecordHeader* record = GetRecord(mNextRecord)) {
+		if (record->time > mTime) {
+			break;
+		}
+		mNextRecord += GetRecordSize(*record);
+		handler(*record, (GamePacket*)(record + 1));
+		dispatched++;
+	}
+	if (!GetRecord(mNextRecord)) {
+		mNextRecord = mFile.GetSize();
+	}
+	return dispatched;
+}
+
+const GamePacket* ReplayPlayer::FindPacket(ReplayDirection direction, const PacketMatch& isMatch) const {
+	size_t offset = sizeof(ReplayFileHeader);
+	while (const ReplayRecordHeader* record = GetRecord(offset)) {
+		const GamePacket* packet = (const GamePacket*)(record + 1);
+		if (record->direction == direction && isMatch(*packet)) {
+			return packet;
+		}
+		offset += GetRecordSize(*record);
+	}
+	return nullptr;
+}
+
+const ReplayRecordHeader* ReplayPlayer::GetRecord(size_t offset) const {
+	if (offset + sizeof(ReplayRecordHeader) > mFile.GetSize()) {
+		return nullptr;
+	}
+	const ReplayRecordHeader* record = (const ReplayRecordHeader*)(mFile.GetData() + offset);
+	if (record->size < sizeof(GamePacket) || offset + sizeof(ReplayRecordHeader) + record->size > mFile.GetSize()) {
+		return nullptr;
+	}
+	return record;
+}
+
+size_t ReplayPlayer::GetRecordSize(const ReplayRecordHeader& record) {
+	const size_t paddedSize = (record.size + REPLAY_RECORD_ALIGNMENT - 1) / REPLAY_RECORD_ALIGNMENT * REPLAY_RECORD_ALIGNMENT;
+	return sizeof(ReplayRecordHeader) + paddedSize;
+}
+#endif
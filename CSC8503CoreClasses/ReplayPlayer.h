@@ -0,0 +1,59 @@
+#ifdef USEGL
+#pragma once
+#include <functional>
+#include <string>
+
+#include "MappedFile.h"
+#include "ReplayRecorder.h"
+
+struct GamePacket;
+
+namespace NCL::CSC8503 {
+	// Plays back a file written by ReplayRecorder, as what one client received or as what the server did. The
+	// file is mapped rather than read and packets are handed on straight from the mapping, so playback costs
+	// little beyond the handlers.
+	class ReplayPlayer {
+	public:
+		typedef std::function<void(GamePacket* packet)> PacketHandler;
+		typedef std::function<void(const ReplayRecordHeader& record, GamePacket* packet)> RecordHandler;
+		typedef std::function<bool(const GamePacket& packet)> PacketMatch;
+
+		ReplayPlayer();
+
+		bool Open(const std::string& filepath);
+
+		//Packets sent to this peer and to everyone are played, the rest are skipped. -1 plays every peer's.
+		void SetPeerNumber(int peerNumber) { mPeerNumber = peerNumber; }
+
+		void AdvanceTime(float dt) { mTime += dt; }
+		//Hands on every packet due by now for the client's peer number, returns how many.
+		int Dispatch(const PacketHandler& handler);
+		//Hands on every record due by now whatever its direction, for playing the server back.
+		int DispatchRecords(const RecordHandler& handler);
+		//The first packet sent that way that matches, searched from the start wherever playback is up to.
+		const GamePacket* FindPacket(ReplayDirection direction, const PacketMatch& isMatch) const;
+
+		float GetTime() const { return mTime; }
+		float GetDuration() const { return mDuration; }
+		//The first client the server sent anything to alone, 0 if it only ever sent to everyone.
+		int GetFirstPeerNumber() const { return mFirstPeerNumber; }
+		bool IsFinished() const { return mNextRecord >= mFile.GetSize(); }
+		int GetPacketsDispatched() const { return mPacketsDispatched; }
+
+	protected:
+		//Moves playback up to now, handing on every record passed.
+		int ForEachDueRecord(const RecordHandler& handler);
+		//The header of the record at offset, or nullptr if the file ends partway through it.
+		const ReplayRecordHeader* GetRecord(size_t offset) const;
+		static size_t GetRecordSize(const ReplayRecordHeader& record);
+
+		MappedFile mFile;
+		size_t mNextRecord;
+		int mPeerNumber;
+		float mTime;
+		float mDuration;
+		int mFirstPeerNumber;
+		int mPacketsDispatched;
+	};
+}
+#endif
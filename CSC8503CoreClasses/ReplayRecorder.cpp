@@ -0,0 +1,69 @@
+#ifdef USEGL
+#include "ReplayRecorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+using namespace NCL;
+using namespace CSC8503;
+
+ReplayRecorder::ReplayRecorder() {
+	mRecordCount = 0;
+}
+
+ReplayRecorder::~ReplayRecorder() {
+	Close();
+}
+
+bool ReplayRecorder::Open(const std::string& filepath) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mFile.close();
+	mFile.open(filepath, std::ios::binary | std::ios::trunc);
+	if (!mFile) {
+		std::cout << __FUNCTION__ << " can't create replay file " << filepath << "\n";
+		return false;
+	}
+
+	ReplayFileHeader header;
+	memcpy(header.magic, REPLAY_FILE_MAGIC, sizeof(header.magic));
+	header.version = REPLAY_FILE_VERSION;
+	mFile.write((const char*)&header, sizeof(header));
+
+	mStartTime = std::chrono::steady_clock::now();
+	mRecordCount = 0;
+	return true;
+}
+
+void ReplayRecorder::Close() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mFile.is_open()) {
+		mFile.close();
+	}
+}
+
+void ReplayRecorder::Record(ReplayDirection direction, int peerNumber, const void* packet, int size) {
+	if (size <= 0 || size > UINT16_MAX) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (!mFile.is_open()) {
+		return;
+	}
+	const std::chrono::duration<float> time = std::chrono::steady_clock::now() - mStartTime;
+
+	ReplayRecordHeader header;
+	header.time = time.count();
+	header.size = (uint16_t)size;
+	header.direction = direction;
+	header.peerNumber = (uint8_t)std::clamp(peerNumber, 0, (int)UINT8_MAX);
+
+	constexpr char PADDING[REPLAY_RECORD_ALIGNMENT] = {};
+	const int paddingSize = (REPLAY_RECORD_ALIGNMENT - size % REPLAY_RECORD_ALIGNMENT) % REPLAY_RECORD_ALIGNMENT;
+
+	mFile.write((const char*)&header, sizeof(header));
+	mFile.write((const char*)packet, size);
+	mFile.write(PADDING, paddingSize);
+	mRecordCount++;
+}
+#endif
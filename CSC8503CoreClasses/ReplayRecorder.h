@@ -0,0 +1,61 @@
+#ifdef USEGL
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+namespace NCL::CSC8503 {
+	constexpr char REPLAY_FILE_MAGIC[4] = { 'R', 'P', 'L', 'Y' };
+	constexpr uint32_t REPLAY_FILE_VERSION = 2;
+	//Packets are padded to this, so every one in a mapped file is aligned like a freshly allocated packet.
+	constexpr int REPLAY_RECORD_ALIGNMENT = 8;
+
+	enum class ReplayDirection : uint8_t {
+		ServerToClient,
+		ClientToServer,
+		//Carry an empty packet, they are there so the server side can be played back too.
+		ClientConnected,
+		ClientDisconnected
+	};
+
+	struct ReplayFileHeader {
+		char magic[4];
+		uint32_t version;
+	};
+
+	//Followed by size bytes of packet, then padding.
+	struct ReplayRecordHeader {
+		float time;			//Seconds since recording started
+		uint16_t size;
+		ReplayDirection direction;
+		uint8_t peerNumber;	//The server's +1 numbering, 0 for a packet sent to everyone
+	};
+	static_assert(sizeof(ReplayFileHeader) % REPLAY_RECORD_ALIGNMENT == 0 && sizeof(ReplayRecordHeader) % REPLAY_RECORD_ALIGNMENT == 0);
+
+	// Appends every packet a server sends and receives, and every client coming and going, to a file, for
+	// ReplayPlayer to feed back through the client's or the server's packet handlers later. Records are only ever added to the end, so a file cut short by a crash still
+	// plays up to the last whole packet.
+	class ReplayRecorder {
+	public:
+		ReplayRecorder();
+		~ReplayRecorder();
+
+		bool Open(const std::string& filepath);
+		void Close();
+		bool IsOpen() const { return mFile.is_open(); }
+
+		//Safe from any thread, snapshots are sent from the sender thread.
+		void Record(ReplayDirection direction, int peerNumber, const void* packet, int size);
+
+		int GetRecordCount() const { return mRecordCount; }
+
+	protected:
+		std::mutex mMutex;
+		std::ofstream mFile;
+		std::chrono::steady_clock::time_point mStartTime;
+		int mRecordCount;
+	};
+}
+#endif
@@ -0,0 +1,261 @@
+#ifdef USEGL
+#include "ReplicatedProperties.h"
+
+#include <bit>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	constexpr int GROUP_ID_BITS = 4;
+	constexpr int MAX_GROUPS = 1 << GROUP_ID_BITS;
+	constexpr int MAX_VALUE_BITS = 32;
+	//Zigzag varint of any int key.
+	constexpr int MAX_KEY_BITS = 40;
+	constexpr int ACK_BITS_WINDOW = 32;
+	constexpr int DIRTY_WORD_BITS = 64;
+}
+
+ReplicatedProperties::ReplicatedProperties() {
+	mReceivedSequence = -1;
+	mReceivedAckBits = 0;
+}
+
+int ReplicatedProperties::DeclareGroup(const ReplicatedPropertyDesc& desc, const ReceiveCallback& onReceived) {
+	if (mGroups.size() >= MAX_GROUPS) {
+		std::cout << __FUNCTION__ << " only " << MAX_GROUPS << " property groups fit in the group ID" << std::endl;
+		return -1;
+	}
+	Group group;
+	group.desc = desc;
+	group.desc.bits = std::clamp(desc.bits, 1, MAX_VALUE_BITS);
+	group.onReceived = onReceived;
+	mGroups.push_back(group);
+	return (int)mGroups.size() - 1;
+}
+
+void ReplicatedProperties::Set(int group, int key, float value) {
+	if (group < 0 || group >= mGroups.size()) {
+		return;
+	}
+	const uint32_t quantised = Quantise(mGroups[group].desc, value);
+
+	const auto found = mPropertyIndices.find({ group, key });
+	if (found != mPropertyIndices.end()) {
+		Property& property = mProperties[found->second];
+		if (property.value != quantised) {
+			property.value = quantised;
+			MarkDirty(found->second);
+		}
+		return;
+	}
+
+	Property property;
+	property.group = group;
+	property.key = key;
+	property.value = quantised;
+	mProperties.push_back(property);
+
+	const int propertyIndex = (int)mProperties.size() - 1;
+	mPropertyIndices[{ group, key }] = propertyIndex;
+	MarkDirty(propertyIndex);
+}
+
+void ReplicatedProperties::RemoveClient(int peerID) {
+	mClients.erase(peerID);
+}
+
+void ReplicatedProperties::Clear() {
+	mProperties.clear();
+	mPropertyIndices.clear();
+	// sequences keep counting so acks for blocks sent before the clear can't confirm new properties
+	for (auto& [peerID, client] : mClients) {
+		client.properties.clear();
+		client.dirtyMask.clear();
+	}
+	mAppliedSequences.clear();
+	mReceivedSequence = -1;
+	mReceivedAckBits = 0;
+}
+
+int ReplicatedProperties::WriteChanges(BitStream& stream, int peerID, float time, int maxBits, int& sequence) {
+	ClientState& client = GetClient(peerID);
+	const int maxRecordBits = GetMaxRecordBits();
+	const int startBits = stream.GetBitsProcessed();
+	int written = 0;
+	bool isBudgetSpent = false;
+
+	for (int word = 0; word < client.dirtyMask.size() && !isBudgetSpent; word++) {
+		uint64_t dirtyBits = client.dirtyMask[word];
+		while (dirtyBits != 0) {
+			const int propertyIndex = word * DIRTY_WORD_BITS + std::countr_zero(dirtyBits);
+			dirtyBits &= dirtyBits - 1;
+
+			const Property& property = mProperties[propertyIndex];
+			const ReplicatedPropertyDesc& desc = mGroups[property.group].desc;
+			ClientProperty& clientProperty = client.properties[propertyIndex];
+			if (clientProperty.lastSentTime >= 0.0f && time - clientProperty.lastSentTime < desc.sendInterval) {
+				continue;
+			}
+			// whatever doesn't fit stays dirty for the next tick
+			if (stream.GetBitsProcessed() - startBits + maxRecordBits > maxBits || !stream.CanWrite(maxRecordBits)) {
+				isBudgetSpent = true;
+				break;
+			}
+
+			stream.WriteBits(property.group, GROUP_ID_BITS);
+			stream.WriteVarInt(property.key);
+			stream.WriteBits(property.value, desc.bits);
+
+			clientProperty.sentSequence = client.nextSequence;
+			clientProperty.sentValue = property.value;
+			clientProperty.lastSentTime = time;
+			written++;
+		}
+	}
+
+	sequence = client.nextSequence;
+	if (written > 0) {
+		client.nextSequence++;
+	}
+	return written;
+}
+
+void ReplicatedProperties::Acknowledge(int peerID, int sequence, uint32_t ackBits) {
+	if (sequence < 0) {
+		return;
+	}
+	ClientState& client = GetClient(peerID);
+	for (int word = 0; word < client.dirtyMask.size(); word++) {
+		uint64_t dirtyBits = client.dirtyMask[word];
+		while (dirtyBits != 0) {
+			const int propertyIndex = word * DIRTY_WORD_BITS + std::countr_zero(dirtyBits);
+			dirtyBits &= dirtyBits - 1;
+
+			const ClientProperty& clientProperty = client.properties[propertyIndex];
+			const int age = sequence - clientProperty.sentSequence;
+			if (clientProperty.sentSequence < 0 || age < 0 || age > ACK_BITS_WINDOW) {
+				continue;
+			}
+			const bool isReceived = age == 0 || (ackBits & (1u << (age - 1))) != 0;
+			if (isReceived && clientProperty.sentValue == mProperties[propertyIndex].value) {
+				SetDirty(client, propertyIndex, false);
+			}
+		}
+	}
+}
+
+bool ReplicatedProperties::MarkReceived(int sequence) {
+	const bool isNewest = sequence > mReceivedSequence;
+	if (isNewest) {
+		const int shift = sequence - mReceivedSequence;
+		if (mReceivedSequence < 0 || shift > ACK_BITS_WINDOW) {
+			mReceivedAckBits = 0;
+		}
+		else {
+			mReceivedAckBits = (uint32_t)(((uint64_t)mReceivedAckBits << shift) | (1ull << (shift - 1)));
+		}
+		mReceivedSequence = sequence;
+	}
+	else if (sequence < mReceivedSequence && mReceivedSequence - sequence <= ACK_BITS_WINDOW) {
+		mReceivedAckBits |= 1u << (mReceivedSequence - sequence - 1);
+	}
+	return isNewest;
+}
+
+void ReplicatedProperties::ReadChanges(BitStream& stream, int sequence, int count) {
+	// every block is acknowledged, which tells the server each property in it arrived, so an older block's
+	// values still count for whatever a newer block didn't carry
+	MarkReceived(sequence);
+
+	for (int i = 0; i < count; i++) {
+		const int group = (int)stream.ReadBits(GROUP_ID_BITS);
+		const int key = stream.ReadVarInt();
+		if (group >= mGroups.size()) {
+			std::cout << __FUNCTION__ << " unknown property group " << group << ", dropping the rest of the block" << std::endl;
+			stream.Invalidate();
+			return;
+		}
+		const Group& declared = mGroups[group];
+		const uint32_t value = stream.ReadBits(declared.desc.bits);
+		if (stream.HasOverflowed()) {
+			return;
+		}
+		int& appliedSequence = mAppliedSequences.try_emplace({ group, key }, -1).first->second;
+		if (sequence <= appliedSequence) {
+			continue;
+		}
+		appliedSequence = sequence;
+		if (declared.onReceived) {
+			declared.onReceived(key, Dequantise(declared.desc, value));
+		}
+	}
+}
+
+int ReplicatedProperties::GetDirtyCount(int peerID) const {
+	const auto found = mClients.find(peerID);
+	if (found == mClients.end()) {
+		return (int)mProperties.size();
+	}
+	int dirtyCount = 0;
+	for (uint64_t word : found->second.dirtyMask) {
+		dirtyCount += std::popcount(word);
+	}
+	return dirtyCount;
+}
+
+ReplicatedProperties::ClientState& ReplicatedProperties::GetClient(int peerID) {
+	ClientState& client = mClients[peerID];
+	// a new client, or properties created since the client was last seen, start out dirty
+	for (int propertyIndex = (int)client.properties.size(); propertyIndex < mProperties.size(); propertyIndex++) {
+		client.properties.emplace_back();
+		SetDirty(client, propertyIndex, true);
+	}
+	return client;
+}
+
+void ReplicatedProperties::MarkDirty(int propertyIndex) {
+	for (auto& [peerID, client] : mClients) {
+		if (propertyIndex < client.properties.size()) {
+			SetDirty(client, propertyIndex, true);
+		}
+	}
+}
+
+void ReplicatedProperties::SetDirty(ClientState& client, int propertyIndex, bool isDirty) {
+	const int word = propertyIndex / DIRTY_WORD_BITS;
+	if (word >= client.dirtyMask.size()) {
+		client.dirtyMask.resize(word + 1, 0);
+	}
+	const uint64_t bit = 1ull << (propertyIndex % DIRTY_WORD_BITS);
+	if (isDirty) {
+		client.dirtyMask[word] |= bit;
+	}
+	else {
+		client.dirtyMask[word] &= ~bit;
+	}
+}
+
+uint32_t ReplicatedProperties::Quantise(const ReplicatedPropertyDesc& desc, float value) const {
+	const double steps = desc.bits == MAX_VALUE_BITS ? 4294967295.0 : (double)((1ull << desc.bits) - 1);
+	const double range = desc.maxValue - desc.minValue;
+	if (range <= 0.0) {
+		return 0;
+	}
+	const double normalised = std::clamp(((double)value - desc.minValue) / range, 0.0, 1.0);
+	return (uint32_t)std::llround(normalised * steps);
+}
+
+float ReplicatedProperties::Dequantise(const ReplicatedPropertyDesc& desc, uint32_t value) const {
+	const double steps = desc.bits == MAX_VALUE_BITS ? 4294967295.0 : (double)((1ull << desc.bits) - 1);
+	return (float)(desc.minValue + (value / steps) * (desc.maxValue - desc.minValue));
+}
+
+int ReplicatedProperties::GetMaxRecordBits() const {
+	int maxValueBits = 0;
+	for (const Group& group : mGroups) {
+		maxValueBits = std::max(maxValueBits, group.desc.bits);
+	}
+	return GROUP_ID_BITS + MAX_KEY_BITS + maxValueBits;
+}
+#endif
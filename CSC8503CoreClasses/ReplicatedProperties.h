@@ -0,0 +1,96 @@
+#ifdef USEGL
+#pragma once
+#include <functional>
+
+#include "BitStream.h"
+
+namespace NCL::CSC8503 {
+	//How every property in a group goes on the wire. Integers quantise exactly when
+	//maxValue - minValue == (1 << bits) - 1.
+	struct ReplicatedPropertyDesc {
+		float minValue = 0.0f;
+		float maxValue = 100.0f;
+		int bits = 8;
+		float sendInterval = 0.0f;	//Least time between two sends of one property to one client
+	};
+
+	// Gameplay values the server owns and clients mirror. A property only goes out while some client
+	// hasn't confirmed its current quantised value, and everything dirty for a client in a tick is
+	// written together into that client's snapshot stream.
+	class ReplicatedProperties {
+	public:
+		using ReceiveCallback = std::function<void(int key, float value)>;
+
+		ReplicatedProperties();
+
+		//Groups are matched by declaration order, so server and clients must declare them identically.
+		int DeclareGroup(const ReplicatedPropertyDesc& desc, const ReceiveCallback& onReceived);
+
+		//Called by servers. Properties are created on first use, a value that quantises the same costs nothing.
+		void Set(int group, int key, float value);
+
+		void RemoveClient(int peerID);
+		//Forgets all properties and clients, groups stay declared.
+		void Clear();
+
+		//Called by servers once per client and tick. Returns how many properties were written, and the
+		//sequence the client will acknowledge them by.
+		int WriteChanges(BitStream& stream, int peerID, float time, int maxBits, int& sequence);
+		//Called by servers with the newest sequence the client received, bit n of ackBits is sequence - 1 - n.
+		void Acknowledge(int peerID, int sequence, uint32_t ackBits);
+
+		//Called by clients for each block of properties in a snapshot. Blocks can arrive out of order, a value
+		//is applied unless one from a newer block already has been.
+		void ReadChanges(BitStream& stream, int sequence, int count);
+		//Records a block as received without reading it, returns true if it is the newest so far.
+		bool MarkReceived(int sequence);
+		int GetReceivedSequence() const { return mReceivedSequence; }
+		uint32_t GetReceivedAckBits() const { return mReceivedAckBits; }
+
+		int GetPropertyCount() const { return (int)mProperties.size(); }
+		int GetDirtyCount(int peerID) const;
+
+	protected:
+		struct Group {
+			ReplicatedPropertyDesc desc;
+			ReceiveCallback onReceived;
+		};
+
+		struct Property {
+			int group = -1;
+			int key = 0;
+			uint32_t value = 0;	//Quantised
+		};
+
+		struct ClientProperty {
+			int sentSequence = -1;
+			uint32_t sentValue = 0;
+			float lastSentTime = -1.0f;
+		};
+
+		struct ClientState {
+			std::vector<ClientProperty> properties;	//Indexed like mProperties
+			std::vector<uint64_t> dirtyMask;
+			int nextSequence = 0;
+		};
+
+		ClientState& GetClient(int peerID);
+		void MarkDirty(int propertyIndex);
+		static void SetDirty(ClientState& client, int propertyIndex, bool isDirty);
+
+		uint32_t Quantise(const ReplicatedPropertyDesc& desc, float value) const;
+		float Dequantise(const ReplicatedPropertyDesc& desc, uint32_t value) const;
+		int GetMaxRecordBits() const;
+
+		std::vector<Group> mGroups;
+		std::vector<Property> mProperties;
+		std::map<std::pair<int, int>, int> mPropertyIndices;
+		std::map<int, ClientState> mClients;
+
+		//Clients only, the newest block each property's value was applied from.
+		std::map<std::pair<int, int>, int> mAppliedSequences;
+		int mReceivedSequence;
+		uint32_t mReceivedAckBits;
+	};
+}
+#endif
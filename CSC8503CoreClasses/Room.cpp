@@ -1,6 +1,6 @@
 #include "Room.h"
-#include "JsonParser.h"
-#include <fstream>
+#include "LevelReader.h"
+#include "CookedLevel.h"
 
 using namespace NCL::CSC8503;
 
@@ -28,13 +28,15 @@ Room::Room(int type, int doorPos, int primaryDoor) {
 
 Room::Room(std::string roomPath) {
 	mRoomName = roomPath.substr(23, roomPath.size() - 28);
-	std::ifstream roomFile(roomPath);
-	std::string line;
-	getline(roomFile, line);
 
-	JsonParser parser = JsonParser();
+	if (CookedLevel::Load(roomPath, nullptr, this)) {
+		return;
+	}
+	LevelReader reader = LevelReader();
 
-	parser.ParseJson(line, nullptr, this);
+	if (reader.ReadFile(roomPath, nullptr, this)) {
+		CookedLevel::Cook(roomPath, true);
+	}
 }
 
 Room::~Room() {
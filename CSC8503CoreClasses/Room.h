@@ -28,6 +28,8 @@ namespace NCL {
 			const std::unordered_map<DecorationType, std::vector<Transform>>& GetDecorationMap() { return mDecorationMap; }
 
 			friend class JsonParser;
+			friend class LevelReader;
+			friend class CookedLevel;
 		protected:
 			std::string mRoomName;
 			RoomType mType;
@@ -0,0 +1,81 @@
+#ifdef USEGL
+#include "SessionHost.h"
+#include "GameServer.h"
+#include "NetworkTransport.h"
+#include <iostream>
+
+using namespace NCL;
+using namespace CSC8503;
+
+SessionHost::SessionHost(int onPort, int maxPeers) {
+	mPort = onPort;
+	mMaxPeers = maxPeers;
+	mNetHandle = nullptr;
+	mPeerSessions.resize(mMaxPeers, nullptr);
+}
+
+SessionHost::~SessionHost() {
+	delete mNetHandle;
+}
+
+bool SessionHost::Initialise() {
+	mNetHandle = NetworkBase::GetTransport().CreateHost(mPort, mMaxPeers);
+	if (!mNetHandle) {
+		std::cout << __FUNCTION__ << "failed to create network handle!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void SessionHost::Update() {
+	if (!mNetHandle) { return; }
+
+	std::unique_lock<std::mutex> lock(mHostMutex);
+	TransportEvent event;
+	while (mNetHandle->Service(event)) {
+		const int peer = event.peer;
+
+		if (event.type == TransportEventType::Connect) {
+			//resolving can start a match, and its server takes this lock to send
+			lock.unlock();
+			GameServer* server = mSessionResolver ? mSessionResolver(event.data) : nullptr;
+			lock.lock();
+			if (!server || GetSessionPeerCount(*server) >= server->GetClientMax()) {
+				std::cout << "Session host: No room in session " << event.data << ", turning client away" << std::endl;
+				mNetHandle->Disconnect(peer);
+				continue;
+			}
+			mPeerSessions[peer] = server;
+		}
+
+		GameServer* server = mPeerSessions[peer];
+		if (event.type == TransportEventType::Disconnect) {
+			mPeerSessions[peer] = nullptr;
+		}
+		if (server) {
+			server->QueueIncomingEvent(event);
+		}
+		else {
+			mNetHandle->ReleasePacket(event.packet);
+		}
+	}
+}
+
+void SessionHost::RemoveSession(const GameServer& server) {
+	for (GameServer*& session : mPeerSessions) {
+		if (session == &server) {
+			session = nullptr;
+		}
+	}
+}
+
+int SessionHost::GetSessionPeerCount(const GameServer& server) const {
+	int peerCount = 0;
+	for (const GameServer* session : mPeerSessions) {
+		if (session == &server) {
+			peerCount++;
+		}
+	}
+	return peerCount;
+}
+#endif
@@ -0,0 +1,50 @@
+#ifdef USEGL
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+namespace NCL {
+	namespace CSC8503 {
+		class GameServer;
+		class TransportHost;
+
+		// Owns the one listening host when a process serves several matches. Clients pass a session ID
+		// when they connect and each connection is handed to the GameServer running that session.
+		class SessionHost {
+		public:
+			//Returns the server for a session, or nullptr to turn the connection away. Called without the host
+			//mutex held, so it may create the server.
+			typedef std::function<GameServer*(uint32_t sessionId)> SessionResolver;
+
+			SessionHost(int onPort, int maxPeers);
+			~SessionHost();
+
+			bool Initialise();
+
+			void SetSessionResolver(const SessionResolver& resolver) { mSessionResolver = resolver; }
+
+			//Services the host and queues every event on its session's server. Only one thread may call this.
+			void Update();
+
+			void RemoveSession(const GameServer& server);
+			int GetSessionPeerCount(const GameServer& server) const;
+
+			TransportHost* GetHost() const { return mNetHandle; }
+			std::mutex& GetHostMutex() { return mHostMutex; }
+
+		protected:
+			int mPort;
+			int mMaxPeers;
+			TransportHost* mNetHandle;
+			std::mutex mHostMutex;
+
+			//Indexed by the host's peer number.
+			std::vector<GameServer*> mPeerSessions;
+			SessionResolver mSessionResolver;
+		};
+	}
+}
+#endif
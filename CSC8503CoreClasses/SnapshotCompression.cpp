@@ -0,0 +1,264 @@
+#ifdef USEGL
+#include "SnapshotCompression.h"
+
+#include "NetworkObject.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace NCL;
+using namespace CSC8503;
+
+namespace {
+	constexpr int MIN_MATCH = 4;
+	constexpr int HASH_BITS = 12;
+	constexpr int HASH_SIZE = 1 << HASH_BITS;
+	constexpr int MAX_OFFSET = 0xFFFF;
+	//Lengths from this up carry on in extra bytes after the token.
+	constexpr int TOKEN_LENGTH_MAX = 15;
+	constexpr int EXTRA_LENGTH_BYTE_MAX = 255;
+
+	constexpr uint32_t FNV_OFFSET_BASIS = 2166136261u;
+	constexpr uint32_t FNV_PRIME = 16777619u;
+
+	uint32_t Read32(const char* data) {
+		uint32_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	int Hash(const char* data) {
+		return (int)((Read32(data) * 2654435761u) >> (32 - HASH_BITS));
+	}
+
+	bool WriteExtraLength(char*& out, const char* outEnd, int length) {
+		while (length >= EXTRA_LENGTH_BYTE_MAX) {
+			if (out >= outEnd) {
+				return false;
+			}
+			*out++ = (char)EXTRA_LENGTH_BYTE_MAX;
+			length -= EXTRA_LENGTH_BYTE_MAX;
+		}
+		if (out >= outEnd) {
+			return false;
+		}
+		*out++ = (char)length;
+		return true;
+	}
+
+	bool ReadExtraLength(const uint8_t*& in, const uint8_t* inEnd, int& length) {
+		uint8_t lengthByte;
+		do {
+			if (in >= inEnd || length > SnapshotDictionary::MAX_SIZE + SNAPSHOT_MAX_PAYLOAD_SIZE) {
+				return false;
+			}
+			lengthByte = *in++;
+			length += lengthByte;
+		} while (lengthByte == EXTRA_LENGTH_BYTE_MAX);
+		return true;
+	}
+
+	//A match length of 0 writes the literals that end the block.
+	bool WriteSequence(char*& out, const char* outEnd, const char* literals, int literalLength, int offset, int matchLength) {
+		if (out >= outEnd) {
+			return false;
+		}
+		const int matchExtra = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+		*out++ = (char)((std::min(literalLength, TOKEN_LENGTH_MAX) << 4) | std::min(matchExtra, TOKEN_LENGTH_MAX));
+		if (literalLength >= TOKEN_LENGTH_MAX && !WriteExtraLength(out, outEnd, literalLength - TOKEN_LENGTH_MAX)) {
+			return false;
+		}
+		if (literalLength > outEnd - out) {
+			return false;
+		}
+		memcpy(out, literals, literalLength);
+		out += literalLength;
+
+		if (matchLength == 0) {
+			return true;
+		}
+		if (outEnd - out < 2) {
+			return false;
+		}
+		*out++ = (char)(offset & 0xFF);
+		*out++ = (char)(offset >> 8);
+		return matchExtra < TOKEN_LENGTH_MAX || WriteExtraLength(out, outEnd, matchExtra - TOKEN_LENGTH_MAX);
+	}
+}
+
+bool SnapshotDictionary::LoadFromFile(const std::string& filepath) {
+	std::ifstream file(filepath, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	const std::vector<char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (content.empty() || (int)content.size() > MAX_SIZE) {
+		std::cout << __FUNCTION__ << " " << filepath << " is not a snapshot dictionary\n";
+		return false;
+	}
+	SetContent(content.data(), (int)content.size());
+	return true;
+}
+
+bool SnapshotDictionary::SaveToFile(const std::string& filepath) const {
+	std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+	file.write(mContent.data(), mContent.size());
+	return (bool)file;
+}
+
+void SnapshotDictionary::SetContent(const char* data, int size) {
+	mContent.assign(data, data + std::min(size, MAX_SIZE));
+	mId = 0;
+	if (mContent.empty()) {
+		return;
+	}
+	//FNV-1a, never 0 so 0 can mean no dictionary
+	mId = FNV_OFFSET_BASIS;
+	for (char byte : mContent) {
+		mId = (mId ^ (uint8_t)byte) * FNV_PRIME;
+	}
+	mId = std::max(mId, 1u);
+}
+
+SnapshotCodec::SnapshotCodec() {
+	mHashTable.resize(HASH_SIZE);
+	SetDictionary(nullptr);
+}
+
+void SnapshotCodec::SetDictionary(const SnapshotDictionary* dictionary) {
+	mDictionarySize = dictionary ? (int)dictionary->GetContent().size() : 0;
+	mWindow.resize(mDictionarySize + SNAPSHOT_MAX_PAYLOAD_SIZE);
+	if (mDictionarySize > 0) {
+		memcpy(mWindow.data(), dictionary->GetContent().data(), mDictionarySize);
+	}
+
+	mDictionaryHashTable.assign(HASH_SIZE, -1);
+	for (int position = 0; position + MIN_MATCH <= mDictionarySize; position++) {
+		mDictionaryHashTable[Hash(mWindow.data() + position)] = position;
+	}
+}
+
+int SnapshotCodec::Compress(const char* src, int srcSize, char* dst, int dstCapacity) {
+	if (srcSize <= 0 || srcSize > (int)mWindow.size() - mDictionarySize) {
+		return -1;
+	}
+	char* window = mWindow.data();
+	memcpy(window + mDictionarySize, src, srcSize);
+	memcpy(mHashTable.data(), mDictionaryHashTable.data(), HASH_SIZE * sizeof(int));
+
+	const int end = mDictionarySize + srcSize;
+	int position = mDictionarySize;
+	int literalStart = position;
+	char* out = dst;
+	const char* outEnd = dst + std::min(dstCapacity, srcSize);
+
+	while (position + MIN_MATCH <= end) {
+		const int hash = Hash(window + position);
+		const int candidate = mHashTable[hash];
+		mHashTable[hash] = position;
+		if (candidate < 0 || position - candidate > MAX_OFFSET || Read32(window + candidate) != Read32(window + position)) {
+			position++;
+			continue;
+		}
+
+		int matchLength = MIN_MATCH;
+		while (position + matchLength < end && window[candidate + matchLength] == window[position + matchLength]) {
+			matchLength++;
+		}
+		if (!WriteSequence(out, outEnd, window + literalStart, position - literalStart, position - candidate, matchLength)) {
+			return -1;
+		}
+		//packets are small enough to index every position, which finds noticeably more matches than skipping
+		for (int i = position + 1; i < position + matchLength && i + MIN_MATCH <= end; i++) {
+			mHashTable[Hash(window + i)] = i;
+		}
+		position += matchLength;
+		literalStart = position;
+	}
+	if (!WriteSequence(out, outEnd, window + literalStart, end - literalStart, 0, 0)) {
+		return -1;
+	}
+	const int compressedSize = (int)(out - dst);
+	return compressedSize < srcSize ? compressedSize : -1;
+}
+
+int SnapshotCodec::Decompress(const char* src, int srcSize, char* dst, int dstCapacity) {
+	char* window = mWindow.data();
+	const uint8_t* in = (const uint8_t*)src;
+	const uint8_t* inEnd = in + srcSize;
+	int out = mDictionarySize;
+	const int outEnd = mDictionarySize + std::min(dstCapacity, (int)mWindow.size() - mDictionarySize);
+
+	while (in < inEnd) {
+		const uint8_t token = *in++;
+		int literalLength = token >> 4;
+		if (literalLength == TOKEN_LENGTH_MAX && !ReadExtraLength(in, inEnd, literalLength)) {
+			return -1;
+		}
+		if (literalLength > inEnd - in || literalLength > outEnd - out) {
+			return -1;
+		}
+		memcpy(window + out, in, literalLength);
+		in += literalLength;
+		out += literalLength;
+
+		//only the last sequence has no match
+		if (in == inEnd) {
+			break;
+		}
+		if (inEnd - in < 2) {
+			return -1;
+		}
+		const int offset = in[0] | (in[1] << 8);
+		in += 2;
+		int matchLength = (token & TOKEN_LENGTH_MAX) + MIN_MATCH;
+		if ((token & TOKEN_LENGTH_MAX) == TOKEN_LENGTH_MAX && !ReadExtraLength(in, inEnd, matchLength)) {
+			return -1;
+		}
+		if (offset == 0 || offset > out || matchLength > outEnd - out) {
+			return -1;
+		}
+		//byte by byte, a match can overlap the bytes it is writing
+		for (int i = 0; i < matchLength; i++) {
+			window[out + i] = window[out - offset + i];
+		}
+		out += matchLength;
+	}
+
+	const int size = out - mDictionarySize;
+	memcpy(dst, window + mDictionarySize, size);
+	return size;
+}
+
+bool SnapshotCodec::CompressPacket(const SnapshotPacket& packet, SnapshotPacket& compressed) {
+	if (packet.isCompressed) {
+		return false;
+	}
+	const int size = Compress(packet.data, packet.GetPayloadSize(), compressed.data, SNAPSHOT_MAX_PAYLOAD_SIZE);
+	if (size < 0) {
+		return false;
+	}
+	memcpy((void*)&compressed, &packet, packet.GetHeaderSize());
+	compressed.isCompressed = true;
+	compressed.SetPayloadSize(size);
+	return true;
+}
+
+bool SnapshotCodec::DecompressPacket(const SnapshotPacket& packet, SnapshotPacket& decompressed) {
+	if (packet.GetPayloadSize() < 0 || packet.GetPayloadSize() > SNAPSHOT_MAX_PAYLOAD_SIZE) {
+		return false;
+	}
+	const int size = Decompress(packet.data, packet.GetPayloadSize(), decompressed.data, SNAPSHOT_MAX_PAYLOAD_SIZE);
+	if (size < 0) {
+		return false;
+	}
+	memcpy((void*)&decompressed, &packet, packet.GetHeaderSize());
+	decompressed.isCompressed = false;
+	decompressed.SetPayloadSize(size);
+	return true;
+}
+#endif
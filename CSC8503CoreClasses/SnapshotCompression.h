@@ -0,0 +1,58 @@
+#ifdef USEGL
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace NCL::CSC8503 {
+	struct SnapshotPacket;
+
+	// Bytes that snapshots are likely to repeat, trained offline from recorded matches. Both ends need the
+	// same one, so clients offer its ID when they connect and the server only compresses for a match.
+	class SnapshotDictionary {
+	public:
+		//Compressed data points back up to 64KB, the dictionary has to leave room for the packet itself.
+		static constexpr int MAX_SIZE = 32 * 1024;
+
+		bool LoadFromFile(const std::string& filepath);
+		bool SaveToFile(const std::string& filepath) const;
+		void SetContent(const char* data, int size);
+
+		bool IsEmpty() const { return mContent.empty(); }
+		//0 for an empty dictionary, otherwise a hash of the content.
+		uint32_t GetId() const { return mId; }
+		const std::vector<char>& GetContent() const { return mContent; }
+
+	protected:
+		std::vector<char> mContent;
+		uint32_t mId = 0;
+	};
+
+	// LZ77 in the LZ4 block layout, with the dictionary as history before the first byte so even a small
+	// packet can point back at it. Each codec keeps scratch space, so use one per thread.
+	class SnapshotCodec {
+	public:
+		SnapshotCodec();
+
+		//Null or empty compresses with no history.
+		void SetDictionary(const SnapshotDictionary* dictionary);
+
+		//Returns the compressed size, or -1 when it would not be smaller than the input or fit in dst.
+		int Compress(const char* src, int srcSize, char* dst, int dstCapacity);
+		//Returns the decompressed size, or -1 for data that is malformed or would not fit in dst.
+		int Decompress(const char* src, int srcSize, char* dst, int dstCapacity);
+
+		//False when compressing would not save anything, send the original then.
+		bool CompressPacket(const SnapshotPacket& packet, SnapshotPacket& compressed);
+		bool DecompressPacket(const SnapshotPacket& packet, SnapshotPacket& decompressed);
+
+	protected:
+		//Dictionary followed by the data being worked on, so matches can cross from one into the other.
+		std::vector<char> mWindow;
+		int mDictionarySize;
+		//Last position each hash was seen at, the dictionary's positions are worked out once and copied.
+		std::vector<int> mDictionaryHashTable;
+		std::vector<int> mHashTable;
+	};
+}
+#endif
@@ -0,0 +1,124 @@
+#ifdef USEGL
+#include "SnapshotInterpolation.h"
+
+using namespace NCL;
+using namespace CSC8503;
+using namespace Maths;
+
+namespace {
+	constexpr float DEFAULT_SNAPSHOT_INTERVAL = 1.0f / 60.0f;
+	constexpr float MIN_PLAYOUT_DELAY = 1.0f / 60.0f;
+	constexpr float MAX_PLAYOUT_DELAY = 0.25f;
+	constexpr float JITTER_MULTIPLIER = 2.0f;
+	//How quickly the running estimates follow new measurements.
+	constexpr float OFFSET_SMOOTHING = 0.05f;
+	constexpr float INTERVAL_SMOOTHING = 0.1f;
+	constexpr float JITTER_SMOOTHING = 1.0f / 16.0f;
+	//Fraction of the gap to the target delay closed per second.
+	constexpr float PLAYOUT_DELAY_ADAPT_RATE = 2.0f;
+	//Further than this from the expected offset and the clock is resynced instead of smoothed.
+	constexpr float CLOCK_RESYNC_THRESHOLD = 1.0f;
+}
+
+InterpolationBuffer::InterpolationBuffer() {
+	Clear();
+}
+
+void InterpolationBuffer::Clear() {
+	mNewestIndex = -1;
+	mSampleCount = 0;
+}
+
+const InterpolationSample& InterpolationBuffer::GetSample(int age) const {
+	return mSamples[(mNewestIndex - age + INTERPOLATION_BUFFER_SIZE) % INTERPOLATION_BUFFER_SIZE];
+}
+
+void InterpolationBuffer::AddSample(float serverTime, const Vector3& position, const Quaternion& orientation) {
+	if (mSampleCount > 0 && serverTime <= GetSample(0).serverTime) {
+		// several packets can carry the same tick, and a late one is already behind playout
+		if (serverTime == GetSample(0).serverTime) {
+			mSamples[mNewestIndex].position = position;
+			mSamples[mNewestIndex].orientation = orientation;
+		}
+		return;
+	}
+	mNewestIndex = (mNewestIndex + 1) % INTERPOLATION_BUFFER_SIZE;
+	mSamples[mNewestIndex].serverTime = serverTime;
+	mSamples[mNewestIndex].position = position;
+	mSamples[mNewestIndex].orientation = orientation;
+	mSampleCount = std::min(mSampleCount + 1, INTERPOLATION_BUFFER_SIZE);
+}
+
+bool InterpolationBuffer::Sample(float renderTime, Vector3& position, Quaternion& orientation) const {
+	if (mSampleCount == 0) {
+		return false;
+	}
+
+	const InterpolationSample& newest = GetSample(0);
+	// nothing newer has arrived yet, hold the last known transform rather than guess
+	if (renderTime >= newest.serverTime || mSampleCount == 1) {
+		position = newest.position;
+		orientation = newest.orientation;
+		return true;
+	}
+
+	for (int age = 1; age < mSampleCount; age++) {
+		const InterpolationSample& from = GetSample(age);
+		if (from.serverTime > renderTime) {
+			continue;
+		}
+		const InterpolationSample& to = GetSample(age - 1);
+		const float t = (renderTime - from.serverTime) / (to.serverTime - from.serverTime);
+		position = from.position + (to.position - from.position) * t;
+		orientation = Quaternion::Slerp(from.orientation, to.orientation, t);
+		return true;
+	}
+
+	const InterpolationSample& oldest = GetSample(mSampleCount - 1);
+	position = oldest.position;
+	orientation = oldest.orientation;
+	return true;
+}
+
+PlayoutClock::PlayoutClock() {
+	Reset();
+}
+
+void PlayoutClock::Reset() {
+	mHasSnapshot = false;
+	mLastServerTime = 0.0f;
+	mClockOffset = 0.0f;
+	mSnapshotInterval = DEFAULT_SNAPSHOT_INTERVAL;
+	mJitter = 0.0f;
+	mPlayoutDelay = DEFAULT_SNAPSHOT_INTERVAL * JITTER_MULTIPLIER;
+}
+
+void PlayoutClock::OnSnapshotReceived(float serverTime, float localTime) {
+	const float offset = serverTime - localTime;
+	if (!mHasSnapshot || std::abs(offset - mClockOffset) > CLOCK_RESYNC_THRESHOLD) {
+		mHasSnapshot = true;
+		mLastServerTime = serverTime;
+		mClockOffset = offset;
+		return;
+	}
+	//Every packet of a tick carries the same time, only the first says anything about arrival.
+	if (serverTime <= mLastServerTime) {
+		return;
+	}
+
+	const float interval = serverTime - mLastServerTime;
+	mSnapshotInterval += (interval - mSnapshotInterval) * INTERVAL_SMOOTHING;
+	mLastServerTime = serverTime;
+
+	// how late or early this arrived compared to the running estimate
+	const float transitDeviation = std::abs(offset - mClockOffset);
+	mJitter += (transitDeviation - mJitter) * JITTER_SMOOTHING;
+	mClockOffset += (offset - mClockOffset) * OFFSET_SMOOTHING;
+}
+
+float PlayoutClock::GetRenderTime(float localTime, float dt) {
+	const float targetDelay = std::clamp(mSnapshotInterval + JITTER_MULTIPLIER * mJitter, MIN_PLAYOUT_DELAY, MAX_PLAYOUT_DELAY);
+	mPlayoutDelay += (targetDelay - mPlayoutDelay) * std::min(1.0f, dt * PLAYOUT_DELAY_ADAPT_RATE);
+	return localTime + mClockOffset - mPlayoutDelay;
+}
+#endif
@@ -0,0 +1,56 @@
+#ifdef USEGL
+#pragma once
+
+namespace NCL::CSC8503 {
+	constexpr int INTERPOLATION_BUFFER_SIZE = 32;
+
+	struct InterpolationSample {
+		float serverTime = 0.0f;
+		Maths::Vector3 position;
+		Maths::Quaternion orientation;
+	};
+
+	// Transforms received for one object, stamped with the server time they were sent at.
+	// Clients render slightly in the past so there is nearly always a sample either side.
+	class InterpolationBuffer {
+	public:
+		InterpolationBuffer();
+
+		void AddSample(float serverTime, const Maths::Vector3& position, const Maths::Quaternion& orientation);
+		//Lerps position and slerps orientation between the samples bracketing renderTime.
+		bool Sample(float renderTime, Maths::Vector3& position, Maths::Quaternion& orientation) const;
+		void Clear();
+
+		bool IsEmpty() const { return mSampleCount == 0; }
+
+	protected:
+		const InterpolationSample& GetSample(int age) const;
+
+		InterpolationSample mSamples[INTERPOLATION_BUFFER_SIZE];
+		int mNewestIndex;
+		int mSampleCount;
+	};
+
+	// Maps local time onto server time and picks how far behind it to render. The delay
+	// follows the measured snapshot interval plus jitter, so it shrinks again on a clean connection.
+	class PlayoutClock {
+	public:
+		PlayoutClock();
+
+		void OnSnapshotReceived(float serverTime, float localTime);
+		float GetRenderTime(float localTime, float dt);
+		void Reset();
+
+		float GetPlayoutDelay() const { return mPlayoutDelay; }
+		float GetJitter() const { return mJitter; }
+
+	protected:
+		bool mHasSnapshot;
+		float mLastServerTime;
+		float mClockOffset;
+		float mSnapshotInterval;
+		float mJitter;
+		float mPlayoutDelay;
+	};
+}
+#endif
@@ -0,0 +1,97 @@
+#ifdef USEGL
+#include "SnapshotWriter.h"
+#include "NetworkObject.h"
+#include "PacketSender.h"
+#include "ReplicatedProperties.h"
+
+using namespace NCL;
+using namespace CSC8503;
+
+SnapshotWriter::SnapshotWriter(const NetworkQuantizer& quantizer, SnapshotPacketPool& packetPool) :
+	mStream(BitStream::ForWriting(nullptr, 0)), mQuantizer(quantizer), mPacketPool(packetPool) {
+	mMaxObjectBits = NetworkObject::GetMaxSnapshotObjectBits(quantizer);
+	mCurrentPacket = nullptr;
+	mIsDeltaFrame = false;
+	mStateID = -1;
+	mServerTime = 0.0f;
+	mAckedStateID = -1;
+	mObjectsWritten = 0;
+	mBitsWritten = 0;
+}
+
+SnapshotWriter::~SnapshotWriter() {
+	for (SnapshotPacket* packet : mPackets) {
+		mPacketPool.Release(packet);
+	}
+	mPacketPool.Release(mCurrentPacket);
+}
+
+void SnapshotWriter::Begin(bool deltaFrame, int stateID, float serverTime, int ackedStateID) {
+	mIsDeltaFrame = deltaFrame;
+	mStateID = stateID;
+	mServerTime = serverTime;
+	mAckedStateID = ackedStateID;
+	mObjectsWritten = 0;
+	mBitsWritten = 0;
+}
+
+int SnapshotWriter::AddProperties(ReplicatedProperties& properties, int peerID, float time, int maxBits) {
+	if (mCurrentPacket == nullptr) {
+		StartPacket();
+	}
+	const int bitsBefore = mStream.GetBitsProcessed();
+	int sequence = -1;
+	const int written = properties.WriteChanges(mStream, peerID, time, maxBits, sequence);
+	if (written > 0) {
+		mCurrentPacket->propertySequence = sequence;
+		mCurrentPacket->propertyCount = (short)written;
+		mBitsWritten += mStream.GetBitsProcessed() - bitsBefore;
+	}
+	return written;
+}
+
+bool SnapshotWriter::AddObject(NetworkObject& networkObject, SnapshotSendState& sendState) {
+	if (mCurrentPacket == nullptr || !mStream.CanWrite(mMaxObjectBits)) {
+		SealPacket();
+		StartPacket();
+	}
+	const int bitsBefore = mStream.GetBitsProcessed();
+	if (!networkObject.WriteSnapshot(mStream, mIsDeltaFrame, mStateID, mAckedStateID, mQuantizer, sendState)) {
+		return false;
+	}
+	mCurrentPacket->objectCount++;
+	mObjectsWritten++;
+	mBitsWritten += mStream.GetBitsProcessed() - bitsBefore;
+	return true;
+}
+
+std::vector<SnapshotPacket*> SnapshotWriter::End() {
+	SealPacket();
+	std::vector<SnapshotPacket*> packets;
+	packets.swap(mPackets);
+	return packets;
+}
+
+void SnapshotWriter::StartPacket() {
+	mCurrentPacket = mPacketPool.Acquire();
+	mCurrentPacket->stateID = mStateID;
+	mCurrentPacket->serverTime = mServerTime;
+	mCurrentPacket->isDeltaFrame = mIsDeltaFrame;
+	mStream = BitStream::ForWriting(mCurrentPacket->data, SNAPSHOT_MAX_PAYLOAD_SIZE);
+}
+
+void SnapshotWriter::SealPacket() {
+	if (mCurrentPacket == nullptr) {
+		return;
+	}
+	// nothing changed since the last snapshot, so there is nothing worth sending
+	if (mCurrentPacket->objectCount == 0 && mCurrentPacket->propertyCount == 0) {
+		mPacketPool.Release(mCurrentPacket);
+	}
+	else {
+		mCurrentPacket->SetPayloadSize(mStream.Flush());
+		mPackets.push_back(mCurrentPacket);
+	}
+	mCurrentPacket = nullptr;
+}
+#endif
@@ -0,0 +1,52 @@
+#ifdef USEGL
+#pragma once
+#include "BitStream.h"
+#include "PacketPool.h"
+
+namespace NCL::CSC8503 {
+	class NetworkObject;
+	class NetworkQuantizer;
+	class ReplicatedProperties;
+	struct SnapshotSendState;
+
+	// Packs the network objects for a tick into as few MTU sized SnapshotPackets as possible,
+	// starting a new packet only when the next object might not fit.
+	class SnapshotWriter {
+	public:
+		SnapshotWriter(const NetworkQuantizer& quantizer, SnapshotPacketPool& packetPool);
+		~SnapshotWriter();
+
+		//Snapshots are written per client, ackedStateID is the newest full state that client confirmed.
+		void Begin(bool deltaFrame, int stateID, float serverTime, int ackedStateID);
+		//Everything the client hasn't confirmed goes ahead of the objects, call before the first AddObject.
+		int AddProperties(ReplicatedProperties& properties, int peerID, float time, int maxBits);
+		//Returns false if the client already had everything about the object.
+		bool AddObject(NetworkObject& networkObject, SnapshotSendState& sendState);
+		//Ownership of the returned packets passes to the caller, they belong back in the pool.
+		std::vector<SnapshotPacket*> End();
+
+		int GetObjectsWritten() const { return mObjectsWritten; }
+		int GetBitsWritten() const { return mBitsWritten; }
+		//Worst case size of one more object, for staying inside a bandwidth budget.
+		int GetMaxObjectBits() const { return mMaxObjectBits; }
+
+	protected:
+		void StartPacket();
+		void SealPacket();
+
+		std::vector<SnapshotPacket*> mPackets;
+		SnapshotPacket* mCurrentPacket;
+		BitStream mStream;
+		const NetworkQuantizer& mQuantizer;
+		SnapshotPacketPool& mPacketPool;
+		int mMaxObjectBits;
+
+		bool mIsDeltaFrame;
+		int mStateID;
+		float mServerTime;
+		int mAckedStateID;
+		int mObjectsWritten;
+		int mBitsWritten;
+	};
+}
+#endif
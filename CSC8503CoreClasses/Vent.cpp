@@ -145,6 +145,9 @@ bool Vent::CanBeInteractedWith(InteractType interactType, GameObject* interacted
 
 bool Vent::CanUseItem(){
 	auto* localPlayer = LevelManager::GetLevelManager()->GetTempPlayer();
+	if (localPlayer == nullptr) {
+		return false;
+	}
 	PlayerInventory::item usedItem = localPlayer->GetEquippedItem();
 
 	switch (usedItem) {
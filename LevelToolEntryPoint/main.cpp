@@ -0,0 +1,5 @@
+#include "../CSC8503/LevelToolStart.cpp"
+
+int main(int argc, char** argv) {
+	return RunLevelTool(argc, argv);
+}
@@ -0,0 +1,5 @@
+#include "../CSC8503/LoadTestStart.cpp"
+
+int main(int argc, char** argv) {
+	return RunLoadTest(argc, argv);
+}
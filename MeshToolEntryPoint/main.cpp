@@ -0,0 +1,5 @@
+#include "../CSC8503/MeshToolStart.cpp"
+
+int main(int argc, char** argv) {
+	return RunMeshTool(argc, argv);
+}
@@ -0,0 +1,160 @@
+#include "AssetCache.h"
+#include "Assets.h"
+#include "MappedFile.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+using namespace NCL;
+
+namespace {
+	constexpr uint64_t HASH_PRIME = 1099511628211ull;
+	//One "<hash> <size> <write time> <path>" line per source hashed, later lines win.
+	constexpr const char* SOURCE_INDEX_NAME = "Sources.txt";
+
+	struct SourceStamp {
+		uint64_t size;
+		int64_t writeTime;
+		uint64_t hash;
+	};
+
+	std::mutex sourceMutex;
+	std::unordered_map<std::string, SourceStamp> sourceStamps;
+	bool isIndexRead = false;
+	std::atomic<bool> isEnabled = true;
+
+	std::string ToHex(uint64_t value) {
+		char text[17];
+		snprintf(text, sizeof(text), "%016llx", (unsigned long long)value);
+		return text;
+	}
+
+	//Called with sourceMutex held.
+	void ReadSourceIndex() {
+		isIndexRead = true;
+		std::ifstream index(AssetCache::GetCacheDir() + SOURCE_INDEX_NAME);
+		SourceStamp stamp;
+		std::string path;
+		while (index >> std::hex >> stamp.hash >> std::dec >> stamp.size >> stamp.writeTime && index.get() == ' ' && std::getline(index, path)) {
+			sourceStamps[path] = stamp;
+		}
+	}
+
+	bool GetSourceHash(const std::string& sourcePath, uint64_t& hash) {
+		std::error_code error;
+		const std::filesystem::path path(sourcePath);
+		const uint64_t size = (uint64_t)std::filesystem::file_size(path, error);
+		if (error) {
+			return false;
+		}
+		const int64_t writeTime = (int64_t)std::filesystem::last_write_time(path, error).time_since_epoch().count();
+		if (error) {
+			return false;
+		}
+		{
+			std::lock_guard<std::mutex> lock(sourceMutex);
+			if (!isIndexRead) {
+				ReadSourceIndex();
+			}
+			auto it = sourceStamps.find(sourcePath);
+			if (it != sourceStamps.end() && it->second.size == size && it->second.writeTime == writeTime) {
+				hash = it->second.hash;
+				return true;
+			}
+		}
+
+		//hashed outside the lock, loader threads hash their own sources side by side
+		MappedFile source;
+		if (size > 0 && !source.Open(sourcePath)) {
+			return false;
+		}
+		hash = AssetCache::Hash(source.GetData(), source.GetSize());
+
+		std::lock_guard<std::mutex> lock(sourceMutex);
+		sourceStamps[sourcePath] = { size, writeTime, hash };
+		std::filesystem::create_directories(AssetCache::GetCacheDir(), error);
+		std::ofstream index(AssetCache::GetCacheDir() + SOURCE_INDEX_NAME, std::ios::app);
+		index << ToHex(hash) << " " << size << " " << writeTime << " " << sourcePath << "\n";
+		return true;
+	}
+}
+
+std::string AssetCache::GetCacheDir() {
+	return Assets::ASSETROOT + "Cache/";
+}
+
+std::string AssetCache::GetArtifactPath(const std::string& sourcePath, const char* importer, uint32_t version) {
+	uint64_t sourceHash = 0;
+	if (!isEnabled || !GetSourceHash(sourcePath, sourceHash)) {
+		return "";
+	}
+	const uint64_t key = Hash(importer, strlen(importer), Hash(&version, sizeof(version), sourceHash));
+	return GetCacheDir() + importer + "/" + ToHex(key) + "." + importer;
+}
+
+bool AssetCache::WriteArtifact(const std::string& artifactPath, const char* data, size_t size) {
+	if (artifactPath.empty()) {
+		return false;
+	}
+	const std::filesystem::path path(artifactPath);
+	std::error_code error;
+	std::filesystem::create_directories(path.parent_path(), error);
+	//threads cooking the same source write the same bytes, but not to the same temporary file
+	std::filesystem::path tempPath = path;
+	tempPath += "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.write(data, size)) {
+			std::cout << __FUNCTION__ << " can't write " << tempPath.string() << "\n";
+			return false;
+		}
+	}
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		std::cout << __FUNCTION__ << " can't replace " << artifactPath << "\n";
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
+
+uint64_t AssetCache::Hash(const void* data, size_t size, uint64_t seed) {
+	//FNV-1a a word at a time, with a shift so the high bits of each word reach the low bits of the hash
+	const char* bytes = (const char*)data;
+	uint64_t hash = seed;
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, bytes + i, sizeof(uint64_t));
+		hash = (hash ^ word) * HASH_PRIME;
+		hash ^= hash >> 29;
+	}
+	for (; i < size; i++) {
+		hash = (hash ^ (uint8_t)bytes[i]) * HASH_PRIME;
+	}
+	return hash;
+}
+
+void AssetCache::Clear() {
+	std::lock_guard<std::mutex> lock(sourceMutex);
+	sourceStamps.clear();
+	isIndexRead = false;
+	std::error_code error;
+	std::filesystem::remove_all(GetCacheDir(), error);
+}
+
+void AssetCache::SetEnabled(bool enabled) {
+	isEnabled = enabled;
+}
+
+bool AssetCache::IsEnabled() {
+	return isEnabled;
+}
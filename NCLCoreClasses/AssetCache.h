@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace NCL {
+	// Cooked copies of assets, kept under Assets/Cache/ and named after what they were made from: a hash of the
+	// source file's bytes, the importer that made them, and that importer's version. An edited source or a bumped
+	// VERSION just names a different file, so a cooked copy that exists is never stale and loading checks nothing.
+	// Each source's hash is remembered against its size and write time, so a warm start doesn't read the sources.
+	class AssetCache {
+	public:
+		static constexpr uint64_t HASH_SEED = 14695981039346656037ull;
+
+		//Assets/Cache/
+		static std::string GetCacheDir();
+
+		//Assets/Cache/<importer>/<key>.<importer>, empty when the source can't be read or the cache is disabled.
+		static std::string GetArtifactPath(const std::string& sourcePath, const char* importer, uint32_t version);
+
+		//Written to a temporary file then renamed, so nothing ever maps half an artifact.
+		static bool WriteArtifact(const std::string& artifactPath, const char* data, size_t size);
+
+		static uint64_t Hash(const void* data, size_t size, uint64_t seed = HASH_SEED);
+
+		//Deletes every artifact and every remembered hash.
+		static void Clear();
+
+		//While disabled there are no artifact paths, so every asset loads from its source and nothing is cooked.
+		static void SetEnabled(bool enabled);
+		static bool IsEnabled();
+	};
+}
@@ -0,0 +1,468 @@
+#include "CookedAnimation.h"
+#include "AssetCache.h"
+#include "Assets.h"
+#include "MappedFile.h"
+#include "MeshAnimation.h"
+
+#include "Vector3.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <type_traits>
+
+using namespace NCL;
+using namespace Rendering;
+using namespace Maths;
+
+namespace {
+	//"NANM" at the start of the file.
+	constexpr uint32_t COOKED_CLIP_MAGIC = 0x4D4E414E;
+	constexpr size_t ARRAY_ALIGNMENT = 16;
+	//Key frames are stored as 16 bit frame numbers.
+	constexpr size_t MAX_FRAMES = 65535;
+	//Scales this close to 1, or to each other, are taken as exactly that. The clips carry float noise around 1e-6.
+	constexpr float SCALE_EPSILON = 1e-5f;
+	//Each of the three smallest components of a unit quaternion lies within +-1/sqrt(2).
+	constexpr float ROTATION_RANGE = 0.70710678f;
+	constexpr float ROTATION_STEPS = 32767.0f;
+
+	static_assert(std::endian::native == std::endian::little, "Cooked clips are little-endian and used in place");
+
+	enum CookedScaleType : uint32_t {
+		NoScale,
+		UniformScale,
+		NonUniformScale
+	};
+
+	struct CookedVector3 {
+		float x;
+		float y;
+		float z;
+	};
+
+	//The largest component is dropped and rebuilt from the other three, its sign is kept positive.
+	struct CookedRotation {
+		int16_t components[3];
+		uint16_t largest;
+	};
+
+	//A run of keys: frame numbers in the channel's frames array, values at the same index in its values array.
+	struct CookedChannel {
+		uint32_t firstKey;
+		uint32_t keyCount;
+	};
+
+	struct CookedJointTrack {
+		CookedChannel translation;
+		CookedChannel rotation;
+		CookedChannel scale;
+		//scales are one or three floats a key, so they have their own offset
+		uint32_t firstScaleValue;
+		uint32_t scaleType;
+	};
+
+	struct CookedArray {
+		uint32_t offset;
+		uint32_t count;
+	};
+
+	struct CookedClipHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t jointCount;
+		uint32_t frameCount;
+		float frameRate;
+		uint32_t padding;
+		CookedArray tracks;
+		CookedArray translationFrames;
+		CookedArray translations;
+		CookedArray rotationFrames;
+		CookedArray rotations;
+		CookedArray scaleFrames;
+		CookedArray scales;
+	};
+	static_assert(sizeof(CookedClipHeader) == 80 && sizeof(CookedClipHeader) % ARRAY_ALIGNMENT == 0, "Cooked clip header layout changed, bump VERSION");
+
+	//Up to four components of one key, whatever the channel holds.
+	using Key = std::array<float, 4>;
+
+	//The quaternion Matrix4(Quaternion) turns back into m, built from whichever of w, x, y and z is largest
+	//so nothing is divided by a component near zero.
+	Quaternion ToRotation(const Matrix4& m) {
+		const float trace = m.array[0][0] + m.array[1][1] + m.array[2][2];
+		Quaternion rotation;
+		if (trace > 0.0f) {
+			const float s = std::sqrt(trace + 1.0f) * 2.0f;
+			rotation = Quaternion(m.array[1][2] - m.array[2][1], m.array[2][0] - m.array[0][2], m.array[0][1] - m.array[1][0], s * s * 0.25f) * (1.0f / s);
+		}
+		else if (m.array[0][0] > m.array[1][1] && m.array[0][0] > m.array[2][2]) {
+			const float s = std::sqrt(1.0f + m.array[0][0] - m.array[1][1] - m.array[2][2]) * 2.0f;
+			rotation = Quaternion(s * s * 0.25f, m.array[0][1] + m.array[1][0], m.array[2][0] + m.array[0][2], m.array[1][2] - m.array[2][1]) * (1.0f / s);
+		}
+		else if (m.array[1][1] > m.array[2][2]) {
+			const float s = std::sqrt(1.0f + m.array[1][1] - m.array[0][0] - m.array[2][2]) * 2.0f;
+			rotation = Quaternion(m.array[0][1] + m.array[1][0], s * s * 0.25f, m.array[1][2] + m.array[2][1], m.array[2][0] - m.array[0][2]) * (1.0f / s);
+		}
+		else {
+			const float s = std::sqrt(1.0f + m.array[2][2] - m.array[0][0] - m.array[1][1]) * 2.0f;
+			rotation = Quaternion(m.array[2][0] + m.array[0][2], m.array[1][2] + m.array[2][1], s * s * 0.25f, m.array[0][1] - m.array[1][0]) * (1.0f / s);
+		}
+		return rotation.Normalised();
+	}
+
+	CookedRotation QuantiseRotation(const Quaternion& rotation) {
+		const float values[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+		uint16_t largest = 0;
+		for (uint16_t i = 1; i < 4; i++) {
+			if (std::abs(values[i]) > std::abs(values[largest])) {
+				largest = i;
+			}
+		}
+		const float sign = values[largest] < 0.0f ? -1.0f : 1.0f;
+		CookedRotation cooked = {};
+		cooked.largest = largest;
+		int component = 0;
+		for (uint16_t i = 0; i < 4; i++) {
+			if (i == largest) {
+				continue;
+			}
+			const float scaled = std::clamp(values[i] * sign / ROTATION_RANGE, -1.0f, 1.0f);
+			cooked.components[component++] = (int16_t)std::lround(scaled * ROTATION_STEPS);
+		}
+		return cooked;
+	}
+
+	Quaternion ToQuaternion(const CookedRotation& cooked) {
+		float values[4] = {};
+		float sumSquares = 0.0f;
+		int component = 0;
+		for (int i = 0; i < 4; i++) {
+			if (i == cooked.largest) {
+				continue;
+			}
+			values[i] = cooked.components[component++] / ROTATION_STEPS * ROTATION_RANGE;
+			sumSquares += values[i] * values[i];
+		}
+		values[cooked.largest] = std::sqrt(std::max(0.0f, 1.0f - sumSquares));
+		return Quaternion(values[0], values[1], values[2], values[3]);
+	}
+
+	Key ToKey(const Quaternion& rotation) {
+		return { rotation.x, rotation.y, rotation.z, rotation.w };
+	}
+
+	Quaternion KeyToQuaternion(const Key& key) {
+		return Quaternion(key[0], key[1], key[2], key[3]);
+	}
+
+	Key LerpKey(const Key& from, const Key& to, float by) {
+		Key key;
+		for (int i = 0; i < 4; i++) {
+			key[i] = from[i] + (to[i] - from[i]) * by;
+		}
+		return key;
+	}
+
+	Key LerpRotationKey(const Key& from, const Key& to, float by) {
+		return ToKey(Quaternion::Lerp(KeyToQuaternion(from), KeyToQuaternion(to), by).Normalised());
+	}
+
+	//q and -q are the same rotation, so rotations take whichever sign is closer.
+	float KeyError(const Key& a, const Key& b, bool isRotation) {
+		float error = 0.0f;
+		float flippedError = 0.0f;
+		for (int i = 0; i < 4; i++) {
+			error = std::max(error, std::abs(a[i] - b[i]));
+			flippedError = std::max(flippedError, std::abs(a[i] + b[i]));
+		}
+		return isRotation ? std::min(error, flippedError) : error;
+	}
+
+	//The frames worth keeping: just the first when nothing changes, otherwise the first, the last, and every
+	//frame the keys either side of it can't rebuild to within tolerance.
+	std::vector<uint16_t> ReduceKeys(const std::vector<Key>& values, float tolerance, bool isRotation) {
+		const size_t frameCount = values.size();
+		bool isConstant = true;
+		for (size_t i = 1; i < frameCount && isConstant; i++) {
+			isConstant = KeyError(values[i], values[0], isRotation) <= tolerance;
+		}
+		if (isConstant) {
+			return { 0 };
+		}
+		auto canSpan = [&](size_t from, size_t to) {
+			for (size_t i = from + 1; i < to; i++) {
+				const float by = (float)(i - from) / (float)(to - from);
+				const Key rebuilt = isRotation ? LerpRotationKey(values[from], values[to], by) : LerpKey(values[from], values[to], by);
+				if (KeyError(rebuilt, values[i], isRotation) > tolerance) {
+					return false;
+				}
+			}
+			return true;
+		};
+		std::vector<uint16_t> keys = { 0 };
+		size_t from = 0;
+		for (size_t to = 2; to < frameCount; to++) {
+			if (!canSpan(from, to)) {
+				from = to - 1;
+				keys.push_back((uint16_t)from);
+			}
+		}
+		keys.push_back((uint16_t)(frameCount - 1));
+		return keys;
+	}
+
+	void AlignBlob(std::vector<char>& blob) {
+		blob.resize((blob.size() + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT, 0);
+	}
+
+	template <typename T>
+	CookedArray AppendArray(std::vector<char>& blob, const std::vector<T>& elements) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		AlignBlob(blob);
+		const CookedArray array = { (uint32_t)blob.size(), (uint32_t)elements.size() };
+		const char* bytes = (const char*)elements.data();
+		blob.insert(blob.end(), bytes, bytes + elements.size() * sizeof(T));
+		return array;
+	}
+
+	//Null if the array runs off the end of the file.
+	template <typename T>
+	const T* GetArray(const MappedFile& file, const CookedArray& array) {
+		if ((size_t)array.offset + (size_t)array.count * sizeof(T) > file.GetSize() || array.offset % alignof(T) != 0) {
+			return nullptr;
+		}
+		return (const T*)(file.GetData() + array.offset);
+	}
+
+	bool IsChannelInside(const CookedChannel& channel, const CookedArray& frames, const CookedArray& values) {
+		return channel.keyCount > 0 && (uint64_t)channel.firstKey + channel.keyCount <= std::min(frames.count, values.count);
+	}
+
+	//The two keys either side of frame, and how far between them it is.
+	void FindKeys(const uint16_t* frames, const CookedChannel& channel, size_t frame, uint32_t& from, uint32_t& to, float& by) {
+		const uint16_t* first = frames + channel.firstKey;
+		const uint16_t* last = first + channel.keyCount;
+		const uint16_t* next = std::upper_bound(first, last, (uint16_t)frame);
+		if (next == first || next == last) {
+			from = to = (uint32_t)((next == first ? first : last - 1) - frames);
+			by = 0.0f;
+			return;
+		}
+		to = (uint32_t)(next - frames);
+		from = to - 1;
+		by = (float)(frame - frames[from]) / (float)(frames[to] - frames[from]);
+	}
+}
+
+std::string CookedAnimation::GetCookedPath(const std::string& filename) {
+	return AssetCache::GetArtifactPath(Assets::MESHDIR + filename, IMPORTER, VERSION);
+}
+
+bool CookedAnimation::HasAllFrames(const MeshAnimation& anim) {
+	return anim.frameCount > 0 && anim.jointCount > 0 && anim.allJoints.size() == anim.frameCount * anim.jointCount;
+}
+
+bool CookedAnimation::Cook(const std::string& filename, const MeshAnimation& anim, float tolerance) {
+	if (!HasAllFrames(anim) || anim.frameCount > MAX_FRAMES) {
+		std::cout << __FUNCTION__ << " " << filename << " doesn't have frames that can be cooked\n";
+		return false;
+	}
+	CookedClipHeader header = {};
+	header.magic = COOKED_CLIP_MAGIC;
+	header.version = VERSION;
+	header.jointCount = (uint32_t)anim.jointCount;
+	header.frameCount = (uint32_t)anim.frameCount;
+	header.frameRate = anim.frameRate;
+	const std::string cookedPath = GetCookedPath(filename);
+	//the cache is disabled, or the source has gone
+	if (cookedPath.empty()) {
+		return false;
+	}
+
+	std::vector<CookedJointTrack> tracks;
+	std::vector<uint16_t> translationFrames;
+	std::vector<CookedVector3> translations;
+	std::vector<uint16_t> rotationFrames;
+	std::vector<CookedRotation> rotations;
+	std::vector<uint16_t> scaleFrames;
+	std::vector<float> scales;
+	for (size_t joint = 0; joint < anim.jointCount; joint++) {
+		std::vector<Key> translationKeys;
+		std::vector<Key> rotationKeys;
+		std::vector<CookedRotation> quantisedRotations;
+		std::vector<Key> scaleKeys;
+		CookedJointTrack track = {};
+		track.scaleType = NoScale;
+		for (size_t frame = 0; frame < anim.frameCount; frame++) {
+			const Matrix4& matrix = anim.allJoints[frame * anim.jointCount + joint];
+			Matrix4 rotationMatrix = matrix;
+			Key scale = {};
+			for (int column = 0; column < 3; column++) {
+				scale[column] = Vector3(matrix.array[column][0], matrix.array[column][1], matrix.array[column][2]).Length();
+				for (int row = 0; row < 3; row++) {
+					rotationMatrix.array[column][row] /= scale[column];
+				}
+			}
+			const CookedRotation rotation = QuantiseRotation(ToRotation(rotationMatrix));
+			quantisedRotations.push_back(rotation);
+			//keys are reduced against what would be stored, so a tolerance of 0 loses nothing more than quantising
+			rotationKeys.push_back(ToKey(ToQuaternion(rotation)));
+			translationKeys.push_back({ matrix.array[3][0], matrix.array[3][1], matrix.array[3][2], 0.0f });
+			scaleKeys.push_back(scale);
+
+			const bool isUniform = std::abs(scale[0] - scale[1]) <= SCALE_EPSILON && std::abs(scale[0] - scale[2]) <= SCALE_EPSILON;
+			const bool isOne = isUniform && std::abs(scale[0] - 1.0f) <= SCALE_EPSILON;
+			if (!isUniform) {
+				track.scaleType = NonUniformScale;
+			}
+			else if (!isOne && track.scaleType == NoScale) {
+				track.scaleType = UniformScale;
+			}
+		}
+
+		const std::vector<uint16_t> translationKeyFrames = ReduceKeys(translationKeys, tolerance, false);
+		track.translation = { (uint32_t)translationFrames.size(), (uint32_t)translationKeyFrames.size() };
+		for (uint16_t frame : translationKeyFrames) {
+			translationFrames.push_back(frame);
+			translations.push_back({ translationKeys[frame][0], translationKeys[frame][1], translationKeys[frame][2] });
+		}
+
+		const std::vector<uint16_t> rotationKeyFrames = ReduceKeys(rotationKeys, tolerance, true);
+		track.rotation = { (uint32_t)rotationFrames.size(), (uint32_t)rotationKeyFrames.size() };
+		for (uint16_t frame : rotationKeyFrames) {
+			rotationFrames.push_back(frame);
+			rotations.push_back(quantisedRotations[frame]);
+		}
+
+		if (track.scaleType != NoScale) {
+			const int components = track.scaleType == UniformScale ? 1 : 3;
+			if (track.scaleType == UniformScale) {
+				for (Key& scale : scaleKeys) {
+					scale = { scale[0], 0.0f, 0.0f, 0.0f };
+				}
+			}
+			const std::vector<uint16_t> scaleKeyFrames = ReduceKeys(scaleKeys, tolerance, false);
+			track.scale = { (uint32_t)scaleFrames.size(), (uint32_t)scaleKeyFrames.size() };
+			track.firstScaleValue = (uint32_t)scales.size();
+			for (uint16_t frame : scaleKeyFrames) {
+				scaleFrames.push_back(frame);
+				scales.insert(scales.end(), scaleKeys[frame].begin(), scaleKeys[frame].begin() + components);
+			}
+		}
+		tracks.push_back(track);
+	}
+
+	std::vector<char> blob(sizeof(CookedClipHeader));
+	header.tracks = AppendArray(blob, tracks);
+	header.translationFrames = AppendArray(blob, translationFrames);
+	header.translations = AppendArray(blob, translations);
+	header.rotationFrames = AppendArray(blob, rotationFrames);
+	header.rotations = AppendArray(blob, rotations);
+	header.scaleFrames = AppendArray(blob, scaleFrames);
+	header.scales = AppendArray(blob, scales);
+	memcpy(blob.data(), &header, sizeof(CookedClipHeader));
+	return AssetCache::WriteArtifact(cookedPath, blob.data(), blob.size());
+}
+
+bool CookedAnimation::Load(const std::string& filename, MeshAnimation& anim) {
+	const std::string cookedPath = GetCookedPath(filename);
+	MappedFile& cooked = anim.cookedClip;
+	//not cooked isn't worth a message, MappedFile would print one
+	if (cookedPath.empty() || !std::filesystem::exists(cookedPath) || !cooked.Open(cookedPath)) {
+		return false;
+	}
+	const CookedClipHeader& header = *(const CookedClipHeader*)cooked.GetData();
+	if (cooked.GetSize() < sizeof(CookedClipHeader) || header.magic != COOKED_CLIP_MAGIC || header.version != VERSION) {
+		cooked.Close();
+		return false;
+	}
+
+	const CookedJointTrack* tracks = GetArray<CookedJointTrack>(cooked, header.tracks);
+	bool isValid = tracks && header.tracks.count == header.jointCount && header.frameCount > 0 &&
+		GetArray<uint16_t>(cooked, header.translationFrames) && GetArray<CookedVector3>(cooked, header.translations) &&
+		GetArray<uint16_t>(cooked, header.rotationFrames) && GetArray<CookedRotation>(cooked, header.rotations) &&
+		GetArray<uint16_t>(cooked, header.scaleFrames) && GetArray<float>(cooked, header.scales);
+	//checked once here so sampling can index without checking
+	for (uint32_t i = 0; isValid && i < header.jointCount; i++) {
+		const CookedJointTrack& track = tracks[i];
+		const uint64_t scaleValueCount = (uint64_t)track.scale.keyCount * (track.scaleType == UniformScale ? 1 : 3);
+		isValid = IsChannelInside(track.translation, header.translationFrames, header.translations) &&
+			IsChannelInside(track.rotation, header.rotationFrames, header.rotations) && track.scaleType <= NonUniformScale &&
+			(track.scaleType == NoScale || ((uint64_t)track.scale.firstKey + track.scale.keyCount <= header.scaleFrames.count &&
+				track.scale.keyCount > 0 && track.firstScaleValue + scaleValueCount <= header.scales.count));
+	}
+	if (!isValid) {
+		std::cout << __FUNCTION__ << " " << cookedPath << " is truncated\n";
+		cooked.Close();
+		return false;
+	}
+
+	anim.jointCount = header.jointCount;
+	anim.frameCount = header.frameCount;
+	anim.frameRate = header.frameRate;
+	anim.allJoints.clear();
+	return true;
+}
+
+float CookedAnimation::GetMaxError(const MeshAnimation& a, const MeshAnimation& b) {
+	if (a.GetFrameCount() != b.GetFrameCount() || a.GetJointCount() != b.GetJointCount()) {
+		return INFINITY;
+	}
+	float maxError = 0.0f;
+	for (size_t frame = 0; frame < a.GetFrameCount(); frame++) {
+		for (size_t joint = 0; joint < a.GetJointCount(); joint++) {
+			const Matrix4 expected = a.GetJointMatrix(frame, joint);
+			const Matrix4 actual = b.GetJointMatrix(frame, joint);
+			for (int i = 0; i < 16; i++) {
+				maxError = std::max(maxError, std::abs(expected.array[i / 4][i % 4] - actual.array[i / 4][i % 4]));
+			}
+		}
+	}
+	return maxError;
+}
+
+Matrix4 CookedAnimation::SampleJoint(const MappedFile& clip, size_t frame, size_t joint) {
+	const char* data = clip.GetData();
+	const CookedClipHeader& header = *(const CookedClipHeader*)data;
+	const CookedJointTrack& track = ((const CookedJointTrack*)(data + header.tracks.offset))[joint];
+	uint32_t from;
+	uint32_t to;
+	float by;
+
+	const CookedRotation* rotations = (const CookedRotation*)(data + header.rotations.offset);
+	FindKeys((const uint16_t*)(data + header.rotationFrames.offset), track.rotation, frame, from, to, by);
+	Quaternion rotation = ToQuaternion(rotations[from]);
+	if (from != to) {
+		rotation = Quaternion::Lerp(rotation, ToQuaternion(rotations[to]), by).Normalised();
+	}
+	Matrix4 matrix(rotation);
+
+	if (track.scaleType != NoScale) {
+		const int components = track.scaleType == UniformScale ? 1 : 3;
+		FindKeys((const uint16_t*)(data + header.scaleFrames.offset), track.scale, frame, from, to, by);
+		const float* scales = (const float*)(data + header.scales.offset) + track.firstScaleValue;
+		const float* fromScale = scales + (from - track.scale.firstKey) * components;
+		const float* toScale = scales + (to - track.scale.firstKey) * components;
+		for (int column = 0; column < 3; column++) {
+			const int component = components == 1 ? 0 : column;
+			const float scale = fromScale[component] + (toScale[component] - fromScale[component]) * by;
+			for (int row = 0; row < 3; row++) {
+				matrix.array[column][row] *= scale;
+			}
+		}
+	}
+
+	const CookedVector3* translations = (const CookedVector3*)(data + header.translations.offset);
+	FindKeys((const uint16_t*)(data + header.translationFrames.offset), track.translation, frame, from, to, by);
+	matrix.array[3][0] = translations[from].x + (translations[to].x - translations[from].x) * by;
+	matrix.array[3][1] = translations[from].y + (translations[to].y - translations[from].y) * by;
+	matrix.array[3][2] = translations[from].z + (translations[to].z - translations[from].z) * by;
+	return matrix;
+}
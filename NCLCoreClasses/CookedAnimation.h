@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace NCL {
+	class MappedFile;
+}
+
+namespace NCL::Maths {
+	class Matrix4;
+}
+
+namespace NCL::Rendering {
+	class MeshAnimation;
+
+	// A .anm converted offline into per joint tracks: a translation, a rotation quantised to three 16 bit
+	// components, and a scale only when it isn't 1 (one float when uniform). A track that doesn't change is
+	// a single key, and with a tolerance keys that linear interpolation can rebuild are dropped too.
+	// The clip is used straight from the mapping, matrices are built when a joint is sampled.
+	// It is kept in the AssetCache under a hash of the .anm.
+	class CookedAnimation {
+	public:
+		static constexpr uint32_t VERSION = 2;
+		static constexpr const char* IMPORTER = "clip";
+		//Rotations are quantised to about 2e-5 a quaternion component, which moves a matrix element by up to about 4 times that.
+		static constexpr float MAX_ERROR = 1e-3f;
+
+		//The AssetCache artifact for Assets/Meshes/<filename>, empty if the .anm can't be read.
+		static std::string GetCookedPath(const std::string& filename);
+
+		//False for clips the text parser couldn't fill every frame of.
+		static bool HasAllFrames(const MeshAnimation& anim);
+
+		//anim as loaded from the text of filename. tolerance is the largest error allowed in a translation,
+		//quaternion or scale component when dropping keys, 0 keeps every key that differs.
+		static bool Cook(const std::string& filename, const MeshAnimation& anim, float tolerance = 0.0f);
+		//False, with the clip untouched, when the .anm hasn't been cooked as it is now.
+		static bool Load(const std::string& filename, MeshAnimation& anim);
+
+		//Largest difference in any matrix element between two loads of the same clip, such as its text and its cooked copy.
+		static float GetMaxError(const MeshAnimation& a, const MeshAnimation& b);
+
+		//clip has been checked by Load, frame and joint by the caller.
+		static Maths::Matrix4 SampleJoint(const MappedFile& clip, size_t frame, size_t joint);
+	};
+}
@@ -0,0 +1,160 @@
+#include "CookedMaterial.h"
+#include "AssetCache.h"
+#include "Assets.h"
+#include "MappedFile.h"
+#include "MeshMaterial.h"
+
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+using namespace NCL;
+
+namespace {
+	//"NMAT" at the start of the file.
+	constexpr uint32_t COOKED_MATERIAL_MAGIC = 0x54414D4E;
+
+	static_assert(std::endian::native == std::endian::little, "Cooked materials are little-endian");
+
+	struct CookedMaterialHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t layerCount;
+		uint32_t meshLayerCount;
+	};
+
+	void AppendUInt(std::vector<char>& blob, uint32_t value) {
+		const char* bytes = (const char*)&value;
+		blob.insert(blob.end(), bytes, bytes + sizeof(uint32_t));
+	}
+
+	void AppendString(std::vector<char>& blob, const std::string& string) {
+		AppendUInt(blob, (uint32_t)string.size());
+		blob.insert(blob.end(), string.begin(), string.end());
+	}
+
+	//Reads the blob front to back, every read after one that ran off the end fails too.
+	struct CookedReader {
+		const MappedFile& file;
+		size_t offset;
+		bool isValid;
+
+		uint32_t ReadUInt() {
+			uint32_t value = 0;
+			if (!isValid || offset + sizeof(uint32_t) > file.GetSize()) {
+				isValid = false;
+				return value;
+			}
+			memcpy(&value, file.GetData() + offset, sizeof(uint32_t));
+			offset += sizeof(uint32_t);
+			return value;
+		}
+
+		std::string ReadString() {
+			const uint32_t length = ReadUInt();
+			if (!isValid || offset + length > file.GetSize()) {
+				isValid = false;
+				return "";
+			}
+			offset += length;
+			return std::string(file.GetData() + offset - length, length);
+		}
+	};
+}
+
+std::string CookedMaterial::GetCookedPath(const std::string& filename) {
+	return AssetCache::GetArtifactPath(Assets::MESHDIR + filename, IMPORTER, VERSION);
+}
+
+bool CookedMaterial::Cook(const std::string& filename, const MeshMaterial& material) {
+	const std::string cookedPath = GetCookedPath(filename);
+	//the cache is disabled, or the source has gone
+	if (cookedPath.empty()) {
+		return false;
+	}
+	CookedMaterialHeader header = {};
+	header.magic = COOKED_MATERIAL_MAGIC;
+	header.version = VERSION;
+	header.layerCount = (uint32_t)material.materialLayers.size();
+	header.meshLayerCount = (uint32_t)material.meshLayers.size();
+
+	std::vector<char> blob(sizeof(CookedMaterialHeader));
+	for (const MeshMaterialEntry& layer : material.materialLayers) {
+		AppendUInt(blob, (uint32_t)layer.entries.size());
+		for (const auto& [channel, entry] : layer.entries) {
+			AppendString(blob, channel);
+			AppendString(blob, entry.first);
+		}
+	}
+	for (const MeshMaterialEntry* meshLayer : material.meshLayers) {
+		const size_t index = meshLayer - material.materialLayers.data();
+		if (index >= material.materialLayers.size()) {
+			std::cout << __FUNCTION__ << " " << filename << " has a submesh without a layer\n";
+			return false;
+		}
+		AppendUInt(blob, (uint32_t)index);
+	}
+	memcpy(blob.data(), &header, sizeof(CookedMaterialHeader));
+	return AssetCache::WriteArtifact(cookedPath, blob.data(), blob.size());
+}
+
+bool CookedMaterial::Load(const std::string& filename, MeshMaterial& material) {
+	const std::string cookedPath = GetCookedPath(filename);
+	MappedFile cooked;
+	//not cooked isn't worth a message, MappedFile would print one
+	if (cookedPath.empty() || !std::filesystem::exists(cookedPath) || !cooked.Open(cookedPath) || cooked.GetSize() < sizeof(CookedMaterialHeader)) {
+		return false;
+	}
+	const CookedMaterialHeader& header = *(const CookedMaterialHeader*)cooked.GetData();
+	if (header.magic != COOKED_MATERIAL_MAGIC || header.version != VERSION) {
+		return false;
+	}
+
+	CookedReader reader = { cooked, sizeof(CookedMaterialHeader), true };
+	std::vector<MeshMaterialEntry> layers;
+	for (uint32_t i = 0; reader.isValid && i < header.layerCount; i++) {
+		MeshMaterialEntry& layer = layers.emplace_back();
+		const uint32_t entryCount = reader.ReadUInt();
+		for (uint32_t j = 0; reader.isValid && j < entryCount; j++) {
+			std::string channel = reader.ReadString();
+			std::string file = reader.ReadString();
+			layer.entries.insert(std::make_pair(std::move(channel), std::make_pair(std::move(file), nullptr)));
+		}
+	}
+	std::vector<uint32_t> meshLayers;
+	for (uint32_t i = 0; reader.isValid && i < header.meshLayerCount; i++) {
+		meshLayers.push_back(reader.ReadUInt());
+		reader.isValid = reader.isValid && meshLayers.back() < header.layerCount;
+	}
+	if (!reader.isValid) {
+		std::cout << __FUNCTION__ << " " << cookedPath << " is truncated\n";
+		return false;
+	}
+
+	//meshLayers point into materialLayers, which doesn't change size again
+	material.materialLayers = std::move(layers);
+	material.meshLayers.clear();
+	for (uint32_t index : meshLayers) {
+		material.meshLayers.push_back(&material.materialLayers[index]);
+	}
+	return true;
+}
+
+bool CookedMaterial::IsSameMaterial(const MeshMaterial& a, const MeshMaterial& b) {
+	if (a.materialLayers.size() != b.materialLayers.size() || a.meshLayers.size() != b.meshLayers.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.materialLayers.size(); i++) {
+		if (a.materialLayers[i].entries != b.materialLayers[i].entries) {
+			return false;
+		}
+	}
+	for (size_t i = 0; i < a.meshLayers.size(); i++) {
+		if (a.meshLayers[i] - a.materialLayers.data() != b.meshLayers[i] - b.materialLayers.data()) {
+			return false;
+		}
+	}
+	return true;
+}
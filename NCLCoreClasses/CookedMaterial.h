@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace NCL {
+	class MeshMaterial;
+
+	// A .mat with its text already parsed: the layers' channel and texture names, then the layer each submesh uses,
+	// as uint32_t counts and lengths followed by the characters. Kept in the AssetCache under a hash of the .mat.
+	class CookedMaterial {
+	public:
+		static constexpr uint32_t VERSION = 1;
+		static constexpr const char* IMPORTER = "material";
+
+		//The AssetCache artifact for Assets/Meshes/<filename>, empty if the .mat can't be read.
+		static std::string GetCookedPath(const std::string& filename);
+
+		//material as loaded from the text of filename.
+		static bool Cook(const std::string& filename, const MeshMaterial& material);
+		//False, with the material untouched, when the .mat hasn't been cooked as it is now.
+		static bool Load(const std::string& filename, MeshMaterial& material);
+
+		static bool IsSameMaterial(const MeshMaterial& a, const MeshMaterial& b);
+	};
+}
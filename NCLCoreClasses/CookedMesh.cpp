@@ -0,0 +1,221 @@
+#include "CookedMesh.h"
+#include "AssetCache.h"
+#include "Assets.h"
+#include "MappedFile.h"
+#include "Mesh.h"
+
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Vector4i.h"
+#include "Matrix4.h"
+
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <span>
+#include <type_traits>
+
+using namespace NCL;
+using namespace Rendering;
+using namespace Maths;
+
+namespace {
+	//"NMSH" at the start of the file.
+	constexpr uint32_t COOKED_MESH_MAGIC = 0x48534D4E;
+	//Every stream starts on a 16 byte boundary of the file, and so of the page aligned mapping.
+	constexpr size_t STREAM_ALIGNMENT = 16;
+
+	static_assert(std::endian::native == std::endian::little, "Cooked meshes are little-endian and used in place");
+	static_assert(sizeof(Vector2) == 8 && sizeof(Vector3) == 12 && sizeof(Vector4) == 16 && sizeof(Vector4i) == 16 && sizeof(Matrix4) == 64,
+		"Cooked mesh streams are the Mesh's own vectors written out byte for byte");
+
+	enum CookedStreamType {
+		Positions,
+		TexCoords,
+		Colours,
+		Normals,
+		Tangents,
+		SkinWeights,
+		SkinIndices,
+		Indices,
+		SubMeshes,
+		JointParents,
+		BindPose,
+		InverseBindPose,
+		BindPoseIndices,
+		BindPoseStates,
+		//count strings, then count uint32_t lengths followed by the characters
+		JointNames,
+		SubMeshNames,
+		STREAM_COUNT
+	};
+
+	struct CookedStream {
+		uint32_t offset;
+		uint32_t count;
+	};
+
+	struct CookedMeshHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t primitiveType;
+		uint32_t padding;
+		CookedStream streams[STREAM_COUNT];
+	};
+	static_assert(sizeof(CookedMeshHeader) == 144 && sizeof(CookedMeshHeader) % STREAM_ALIGNMENT == 0, "Cooked mesh header layout changed, bump VERSION");
+
+	void AlignBlob(std::vector<char>& blob) {
+		blob.resize((blob.size() + STREAM_ALIGNMENT - 1) / STREAM_ALIGNMENT * STREAM_ALIGNMENT, 0);
+	}
+
+	template <typename T>
+	void AppendStream(std::vector<char>& blob, CookedStream& stream, const std::vector<T>& elements) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		AlignBlob(blob);
+		stream = { (uint32_t)blob.size(), (uint32_t)elements.size() };
+		const char* bytes = (const char*)elements.data();
+		blob.insert(blob.end(), bytes, bytes + elements.size() * sizeof(T));
+	}
+
+	void AppendStrings(std::vector<char>& blob, CookedStream& stream, const std::vector<std::string>& strings) {
+		std::vector<uint32_t> lengths;
+		for (const std::string& string : strings) {
+			lengths.push_back((uint32_t)string.size());
+		}
+		AppendStream(blob, stream, lengths);
+		for (const std::string& string : strings) {
+			blob.insert(blob.end(), string.begin(), string.end());
+		}
+	}
+
+	//Empty with isValid false if the stream runs off the end of the file.
+	template <typename T>
+	std::span<const T> GetStream(const MappedFile& file, const CookedStream& stream, bool& isValid) {
+		if ((size_t)stream.offset + (size_t)stream.count * sizeof(T) > file.GetSize() || stream.offset % alignof(T) != 0) {
+			isValid = false;
+			return {};
+		}
+		return std::span<const T>((const T*)(file.GetData() + stream.offset), stream.count);
+	}
+
+	bool ReadStrings(const MappedFile& file, const CookedStream& stream, std::vector<std::string>& strings) {
+		bool isValid = true;
+		const std::span<const uint32_t> lengths = GetStream<uint32_t>(file, stream, isValid);
+		size_t offset = (size_t)stream.offset + lengths.size_bytes();
+		for (uint32_t length : lengths) {
+			if (!isValid || offset + length > file.GetSize()) {
+				return false;
+			}
+			strings.emplace_back(file.GetData() + offset, length);
+			offset += length;
+		}
+		return isValid;
+	}
+
+	template <typename T>
+	bool IsSameStream(const std::vector<T>& a, const std::vector<T>& b) {
+		return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+	}
+}
+
+std::string CookedMesh::GetCookedPath(const std::string& filename) {
+	return AssetCache::GetArtifactPath(Assets::MESHDIR + filename, IMPORTER, VERSION);
+}
+
+bool CookedMesh::Cook(const std::string& filename, const Mesh& mesh) {
+	CookedMeshHeader header = {};
+	header.magic = COOKED_MESH_MAGIC;
+	header.version = VERSION;
+	header.primitiveType = mesh.primType;
+	const std::string cookedPath = GetCookedPath(filename);
+	//the cache is disabled, or the source has gone
+	if (cookedPath.empty()) {
+		return false;
+	}
+
+	std::vector<char> blob(sizeof(CookedMeshHeader));
+	AppendStream(blob, header.streams[Positions], mesh.positions);
+	AppendStream(blob, header.streams[TexCoords], mesh.texCoords);
+	AppendStream(blob, header.streams[Colours], mesh.colours);
+	AppendStream(blob, header.streams[Normals], mesh.normals);
+	AppendStream(blob, header.streams[Tangents], mesh.tangents);
+	AppendStream(blob, header.streams[SkinWeights], mesh.skinWeights);
+	AppendStream(blob, header.streams[SkinIndices], mesh.skinIndices);
+	AppendStream(blob, header.streams[Indices], mesh.indices);
+	AppendStream(blob, header.streams[SubMeshes], mesh.subMeshes);
+	AppendStream(blob, header.streams[JointParents], mesh.jointParents);
+	AppendStream(blob, header.streams[BindPose], mesh.bindPose);
+	AppendStream(blob, header.streams[InverseBindPose], mesh.inverseBindPose);
+	AppendStream(blob, header.streams[BindPoseIndices], mesh.mBindPoseIndices);
+	AppendStream(blob, header.streams[BindPoseStates], mesh.mBindPoseStates);
+	AppendStrings(blob, header.streams[JointNames], mesh.jointNames);
+	AppendStrings(blob, header.streams[SubMeshNames], mesh.subMeshNames);
+	memcpy(blob.data(), &header, sizeof(CookedMeshHeader));
+	return AssetCache::WriteArtifact(cookedPath, blob.data(), blob.size());
+}
+
+bool CookedMesh::Load(const std::string& filename, Mesh& mesh) {
+	const std::string cookedPath = GetCookedPath(filename);
+	MappedFile cooked;
+	//not cooked isn't worth a message, MappedFile would print one
+	if (cookedPath.empty() || !std::filesystem::exists(cookedPath) || !cooked.Open(cookedPath) || cooked.GetSize() < sizeof(CookedMeshHeader)) {
+		return false;
+	}
+	const CookedMeshHeader& header = *(const CookedMeshHeader*)cooked.GetData();
+	if (header.magic != COOKED_MESH_MAGIC || header.version != VERSION || header.primitiveType >= GeometryPrimitive::MAX_PRIM) {
+		return false;
+	}
+
+	bool isValid = true;
+	const std::span<const Vector3> positions = GetStream<Vector3>(cooked, header.streams[Positions], isValid);
+	const std::span<const Vector2> texCoords = GetStream<Vector2>(cooked, header.streams[TexCoords], isValid);
+	const std::span<const Vector4> colours = GetStream<Vector4>(cooked, header.streams[Colours], isValid);
+	const std::span<const Vector3> normals = GetStream<Vector3>(cooked, header.streams[Normals], isValid);
+	const std::span<const Vector4> tangents = GetStream<Vector4>(cooked, header.streams[Tangents], isValid);
+	const std::span<const Vector4> skinWeights = GetStream<Vector4>(cooked, header.streams[SkinWeights], isValid);
+	const std::span<const Vector4i> skinIndices = GetStream<Vector4i>(cooked, header.streams[SkinIndices], isValid);
+	const std::span<const unsigned int> indices = GetStream<unsigned int>(cooked, header.streams[Indices], isValid);
+	const std::span<const SubMesh> subMeshes = GetStream<SubMesh>(cooked, header.streams[SubMeshes], isValid);
+	const std::span<const int> jointParents = GetStream<int>(cooked, header.streams[JointParents], isValid);
+	const std::span<const Matrix4> bindPose = GetStream<Matrix4>(cooked, header.streams[BindPose], isValid);
+	const std::span<const Matrix4> inverseBindPose = GetStream<Matrix4>(cooked, header.streams[InverseBindPose], isValid);
+	const std::span<const int> bindPoseIndices = GetStream<int>(cooked, header.streams[BindPoseIndices], isValid);
+	const std::span<const Mesh::SubMeshPoses> bindPoseStates = GetStream<Mesh::SubMeshPoses>(cooked, header.streams[BindPoseStates], isValid);
+	std::vector<std::string> jointNames;
+	std::vector<std::string> subMeshNames;
+	if (!isValid || !ReadStrings(cooked, header.streams[JointNames], jointNames) || !ReadStrings(cooked, header.streams[SubMeshNames], subMeshNames)) {
+		std::cout << __FUNCTION__ << " " << cookedPath << " is truncated\n";
+		return false;
+	}
+
+	//Mesh owns its streams, so each one is a single copy out of the mapping
+	mesh.positions.assign(positions.begin(), positions.end());
+	mesh.texCoords.assign(texCoords.begin(), texCoords.end());
+	mesh.colours.assign(colours.begin(), colours.end());
+	mesh.normals.assign(normals.begin(), normals.end());
+	mesh.tangents.assign(tangents.begin(), tangents.end());
+	mesh.skinWeights.assign(skinWeights.begin(), skinWeights.end());
+	mesh.skinIndices.assign(skinIndices.begin(), skinIndices.end());
+	mesh.indices.assign(indices.begin(), indices.end());
+	mesh.subMeshes.assign(subMeshes.begin(), subMeshes.end());
+	mesh.jointParents.assign(jointParents.begin(), jointParents.end());
+	mesh.bindPose.assign(bindPose.begin(), bindPose.end());
+	mesh.inverseBindPose.assign(inverseBindPose.begin(), inverseBindPose.end());
+	mesh.mBindPoseIndices.assign(bindPoseIndices.begin(), bindPoseIndices.end());
+	mesh.mBindPoseStates.assign(bindPoseStates.begin(), bindPoseStates.end());
+	mesh.jointNames = std::move(jointNames);
+	mesh.subMeshNames = std::move(subMeshNames);
+	mesh.primType = (GeometryPrimitive::Type)header.primitiveType;
+	return true;
+}
+
+bool CookedMesh::IsSameMesh(const Mesh& a, const Mesh& b) {
+	return a.primType == b.primType && IsSameStream(a.positions, b.positions) && IsSameStream(a.texCoords, b.texCoords) &&
+		IsSameStream(a.colours, b.colours) && IsSameStream(a.normals, b.normals) && IsSameStream(a.tangents, b.tangents) &&
+		IsSameStream(a.skinWeights, b.skinWeights) && IsSameStream(a.skinIndices, b.skinIndices) && IsSameStream(a.indices, b.indices) &&
+		IsSameStream(a.subMeshes, b.subMeshes) && IsSameStream(a.jointParents, b.jointParents) && IsSameStream(a.bindPose, b.bindPose) &&
+		IsSameStream(a.inverseBindPose, b.inverseBindPose) && IsSameStream(a.mBindPoseIndices, b.mBindPoseIndices) &&
+		IsSameStream(a.mBindPoseStates, b.mBindPoseStates) && a.jointNames == b.jointNames && a.subMeshNames == b.subMeshNames;
+}
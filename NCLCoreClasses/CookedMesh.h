@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace NCL::Rendering {
+	class Mesh;
+
+	// A .msh converted offline into one little-endian blob: a header, then one 16 byte aligned stream per
+	// attribute, laid out exactly as the Mesh holds it (and as OGLMesh uploads it, one buffer per attribute).
+	// Loading maps the blob and hands each stream to the mesh in a single copy, nothing is parsed.
+	// It is kept in the AssetCache under a hash of the .msh, so an edited mesh is read as text and cooked again.
+	class CookedMesh {
+	public:
+		static constexpr uint32_t VERSION = 2;
+		static constexpr const char* IMPORTER = "mesh";
+
+		//The AssetCache artifact for Assets/Meshes/<filename>, empty if the .msh can't be read.
+		static std::string GetCookedPath(const std::string& filename);
+
+		//mesh as loaded from the text of filename.
+		static bool Cook(const std::string& filename, const Mesh& mesh);
+		//False, with the mesh untouched, when the .msh hasn't been cooked as it is now.
+		static bool Load(const std::string& filename, Mesh& mesh);
+
+		static bool IsSameMesh(const Mesh& a, const Mesh& b);
+	};
+}
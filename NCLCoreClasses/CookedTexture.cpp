@@ -0,0 +1,107 @@
+#include "CookedTexture.h"
+#include "AssetCache.h"
+#include "MappedFile.h"
+
+#include "./stb/stb_image_resize.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+using namespace NCL;
+
+namespace {
+	//"NTEX" at the start of the file.
+	constexpr uint32_t COOKED_TEXTURE_MAGIC = 0x5845544E;
+	constexpr int CHANNELS = 4;
+
+	static_assert(std::endian::native == std::endian::little, "Cooked textures are little-endian");
+
+	struct CookedTextureHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t width;
+		uint32_t height;
+		uint32_t mipCount;
+		uint32_t padding[3];
+	};
+	static_assert(sizeof(CookedTextureHeader) == 32, "Cooked texture header layout changed, bump VERSION");
+
+	size_t GetMipSize(int width, int height, int level) {
+		return (size_t)std::max(1, width >> level) * (size_t)std::max(1, height >> level) * CHANNELS;
+	}
+}
+
+std::string CookedTexture::GetCookedPath(const std::string& imagePath) {
+	return AssetCache::GetArtifactPath(imagePath, IMPORTER, VERSION);
+}
+
+bool CookedTexture::Cook(const std::string& imagePath, const unsigned char* pixels, int width, int height) {
+	const std::string cookedPath = GetCookedPath(imagePath);
+	if (cookedPath.empty() || width <= 0 || height <= 0) {
+		return false;
+	}
+	CookedTextureHeader header = {};
+	header.magic = COOKED_TEXTURE_MAGIC;
+	header.version = VERSION;
+	header.width = (uint32_t)width;
+	header.height = (uint32_t)height;
+	header.mipCount = (uint32_t)GetMipCount(width, height);
+
+	std::vector<char> blob(sizeof(CookedTextureHeader) + GetMipChainSize(width, height));
+	memcpy(blob.data(), &header, sizeof(CookedTextureHeader));
+	unsigned char* level = (unsigned char*)blob.data() + sizeof(CookedTextureHeader);
+	memcpy(level, pixels, GetMipSize(width, height, 0));
+	//each level from the one before, as glGenerateMipmap would
+	for (int i = 1; i < (int)header.mipCount; i++) {
+		unsigned char* nextLevel = level + GetMipSize(width, height, i - 1);
+		stbir_resize_uint8(level, std::max(1, width >> (i - 1)), std::max(1, height >> (i - 1)), 0,
+			nextLevel, std::max(1, width >> i), std::max(1, height >> i), 0, CHANNELS);
+		level = nextLevel;
+	}
+	return AssetCache::WriteArtifact(cookedPath, blob.data(), blob.size());
+}
+
+bool CookedTexture::Load(const std::string& imagePath, char*& outData, int& width, int& height) {
+	const std::string cookedPath = GetCookedPath(imagePath);
+	MappedFile cooked;
+	//not cooked isn't worth a message, MappedFile would print one
+	if (cookedPath.empty() || !std::filesystem::exists(cookedPath) || !cooked.Open(cookedPath) || cooked.GetSize() < sizeof(CookedTextureHeader)) {
+		return false;
+	}
+	const CookedTextureHeader& header = *(const CookedTextureHeader*)cooked.GetData();
+	if (header.magic != COOKED_TEXTURE_MAGIC || header.version != VERSION || header.width == 0 || header.height == 0 ||
+		header.width > INT32_MAX || header.height > INT32_MAX || header.mipCount != (uint32_t)GetMipCount(header.width, header.height)) {
+		return false;
+	}
+	const size_t chainSize = GetMipChainSize(header.width, header.height);
+	if (sizeof(CookedTextureHeader) + chainSize > cooked.GetSize()) {
+		std::cout << __FUNCTION__ << " " << cookedPath << " is truncated\n";
+		return false;
+	}
+	//callers free() what TextureLoader gives them
+	outData = (char*)malloc(chainSize);
+	if (!outData) {
+		return false;
+	}
+	memcpy(outData, cooked.GetData() + sizeof(CookedTextureHeader), chainSize);
+	width = (int)header.width;
+	height = (int)header.height;
+	return true;
+}
+
+int CookedTexture::GetMipCount(int width, int height) {
+	return std::bit_width((unsigned int)std::max(width, height));
+}
+
+size_t CookedTexture::GetMipChainSize(int width, int height) {
+	size_t size = 0;
+	for (int i = 0; i < GetMipCount(width, height); i++) {
+		size += GetMipSize(width, height, i);
+	}
+	return size;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace NCL {
+	// An image already decoded to RGBA8, followed by every smaller mip level down to 1x1, each half the size of
+	// the one before. Loading it runs neither the image decoder nor mip generation.
+	// Kept in the AssetCache under a hash of the image file.
+	class CookedTexture {
+	public:
+		static constexpr uint32_t VERSION = 1;
+		static constexpr const char* IMPORTER = "texture";
+
+		//The AssetCache artifact for imagePath, empty if the image can't be read.
+		static std::string GetCookedPath(const std::string& imagePath);
+
+		//pixels as stb_image decoded them from imagePath, 4 channels.
+		static bool Cook(const std::string& imagePath, const unsigned char* pixels, int width, int height);
+		//outData is malloced, like stb_image's, and holds the whole chain from level 0.
+		//False, with nothing allocated, when the image hasn't been cooked as it is now.
+		static bool Load(const std::string& imagePath, char*& outData, int& width, int& height);
+
+		static int GetMipCount(int width, int height);
+		static size_t GetMipChainSize(int width, int height);
+	};
+}
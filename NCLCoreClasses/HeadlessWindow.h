@@ -0,0 +1,17 @@
+#pragma once
+#include "Window.h"
+
+namespace NCL {
+	//Stands in for the OS window on the dedicated server. There is nothing to draw to or read input from,
+	//but the keyboard and mouse exist and are never pressed, so gameplay code can poll them as usual.
+	class HeadlessWindow : public Window {
+	public:
+		friend class Window;
+
+	protected:
+		HeadlessWindow(const std::string& title, int sizeX, int sizeY);
+		virtual ~HeadlessWindow();
+
+		bool	InternalUpdate()	override;
+	};
+}
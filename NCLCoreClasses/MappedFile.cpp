@@ -0,0 +1,114 @@
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace NCL;
+
+MappedFile::MappedFile() {
+	mData = nullptr;
+	mSize = 0;
+#ifdef _WIN32
+	mFileHandle = INVALID_HANDLE_VALUE;
+	mMappingHandle = nullptr;
+#else
+	mFileDescriptor = -1;
+#endif
+}
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& filepath) {
+	Close();
+
+	mFileHandle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (mFileHandle == INVALID_HANDLE_VALUE) {
+		std::cout << __FUNCTION__ << " can't open file " << filepath << "\n";
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	//an empty file can't be mapped
+	if (!GetFileSizeEx(mFileHandle, &fileSize) || fileSize.QuadPart == 0) {
+		Close();
+		return false;
+	}
+	mMappingHandle = CreateFileMappingA(mFileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (mMappingHandle) {
+		mData = (char*)MapViewOfFile(mMappingHandle, FILE_MAP_COPY, 0, 0, 0);
+	}
+	if (!mData) {
+		std::cout << __FUNCTION__ << " can't map file " << filepath << "\n";
+		Close();
+		return false;
+	}
+	mSize = (size_t)fileSize.QuadPart;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (mData) {
+		UnmapViewOfFile(mData);
+	}
+	if (mMappingHandle) {
+		CloseHandle(mMappingHandle);
+	}
+	if (mFileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(mFileHandle);
+	}
+	mData = nullptr;
+	mSize = 0;
+	mMappingHandle = nullptr;
+	mFileHandle = INVALID_HANDLE_VALUE;
+}
+#else
+bool MappedFile::Open(const std::string& filepath) {
+	Close();
+
+	mFileDescriptor = open(filepath.c_str(), O_RDONLY);
+	if (mFileDescriptor < 0) {
+		std::cout << __FUNCTION__ << " can't open file " << filepath << "\n";
+		return false;
+	}
+	struct stat fileStat;
+	//an empty file can't be mapped
+	if (fstat(mFileDescriptor, &fileStat) != 0 || fileStat.st_size == 0) {
+		Close();
+		return false;
+	}
+	void* data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, mFileDescriptor, 0);
+	if (data == MAP_FAILED) {
+		std::cout << __FUNCTION__ << " can't map file " << filepath << "\n";
+		Close();
+		return false;
+	}
+	mData = (char*)data;
+	mSize = (size_t)fileStat.st_size;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (mData) {
+		munmap(mData, mSize);
+	}
+	if (mFileDescriptor >= 0) {
+		close(mFileDescriptor);
+	}
+	mData = nullptr;
+	mSize = 0;
+	mFileDescriptor = -1;
+}
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace NCL {
+	// A whole file mapped into memory, read only as far as the file is concerned. Pages are copy on write,
+	// so the contents can be changed in place without the changes ever reaching the disk.
+	class MappedFile {
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::string& filepath);
+		void Close();
+
+		bool IsOpen() const { return mData != nullptr; }
+		char* GetData() const { return mData; }
+		size_t GetSize() const { return mSize; }
+
+	protected:
+		char* mData;
+		size_t mSize;
+#ifdef _WIN32
+		void* mFileHandle;
+		void* mMappingHandle;
+#else
+		int mFileDescriptor;
+#endif
+	};
+}
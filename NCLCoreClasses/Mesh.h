@@ -66,6 +66,7 @@ namespace NCL::Rendering {
 	};
 
 	class Mesh	{
+		friend class CookedMesh;
 	public:		
 		virtual ~Mesh();
 		
@@ -1,6 +1,7 @@
 #include "MeshAnimation.h"
 #include "Matrix4.h"
 #include "Assets.h"
+#include "CookedAnimation.h"
 
 using namespace NCL;
 using namespace Rendering;
@@ -20,6 +21,12 @@ MeshAnimation::MeshAnimation(size_t jointCount, size_t frameCount, float frameRa
 }
 
 MeshAnimation::MeshAnimation(const std::string& filename) : MeshAnimation() {
+	if (!CookedAnimation::Load(filename, *this) && LoadTextAnimation(filename) && CookedAnimation::HasAllFrames(*this)) {
+		CookedAnimation::Cook(filename, *this);
+	}
+}
+
+bool MeshAnimation::LoadTextAnimation(const std::string& filename) {
 	std::ifstream file(Assets::MESHDIR + filename);
 
 	std::string filetype;
@@ -29,7 +36,7 @@ MeshAnimation::MeshAnimation(const std::string& filename) : MeshAnimation() {
 
 	if (filetype != "MeshAnim") {
 		std::cout << __FUNCTION__ << " File is not a MeshAnim file!\n";
-		return;
+		return false;
 	}
 	file >> fileVersion;
 	file >> frameCount;
@@ -91,6 +98,7 @@ MeshAnimation::MeshAnimation(const std::string& filename) : MeshAnimation() {
 
 	tempExp = nullptr;
 	delete[] tempExp;
+	return true;
 }
 
 float MeshAnimation::StrToFloat(const char* str, const char* exp, const bool hasExponent, int strLen) {
@@ -145,13 +153,14 @@ MeshAnimation::~MeshAnimation() {
 
 }
 
-const Matrix4* MeshAnimation::GetJointData(size_t frame) const {
-	if (frame >= frameCount) {
-		return nullptr;
+Matrix4 MeshAnimation::GetJointMatrix(size_t frame, size_t joint) const {
+	if (frame >= frameCount || joint >= jointCount) {
+		return Matrix4();
 	}
-	int matStart = frame * jointCount;
-
-	Matrix4* dataStart = (Matrix4*)allJoints.data();
-
-	return dataStart + matStart;
-}
\ No newline at end of file
+	if (cookedClip.IsOpen()) {
+		return CookedAnimation::SampleJoint(cookedClip, frame, joint);
+	}
+	//a clip the text parser couldn't read has its counts but no frames
+	const size_t index = frame * jointCount + joint;
+	return index < allJoints.size() ? allJoints[index] : Matrix4();
+}
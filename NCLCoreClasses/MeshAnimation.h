@@ -7,6 +7,7 @@ Comments and queries to: richard-gordon.davison AT ncl.ac.uk
 https://research.ncl.ac.uk/game/
 */
 #pragma once
+#include "MappedFile.h"
 
 namespace NCL::Maths {
 	class Matrix4;
@@ -17,6 +18,7 @@ namespace NCL::Rendering {
 	using SharedMeshAnim = std::shared_ptr<class MeshAnimation>;
 
 	class MeshAnimation	{
+		friend class CookedAnimation;
 	public:
 		MeshAnimation();
 		MeshAnimation(size_t jointCount, size_t frameCount, float frameRate, std::vector<Maths::Matrix4>& frames);
@@ -24,6 +26,9 @@ namespace NCL::Rendering {
 
 		virtual ~MeshAnimation();
 
+		//Always parses the .anm text, for converting it. The constructor uses an up to date cooked copy first.
+		bool LoadTextAnimation(const std::string& filename);
+
 		size_t GetJointCount() const {
 			return jointCount;
 		}
@@ -40,7 +45,8 @@ namespace NCL::Rendering {
 			return 1.0f / (float)frameRate;
 		}
 
-		const Maths::Matrix4* GetJointData(size_t frame) const;
+		//Cooked clips keep their keys compressed and build the matrix when it is asked for.
+		Maths::Matrix4 GetJointMatrix(size_t frame, size_t joint) const;
 
 	protected:
 		static float StrToFloat(const char* str, const char* exp, const bool hasExponent, int strLen);
@@ -50,6 +56,8 @@ namespace NCL::Rendering {
 		float		frameRate;
 
 		std::vector<Maths::Matrix4>		allJoints;
+		//Open instead of allJoints being filled when the clip was loaded from its cooked copy.
+		MappedFile						cookedClip;
 	};
 }
 
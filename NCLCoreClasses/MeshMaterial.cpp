@@ -1,5 +1,6 @@
 #include "MeshMaterial.h"
 #include "Assets.h"
+#include "CookedMaterial.h"
 #include "TextureLoader.h"
 
 using namespace NCL;
@@ -9,6 +10,12 @@ using std::ifstream;
 
 
 MeshMaterial::MeshMaterial(const std::string& filename) {
+	if (!CookedMaterial::Load(filename, *this) && LoadTextMaterial(filename)) {
+		CookedMaterial::Cook(filename, *this);
+	}
+}
+
+bool MeshMaterial::LoadTextMaterial(const std::string& filename) {
 	ifstream file(Assets::MESHDIR + filename);
 
 	string dataType;
@@ -16,14 +23,14 @@ MeshMaterial::MeshMaterial(const std::string& filename) {
 
 	if (dataType != "MeshMat") {
 		std::cout << __FUNCTION__ << " File " << filename << " is not a MeshMaterial!\n";
-		return;
+		return false;
 	}
 	int version;
 	file >> version;
 
 	if (version != 1) {
 		std::cout << __FUNCTION__ << " File " << filename << " has incompatible version " << version << "!\n";
-		return;
+		return false;
 	}
 
 	int matCount;
@@ -57,6 +64,7 @@ MeshMaterial::MeshMaterial(const std::string& filename) {
 		file >> entry;
 		meshLayers.emplace_back(&materialLayers[entry]);
 	}
+	return true;
 }
 
 const MeshMaterialEntry* MeshMaterial::GetMaterialForLayer(int i) const {
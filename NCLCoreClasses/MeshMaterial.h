@@ -20,6 +20,7 @@ namespace NCL {
 	}
 	class MeshMaterialEntry {
 		friend class MeshMaterial;
+		friend class CookedMaterial;
 	public:
 		bool GetEntry(const string& name, const string** output) const {
 			auto i = entries.find(name);
@@ -43,13 +44,17 @@ namespace NCL {
 	};
 
 	class MeshMaterial	{
-
+		friend class CookedMaterial;
 
 	public:
+		MeshMaterial() {}
 		MeshMaterial(const std::string& filename);
 		~MeshMaterial() {}
 		const MeshMaterialEntry* GetMaterialForLayer(int i) const;
 
+		//The .mat parsed as text, whether or not there is a cooked copy.
+		bool LoadTextMaterial(const std::string& filename);
+
 		void LoadTextures();
 
 	protected:
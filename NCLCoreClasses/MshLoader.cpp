@@ -13,13 +13,25 @@
 #include "Maths.h"
 
 #include "Mesh.h"
+#include "CookedMesh.h"
 
 using namespace NCL;
 using namespace Rendering;
 using namespace Maths;
 
 bool MshLoader::LoadMesh(const std::string& filename, Mesh& destinationMesh) {
-	
+	if (CookedMesh::Load(filename, destinationMesh)) {
+		return true;
+	}
+	if (!LoadTextMesh(filename, destinationMesh)) {
+		return false;
+	}
+	//so the next run finds it in the cache
+	CookedMesh::Cook(filename, destinationMesh);
+	return true;
+}
+
+bool MshLoader::LoadTextMesh(const std::string& filename, Mesh& destinationMesh) {
 	std::ifstream file(Assets::MESHDIR + filename);
 
 	std::string filetype;
@@ -56,7 +56,10 @@ namespace NCL::Rendering {
 	};
 
 	public:		
+		//Uses the cooked copy of the file when there is an up to date one.
 		static bool LoadMesh(const std::string& filename, Mesh& destinationMesh);
+		//Always parses the .msh text, for converting it.
+		static bool LoadTextMesh(const std::string& filename, Mesh& destinationMesh);
 
 	protected:
 		static unsigned int StrToUInt(const char* str, int strLen);
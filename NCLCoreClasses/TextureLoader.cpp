@@ -15,6 +15,7 @@ https://research.ncl.ac.uk/game/
 #include "./stb/stb_image_write.h"
 
 #include "Assets.h"
+#include "CookedTexture.h"
 
 using namespace NCL;
 using namespace Rendering;
@@ -56,13 +57,22 @@ bool TextureLoader::LoadTexture(const std::string& filename, char*& outData, int
 		return it->second(realPath, outData, width, height, channels, flags);
 	}
 
+	const std::string imagePath = highestQuality ? realPath : GetImagePath(filename);
+	if (CookedTexture::Load(imagePath, outData, width, height)) {
+		channels = 4;
+		flags |= MIP_CHAIN_FLAG;
+		return true;
+	}
+
 	stbi_uc* texData = nullptr;
+	std::string decodedPath = texturePath;
 
-	if(!highestQuality) {
+	if(imagePath == texturePath) {
 		texData = stbi_load(texturePath.c_str(), &width, &height, &channels, 4);
 	}
 
 	if (!texData) {
+		decodedPath = realPath;
 		texData = stbi_load(realPath.c_str(), &width, &height, &channels, 4); //4 forces this to always be rgba!
 		if(texData && createTextureFiles) CreateTextureFile(filename, texData, width, height, resize);
 	}
@@ -70,6 +80,7 @@ bool TextureLoader::LoadTexture(const std::string& filename, char*& outData, int
 	channels = 4; //it gets forced, we don't care about the 'real' channel size
 
 	if (texData) {
+		CookedTexture::Cook(decodedPath, texData, width, height);
 		outData = (char*)texData;
 		std::cout << "success"+filename << "\n";
 		//CreateTxtrFile(filename, outData, width, height, channels, flags);
@@ -79,6 +90,16 @@ bool TextureLoader::LoadTexture(const std::string& filename, char*& outData, int
 	return false;
 }
 
+std::string TextureLoader::GetImagePath(const std::string& filename) {
+	const bool isAbsolute = std::filesystem::path(filename).is_absolute();
+	const std::string textureFilename = filename.substr(0, filename.find('.')) + ".texture";
+	const std::string texturePath = isAbsolute ? textureFilename : Assets::TEXTUREDIR + textureFilename;
+	if (std::filesystem::exists(texturePath)) {
+		return texturePath;
+	}
+	return isAbsolute ? filename : Assets::TEXTUREDIR + filename;
+}
+
 void TextureLoader::RegisterTextureLoadFunction(TextureLoadFunction f, const std::string&fileExtension) {
 	fileHandlers.insert(std::make_pair(fileExtension, f));
 }
@@ -22,8 +22,14 @@ namespace NCL {
 
 	class TextureLoader	{
 	public:
+		//Set in flags by LoadTexture when outData is followed by every smaller mip level, each half the one before.
+		static constexpr int MIP_CHAIN_FLAG = 1;
+
 		static bool LoadTexture(const std::string& filename, char*& outData, int& width, int &height, int &channels, int&flags, bool resize = true);
 
+		//The file LoadTexture decodes for filename, its smaller .texture copy whenever there is one.
+		static std::string GetImagePath(const std::string& filename);
+
 		static void RegisterTextureLoadFunction(TextureLoadFunction f, const std::string&fileExtension);
 
 		static void DeleteTextureData(char* data);
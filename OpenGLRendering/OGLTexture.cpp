@@ -25,7 +25,7 @@ OGLTexture::~OGLTexture()	{
 	glDeleteTextures(1, &texID);
 }
 
-UniqueOGLTexture OGLTexture::TextureFromData(char* data, int width, int height, int channels) {
+UniqueOGLTexture OGLTexture::TextureFromData(char* data, int width, int height, int channels, int flags) {
 	UniqueOGLTexture tex = std::make_unique<OGLTexture>();
 	tex->dimensions = { width, height };
 
@@ -48,7 +48,17 @@ UniqueOGLTexture OGLTexture::TextureFromData(char* data, int width, int height,
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	glGenerateMipmap(GL_TEXTURE_2D);
+	if ((flags & TextureLoader::MIP_CHAIN_FLAG) && channels == 4) {
+		//the rest of the chain follows level 0, down to 1x1
+		char* level = data;
+		for (int i = 1; (width >> (i - 1)) > 1 || (height >> (i - 1)) > 1; i++) {
+			level += std::max(1, width >> (i - 1)) * std::max(1, height >> (i - 1)) * channels;
+			glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, std::max(1, width >> i), std::max(1, height >> i), 0, sourceType, GL_UNSIGNED_BYTE, level);
+		}
+	}
+	else {
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
 
 	glBindTexture(GL_TEXTURE_2D, 0);
 	
@@ -63,7 +73,7 @@ UniqueOGLTexture OGLTexture::TextureFromFile(const std::string&name, bool resize
 	int flags		= 0;
 	TextureLoader::LoadTexture(name, texData, width, height, channels, flags, resize);  
 
-	UniqueOGLTexture glTex = TextureFromData(texData, width, height, channels);
+	UniqueOGLTexture glTex = TextureFromData(texData, width, height, channels, flags);
 
 	free(texData);
 
@@ -21,7 +21,8 @@ namespace NCL::Rendering {
 		OGLTexture(GLuint texToOwn);
 		~OGLTexture();
 
-		static UniqueOGLTexture TextureFromData(char* data, int width, int height, int channels);
+		//flags as TextureLoader set them, with its MIP_CHAIN_FLAG every level is uploaded rather than generated
+		static UniqueOGLTexture TextureFromData(char* data, int width, int height, int channels, int flags = 0);
 
 		static UniqueOGLTexture TextureFromFile(const std::string&name, bool resize = true);
 
@@ -0,0 +1,5 @@
+#include "../CSC8503/ServerStart.cpp"
+
+int main(int argc, char** argv) {
+	return RunServer(argc, argv);
+}
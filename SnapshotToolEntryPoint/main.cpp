@@ -0,0 +1,5 @@
+#include "../CSC8503/SnapshotToolStart.cpp"
+
+int main(int argc, char** argv) {
+	return RunSnapshotTool(argc, argv);
+}